@@ -0,0 +1,315 @@
+#!/usr/bin/env python
+"""Benchmarks of the hot paths of pygame.mixer and pygame.mixer.music.
+
+The mixer is opened offline, with no audio device, and mixes only when a
+benchmark renders, so this runs on a headless machine and nothing is heard.
+A pygame that can't mix offline, to compare against, gets a real-time mixer
+on SDL's disk audio driver writing to the null device instead, and skips the
+benchmarks that render. Every benchmark runs for each sample size and
+channel count, and reports the time per operation, and the throughput where
+there is data to move.
+
+    python benchmarks/mixer_benchmark.py
+    python benchmarks/mixer_benchmark.py --save before.json
+    python benchmarks/mixer_benchmark.py --compare before.json
+
+Each benchmark is timed several times and the fastest run is kept, being
+the one least disturbed by the rest of the system. With --compare, the exit
+status is 1 when something got slower than the tolerance allows.
+"""
+
+import argparse
+import io
+import json
+import os
+import sys
+import tempfile
+import time
+import wave
+
+os.environ.setdefault("SDL_VIDEODRIVER", "dummy")
+os.environ.setdefault("SDL_AUDIODRIVER", "disk")
+os.environ.setdefault("SDL_DISKAUDIOFILE", os.devnull)
+
+import pygame
+from pygame import mixer
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+FREQUENCY = 44100
+SIZES = (8, -16, 32)
+CHANNELS = (1, 2)
+SECONDS = 1.0  # of the sounds loaded and converted
+END_CHANNELS = 64
+
+WAV_WIDTHS = {8: 1, -16: 2, 32: 4}
+ARRAY_TYPES = {8: "uint8", -16: "int16", 32: "float32"}
+
+
+def best_of(repeat, number, func, setup=None):
+    """The fastest of repeat runs of func(number), in ns per operation."""
+    best = None
+    for _ in range(repeat):
+        if setup is not None:
+            setup()
+        start = time.perf_counter_ns()
+        func(number)
+        elapsed = time.perf_counter_ns() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best / number
+
+
+def samples(length):
+    """Deterministic bytes that are not all silence."""
+    return (bytes(range(256)) * (length // 256 + 1))[:length]
+
+
+def wav_bytes(size, channels, frames):
+    """A WAV file of frames, with the sample width of size."""
+    width = WAV_WIDTHS[size]
+    data = io.BytesIO()
+    with wave.open(data, "wb") as wav:
+        wav.setnchannels(channels)
+        wav.setsampwidth(width)
+        wav.setframerate(FREQUENCY)
+        wav.writeframes(samples(frames * channels * width))
+    return data.getvalue()
+
+
+def open_mixer(size, channels):
+    """Open the mixer offline, or in real time where this pygame can't mix
+    offline. Returns whether it is offline."""
+    try:
+        mixer.init(FREQUENCY, size, channels, offline=True)
+        return True
+    except TypeError:
+        mixer.init(FREQUENCY, size, channels)
+        return False
+
+
+class Benchmarks:
+    """The benchmarks of one mixer format."""
+
+    def __init__(self, size, channels, offline, repeat, scale):
+        self.size = size
+        self.channels = channels
+        self.offline = offline
+        self.repeat = repeat
+        self.scale = scale
+        self.frame = abs(size) // 8 * channels
+        self.frames = int(FREQUENCY * SECONDS)
+        self.raw = samples(self.frames * self.frame)
+        self.wav = wav_bytes(size, channels, self.frames)
+
+    def run(self, number, func, setup=None):
+        return best_of(self.repeat, max(1, int(number * self.scale)), func, setup)
+
+    def bench_load_wav(self):
+        """Sound(file) from a WAV file in memory."""
+
+        def func(number):
+            for _ in range(number):
+                mixer.Sound(file=io.BytesIO(self.wav))
+
+        return self.run(20, func), len(self.wav)
+
+    def bench_from_buffer(self):
+        """Sound(buffer) copying raw samples."""
+
+        def func(number):
+            for _ in range(number):
+                mixer.Sound(buffer=self.raw)
+
+        return self.run(50, func), len(self.raw)
+
+    def bench_from_array(self):
+        """Sound(array), through _chunk_from_array."""
+        if numpy is None:
+            return None
+        array = numpy.frombuffer(self.raw, dtype=ARRAY_TYPES[self.size])
+        if self.channels > 1:
+            array = array.reshape(-1, self.channels)
+
+        def func(number):
+            for _ in range(number):
+                mixer.Sound(array=array)
+
+        return self.run(50, func), len(self.raw)
+
+    def bench_channel_play(self):
+        """Channel.play, taking over the sound already playing."""
+        sound = mixer.Sound(buffer=self.raw)
+        channel = mixer.Channel(0)
+
+        def func(number):
+            for _ in range(number):
+                channel.play(sound)
+
+        result = self.run(10000, func)
+        channel.stop()
+        return result, None
+
+    def bench_sound_play(self):
+        """Sound.play, on a free channel."""
+        sound = mixer.Sound(buffer=self.raw)
+        number = max(1, int(1000 * self.scale))
+
+        def setup():
+            mixer.stop()
+            mixer.set_num_channels(number)
+
+        def func(number):
+            for _ in range(number):
+                sound.play()
+
+        result = best_of(self.repeat, number, func, setup)
+        mixer.stop()
+        mixer.set_num_channels(8)
+        return result, None
+
+    def bench_channel_end(self):
+        """A sound playing to its end, with an end event, until Python sees
+        the channel free again."""
+        if not self.offline:
+            return None
+        sound = mixer.Sound(buffer=self.raw[: self.frame])
+        channels = [mixer.Channel(i) for i in range(END_CHANNELS)]
+        # rendering a buffer at a time makes each render one callback
+        mixer.render_offline(1 / FREQUENCY)
+        buffer = mixer.get_stats()["buffer"]
+        for channel in channels:
+            channel.set_endevent(pygame.USEREVENT)
+
+        def func(number):
+            for _ in range(number // END_CHANNELS):
+                for channel in channels:
+                    channel.play(sound)
+                mixer.render_offline(buffer / FREQUENCY)
+                for channel in channels:
+                    channel.get_busy()
+                pygame.event.clear()
+
+        mixer.set_num_channels(END_CHANNELS)
+        result = self.run(END_CHANNELS * 50, func)
+        for channel in channels:
+            channel.set_endevent()
+        mixer.set_num_channels(8)
+        return result, None
+
+    def bench_render(self):
+        """Mixing a second of eight looping channels."""
+        if not self.offline:
+            return None
+        sound = mixer.Sound(buffer=self.raw)
+        for i in range(8):
+            mixer.Channel(i).play(sound, loops=-1)
+
+        def func(number):
+            for _ in range(number):
+                mixer.render_offline(1.0)
+
+        result = self.run(5, func)
+        mixer.stop()
+        return result, FREQUENCY * self.frame
+
+    def bench_music_get_pos(self):
+        """music.get_pos while the music plays."""
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "music.wav")
+            with open(path, "wb") as file:
+                file.write(self.wav)
+            mixer.music.load(path)
+            mixer.music.play(loops=-1)
+            if self.offline:
+                mixer.render_offline(0.1)
+            else:
+                time.sleep(0.1)
+
+            def func(number):
+                for _ in range(number):
+                    mixer.music.get_pos()
+
+            result = self.run(100000, func)
+            mixer.music.stop()
+            mixer.music.unload()
+        return result, None
+
+
+def run(args):
+    results = {}
+    names = [name for name in dir(Benchmarks) if name.startswith("bench_")]
+    pygame.init()
+    for size in SIZES:
+        for channels in CHANNELS:
+            mixer.quit()
+            offline = open_mixer(size, channels)
+            benchmarks = Benchmarks(size, channels, offline, args.repeat, args.scale)
+            for name in names:
+                label = name[len("bench_") :]
+                if args.filter and args.filter not in label:
+                    continue
+                result = getattr(benchmarks, name)()
+                if result is None:
+                    continue
+                ns, nbytes = result
+                key = f"{label}/{size}/{channels}"
+                results[key] = ns
+                line = f"{label:<16} {size:>4} {channels:>3} {ns:>14.0f} ns/op"
+                if nbytes:
+                    line += f" {nbytes * 1000.0 / ns:>10.1f} MB/s"
+                print(line)
+    mixer.quit()
+    pygame.quit()
+    return results
+
+
+def compare(results, path, tolerance):
+    with open(path) as file:
+        before = json.load(file)
+    slower = 0
+    print()
+    for key, ns in results.items():
+        if key not in before:
+            continue
+        ratio = ns / before[key]
+        mark = ""
+        if ratio > 1.0 + tolerance:
+            mark = "  slower"
+            slower += 1
+        print(f"{key:<32} {ratio:>6.2f}x{mark}")
+    return slower
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--filter", help="run the benchmarks with this in their name")
+    parser.add_argument("--repeat", type=int, default=5, help="runs of each benchmark")
+    parser.add_argument(
+        "--scale", type=float, default=1.0, help="multiply the operations timed"
+    )
+    parser.add_argument("--save", help="write the results to this JSON file")
+    parser.add_argument("--compare", help="compare with results saved before")
+    parser.add_argument(
+        "--tolerance",
+        type=float,
+        default=0.1,
+        help="how much slower counts as a regression, 0.1 for 10%%",
+    )
+    args = parser.parse_args()
+
+    print(f"pygame {pygame.version.ver}, SDL_mixer {mixer.get_sdl_mixer_version()}")
+    results = run(args)
+    if args.save:
+        with open(args.save, "w") as file:
+            json.dump(results, file, indent=1, sort_keys=True)
+    if args.compare and compare(results, args.compare, args.tolerance):
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,4 +1,4 @@
-from typing import Callable, List
+from typing import Any, Callable, List, Optional, Tuple
 
 AUDIO_U8: int
 AUDIO_S8: int
@@ -32,7 +32,8 @@ class AudioDevice:
         numchannels: int,
         chunksize: int,
         allowed_changes: int,
-        callback: Callable[[AudioDevice, memoryview], None],
+        callback: Optional[Callable[[AudioDevice, memoryview], None]] = None,
+        ring_frames: int = 0,
     ) -> None: ...
     @property
     def iscapture(self) -> bool: ...
@@ -41,7 +42,7 @@ class AudioDevice:
     @property
     def devicename(self) -> str: ...
     @property
-    def callback(self) -> Callable[[AudioDevice, memoryview], None]: ...
+    def callback(self) -> Optional[Callable[[AudioDevice, memoryview], None]]: ...
     @property
     def frequency(self) -> int: ...
     @property
@@ -52,3 +53,8 @@ class AudioDevice:
     def chunksize(self) -> int: ...
     def pause(self, pause_on: int) -> None: ...
     def close(self) -> None: ...
+    def get_available(self) -> int: ...
+    def read(self, frames: int = -1) -> bytes: ...
+    def read_into(self, buffer: Any) -> int: ...
+    def get_levels(self) -> Tuple[Tuple[float, ...], Tuple[float, ...]]: ...
+    def get_dropped(self) -> int: ...
@@ -1,11 +1,23 @@
-from typing import Any, Dict, Optional, Tuple, Union, overload
+from typing import (
+    Any,
+    Dict,
+    Iterable,
+    List,
+    Mapping,
+    Optional,
+    Sequence,
+    Tuple,
+    Union,
+    overload,
+)
 
 import numpy
 
 from pygame.event import Event
+from pygame.math import Vector3
 
 from . import mixer_music
-from ._common import FileArg
+from ._common import AnyPath, FileArg
 
 # export mixer_music as mixer.music
 music = mixer_music
@@ -17,6 +29,7 @@ def init(
     buffer: int = 512,
     devicename: Optional[str] = None,
     allowedchanges: int = 5,
+    offline: bool = False,
 ) -> None: ...
 def pre_init(
     frequency: int = 44100,
@@ -32,26 +45,68 @@ def get_driver() -> str: ...
 def stop() -> None: ...
 def pause() -> None: ...
 def unpause() -> None: ...
+def set_volumes(
+    channels: Sequence[Union[Channel, int]],
+    volumes: Sequence[Union[float, Tuple[float, float]]],
+) -> None: ...
+def set_source_locations(
+    channels: Sequence[Union[Channel, int]],
+    locations: Sequence[Tuple[float, float]],
+) -> None: ...
 def fadeout(time: int, /) -> None: ...
 def set_num_channels(count: int, /) -> None: ...
 def get_num_channels() -> int: ...
 def set_reserved(count: int, /) -> int: ...
+def set_num_virtual(count: int, /) -> None: ...
+def get_num_virtual() -> int: ...
 def find_channel(force: bool = False) -> Channel: ...
 def set_soundfont(paths: Optional[str] = None, /) -> None: ...
 def get_soundfont() -> Optional[str]: ...
 def get_busy() -> bool: ...
+def get_sample_clock() -> int: ...
+def get_stats(reset: bool = False) -> Dict[str, Union[int, float]]: ...
+@overload
+def render_offline(seconds: float, file: None = None) -> bytes: ...
+@overload
+def render_offline(seconds: float, file: FileArg) -> None: ...
 def get_sdl_mixer_version(linked: bool = True) -> Tuple[int, int, int]: ...
+def load_sounds_async(
+    paths: Sequence[AnyPath], workers: int = 0, event: int = 0
+) -> SoundLoader: ...
+def resample_buffer(
+    buffer: Any, rate: int, new_rate: int = 0, quality: int = 1
+) -> bytes: ...
+def write_sound_bank(
+    file: FileArg,
+    sounds: Union[Mapping[str, Sound], Iterable[Tuple[str, Sound]]],
+    adpcm: bool = False,
+) -> None: ...
+def play_streams(
+    streams: Sequence[MusicStream], loops: int = 0, at_sample: Optional[int] = None
+) -> int: ...
+def set_output_effects(effects: Sequence[Effect], /) -> None: ...
+def get_output_effects() -> Tuple[Effect, ...]: ...
+def set_listener(
+    position: Optional[Sequence[float]] = None,
+    velocity: Optional[Sequence[float]] = None,
+    forward: Optional[Sequence[float]] = None,
+    up: Optional[Sequence[float]] = None,
+    speed_of_sound: Optional[float] = None,
+) -> None: ...
+def get_listener() -> Dict[str, Union[Vector3, float]]: ...
 
 class Sound:
     @overload
-    def __init__(self, file: FileArg) -> None: ...
+    def __init__(
+        self, file: FileArg, stream: bool = False, mmap: bool = False
+    ) -> None: ...
     @overload
     def __init__(
-        self, buffer: Any
+        self, buffer: Any, copy: bool = True
     ) -> None: ...  # Buffer protocol is still not implemented in typing
     @overload
     def __init__(
-        self, array: numpy.ndarray
+        self, array: numpy.ndarray, copy: bool = True
     ) -> None: ...  # Buffer protocol is still not implemented in typing
     def play(
         self,
@@ -67,9 +122,13 @@ class Sound:
     def fadeout(self, time: int, /) -> None: ...
     def set_volume(self, value: float, /) -> None: ...
     def get_volume(self) -> float: ...
+    def set_priority(self, priority: int, /) -> None: ...
+    def get_priority(self) -> int: ...
     def get_num_channels(self) -> int: ...
     def get_length(self) -> float: ...
     def get_raw(self) -> bytes: ...
+    def resample(self, rate: int, quality: int = 1) -> Sound: ...
+    def subsound(self, start: float, end: Optional[float] = None) -> Sound: ...
 
 
 class Channel:
@@ -82,8 +141,11 @@ class Channel:
         loops: int = 0,
         maxtime: int = 0,
         fade_ms: int = 0,
+        at_sample: Optional[int] = None,
+        loop_start: Optional[float] = None,
+        loop_end: Optional[float] = None,
     ) -> None: ...
-    def stop(self) -> None: ...
+    def stop(self, at_sample: Optional[int] = None) -> None: ...
     def pause(self) -> None: ...
     def unpause(self) -> None: ...
     def fadeout(self, time: int, /) -> None: ...
@@ -94,11 +156,162 @@ class Channel:
     @overload
     def set_volume(self, left: float, right: float, /) -> None: ...
     def get_volume(self) -> float: ...
+    def set_rate(self, rate: float, /) -> None: ...
+    def get_rate(self) -> float: ...
+    def set_bus(self, bus: Optional[Bus], /) -> None: ...
+    def get_bus(self) -> Optional[Bus]: ...
+    def set_effects(self, effects: Sequence[Effect], /) -> None: ...
+    def get_effects(self) -> Tuple[Effect, ...]: ...
     def get_busy(self) -> bool: ...
     def get_sound(self) -> Sound: ...
     def get_queue(self) -> Sound: ...
     def set_endevent(self, type: Union[int, Event] = 0, /) -> None: ...
     def get_endevent(self) -> int: ...
 
+class SoundLoader:
+    def done(self) -> bool: ...
+    def result(self, timeout: Optional[float] = None) -> List[Optional[Sound]]: ...
+    def cancel(self) -> None: ...
+    def get_progress(self) -> Tuple[int, int]: ...
+
+class SoundBank:
+    def __init__(self, file: FileArg) -> None: ...
+    def __len__(self) -> int: ...
+    def __contains__(self, name: object) -> bool: ...
+    def load(self, name: str, /) -> Sound: ...
+    def play(
+        self, name: str, loops: int = 0, maxtime: int = 0, fade_ms: int = 0
+    ) -> Channel: ...
+    def get_names(self) -> Tuple[str, ...]: ...
+
+class MusicStream:
+    def __init__(self, file: FileArg) -> None: ...
+    def play(
+        self, loops: int = 0, fade_ms: int = 0, at_sample: Optional[int] = None
+    ) -> Channel: ...
+    def stop(self) -> None: ...
+    def fadeout(self, time: int, /) -> None: ...
+    def set_volume(self, value: float, fade_ms: int = 0) -> None: ...
+    def get_volume(self) -> float: ...
+    def get_busy(self) -> bool: ...
+    def get_channel(self) -> Optional[Channel]: ...
+    def get_length(self) -> float: ...
+
+class Bus:
+    def __init__(self, name: str, parent: Optional[Bus] = None) -> None: ...
+    @property
+    def name(self) -> str: ...
+    @property
+    def parent(self) -> Optional[Bus]: ...
+    def set_gain(self, value: float, /) -> None: ...
+    def get_gain(self) -> float: ...
+    def set_mute(self, mute: bool, /) -> None: ...
+    def get_mute(self) -> bool: ...
+    def set_effects(self, effects: Sequence[Effect], /) -> None: ...
+    def get_effects(self) -> Tuple[Effect, ...]: ...
+
+class Effect: ...
+
+class Ducker(Effect):
+    def __init__(
+        self,
+        sidechain: Bus,
+        depth: float = 0.5,
+        threshold: float = 0.05,
+        attack: float = 10,
+        release: float = 250,
+    ) -> None: ...
+    sidechain: Bus
+    depth: float
+    threshold: float
+    attack: float
+    release: float
+
+class Biquad(Effect):
+    def __init__(
+        self,
+        type: str = "lowpass",
+        frequency: float = 1000,
+        q: float = 0.7071,
+        gain: float = 0,
+    ) -> None: ...
+    type: str
+    frequency: float
+    q: float
+    gain: float
+
+class Compressor(Effect):
+    def __init__(
+        self,
+        threshold: float = -12,
+        ratio: float = 4,
+        attack: float = 5,
+        release: float = 100,
+        makeup: float = 0,
+    ) -> None: ...
+    threshold: float
+    ratio: float
+    attack: float
+    release: float
+    makeup: float
+
+class Delay(Effect):
+    def __init__(
+        self, time: float = 250, feedback: float = 0.35, mix: float = 0.35
+    ) -> None: ...
+    time: float
+    feedback: float
+    mix: float
+
+class Reverb(Effect):
+    def __init__(
+        self, room_size: float = 0.5, damping: float = 0.5, mix: float = 0.3
+    ) -> None: ...
+    room_size: float
+    damping: float
+    mix: float
+
+class Analyzer(Effect):
+    def __init__(
+        self, fft_size: int = 1024, bands: int = 16, threshold: float = 1.5
+    ) -> None: ...
+    def update(self) -> bool: ...
+    def get_spectrum(self) -> memoryview: ...
+    def get_bands(self) -> Tuple[float, ...]: ...
+    def get_onset(self) -> bool: ...
+    @property
+    def fft_size(self) -> int: ...
+    @property
+    def bands(self) -> int: ...
+    threshold: float
+
+class Emitter(Effect):
+    def __init__(
+        self,
+        position: Sequence[float] = (0, 0, 0),
+        velocity: Sequence[float] = (0, 0, 0),
+        model: str = "inverse",
+        min_distance: float = 1.0,
+        max_distance: float = 1000.0,
+        rolloff: float = 1.0,
+        doppler: float = 1.0,
+        binaural: bool = True,
+    ) -> None: ...
+    def get_distance(self) -> float: ...
+    @property
+    def position(self) -> Vector3: ...
+    @position.setter
+    def position(self, value: Sequence[float]) -> None: ...
+    @property
+    def velocity(self) -> Vector3: ...
+    @velocity.setter
+    def velocity(self, value: Sequence[float]) -> None: ...
+    model: str
+    min_distance: float
+    max_distance: float
+    rolloff: float
+    doppler: float
+    binaural: bool
+
 SoundType = Sound
 ChannelType = Channel
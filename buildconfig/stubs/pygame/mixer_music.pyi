@@ -1,6 +1,7 @@
-from typing import Optional, Dict
+from typing import Optional, Dict, Sequence, Tuple
 
-from ._common import FileArg
+from ._common import AnyPath, FileArg
+from .mixer import Effect
 
 def load(filename: FileArg, namehint: Optional[str] = "") -> None: ...
 def unload() -> None: ...
@@ -12,10 +13,19 @@ def unpause() -> None: ...
 def fadeout(time: int, /) -> None: ...
 def set_volume(volume: float, /) -> None: ...
 def get_volume() -> float: ...
+def set_effects(effects: Sequence[Effect], /) -> None: ...
+def get_effects() -> Tuple[Effect, ...]: ...
 def get_busy() -> bool: ...
 def set_pos(pos: float, /) -> None: ...
 def get_pos() -> int: ...
+def get_position() -> float: ...
 def queue(filename: FileArg, namehint: str = "", loops: int = 0) -> None: ...
+def play_playlist(
+    tracks: Sequence[AnyPath], loops: int = 0, crossfade: int = 0
+) -> None: ...
+def extend_playlist(tracks: Sequence[AnyPath], /) -> None: ...
+def skip_track() -> None: ...
+def get_playlist_index() -> int: ...
 def set_endevent(event_type: int, /) -> None: ...
 def get_endevent() -> int: ...
 def get_metadata(filename: Optional[FileArg] = None, namehint: str = "") -> Dict[str, str]: ...
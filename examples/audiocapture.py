@@ -4,6 +4,7 @@
 A pygame 2 experiment.
 
 * record sound from a microphone
+* show the level of the recording as it goes
 * play back the recorded sound
 """
 
@@ -26,20 +27,9 @@ pygame.init()
 names = get_audio_device_names(True)
 print(names)
 
-sounds = []
 sound_chunks = []
 
 
-def callback(audiodevice, audiomemoryview):
-    """This is called in the sound thread.
-
-    Note, that the frequency and such you request may not be what you get.
-    """
-    # print(type(audiomemoryview), len(audiomemoryview))
-    # print(audiodevice)
-    sound_chunks.append(bytes(audiomemoryview))
-
-
 def postmix_callback(postmix, audiomemoryview):
     """This is called in the sound thread.
 
@@ -59,7 +49,10 @@ audio = AudioDevice(
     numchannels=2,
     chunksize=512,
     allowed_changes=AUDIO_ALLOW_FORMAT_CHANGE,
-    callback=callback,
+    # Without a callback, the audio thread records into a ring buffer and
+    # measures the levels itself, so Python only needs to drain it now and
+    # then. Pass callback= to get every chunk in the sound thread instead.
+    # Note, that the frequency and such you request may not be what you get.
 )
 # start recording.
 audio.pause(0)
@@ -67,7 +60,14 @@ audio.pause(0)
 print(audio)
 
 print(f"recording with '{names[0]}'")
-time.sleep(5)
+end = time.time() + 5
+while time.time() < end:
+    time.sleep(0.1)
+    sound_chunks.append(audio.read())
+    rms, peak = audio.get_levels()
+    print("#" * int(40 * max(rms, default=0.0)))
+audio.close()
+sound_chunks.append(audio.read())
 
 
 print("Turning data into a pygame.mixer.Sound")
@@ -26,6 +26,11 @@ cdef extern from "SDL.h" nogil:
 
     int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 
+    int SDL_AUDIO_BITSIZE(SDL_AudioFormat x)
+    int SDL_AUDIO_ISFLOAT(SDL_AudioFormat x)
+    int SDL_AUDIO_ISBIGENDIAN(SDL_AudioFormat x)
+    int SDL_AUDIO_ISSIGNED(SDL_AudioFormat x)
+
     int SDL_GetNumAudioDevices(int iscapture)
 
     const char *SDL_GetAudioDeviceName(int index, int iscapture)
@@ -42,6 +47,15 @@ cdef extern from "SDL.h" nogil:
     void SDL_PauseAudioDevice(SDL_AudioDeviceID dev, int pause_on)
     void SDL_CloseAudioDevice(SDL_AudioDeviceID dev)
 
+    # https://wiki.libsdl.org/SDL2/CategoryAtomic
+    ctypedef struct SDL_atomic_t:
+        int value
+    ctypedef int SDL_SpinLock
+    int SDL_AtomicGet(SDL_atomic_t *a)
+    int SDL_AtomicAdd(SDL_atomic_t *a, int v)
+    void SDL_AtomicLock(SDL_SpinLock *lock)
+    void SDL_AtomicUnlock(SDL_SpinLock *lock)
+
     cdef Uint16 _AUDIO_U8 "AUDIO_U8"
     cdef Uint16 _AUDIO_S8 "AUDIO_S8"
     cdef Uint16 _AUDIO_U16LSB "AUDIO_U16LSB"
@@ -57,10 +71,35 @@ cdef extern from "SDL.h" nogil:
     cdef Uint16 _AUDIO_F32MSB "AUDIO_F32MSB"
     cdef Uint16 _AUDIO_F32 "AUDIO_F32"
 
+# Captured audio, written by the audio thread and read by Python, for the
+# devices opened without a callback.
+cdef enum:
+    CAPTURE_MAX_CHANNELS = 8
+
+cdef struct CaptureRing:
+    Uint8 *buf
+    Uint32 size  # bytes, a whole number of frames
+    Uint32 w  # write offset, audio thread side
+    Uint32 r  # read offset, Python side
+    SDL_atomic_t fill  # bytes ready to read
+    SDL_AudioFormat format
+    int channels
+    int frame_size
+
+    # the meters, under lock
+    SDL_SpinLock lock
+    double sum[CAPTURE_MAX_CHANNELS]  # of the squares of the samples
+    float peak[CAPTURE_MAX_CHANNELS]
+    Uint64 count  # frames in sum
+    Uint64 dropped  # frames the ring had no room for
+
 cdef class AudioDevice:
     cdef SDL_AudioDeviceID _deviceid
+    cdef CaptureRing *_ring
     cdef SDL_AudioSpec desired
     cdef SDL_AudioSpec obtained
     cdef int _iscapture
     cdef object _callback
     cdef object _devicename
+
+    cdef CaptureRing *_capture_ring(self) except NULL
@@ -1,5 +1,10 @@
 from pygame._sdl2.sdl2 import error
 cimport cython
+from cpython.buffer cimport PyObject_GetBuffer, PyBuffer_Release, PyBUF_WRITABLE
+from cpython.bytes cimport PyBytes_AS_STRING, PyBytes_FromStringAndSize
+from libc.math cimport sqrt
+from libc.stdlib cimport calloc, free, malloc
+from libc.string cimport memcpy
 
 
 # expose constants to python.
@@ -84,16 +89,116 @@ cdef void recording_cb(void* userdata, Uint8* stream, int len) nogil:
             raise
 
 
+@cython.cdivision(True)
+cdef inline float _capture_sample(const Uint8 *p, int width,
+                                  SDL_AudioFormat fmt) noexcept nogil:
+    """ A sample of any SDL format, as a float from -1.0 to 1.0.
+    """
+    cdef Uint32 bits = 0
+    cdef float f
+    cdef int i
+    if SDL_AUDIO_ISBIGENDIAN(fmt):
+        for i in range(width):
+            bits = (bits << 8) | p[i]
+    else:
+        for i in range(width - 1, -1, -1):
+            bits = (bits << 8) | p[i]
+    if SDL_AUDIO_ISFLOAT(fmt):
+        memcpy(&f, &bits, 4)
+        return f
+    if not SDL_AUDIO_ISSIGNED(fmt):
+        bits ^= (<Uint32>1) << (width * 8 - 1)
+    # shift the sign bit to the top, so the cast extends it
+    return <float>(<Sint32>(bits << (32 - width * 8))) / 2147483648.0
+
+
+@cython.cdivision(True)
+cdef void capture_cb(void* userdata, Uint8* stream, int len) noexcept nogil:
+    """ The callback of the devices capturing without a Python callback.
+        Copies the data into the ring and updates the meters, all without
+        the GIL.
+    """
+    cdef CaptureRing *ring = <CaptureRing*>userdata
+    cdef int frames = len // ring.frame_size
+    cdef int width = ring.frame_size // ring.channels
+    cdef int metered = ring.channels
+    cdef int i, c
+    cdef Uint32 n, room, part
+    cdef float v
+    cdef float peak[CAPTURE_MAX_CHANNELS]
+    cdef double sum[CAPTURE_MAX_CHANNELS]
+
+    if metered > CAPTURE_MAX_CHANNELS:
+        metered = CAPTURE_MAX_CHANNELS
+    for c in range(metered):
+        peak[c] = 0.0
+        sum[c] = 0.0
+    for i in range(frames):
+        for c in range(metered):
+            v = _capture_sample(stream + i * ring.frame_size + c * width,
+                                width, ring.format)
+            if v < 0.0:
+                v = -v
+            if v > peak[c]:
+                peak[c] = v
+            sum[c] += v * v
+
+    # a full ring drops what doesn't fit, rather than block the device
+    room = ring.size - <Uint32>SDL_AtomicGet(&ring.fill)
+    n = <Uint32>(frames * ring.frame_size)
+    if n > room:
+        n = room
+    part = ring.size - ring.w
+    if part > n:
+        part = n
+    memcpy(ring.buf + ring.w, stream, part)
+    memcpy(ring.buf, stream + part, n - part)
+    ring.w = (ring.w + n) % ring.size
+    SDL_AtomicAdd(&ring.fill, <int>n)
+
+    SDL_AtomicLock(&ring.lock)
+    for c in range(metered):
+        ring.sum[c] += sum[c]
+        if peak[c] > ring.peak[c]:
+            ring.peak[c] = peak[c]
+    ring.count += frames
+    ring.dropped += frames - n // ring.frame_size
+    SDL_AtomicUnlock(&ring.lock)
+
+
+@cython.cdivision(True)
+cdef Uint32 _capture_read(CaptureRing *ring, Uint8 *dst, Uint32 n) noexcept nogil:
+    """ Take up to n bytes, whole frames, out of the ring.
+    """
+    cdef Uint32 fill = <Uint32>SDL_AtomicGet(&ring.fill)
+    cdef Uint32 part
+    if n > fill:
+        n = fill
+    n -= n % ring.frame_size
+    part = ring.size - ring.r
+    if part > n:
+        part = n
+    memcpy(dst, ring.buf + ring.r, part)
+    memcpy(dst + part, ring.buf, n - part)
+    ring.r = (ring.r + n) % ring.size
+    SDL_AtomicAdd(&ring.fill, -<int>n)
+    return n
+
+
 # disable auto_pickle since it causes stubcheck error 
 @cython.auto_pickle(False) 
 cdef class AudioDevice:
     def __cinit__(self):
         self._deviceid = 0
         self._iscapture = 0
+        self._ring = NULL
 
     def __dealloc__(self):
         if self._deviceid:
             SDL_CloseAudioDevice(self._deviceid)
+        if self._ring:
+            free(self._ring.buf)
+            free(self._ring)
 
     def __init__(self,
                  devicename,
@@ -103,7 +208,8 @@ cdef class AudioDevice:
                  numchannels,
                  chunksize,
                  allowed_changes,
-                 callback):
+                 callback=None,
+                 ring_frames=0):
         """ An AudioDevice is for sound playback and capture of 'sound cards'.
 
         :param string devicename: One of the device names from get_audio_device_names.
@@ -127,21 +233,48 @@ cdef class AudioDevice:
                    memoryview is the audio data.
                    Use audiodevice.iscapture to see if it is incoming audio or outgoing.
                    The audiodevice also has the format of the memory.
+
+                   A capture device opened without a callback captures
+                   natively instead: the audio thread writes into a ring
+                   buffer and measures the levels, without calling into
+                   Python. Take the data out with read() or read_into(),
+                   and the levels with get_levels().
+        :param int ring_frames: frames the ring buffer holds, one second if 0.
         """
+        cdef CaptureRing *ring
+        cdef size_t size
         memset(&self.desired, 0, sizeof(SDL_AudioSpec))
         self._iscapture = iscapture
         self._callback = callback
         if not isinstance(devicename, str):
             raise TypeError("devicename must be a string")
+        if callback is None and not iscapture:
+            raise ValueError("playback needs a callback")
+        if self._ring or self._deviceid:
+            raise error("AudioDevice is already open")
+        # checked for the format asked for before the device is opened,
+        # and again below for the one obtained
+        if (callback is None and ring_frames > 0 and
+                ring_frames * (SDL_AUDIO_BITSIZE(audioformat) // 8) *
+                numchannels > 0x7FFFFFFF):
+            raise ValueError("ring_frames is too large")
         self._devicename = devicename
 
         self.desired.freq = frequency;
         self.desired.format = audioformat;
         self.desired.channels = numchannels;
         self.desired.samples = chunksize;
-        self.desired.callback = <SDL_AudioCallback>recording_cb;
-        self.desired.userdata = <void*>self
-
+        if callback is None:
+            self._ring = <CaptureRing*>calloc(1, sizeof(CaptureRing))
+            if not self._ring:
+                raise MemoryError()
+            self.desired.callback = <SDL_AudioCallback>capture_cb;
+            self.desired.userdata = <void*>self._ring
+        else:
+            self.desired.callback = <SDL_AudioCallback>recording_cb;
+            self.desired.userdata = <void*>self
+
+        # devices open paused, so the ring can be set up after
         self._deviceid = SDL_OpenAudioDevice(
             self._devicename.encode("utf-8"),
             self._iscapture,
@@ -153,6 +286,25 @@ cdef class AudioDevice:
         if self._deviceid == 0:
             raise error()
 
+        if self._ring:
+            ring = self._ring
+            ring.format = self.obtained.format
+            ring.channels = self.obtained.channels
+            ring.frame_size = SDL_AUDIO_BITSIZE(ring.format) // 8 * ring.channels
+            if ring_frames <= 0:
+                ring_frames = self.obtained.freq
+            size = <size_t>ring_frames * ring.frame_size
+            if size > 0x7FFFFFFF:
+                SDL_CloseAudioDevice(self._deviceid)
+                self._deviceid = 0
+                raise ValueError("ring_frames is too large")
+            ring.buf = <Uint8*>malloc(size)
+            if not ring.buf:
+                SDL_CloseAudioDevice(self._deviceid)
+                self._deviceid = 0
+                raise MemoryError()
+            ring.size = <Uint32>size
+
     @property
     def iscapture(self):
         """ is the AudioDevice for capturing audio?
@@ -228,3 +380,92 @@ cdef class AudioDevice:
         if self._deviceid:
             SDL_CloseAudioDevice(self._deviceid)
             self._deviceid = 0
+
+    cdef CaptureRing *_capture_ring(self) except NULL:
+        if not self._ring or not self._ring.buf:
+            raise error("only capture devices without a callback have a ring")
+        return self._ring
+
+    def get_available(self):
+        """ Frames captured and not read yet.
+        """
+        cdef CaptureRing *ring = self._capture_ring()
+        return SDL_AtomicGet(&ring.fill) // ring.frame_size
+
+    def read(self, int frames=-1):
+        """ Take captured audio out of the ring buffer.
+
+        :param int frames: the most frames to read, all there are if negative.
+        :return: the samples, in the audioformat of the device.
+        :rtype: bytes
+        """
+        cdef CaptureRing *ring = self._capture_ring()
+        cdef Uint32 n = <Uint32>SDL_AtomicGet(&ring.fill)
+        if 0 <= frames < n // ring.frame_size:
+            n = <Uint32>frames * ring.frame_size
+        n -= n % ring.frame_size
+        data = PyBytes_FromStringAndSize(NULL, n)
+        _capture_read(ring, <Uint8*>PyBytes_AS_STRING(data), n)
+        return data
+
+    def read_into(self, buffer):
+        """ Take captured audio out of the ring buffer into a writable
+        buffer, such as a bytearray shared by a Sound made with
+        ``Sound(buffer=..., copy=False)``, without making any objects.
+
+        :return: the number of frames written, as many as are captured
+                 and fit.
+        :rtype: int
+        """
+        cdef CaptureRing *ring = self._capture_ring()
+        cdef Py_buffer view
+        cdef Uint32 n
+        PyObject_GetBuffer(buffer, &view, PyBUF_WRITABLE)
+        try:
+            n = <Uint32>min(view.len, 0x7FFFFFFF)
+            with nogil:
+                n = _capture_read(ring, <Uint8*>view.buf, n)
+        finally:
+            PyBuffer_Release(&view)
+        return n // ring.frame_size
+
+    def get_levels(self):
+        """ The levels of the audio captured since the last call, for
+        meters, measured in the audio thread.
+
+        :return: (rms, peak), a tuple of each channel for each, from 0.0 to
+                 1.0 of full scale.
+        :rtype: Tuple[Tuple[float, ...], Tuple[float, ...]]
+        """
+        cdef CaptureRing *ring = self._capture_ring()
+        cdef double sum[CAPTURE_MAX_CHANNELS]
+        cdef float peak[CAPTURE_MAX_CHANNELS]
+        cdef Uint64 count
+        cdef int c, channels = min(ring.channels, CAPTURE_MAX_CHANNELS)
+        SDL_AtomicLock(&ring.lock)
+        for c in range(channels):
+            sum[c] = ring.sum[c]
+            peak[c] = ring.peak[c]
+            ring.sum[c] = 0.0
+            ring.peak[c] = 0.0
+        count = ring.count
+        ring.count = 0
+        SDL_AtomicUnlock(&ring.lock)
+
+        rms = []
+        peaks = []
+        for c in range(channels):
+            rms.append(sqrt(sum[c] / count) if count else 0.0)
+            peaks.append(peak[c])
+        return tuple(rms), tuple(peaks)
+
+    def get_dropped(self):
+        """ Frames lost because the ring buffer was full, since the device
+        was opened. Read more often, or open with more ring_frames.
+        """
+        cdef CaptureRing *ring = self._capture_ring()
+        cdef Uint64 dropped
+        SDL_AtomicLock(&ring.lock)
+        dropped = ring.dropped
+        SDL_AtomicUnlock(&ring.lock)
+        return dropped
@@ -1,6 +1,6 @@
 /* Auto generated file: with make_docs.py .  Docs go in docs/reST/ref/ . */
 #define DOC_MIXER "pygame module for loading and playing sounds"
-#define DOC_MIXER_INIT "init(frequency=44100, size=-16, channels=2, buffer=512, devicename=None, allowedchanges=AUDIO_ALLOW_FREQUENCY_CHANGE | AUDIO_ALLOW_CHANNELS_CHANGE) -> None\ninitialize the mixer module"
+#define DOC_MIXER_INIT "init(frequency=44100, size=-16, channels=2, buffer=512, devicename=None, allowedchanges=AUDIO_ALLOW_FREQUENCY_CHANGE | AUDIO_ALLOW_CHANNELS_CHANGE, offline=False) -> None\ninitialize the mixer module"
 #define DOC_MIXER_PREINIT "pre_init(frequency=44100, size=-16, channels=2, buffer=512, devicename=None, allowedchanges=AUDIO_ALLOW_FREQUENCY_CHANGE | AUDIO_ALLOW_CHANNELS_CHANGE) -> None\npreset the mixer init arguments"
 #define DOC_MIXER_QUIT "quit() -> None\nuninitialize the mixer"
 #define DOC_MIXER_GETINIT "get_init() -> (frequency, format, channels)\ntest if the mixer is initialized"
@@ -12,33 +12,129 @@
 #define DOC_MIXER_SETNUMCHANNELS "set_num_channels(count, /) -> None\nset the total number of playback channels"
 #define DOC_MIXER_GETNUMCHANNELS "get_num_channels() -> count\nget the total number of playback channels"
 #define DOC_MIXER_SETRESERVED "set_reserved(count, /) -> count\nreserve channels from being automatically used"
+#define DOC_MIXER_SETNUMVIRTUAL "set_num_virtual(count, /) -> None\nset the number of virtual voices"
+#define DOC_MIXER_GETNUMVIRTUAL "get_num_virtual() -> count\nget the number of virtual voices"
 #define DOC_MIXER_FINDCHANNEL "find_channel(force=False) -> Channel\nfind an unused channel"
 #define DOC_MIXER_SETSOUNDFONT "set_soundfont(path, /) -> None\nset the soundfont for playing midi music"
 #define DOC_MIXER_GETSOUNDFONT "get_soundfont() -> paths\nget the soundfont for playing midi music"
 #define DOC_MIXER_GETBUSY "get_busy() -> bool\ntest if any sound is being mixed"
+#define DOC_MIXER_GETSAMPLECLOCK "get_sample_clock() -> int\nget the number of sample frames mixed so far"
+#define DOC_MIXER_GETSTATS "get_stats(reset=False) -> dict\nget statistics about the audio thread"
+#define DOC_MIXER_RENDEROFFLINE "render_offline(seconds, file=None) -> bytes\nrender_offline(seconds, file) -> None\nmix sound faster than real time with no audio device"
 #define DOC_MIXER_GETSDLMIXERVERSION "get_sdl_mixer_version() -> (major, minor, patch)\nget_sdl_mixer_version(linked=True) -> (major, minor, patch)\nget the mixer's SDL version"
-#define DOC_MIXER_SOUND "Sound(filename) -> Sound\nSound(file=filename) -> Sound\nSound(file=pathlib_path) -> Sound\nSound(buffer) -> Sound\nSound(buffer=buffer) -> Sound\nSound(object) -> Sound\nSound(file=object) -> Sound\nSound(array=object) -> Sound\nCreate a new Sound object from a file or buffer object"
+#define DOC_MIXER_LOADSOUNDSASYNC "load_sounds_async(paths, workers=0, event=0) -> SoundLoader\nload several sounds in the background"
+#define DOC_MIXER_RESAMPLEBUFFER "resample_buffer(buffer, rate, new_rate=0, quality=1) -> bytes\nconvert samples to another sample rate"
+#define DOC_MIXER_WRITESOUNDBANK "write_sound_bank(file, sounds, adpcm=False) -> None\npack many sounds into one sound bank file"
+#define DOC_MIXER_PLAYSTREAMS "play_streams(streams, loops=0, at_sample=None) -> int\nstart music streams together on the same sample"
+#define DOC_MIXER_SETOUTPUTEFFECTS "set_output_effects(effects, /) -> None\nset the effects on everything the mixer outputs"
+#define DOC_MIXER_GETOUTPUTEFFECTS "get_output_effects() -> tuple\nget the effects on everything the mixer outputs"
+#define DOC_MIXER_SETLISTENER "set_listener(position=None, velocity=None, forward=None, up=None, speed_of_sound=None) -> None\nset where the 3D sounds are heard from"
+#define DOC_MIXER_GETLISTENER "get_listener() -> dict\nget where the 3D sounds are heard from"
+#define DOC_MIXER_SETVOLUMES "set_volumes(channels, volumes) -> None\nset the volume of many channels at once"
+#define DOC_MIXER_SETSOURCELOCATIONS "set_source_locations(channels, locations) -> None\nset the position of many channels at once"
+#define DOC_MIXER_SOUND "Sound(filename) -> Sound\nSound(file=filename) -> Sound\nSound(file=pathlib_path) -> Sound\nSound(buffer) -> Sound\nSound(buffer=buffer) -> Sound\nSound(object) -> Sound\nSound(file=object) -> Sound\nSound(array=object) -> Sound\nSound(file, stream=True) -> Sound\nSound(file, mmap=True) -> Sound\nSound(file, mmap='raw') -> Sound\nSound(buffer=buffer, copy=False) -> Sound\nSound(array=object, copy=False) -> Sound\nCreate a new Sound object from a file or buffer object"
 #define DOC_MIXER_SOUND_PLAY "play(loops=0, maxtime=0, fade_ms=0) -> Channel\nbegin sound playback"
 #define DOC_MIXER_SOUND_STOP "stop() -> None\nstop sound playback"
 #define DOC_MIXER_SOUND_FADEOUT "fadeout(time, /) -> None\nstop sound playback after fading out"
 #define DOC_MIXER_SOUND_SETVOLUME "set_volume(value, /) -> None\nset the playback volume for this Sound"
 #define DOC_MIXER_SOUND_GETVOLUME "get_volume() -> value\nget the playback volume"
+#define DOC_MIXER_SOUND_SETPRIORITY "set_priority(priority, /) -> None\nset how important this Sound is"
+#define DOC_MIXER_SOUND_GETPRIORITY "get_priority() -> priority\nget how important this Sound is"
 #define DOC_MIXER_SOUND_GETNUMCHANNELS "get_num_channels() -> count\ncount how many times this Sound is playing"
 #define DOC_MIXER_SOUND_GETLENGTH "get_length() -> seconds\nget the length of the Sound"
 #define DOC_MIXER_SOUND_GETRAW "get_raw() -> bytes\nreturn a bytestring copy of the Sound samples."
+#define DOC_MIXER_SOUND_RESAMPLE "resample(rate, quality=1) -> Sound\nreturn a copy of the Sound converted to the mixer frequency"
+#define DOC_MIXER_SOUND_SUBSOUND "subsound(start, end=None) -> Sound\nreturn a Sound playing part of this one, sharing its samples"
 #define DOC_MIXER_CHANNEL "Channel(id) -> Channel\nCreate a Channel object for controlling playback"
 #define DOC_MIXER_CHANNEL_ID "id -> int\nget the channel id for the Channel object"
-#define DOC_MIXER_CHANNEL_PLAY "play(Sound, loops=0, maxtime=0, fade_ms=0) -> None\nplay a Sound on a specific Channel"
-#define DOC_MIXER_CHANNEL_STOP "stop() -> None\nstop playback on a Channel"
+#define DOC_MIXER_CHANNEL_PLAY "play(Sound, loops=0, maxtime=0, fade_ms=0, at_sample=None, loop_start=None, loop_end=None) -> None\nplay a Sound on a specific Channel"
+#define DOC_MIXER_CHANNEL_STOP "stop(at_sample=None) -> None\nstop playback on a Channel"
 #define DOC_MIXER_CHANNEL_PAUSE "pause() -> None\ntemporarily stop playback of a channel"
 #define DOC_MIXER_CHANNEL_UNPAUSE "unpause() -> None\nresume pause playback of a channel"
 #define DOC_MIXER_CHANNEL_FADEOUT "fadeout(time, /) -> None\nstop playback after fading channel out"
 #define DOC_MIXER_CHANNEL_SETSOURCELOCATION "set_source_location(angle, distance, /) -> None\nset the position of a playing channel"
 #define DOC_MIXER_CHANNEL_SETVOLUME "set_volume(value, /) -> None\nset_volume(left, right, /) -> None\nset the volume of a playing channel"
 #define DOC_MIXER_CHANNEL_GETVOLUME "get_volume() -> value\nget the volume of the playing channel"
+#define DOC_MIXER_CHANNEL_SETRATE "set_rate(rate) -> None\nset the playback rate of the channel"
+#define DOC_MIXER_CHANNEL_GETRATE "get_rate() -> float\nget the playback rate of the channel"
+#define DOC_MIXER_CHANNEL_SETBUS "set_bus(bus, /) -> None\nsend the channel to a Bus"
+#define DOC_MIXER_CHANNEL_GETBUS "get_bus() -> Bus\nget the Bus of the channel"
+#define DOC_MIXER_CHANNEL_SETEFFECTS "set_effects(effects, /) -> None\nset the effect chain of the channel"
+#define DOC_MIXER_CHANNEL_GETEFFECTS "get_effects() -> tuple\nget the effect chain of the channel"
 #define DOC_MIXER_CHANNEL_GETBUSY "get_busy() -> bool\ncheck if the channel is active"
 #define DOC_MIXER_CHANNEL_GETSOUND "get_sound() -> Sound\nget the currently playing Sound"
 #define DOC_MIXER_CHANNEL_QUEUE "queue(sound, /) -> None\nqueue a Sound object to follow the current"
 #define DOC_MIXER_CHANNEL_GETQUEUE "get_queue() -> Sound\nreturn any Sound that is queued"
 #define DOC_MIXER_CHANNEL_SETENDEVENT "set_endevent() -> None\nset_endevent(type, /) -> None\nhave the channel send an event when playback stops"
 #define DOC_MIXER_CHANNEL_GETENDEVENT "get_endevent() -> type\nget the event a channel sends when playback stops"
+#define DOC_MIXER_SOUNDLOADER "Handle for sounds being loaded in the background"
+#define DOC_MIXER_SOUNDLOADER_DONE "done() -> bool\ncheck if all sounds have finished loading"
+#define DOC_MIXER_SOUNDLOADER_RESULT "result(timeout=None) -> list\nwait for the loaded sounds"
+#define DOC_MIXER_SOUNDLOADER_CANCEL "cancel() -> None\nstop loading the remaining sounds"
+#define DOC_MIXER_SOUNDLOADER_GETPROGRESS "get_progress() -> (finished, total)\nget how many sounds have finished loading"
+#define DOC_MIXER_SOUNDBANK "SoundBank(file) -> SoundBank\nMany sounds packed in one file"
+#define DOC_MIXER_SOUNDBANK_LOAD "load(name, /) -> Sound\nget a Sound of a clip"
+#define DOC_MIXER_SOUNDBANK_PLAY "play(name, loops=0, maxtime=0, fade_ms=0) -> Channel\nplay a clip"
+#define DOC_MIXER_SOUNDBANK_GETNAMES "get_names() -> tuple\nget the names of the clips"
+#define DOC_MIXER_MUSICSTREAM "MusicStream(file) -> MusicStream\nCreate a music stream from a WAV file"
+#define DOC_MIXER_MUSICSTREAM_PLAY "play(loops=0, fade_ms=0, at_sample=None) -> Channel\nstart playing the stream"
+#define DOC_MIXER_MUSICSTREAM_STOP "stop() -> None\nstop playing the stream"
+#define DOC_MIXER_MUSICSTREAM_FADEOUT "fadeout(time) -> None\nstop the stream after fading it out"
+#define DOC_MIXER_MUSICSTREAM_SETVOLUME "set_volume(value, fade_ms=0) -> None\nset the volume of the stream"
+#define DOC_MIXER_MUSICSTREAM_GETVOLUME "get_volume() -> value\nget the volume of the stream"
+#define DOC_MIXER_MUSICSTREAM_GETBUSY "get_busy() -> bool\ncheck if the stream is playing"
+#define DOC_MIXER_MUSICSTREAM_GETCHANNEL "get_channel() -> Channel\nget the channel the stream plays on"
+#define DOC_MIXER_MUSICSTREAM_GETLENGTH "get_length() -> seconds\nget the length of the stream"
+#define DOC_MIXER_BUS "Bus(name, parent=None) -> Bus\nCreate a Bus to mix channels together"
+#define DOC_MIXER_BUS_NAME "name -> str\nthe name of the Bus"
+#define DOC_MIXER_BUS_PARENT "parent -> Bus\nthe Bus this one is mixed into"
+#define DOC_MIXER_BUS_SETGAIN "set_gain(value, /) -> None\nset the gain of the Bus"
+#define DOC_MIXER_BUS_GETGAIN "get_gain() -> value\nget the gain of the Bus"
+#define DOC_MIXER_BUS_SETMUTE "set_mute(mute, /) -> None\nmute or unmute the Bus"
+#define DOC_MIXER_BUS_GETMUTE "get_mute() -> bool\ncheck if the Bus is muted"
+#define DOC_MIXER_BUS_SETEFFECTS "set_effects(effects, /) -> None\nset the effect chain of the Bus"
+#define DOC_MIXER_BUS_GETEFFECTS "get_effects() -> tuple\nget the effect chain of the Bus"
+#define DOC_MIXER_EFFECT "Base class of the native audio effects"
+#define DOC_MIXER_DUCKER "Ducker(sidechain, depth=0.5, threshold=0.05, attack=10, release=250) -> Ducker\nEffect lowering the volume while another Bus is loud"
+#define DOC_MIXER_DUCKER_SIDECHAIN "sidechain -> Bus\nthe Bus the Ducker listens to"
+#define DOC_MIXER_DUCKER_DEPTH "depth -> float\nhow much the signal is turned down"
+#define DOC_MIXER_DUCKER_THRESHOLD "threshold -> float\nthe level of the sidechain for the full depth"
+#define DOC_MIXER_DUCKER_ATTACK "attack -> float\nhow fast the signal is turned down, in milliseconds"
+#define DOC_MIXER_DUCKER_RELEASE "release -> float\nhow fast the signal comes back, in milliseconds"
+#define DOC_MIXER_BIQUAD "Biquad(type=\"lowpass\", frequency=1000, q=0.7071, gain=0) -> Biquad\nEffect filtering frequencies"
+#define DOC_MIXER_BIQUAD_TYPE "type -> str\nthe kind of filter"
+#define DOC_MIXER_BIQUAD_FREQUENCY "frequency -> float\nthe cutoff or center frequency in Hz"
+#define DOC_MIXER_BIQUAD_Q "q -> float\nthe quality factor of the filter"
+#define DOC_MIXER_BIQUAD_GAIN "gain -> float\nthe gain in decibels of the peaking and shelf filters"
+#define DOC_MIXER_COMPRESSOR "Compressor(threshold=-12, ratio=4, attack=5, release=100, makeup=0) -> Compressor\nEffect evening out the volume"
+#define DOC_MIXER_COMPRESSOR_THRESHOLD "threshold -> float\nthe level in decibels above which the signal is turned down"
+#define DOC_MIXER_COMPRESSOR_RATIO "ratio -> float\nhow much the signal is turned down above the threshold"
+#define DOC_MIXER_COMPRESSOR_ATTACK "attack -> float\nhow fast the compressor reacts, in milliseconds"
+#define DOC_MIXER_COMPRESSOR_RELEASE "release -> float\nhow fast the compressor recovers, in milliseconds"
+#define DOC_MIXER_COMPRESSOR_MAKEUP "makeup -> float\nthe gain in decibels applied after compressing"
+#define DOC_MIXER_DELAY "Delay(time=250, feedback=0.35, mix=0.35) -> Delay\nEffect repeating the sound"
+#define DOC_MIXER_DELAY_TIME "time -> float\nthe time between echoes, in milliseconds"
+#define DOC_MIXER_DELAY_FEEDBACK "feedback -> float\nthe volume of each echo relative to the previous one"
+#define DOC_MIXER_DELAY_MIX "mix -> float\nthe balance between the signal and the echoes"
+#define DOC_MIXER_REVERB "Reverb(room_size=0.5, damping=0.5, mix=0.3) -> Reverb\nEffect simulating a room"
+#define DOC_MIXER_REVERB_ROOMSIZE "room_size -> float\nhow long the reverb lasts"
+#define DOC_MIXER_REVERB_DAMPING "damping -> float\nhow quickly the high frequencies fade"
+#define DOC_MIXER_REVERB_MIX "mix -> float\nthe balance between the signal and the reverb"
+#define DOC_MIXER_ANALYZER "Analyzer(fft_size=1024, bands=16, threshold=1.5) -> Analyzer\nEffect measuring the spectrum of the sound"
+#define DOC_MIXER_ANALYZER_UPDATE "update() -> bool\ntake the latest spectrum"
+#define DOC_MIXER_ANALYZER_GETSPECTRUM "get_spectrum() -> memoryview\nget the magnitudes of the frequencies"
+#define DOC_MIXER_ANALYZER_GETBANDS "get_bands() -> tuple\nget the levels of the frequency bands"
+#define DOC_MIXER_ANALYZER_GETONSET "get_onset() -> bool\nget whether a sound started"
+#define DOC_MIXER_ANALYZER_FFTSIZE "fft_size -> int\nthe number of samples of each FFT"
+#define DOC_MIXER_ANALYZER_BANDS "bands -> int\nthe number of frequency bands"
+#define DOC_MIXER_ANALYZER_THRESHOLD "threshold -> float\nhow sudden an onset is"
+#define DOC_MIXER_EMITTER "Emitter(position=(0, 0, 0), velocity=(0, 0, 0), model=\"inverse\", min_distance=1, max_distance=1000, rolloff=1, doppler=1, binaural=True) -> Emitter\nEffect placing a sound in 3D space"
+#define DOC_MIXER_EMITTER_GETDISTANCE "get_distance() -> float\nget the distance to the listener"
+#define DOC_MIXER_EMITTER_POSITION "position -> Vector3\nwhere the sound comes from"
+#define DOC_MIXER_EMITTER_VELOCITY "velocity -> Vector3\nhow fast the sound source moves"
+#define DOC_MIXER_EMITTER_MODEL "model -> str\nhow the volume falls with distance"
+#define DOC_MIXER_EMITTER_MINDISTANCE "min_distance -> float\nthe distance the volume starts falling from"
+#define DOC_MIXER_EMITTER_MAXDISTANCE "max_distance -> float\nthe distance the volume stops falling at"
+#define DOC_MIXER_EMITTER_ROLLOFF "rolloff -> float\nhow quickly the volume falls"
+#define DOC_MIXER_EMITTER_DOPPLER "doppler -> float\nhow strong the doppler effect is"
+#define DOC_MIXER_EMITTER_BINAURAL "binaural -> bool\nwhether to model the head of the listener"
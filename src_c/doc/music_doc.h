@@ -10,10 +10,17 @@
 #define DOC_MIXER_MUSIC_FADEOUT "fadeout(time, /) -> None\nstop music playback after fading out"
 #define DOC_MIXER_MUSIC_SETVOLUME "set_volume(volume, /) -> None\nset the music volume"
 #define DOC_MIXER_MUSIC_GETVOLUME "get_volume() -> value\nget the music volume"
+#define DOC_MIXER_MUSIC_SETEFFECTS "set_effects(effects, /) -> None\nset the effect chain of the music"
+#define DOC_MIXER_MUSIC_GETEFFECTS "get_effects() -> tuple\nget the effect chain of the music"
 #define DOC_MIXER_MUSIC_GETBUSY "get_busy() -> bool\ncheck if the music stream is playing"
 #define DOC_MIXER_MUSIC_SETPOS "set_pos(pos, /) -> None\nset position to play from"
 #define DOC_MIXER_MUSIC_GETPOS "get_pos() -> time\nget the music play time"
+#define DOC_MIXER_MUSIC_GETPOSITION "get_position() -> seconds\nget the position in the music"
 #define DOC_MIXER_MUSIC_QUEUE "queue(filename) -> None\nqueue(fileobj, namehint="", loops=0) -> None\nqueue a sound file to follow the current"
+#define DOC_MIXER_MUSIC_PLAYPLAYLIST "play_playlist(tracks, loops=0, crossfade=0) -> None\nplay a list of music files back to back"
+#define DOC_MIXER_MUSIC_EXTENDPLAYLIST "extend_playlist(tracks, /) -> None\nadd tracks to the end of the playlist"
+#define DOC_MIXER_MUSIC_SKIPTRACK "skip_track() -> None\nmove on to the next track of the playlist"
+#define DOC_MIXER_MUSIC_GETPLAYLISTINDEX "get_playlist_index() -> int\nget the index of the track playing"
 #define DOC_MIXER_MUSIC_SETENDEVENT "set_endevent() -> None\nset_endevent(type, /) -> None\nhave the music send an event when playback stops"
 #define DOC_MIXER_MUSIC_GETENDEVENT "get_endevent() -> type\nget the event a channel sends when playback stops"
 #define DOC_MIXER_MUSIC_GETMETADATA "get_metadata() -> dict\nget_metadata(filename) -> dict\nget_metadata(fileobj, namehint="") -> dict\nget metadata of the specified or currently loaded music stream"
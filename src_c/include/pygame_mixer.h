@@ -29,11 +29,21 @@
 #include "pgcompat.h"
 
 struct Mix_Chunk;
+struct pgSoundStream;
+struct pg_bufferinfo_s;
 
 typedef struct {
     PyObject_HEAD Mix_Chunk *chunk;
     Uint8 *mem;
     PyObject *weakreflist;
+    /* NULL unless the Sound was created with stream=True */
+    struct pgSoundStream *stream;
+    /* the exporter's buffer, held when the Sound was created with
+       copy=False */
+    struct pg_bufferinfo_s *view;
+    int readonly;
+    /* for the voice manager, 0 unless set with Sound.set_priority() */
+    int priority;
 } pgSoundObject;
 
 typedef struct {
@@ -64,6 +74,25 @@ PYGAMEAPI_DEFINE_SLOTS(mixer);
 
 #define pgChannel_New (*(PyObject * (*)(int)) PYGAMEAPI_GET_SLOT(mixer, 4))
 
+#define pgMixer_SetMusicEffects \
+    (*(int (*)(PyObject *))PYGAMEAPI_GET_SLOT(mixer, 5))
+
+#define pgMixer_GetMusicEffects \
+    (*(PyObject * (*)(void)) PYGAMEAPI_GET_SLOT(mixer, 6))
+
+#define pgMixer_PlayPlaylist                           \
+    (*(int (*)(PyObject *, int, int, int *))PYGAMEAPI_GET_SLOT(mixer, 7))
+
+#define pgMixer_ExtendPlaylist \
+    (*(int (*)(PyObject *))PYGAMEAPI_GET_SLOT(mixer, 8))
+
+#define pgMixer_SkipTrack (*(int (*)(void))PYGAMEAPI_GET_SLOT(mixer, 9))
+
+#define pgMixer_StopPlaylist (*(void (*)(int))PYGAMEAPI_GET_SLOT(mixer, 10))
+
+#define pgMixer_GetPlaylistState \
+    (*(int (*)(Py_ssize_t *, Sint64 *))PYGAMEAPI_GET_SLOT(mixer, 11))
+
 #define import_pygame_mixer() _IMPORT_PYGAME_MODULE(mixer)
 
 #endif /* PYGAMEAPI_MIXER_INTERNAL */
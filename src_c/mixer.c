@@ -32,8 +32,20 @@
 
 #include "mixer.h"
 
+#include "simd_audio.h"
+
+#include "mixer_dsp.h"
+
 #define PyBUF_HAS_FLAG(f, F) (((f) & (F)) == (F))
 
+#define CHECK_BUS_VALID(BUS, RET)                                         \
+    if (((pgBusObject *)(BUS))->buf == NULL) {                            \
+        PyErr_SetString(PyExc_RuntimeError,                               \
+                        "__init__() was not called on Bus object so it " \
+                        "failed to setup correctly.");                    \
+        return (RET);                                                     \
+    }
+
 #define CHECK_CHUNK_VALID(CHUNK, RET)                                      \
     if ((CHUNK) == NULL) {                                                 \
         PyErr_SetString(PyExc_RuntimeError,                                \
@@ -49,6 +61,7 @@
 typedef Uint32 PG_sample_format_t;
 const PG_sample_format_t PG_SAMPLE_SIGNED = 0x10000u;
 const PG_sample_format_t PG_SAMPLE_NATIVE_ENDIAN = 0x20000u;
+const PG_sample_format_t PG_SAMPLE_FLOAT = 0x40000u;
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
 const PG_sample_format_t PG_SAMPLE_LITTLE_ENDIAN = 0x20000u;
 const PG_sample_format_t PG_SAMPLE_BIG_ENDIAN = 0;
@@ -81,6 +94,16 @@ sound_init(PyObject *, PyObject *, PyObject *);
 
 static PyTypeObject pgSound_Type;
 static PyTypeObject pgChannel_Type;
+static PyTypeObject pgSoundLoader_Type;
+static PyTypeObject pgBus_Type;
+static PyTypeObject pgEffect_Type;
+static PyTypeObject pgDucker_Type;
+static PyTypeObject pgBiquad_Type;
+static PyTypeObject pgCompressor_Type;
+static PyTypeObject pgDelay_Type;
+static PyTypeObject pgReverb_Type;
+static PyTypeObject pgAnalyzer_Type;
+static PyTypeObject pgEmitter_Type;
 static PyObject *
 pgSound_New(Mix_Chunk *);
 static PyObject *
@@ -91,8 +114,38 @@ pgChannel_New(int);
 
 static int
 snd_getbuffer(PyObject *, Py_buffer *, int);
+static int
+_chunk_from_view(pgSoundObject *, pg_buffer *, Uint8 *, Py_ssize_t);
 static void
 snd_releasebuffer(PyObject *, Py_buffer *);
+static Uint8 *
+_resample_samples(const Uint8 *, Py_ssize_t, int, int, int, Py_ssize_t *);
+static int
+_format_audio_type(Uint16);
+static void
+_pg_stream_start_pending(void *);
+static void
+_pg_stream_drop_pending(void *);
+static void
+_pg_voice_start_pending(void *);
+static void
+_pg_virtual_start_pending(void *);
+static void
+_pg_virtual_drop_pending(void *);
+static Uint64
+_pg_sample_clock(void);
+static void
+_pg_bus_attach(int);
+static void
+_pg_bus_effect(int, void *, int, void *);
+static int
+_pg_bus_lock_init(void);
+static int
+_pg_effects_set(PyObject **, PyObject *);
+static PyObject *
+_pg_effects_get(PyObject *);
+static void
+_pg_effects_release(PyObject **);
 
 static int request_frequency = PYGAME_MIXER_DEFAULT_FREQUENCY;
 static int request_size = PYGAME_MIXER_DEFAULT_SIZE;
@@ -101,13 +154,330 @@ static int request_chunksize = PYGAME_MIXER_DEFAULT_CHUNKSIZE;
 static int request_allowedchanges = PYGAME_MIXER_DEFAULT_ALLOWEDCHANGES;
 static char *request_devicename = NULL;
 
+/* The Python side of a channel, sound, queue and sound_gen, is only touched
+   with the GIL held. endsound_callback never takes the GIL: it reports to
+   the interpreter through the message ring below instead, and finds the
+   queued Sound through queue_slot. */
 struct ChannelData {
     PyObject *sound;
     PyObject *queue;
+    Uint32 sound_gen;
     int endevent;
+    pgEventDictProxy *endevent_proxy;
+    /* the queued Sound object, NULL if none, or PG_QUEUE_CLOSED when the
+       channel has nothing playing that could end */
+    void *queue_slot;
+    /* counts the sounds started on the channel */
+    Uint32 gen;
+    struct pgVoice *voice;
+    /* what the sound was started with, for the voice manager, start on
+       the sample clock */
+    int priority;
+    Uint64 start;
+    int loops;
+    int playtime;
+    /* 1 while the sound loops a region of itself, which a virtual voice
+       could not follow */
+    int region;
+    /* the virtual voice resumed on the channel, audio thread side */
+    struct pgVirtualVoice *resumed;
+    /* 1 after Mix_SetPanning, 2 after Mix_SetPosition, with the arguments
+       below, until the channel stops */
+    int position;
+    Uint8 left, right;
+    Sint16 angle;
+    Uint8 distance;
+    /* the Bus the channel is mixed into, and the tuple of its Effects,
+       changed with bus_lock held */
+    struct pgBusObject *bus;
+    PyObject *effects;
+    /* 1 while _pg_bus_effect is registered on the channel */
+    SDL_atomic_t bus_attached;
+    /* where the channel is in the bus buffer, audio thread side */
+    Uint32 bus_tick;
+    int bus_offset;
 };
 static struct ChannelData *channeldata = NULL;
 static int numchanneldata = 0;
+static int numreserved = 0;
+
+/* Format of the opened device, cached for the audio thread */
+static int mixer_frequency = 0;
+static Uint16 mixer_format = 0;
+static int mixer_channels = 0;
+static int mixer_type = 0;   /* converter sample type */
+static int mixer_buffer = 0; /* frames per callback asked for */
+
+/* Frames mixed since the mixer was initialized, the timeline scheduled
+   sounds are placed on. Only the post mix effect changes it, with
+   clock_lock held. */
+static Uint64 sample_clock = 0;
+static SDL_SpinLock clock_lock = 0;
+
+/* What mixer.get_stats() reports of the audio thread, under stats_lock.
+   Times are in performance counter ticks. */
+typedef struct {
+    Uint64 callbacks;
+    Uint64 busy_total; /* spent in the effects of this module */
+    Uint64 busy_max;
+    Uint64 xruns;
+    Uint64 events_lost; /* channel end messages the ring had no room for */
+    Uint64 last_end;    /* of the previous callback */
+    int frames;         /* in the last callback */
+} pgMixerStats;
+
+static pgMixerStats mixer_stats;
+static SDL_SpinLock stats_lock = 0;
+static Uint64 stats_start = 0; /* audio thread side, 0 between callbacks */
+
+/* Note the start of the work of this module in a callback, from each of
+   its effects */
+static void
+_pg_stats_begin(void)
+{
+    if (!stats_start) {
+        stats_start = SDL_GetPerformanceCounter();
+    }
+}
+
+/* Account for a callback of frames, from the end of the post mix effect.
+   A callback that took longer than it plays for, or that came more than
+   a buffer late, counts as an xrun. */
+static void
+_pg_stats_end(int frames)
+{
+    Uint64 now = SDL_GetPerformanceCounter(), busy = now - stats_start;
+    Uint64 period =
+        SDL_GetPerformanceFrequency() * frames / (Uint64)mixer_frequency;
+
+    SDL_AtomicLock(&stats_lock);
+    mixer_stats.callbacks++;
+    mixer_stats.busy_total += busy;
+    if (busy > mixer_stats.busy_max) {
+        mixer_stats.busy_max = busy;
+    }
+    if (busy > period ||
+        (mixer_stats.last_end && now - mixer_stats.last_end > 2 * period)) {
+        mixer_stats.xruns++;
+    }
+    mixer_stats.last_end = now;
+    mixer_stats.frames = frames;
+    SDL_AtomicUnlock(&stats_lock);
+    stats_start = 0;
+}
+
+/* Offline rendering. The device of an offline mixer is opened on SDL's
+   disk driver, writing to nowhere with no delay. The post mix effect
+   copies what is mixed to offline_buf. Once it is full, the audio thread
+   parks in there with the device unlocked until the next render, as it
+   would spin otherwise, even paused. */
+#define PG_OFFLINE_BUFFER 4096 /* default frames per callback */
+#define PG_OFFLINE_MAX_DEVICE 16   /* the highest device id SDL 2 uses */
+#ifdef _WIN32
+#define PG_OFFLINE_NULL_FILE "NUL"
+#else
+#define PG_OFFLINE_NULL_FILE "/dev/null"
+#endif
+
+/* The disk driver settings, only set while the device opens */
+#define PG_OFFLINE_ENV 2
+static const char *offline_env_names[PG_OFFLINE_ENV] = {
+    "SDL_DISKAUDIOFILE", "SDL_DISKAUDIODELAY"};
+static const char *offline_env_values[PG_OFFLINE_ENV] = {
+    PG_OFFLINE_NULL_FILE, "0"};
+
+static SDL_AudioDeviceID offline_device = 0; /* 0 when not offline */
+static SDL_sem *offline_done = NULL;
+static SDL_sem *offline_go = NULL;
+static SDL_atomic_t offline_parking; /* cleared for the audio thread to go */
+static int offline_parked = 0;       /* under the device lock */
+static Uint8 *offline_buf = NULL; /* NULL when not rendering */
+static size_t offline_len = 0;
+static size_t offline_pos = 0;
+static int offline_rendering = 0; /* under the GIL */
+/* mixed past the end of the last render, the start of the next one */
+static Uint8 *offline_carry = NULL;
+static size_t offline_carry_len = 0;
+static size_t offline_carry_size = 0;
+
+/* Set the disk driver up for an offline device, keeping what was set
+   before in saved, NULL where nothing was */
+static void
+_pg_offline_env_set(char **saved)
+{
+    const char *value;
+    int i;
+
+    for (i = 0; i < PG_OFFLINE_ENV; i++) {
+        value = SDL_getenv(offline_env_names[i]);
+        saved[i] = value ? SDL_strdup(value) : NULL;
+        SDL_setenv(offline_env_names[i], offline_env_values[i], 1);
+    }
+}
+
+/* Put back what _pg_offline_env_set() kept */
+static void
+_pg_offline_env_restore(char **saved)
+{
+    int i;
+
+    for (i = 0; i < PG_OFFLINE_ENV; i++) {
+        if (saved[i]) {
+            SDL_setenv(offline_env_names[i], saved[i], 1);
+            SDL_free(saved[i]);
+        }
+        else {
+#ifdef _WIN32
+            /* an empty value unsets it there */
+            SDL_setenv(offline_env_names[i], "", 1);
+#else
+            unsetenv(offline_env_names[i]);
+#endif
+        }
+    }
+}
+
+/* Audio thread side, from the post mix effect */
+static void
+_pg_offline_take(Uint8 *stream, size_t len)
+{
+    size_t n;
+    Uint8 *carry;
+
+    if (offline_buf) {
+        n = offline_len - offline_pos;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(offline_buf + offline_pos, stream, n);
+        offline_pos += n;
+        if (n < len) {
+            /* not a real time thread, so it may allocate */
+            if (len - n > offline_carry_size) {
+                carry = (Uint8 *)SDL_realloc(offline_carry, len - n);
+                if (carry) {
+                    offline_carry = carry;
+                    offline_carry_size = len - n;
+                }
+            }
+            offline_carry_len =
+                len - n < offline_carry_size ? len - n : offline_carry_size;
+            memcpy(offline_carry, stream + n, offline_carry_len);
+        }
+        if (offline_pos < offline_len) {
+            return;
+        }
+        offline_buf = NULL;
+    }
+
+    /* full, or nothing asked for yet */
+    SDL_SemPost(offline_done);
+    if (SDL_AtomicGet(&offline_parking)) {
+        offline_parked = 1;
+        SDL_UnlockAudioDevice(offline_device);
+        SDL_SemWait(offline_go);
+        SDL_LockAudioDevice(offline_device);
+        offline_parked = 0;
+    }
+}
+
+/* Find the device Mix_OpenAudioDevice() just started, the only one the
+   disk driver has open */
+static int
+_pg_offline_open(void)
+{
+    SDL_AudioDeviceID id;
+
+    for (id = 1; id <= PG_OFFLINE_MAX_DEVICE; id++) {
+        if (SDL_GetAudioDeviceStatus(id) != SDL_AUDIO_STOPPED) {
+            offline_device = id;
+            SDL_AtomicSet(&offline_parking, 1);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Wait for the audio thread to park, once the post mix effect is in.
+   The clock starts over there, from what was mixed until then. Call
+   without the GIL. */
+static void
+_pg_offline_start(void)
+{
+    SDL_SemWait(offline_done);
+    sample_clock = 0;
+    SDL_zero(mixer_stats);
+}
+
+/* Let the audio thread go for good, before Mix_CloseAudio() frees the
+   post mix effect it parks in. Call without the GIL. */
+static void
+_pg_offline_release(void)
+{
+    int parked;
+
+    if (!offline_device) {
+        return;
+    }
+    SDL_AtomicSet(&offline_parking, 0);
+    SDL_SemPost(offline_go);
+    do {
+        SDL_LockAudioDevice(offline_device);
+        parked = offline_parked;
+        SDL_UnlockAudioDevice(offline_device);
+        if (parked) {
+            SDL_Delay(1);
+        }
+    } while (parked);
+}
+
+static void
+_pg_offline_close(void)
+{
+    offline_device = 0;
+    offline_buf = NULL;
+    SDL_AtomicSet(&offline_parking, 0);
+    offline_parked = 0;
+    if (offline_done) {
+        SDL_DestroySemaphore(offline_done);
+        offline_done = NULL;
+    }
+    if (offline_go) {
+        SDL_DestroySemaphore(offline_go);
+        offline_go = NULL;
+    }
+    SDL_free(offline_carry);
+    offline_carry = NULL;
+    offline_carry_len = 0;
+    offline_carry_size = 0;
+}
+
+/* Channels being stopped on request rather than finishing, which
+   endsound_callback must not resume a virtual voice on */
+static SDL_atomic_t halting;
+
+static void
+_pg_halt_channel(int channel)
+{
+    SDL_AtomicIncRef(&halting);
+    Mix_HaltChannel(channel);
+    SDL_AtomicDecRef(&halting);
+}
+
+static void
+_pg_halt_group(int tag)
+{
+    SDL_AtomicIncRef(&halting);
+    Mix_HaltGroup(tag);
+    SDL_AtomicDecRef(&halting);
+}
+
+/* Worker threads of all SoundLoaders. mixer_quit waits on loaders_done,
+   which the last one to exit signals with loaders_lock held. */
+static SDL_atomic_t loaders_active;
+static SDL_atomic_t loaders_cancelled;
+static SDL_mutex *loaders_lock = NULL;
+static SDL_cond *loaders_done = NULL;
 
 Mix_Music **mx_current_music;
 Mix_Music **mx_queue_music;
@@ -233,10 +603,12 @@ _format_view_to_audio(Py_buffer *view)
             break;
 
         case 'f':
+            format |= PG_SAMPLE_FLOAT;
             format += native_size ? sizeof(float) : 4;
             break;
 
         case 'd':
+            format |= PG_SAMPLE_FLOAT;
             format += native_size ? sizeof(double) : 8;
             break;
 
@@ -264,1685 +636,9660 @@ _format_view_to_audio(Py_buffer *view)
     return format;
 }
 
-static void
-_pg_push_mixer_event(int type, int code)
+/* Pending starts.
+
+   Effects registered from endsound_callback are dropped again by SDL_mixer
+   once the callback returns, so the sounds it starts go on a pending
+   queue instead, for the post mix effect to start with the start function
+   of the queue. Slots are claimed and emptied with atomic compare and
+   swaps, so any thread can take an item back out.
+*/
+#define PG_PENDING_MAX 64
+
+typedef struct {
+    void *items[PG_PENDING_MAX];
+    void (*start)(void *); /* from the post mix effect */
+    void (*drop)(void *);  /* for an item taken back out, or NULL */
+} pgPendingQueue;
+
+/* with the virtual voices, below the post mix effect that runs it */
+static pgPendingQueue virtual_pending;
+
+/* Add item to the queue. Returns -1 if it is full. */
+static int
+_pg_pending_push(pgPendingQueue *q, void *item)
 {
-    PyObject *dict, *dictcode;
-    PyGILState_STATE gstate = PyGILState_Ensure();
+    int i;
 
-    dict = PyDict_New();
-    if (dict) {
-        if (type >= PGE_USEREVENT && type < PG_NUMEVENTS) {
-            dictcode = PyLong_FromLong(code);
-            if (dictcode) {
-                PyDict_SetItemString(dict, "code", dictcode);
-                Py_DECREF(dictcode);
-            }
+    for (i = 0; i < PG_PENDING_MAX; ++i) {
+        if (SDL_AtomicCASPtr(&q->items[i], NULL, item)) {
+            return 0;
         }
-        pg_post_event(type, dict);
-        Py_DECREF(dict);
     }
-    PyGILState_Release(gstate);
+    return -1;
 }
 
-static void
-endsound_callback(int channel)
+/* Take the items match accepts back out, or arg itself if match is NULL,
+   and drop them. Returns how many were taken. */
+static int
+_pg_pending_cancel(pgPendingQueue *q, int (*match)(void *, void *),
+                   void *arg)
 {
-    if (channeldata) {
-        if (channeldata[channel].endevent && SDL_WasInit(SDL_INIT_VIDEO))
-            _pg_push_mixer_event(channeldata[channel].endevent, channel);
-
-        if (channeldata[channel].queue) {
-            PyGILState_STATE gstate = PyGILState_Ensure();
-            int channelnum;
-            Mix_Chunk *sound = pgSound_AsChunk(channeldata[channel].queue);
-            Py_XDECREF(channeldata[channel].sound);
-            channeldata[channel].sound = channeldata[channel].queue;
-            channeldata[channel].queue = NULL;
-            PyGILState_Release(gstate);
-            channelnum = Mix_PlayChannelTimed(channel, sound, 0, -1);
-            if (channelnum != -1)
-                Mix_GroupChannel(channelnum, (int)(intptr_t)sound);
+    void *item;
+    int i, n = 0;
+
+    for (i = 0; i < PG_PENDING_MAX; ++i) {
+        item = SDL_AtomicGetPtr(&q->items[i]);
+        if (!item || (match ? !match(item, arg) : item != arg) ||
+            !SDL_AtomicCASPtr(&q->items[i], item, NULL)) {
+            continue;
         }
-        else {
-            PyGILState_STATE gstate = PyGILState_Ensure();
-            Py_XDECREF(channeldata[channel].sound);
-            channeldata[channel].sound = NULL;
-            PyGILState_Release(gstate);
-            Mix_GroupChannel(channel, -1);
+        if (q->drop) {
+            q->drop(item);
         }
+        n++;
     }
+    return n;
 }
 
-static PyObject *
-import_music(void)
+/* Start the items, from the post mix effect */
+static void
+_pg_pending_run(pgPendingQueue *q)
 {
-    PyObject *music = PyImport_ImportModule(IMPPREFIX "mixer_music");
-    if (music == NULL) {
-        PyErr_Clear();
-        music = PyImport_ImportModule(RELATIVE_MODULE("mixer_music"));
+    void *item;
+    int i;
+
+    for (i = 0; i < PG_PENDING_MAX; ++i) {
+        item = SDL_AtomicGetPtr(&q->items[i]);
+        if (item && SDL_AtomicCASPtr(&q->items[i], item, NULL)) {
+            q->start(item);
+        }
     }
-    return music;
 }
 
-static PyObject *
-_init(int freq, int size, int channels, int chunk, char *devicename,
-      int allowedchanges)
+/* Forget the items, once the audio thread is gone */
+static void
+_pg_pending_clear(pgPendingQueue *q)
 {
-    Uint16 fmt = 0;
     int i;
-    PyObject *music;
-    char *drivername;
 
-    if (!freq) {
-        freq = request_frequency;
-    }
-    if (!size) {
-        size = request_size;
+    for (i = 0; i < PG_PENDING_MAX; ++i) {
+        SDL_AtomicSetPtr(&q->items[i], NULL);
     }
+}
 
-    if (allowedchanges == -1) {
-        allowedchanges = request_allowedchanges;
-    }
+/* Streaming sounds.
 
-    if (!channels) {
-        channels = request_channels;
-    }
-    if (allowedchanges & SDL_AUDIO_ALLOW_CHANNELS_CHANGE) {
-        if (channels <= 1)
-            channels = 1;
-        else if (channels <= 3)
-            channels = 2;
-        else if (channels <= 5)
-            channels = 4;
-        else
-            channels = 6;
-    }
-    else {
-        switch (channels) {
-            case 1:
-            case 2:
-            case 4:
-            case 6:
-                break;
-            default:
-                return RAISE(PyExc_ValueError,
-                             "'channels' must be 1, 2, 4, or 6");
-        }
-    }
+   A Sound created with stream=True does not decode its file at load time.
+   Its chunk is a short silent block that is played looping, and a channel
+   effect replaces that block with samples taken from a ring buffer. A
+   single worker thread keeps the ring of every stream topped up, reading
+   and converting the file a block at a time. Only uncompressed WAV data is
+   supported, since SDL_mixer has no public API for incremental decoding.
+*/
+#define PG_STREAM_BLOCK_FRAMES 4096
+#define PG_STREAM_RING_BLOCKS 8
+#define PG_STREAM_WAIT_MS 10
+#define PG_STREAM_GAIN_FRAMES 256 /* frames scaled at a time */
 
-    if (!chunk) {
-        chunk = request_chunksize;
-    }
+#define PG_FOURCC(a, b, c, d)                                 \
+    ((Uint32)(a) | ((Uint32)(b) << 8) | ((Uint32)(c) << 16) | \
+     ((Uint32)(d) << 24))
 
-    if (!devicename) {
-        devicename = request_devicename;
-    }
+typedef struct pgSoundStream {
+    struct pgSoundStream *next; /* stream_list link */
 
-    /* printf("size:%d:\n", size); */
+    /* decoder side, only used with stream_lock held */
+    SDL_RWops *rw;
+    Sint64 data_start;
+    Sint64 data_len;
+    Sint64 data_pos;
+    int src_width; /* bytes per sample in the file */
+    int src_channels;
+    SDL_AudioFormat src_format; /* of the samples handed to cvt */
+    int src_loops; /* remaining loops, -1 repeats forever */
+    int src_done;
+    SDL_AudioStream *cvt;
+    Uint8 *src_buf;
+    Uint32 w; /* ring write offset */
+
+    /* audio thread side */
+    Uint32 r; /* ring read offset */
+    int expiring;
+    Uint64 start_at; /* on the sample clock, 0 to start right away */
+    Uint64 clock;    /* sample_clock on the last call */
+    int offset;      /* frames already played in this callback */
+    float gain;
+    float gain_target;
+    Uint32 gain_left; /* frames of the ramp to gain_target */
+    int gain_seen;
+
+    /* the gain asked for, under gain_lock */
+    SDL_SpinLock gain_lock;
+    float gain_from; /* negative to ramp from the current gain */
+    float gain_to;
+    Uint32 gain_frames;
+    int gain_serial;
+
+    /* shared */
+    Uint8 *ring;
+    Uint32 ring_size;
+    Uint32 frame_size;
+    SDL_atomic_t fill; /* bytes ready in the ring */
+    SDL_atomic_t eof;  /* the decoder wrote its last block */
+    int pending_channel;
+    Mix_Chunk *chunk;
+    int src_freq;
+    Sint64 src_frames;
+} pgSoundStream;
 
-    switch (size) {
-        case 8:
-            fmt = AUDIO_U8;
-            break;
-        case -8:
-            fmt = AUDIO_S8;
-            break;
-        case 16:
-            fmt = AUDIO_U16SYS;
+static SDL_mutex *stream_lock = NULL;
+static SDL_cond *stream_cond = NULL;
+static pgSoundStream *stream_list = NULL;
+static SDL_Thread *stream_thread = NULL;
+static int stream_worker_running = 0;
+
+/* Queued streams waiting for the post mix effect to start them */
+static pgPendingQueue stream_pending = {
+    {NULL}, _pg_stream_start_pending, _pg_stream_drop_pending};
+
+/* Where the audio thread scales the streams with a gain */
+static float stream_scratch[PG_STREAM_GAIN_FRAMES * PG_DSP_MAX_CHANNELS];
+
+static Uint16
+_pg_read_le16(const Uint8 *p)
+{
+    return (Uint16)(p[0] | (p[1] << 8));
+}
+
+static Uint32
+_pg_read_le32(const Uint8 *p)
+{
+    return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16) |
+           ((Uint32)p[3] << 24);
+}
+
+static void
+_pg_fill_silence(Uint8 *buf, int len)
+{
+    int i;
+
+    switch (mixer_format) {
+        case AUDIO_U8:
+            memset(buf, 0x80, len);
             break;
-        case -16:
-            fmt = AUDIO_S16SYS;
+        case AUDIO_U16LSB:
+            for (i = 0; i + 1 < len; i += 2) {
+                buf[i] = 0x00;
+                buf[i + 1] = 0x80;
+            }
             break;
-        case 32:
-            fmt = AUDIO_F32SYS;
+        case AUDIO_U16MSB:
+            for (i = 0; i + 1 < len; i += 2) {
+                buf[i] = 0x80;
+                buf[i + 1] = 0x00;
+            }
             break;
         default:
-            PyErr_Format(PyExc_ValueError, "unsupported size %i", size);
-            return NULL;
+            memset(buf, 0, len);
     }
+}
 
-    /* printf("size:%d:\n", size); */
+/* Read the next block of PCM data from the file into the converter.
+   Returns the number of bytes handed over, 0 at the end of the data. */
+static int
+_pg_stream_decode(pgSoundStream *st)
+{
+    size_t frame = (size_t)(st->src_width * st->src_channels);
+    size_t want = PG_STREAM_BLOCK_FRAMES * frame;
+    size_t got, i, samples;
+    Sint64 left = st->data_len - st->data_pos;
 
-    /*make chunk a power of 2*/
-    for (i = 0; 1 << i < chunk; ++i)
-        ;                     /*yes, semicolon on for loop*/
-    chunk = MAX(1 << i, 256); /*do this after for loop exits*/
+    if ((Sint64)want > left) {
+        want = (size_t)left;
+    }
+    want -= want % frame;
+    if (!want) {
+        return 0;
+    }
+    got = SDL_RWread(st->rw, st->src_buf, 1, want);
+    got -= got % frame;
+    if (!got) {
+        return 0;
+    }
+    st->data_pos += got;
+
+    if (st->src_width == 3) {
+        /* widen packed 24 bit samples to 32 bit, back to front so the
+           expansion can happen in place */
+        samples = got / 3;
+        for (i = samples; i-- > 0;) {
+            Uint8 *src = st->src_buf + i * 3;
+            Uint32 v = ((Uint32)src[0] << 8) | ((Uint32)src[1] << 16) |
+                       ((Uint32)src[2] << 24);
+            SDL_memcpy(st->src_buf + i * 4, &v, 4);
+        }
+        got = samples * 4;
+    }
+    if (SDL_AudioStreamPut(st->cvt, st->src_buf, (int)got) < 0) {
+        return 0;
+    }
+    return (int)got;
+}
 
-    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
-        if (!channeldata) { /*should always be null*/
-            channeldata = (struct ChannelData *)malloc(
-                sizeof(struct ChannelData) * MIX_CHANNELS);
-            if (!channeldata) {
-                return PyErr_NoMemory();
+/* Top up the ring of a stream. Call with stream_lock held.
+   Returns 1 if any work was done. */
+static int
+_pg_stream_fill(pgSoundStream *st)
+{
+    int work = 0;
+
+    if (SDL_AtomicGet(&st->eof)) {
+        return 0;
+    }
+    for (;;) {
+        Uint32 room = st->ring_size - (Uint32)SDL_AtomicGet(&st->fill);
+        Uint32 part;
+        int avail, got;
+
+        room -= room % st->frame_size;
+        if (!room) {
+            break;
+        }
+        avail = SDL_AudioStreamAvailable(st->cvt);
+        if (avail <= 0) {
+            if (st->src_done) {
+                SDL_AtomicSet(&st->eof, 1);
+                break;
             }
-            numchanneldata = MIX_CHANNELS;
-            for (i = 0; i < numchanneldata; ++i) {
-                channeldata[i].sound = NULL;
-                channeldata[i].queue = NULL;
-                channeldata[i].endevent = 0;
+            if (!_pg_stream_decode(st)) {
+                if (st->src_loops != 0 && st->data_pos > 0 &&
+                    SDL_RWseek(st->rw, st->data_start, RW_SEEK_SET) >= 0) {
+                    /* keep feeding the same converter so the loop is
+                       gapless */
+                    if (st->src_loops > 0) {
+                        --st->src_loops;
+                    }
+                    st->data_pos = 0;
+                }
+                else {
+                    st->src_done = 1;
+                    SDL_AudioStreamFlush(st->cvt);
+                }
             }
+            work = 1;
+            continue;
         }
-
-        /* Compatibility:
-            pulse and dsound audio drivers were renamed in SDL2,
-            and we don't want it to fail.
-        */
-        drivername = SDL_getenv("SDL_AUDIODRIVER");
-        if (drivername && SDL_strncasecmp("pulse", drivername,
-                                          SDL_strlen(drivername)) == 0) {
-            SDL_setenv("SDL_AUDIODRIVER", "pulseaudio", 1);
-        }
-        else if (drivername && SDL_strncasecmp("dsound", drivername,
-                                               SDL_strlen(drivername)) == 0) {
-            SDL_setenv("SDL_AUDIODRIVER", "directsound", 1);
+        if ((Uint32)avail < room) {
+            room = (Uint32)avail;
         }
-
-        if (SDL_InitSubSystem(SDL_INIT_AUDIO))
-            return RAISE(pgExc_SDLError, SDL_GetError());
-
-        if (Mix_OpenAudioDevice(freq, fmt, channels, chunk, devicename,
-                                allowedchanges) == -1) {
-            SDL_QuitSubSystem(SDL_INIT_AUDIO);
-            return RAISE(pgExc_SDLError, SDL_GetError());
+        part = st->ring_size - st->w;
+        if (part > room) {
+            part = room;
         }
-        Mix_ChannelFinished(endsound_callback);
-        Mix_VolumeMusic(127);
-    }
-
-    mx_current_music = NULL;
-    mx_queue_music = NULL;
-
-    music = import_music();
-    if (music) {
-        PyObject *ptr;
-        ptr = PyObject_GetAttrString(music, "_MUSIC_POINTER");
-        if (ptr) {
-            mx_current_music =
-                (Mix_Music **)PyCapsule_GetPointer(ptr,
-                                                   "pygame.music_mixer."
-                                                   "_MUSIC_POINTER");
-            if (!mx_current_music) {
-                PyErr_Clear();
+        got = SDL_AudioStreamGet(st->cvt, st->ring + st->w, (int)part);
+        if (got > 0 && (Uint32)got == part && part < room) {
+            int more =
+                SDL_AudioStreamGet(st->cvt, st->ring, (int)(room - part));
+            if (more > 0) {
+                got += more;
             }
         }
-        else {
-            PyErr_Clear();
+        if (got <= 0) {
+            break;
         }
+        st->w = (st->w + (Uint32)got) % st->ring_size;
+        SDL_AtomicAdd(&st->fill, got);
+        work = 1;
+    }
+    return work;
+}
 
-        ptr = PyObject_GetAttrString(music, "_QUEUE_POINTER");
-        if (ptr) {
-            mx_queue_music =
-                (Mix_Music **)PyCapsule_GetPointer(ptr,
-                                                   "pygame.music_mixer."
-                                                   "_QUEUE_POINTER");
-            if (!mx_queue_music) {
-                PyErr_Clear();
-            }
+static int SDLCALL
+_pg_stream_worker(void *unused)
+{
+    pgSoundStream *st;
+    int work;
+
+    SDL_LockMutex(stream_lock);
+    while (stream_list) {
+        work = 0;
+        for (st = stream_list; st; st = st->next) {
+            work |= _pg_stream_fill(st);
         }
-        else {
-            PyErr_Clear();
+        if (!work) {
+            SDL_CondWaitTimeout(stream_cond, stream_lock, PG_STREAM_WAIT_MS);
         }
-
-        Py_DECREF(music);
-    }
-    else {
-        PyErr_Clear();
     }
-    Py_RETURN_NONE;
+    stream_worker_running = 0;
+    SDL_UnlockMutex(stream_lock);
+    return 0;
 }
 
-static PyObject *
-pgMixer_AutoInit(PyObject *self, PyObject *_null)
+/* Restart a stream from the beginning of its data and decode the first
+   ring full on the calling thread, so playback starts without a gap.
+   The stream must not be playing. Call without the GIL. */
+static void
+_pg_stream_rewind(pgSoundStream *st, int loops)
 {
-    /* Return init with defaults */
-    return _init(0, 0, 0, 0, NULL, -1);
+    SDL_LockMutex(stream_lock);
+    SDL_RWseek(st->rw, st->data_start, RW_SEEK_SET);
+    st->data_pos = 0;
+    st->src_loops = loops;
+    st->src_done = 0;
+    SDL_AudioStreamClear(st->cvt);
+    st->w = 0;
+    st->r = 0;
+    st->expiring = 0;
+    st->start_at = 0;
+    st->offset = 0;
+    SDL_AtomicSet(&st->fill, 0);
+    SDL_AtomicSet(&st->eof, 0);
+    _pg_stream_fill(st);
+    SDL_UnlockMutex(stream_lock);
+    SDL_CondSignal(stream_cond);
 }
 
-static PyObject *
-mixer_quit(PyObject *self, PyObject *_null)
+/* Ask for the gain of a stream to ramp to to over frames, from from, or
+   from where it is if from is negative */
+static void
+_pg_stream_gain(pgSoundStream *st, float from, float to, Uint32 frames)
 {
-    int i;
-    if (SDL_WasInit(SDL_INIT_AUDIO)) {
-        Py_BEGIN_ALLOW_THREADS;
-        Mix_HaltMusic();
-        Py_END_ALLOW_THREADS;
+    SDL_AtomicLock(&st->gain_lock);
+    st->gain_from = from;
+    st->gain_to = to;
+    st->gain_frames = frames;
+    st->gain_serial++;
+    SDL_AtomicUnlock(&st->gain_lock);
+}
 
-        if (channeldata) {
-            for (i = 0; i < numchanneldata; ++i) {
-                Py_XDECREF(channeldata[i].sound);
-                Py_XDECREF(channeldata[i].queue);
-            }
-            free(channeldata);
-            channeldata = NULL;
-            numchanneldata = 0;
+/* Scale frames of streamed samples by the gain of the stream */
+static void
+_pg_stream_scale(pgSoundStream *st, Uint8 *buf, int frames)
+{
+    int ch = mixer_channels, n, m;
+    float to;
+
+    SDL_AtomicLock(&st->gain_lock);
+    if (st->gain_seen != st->gain_serial) {
+        st->gain_seen = st->gain_serial;
+        if (st->gain_from >= 0.0f) {
+            st->gain = st->gain_from;
+        }
+        st->gain_target = st->gain_to;
+        st->gain_left = st->gain_frames;
+        if (!st->gain_left) {
+            st->gain = st->gain_to;
         }
+    }
+    SDL_AtomicUnlock(&st->gain_lock);
+    if (st->gain == 1.0f && !st->gain_left) {
+        return;
+    }
 
-        if (mx_current_music) {
-            if (*mx_current_music) {
-                Py_BEGIN_ALLOW_THREADS;
-                Mix_FreeMusic(*mx_current_music);
-                Py_END_ALLOW_THREADS;
-                *mx_current_music = NULL;
-            }
-            mx_current_music = NULL;
+    while (frames > 0) {
+        n = frames < PG_STREAM_GAIN_FRAMES ? frames : PG_STREAM_GAIN_FRAMES;
+        pg_audio_to_f32(buf, mixer_type, stream_scratch, (size_t)n * ch);
+        m = st->gain_left < (Uint32)n ? (int)st->gain_left : n;
+        if (m) {
+            to = st->gain +
+                 (st->gain_target - st->gain) * m / (float)st->gain_left;
+            pg_ramp(stream_scratch, m, ch, st->gain, to);
+            st->gain_left -= m;
+            st->gain = st->gain_left ? to : st->gain_target;
         }
-        if (mx_queue_music) {
-            if (*mx_queue_music) {
-                Py_BEGIN_ALLOW_THREADS;
-                Mix_FreeMusic(*mx_queue_music);
-                Py_END_ALLOW_THREADS;
-                *mx_queue_music = NULL;
-            }
-            mx_queue_music = NULL;
+        if (m < n) {
+            pg_ramp(stream_scratch + (size_t)m * ch, n - m, ch, st->gain,
+                    st->gain);
         }
-
-        Py_BEGIN_ALLOW_THREADS;
-        Mix_CloseAudio();
-        SDL_QuitSubSystem(SDL_INIT_AUDIO);
-        Py_END_ALLOW_THREADS;
+        pg_audio_from_f32(stream_scratch, buf, mixer_type, (size_t)n * ch);
+        buf += (size_t)n * st->frame_size;
+        frames -= n;
     }
-    Py_RETURN_NONE;
 }
 
-static PyObject *
-pg_mixer_init(PyObject *self, PyObject *args, PyObject *keywds)
+/* Channel effect: replace the silent block with streamed samples */
+static void
+_pg_stream_effect(int chan, void *stream, int len, void *udata)
 {
-    int freq = 0, size = 0, channels = 0, chunk = 0, allowedchanges = -1;
-    char *devicename = NULL;
-
-    static char *kwids[] = {"frequency", "size",       "channels",
-                            "buffer",    "devicename", "allowedchanges",
-                            NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|iiiizi", kwids, &freq,
-                                     &size, &channels, &chunk, &devicename,
-                                     &allowedchanges)) {
-        return NULL;
+    pgSoundStream *st = (pgSoundStream *)udata;
+    Uint8 *dst = (Uint8 *)stream;
+    int eof = SDL_AtomicGet(&st->eof);
+    Uint32 fill = (Uint32)SDL_AtomicGet(&st->fill);
+    Uint32 n, part, wait = 0;
+    Uint64 now, late;
+
+    _pg_stats_begin();
+    /* as for voices, the effect runs again when the silent block loops
+       within a callback */
+    if (st->clock != sample_clock) {
+        st->clock = sample_clock;
+        st->offset = 0;
+    }
+    now = sample_clock + st->offset;
+    st->offset += len / (int)st->frame_size;
+
+    if (st->start_at > now) {
+        wait = st->start_at - now < (Uint64)len / st->frame_size
+                   ? (Uint32)(st->start_at - now) * st->frame_size
+                   : (Uint32)len;
+        _pg_fill_silence(dst, (int)wait);
+        if (wait == (Uint32)len) {
+            return;
+        }
+    }
+    else if (st->start_at) {
+        /* started late: drop what should have played already, so
+           streams started together stay locked */
+        late = (now - st->start_at) * st->frame_size;
+        n = late < fill ? (Uint32)late : fill;
+        st->r = (st->r + n) % st->ring_size;
+        SDL_AtomicAdd(&st->fill, -(int)n);
+        fill -= n;
     }
-    return _init(freq, size, channels, chunk, devicename, allowedchanges);
+    st->start_at = 0;
+    dst += wait;
+    len -= (int)wait;
+
+    n = (Uint32)len < fill ? (Uint32)len : fill;
+    n -= n % st->frame_size;
+    part = st->ring_size - st->r;
+    if (part > n) {
+        part = n;
+    }
+    memcpy(dst, st->ring + st->r, part);
+    memcpy(dst + part, st->ring, n - part);
+    st->r = (st->r + n) % st->ring_size;
+    SDL_AtomicAdd(&st->fill, -(int)n);
+    _pg_stream_scale(st, dst, (int)(n / st->frame_size));
+
+    if (n < (Uint32)len) {
+        _pg_fill_silence(dst + n, len - (int)n);
+        if (eof && !st->expiring) {
+            /* Halting from inside an effect is not allowed, so let the
+               channel expire on the next callback instead. */
+            st->expiring = 1;
+            Mix_ExpireChannel(chan, 1);
+        }
+    }
+    SDL_CondSignal(stream_cond);
 }
 
-static PyObject *
-pg_mixer_get_init(PyObject *self, PyObject *_null)
+/* Start a queued stream, from the post mix effect */
+static void
+_pg_stream_start_pending(void *item)
 {
-    int freq, channels, realform;
-    Uint16 format;
+    pgSoundStream *st = (pgSoundStream *)item;
+    int channel = st->pending_channel;
 
-    if (!SDL_WasInit(SDL_INIT_AUDIO))
-        Py_RETURN_NONE;
+    if (Mix_Playing(channel)) {
+        return;
+    }
+    if (Mix_RegisterEffect(channel, _pg_stream_effect, NULL, st)) {
+        _pg_bus_attach(channel);
+        if (Mix_PlayChannelTimed(channel, st->chunk, -1, -1) == -1) {
+            Mix_UnregisterEffect(channel, _pg_stream_effect);
+            Mix_GroupChannel(channel, -1);
+        }
+    }
+}
 
-    if (!Mix_QuerySpec(&freq, &format, &channels))
-        Py_RETURN_NONE;
+/* Let go of the channel a queued stream was taken back from */
+static void
+_pg_stream_drop_pending(void *item)
+{
+    pgSoundStream *st = (pgSoundStream *)item;
 
-    // create a signed or unsigned number of bits per sample
-    realform = SDL_AUDIO_BITSIZE(format);
-    if (SDL_AUDIO_ISSIGNED(format)) {
-        realform = -realform;
+    if (!Mix_Playing(st->pending_channel)) {
+        Mix_GroupChannel(st->pending_channel, -1);
     }
-    return Py_BuildValue("(iii)", freq, realform, channels);
 }
 
-static PyObject *
-pg_mixer_get_driver(PyObject *self, PyObject *_null)
+static int
+_pg_stream_on_channel(void *item, void *channel)
 {
-    const char *name = NULL;
-    MIXER_INIT_CHECK();
-    name = SDL_GetCurrentAudioDriver();
-    if (!name) {
-        name = "unknown";
-    }
-    return PyUnicode_FromString(name);
+    return ((pgSoundStream *)item)->pending_channel == *(int *)channel;
 }
 
-static PyObject *
-pre_init(PyObject *self, PyObject *args, PyObject *keywds)
+static void
+_pg_stream_cancel(pgSoundStream *st)
 {
-    static char *kwids[] = {"frequency", "size",       "channels",
-                            "buffer",    "devicename", "allowedchanges",
-                            NULL};
+    _pg_pending_cancel(&stream_pending, NULL, st);
+}
 
-    request_frequency = 0;
-    request_size = 0;
-    request_channels = 0;
-    request_chunksize = 0;
-    request_devicename = NULL;
-    request_allowedchanges = -1;
-    if (!PyArg_ParseTupleAndKeywords(
-            args, keywds, "|iiiizi", kwids, &request_frequency, &request_size,
-            &request_channels, &request_chunksize, &request_devicename,
-            &request_allowedchanges))
-        return NULL;
-    if (!request_frequency) {
-        request_frequency = PYGAME_MIXER_DEFAULT_FREQUENCY;
+/* Start st on a channel that is not playing, or on a free unreserved
+   channel if channel is -1, at frame at of the sample clock or right away
+   if 0. Call without the GIL. */
+static int
+_pg_stream_start(pgSoundStream *st, int channel, int loops, int playtime,
+                 int fade_ms, Uint64 at)
+{
+    int i, numchans;
+
+    _pg_stream_cancel(st);
+    _pg_halt_group((int)(intptr_t)st->chunk);
+    _pg_stream_rewind(st, loops);
+    st->start_at = at;
+
+    if (channel == -1) {
+        numchans = Mix_GroupCount(-1);
+        for (i = numreserved; i < numchans; ++i) {
+            if (!Mix_Playing(i)) {
+                channel = i;
+                break;
+            }
+        }
+        if (channel == -1) {
+            return -1;
+        }
     }
-    if (!request_size) {
-        request_size = PYGAME_MIXER_DEFAULT_SIZE;
+    else if (Mix_Playing(channel)) {
+        _pg_halt_channel(channel);
     }
-    if (!request_channels) {
-        request_channels = PYGAME_MIXER_DEFAULT_CHANNELS;
+
+    /* Register before playing, so no callback can mix the silent block */
+    if (!Mix_RegisterEffect(channel, _pg_stream_effect, NULL, st)) {
+        return -1;
     }
-    if (!request_chunksize) {
-        request_chunksize = PYGAME_MIXER_DEFAULT_CHUNKSIZE;
+    _pg_bus_attach(channel);
+    if (fade_ms > 0) {
+        i = Mix_FadeInChannelTimed(channel, st->chunk, -1, fade_ms, playtime);
     }
-    if (request_allowedchanges == -1) {
-        request_allowedchanges = PYGAME_MIXER_DEFAULT_ALLOWEDCHANGES;
+    else {
+        i = Mix_PlayChannelTimed(channel, st->chunk, -1, playtime);
     }
-    Py_RETURN_NONE;
+    if (i == -1) {
+        Mix_UnregisterEffect(channel, _pg_stream_effect);
+        return -1;
+    }
+    Mix_GroupChannel(channel, (int)(intptr_t)st->chunk);
+    return channel;
 }
 
-/* sound object methods */
-
-static PyObject *
-pgSound_Play(PyObject *self, PyObject *args, PyObject *kwargs)
+/* Defer starting a queued stream to the post mix effect */
+static int
+_pg_stream_defer(pgSoundStream *st, int channel)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
-    int channelnum = -1;
-    int loops = 0, playtime = -1, fade_ms = 0;
-
-    CHECK_CHUNK_VALID(chunk, NULL);
-
-    char *kwids[] = {"loops", "maxtime", "fade_ms", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iii", kwids, &loops,
-                                     &playtime, &fade_ms))
-        return NULL;
-
-    Py_BEGIN_ALLOW_THREADS;
-    if (fade_ms > 0) {
-        channelnum =
-            Mix_FadeInChannelTimed(-1, chunk, loops, fade_ms, playtime);
+    /* the stream can only feed one channel at a time */
+    if (Mix_GroupCount((int)(intptr_t)st->chunk)) {
+        return -1;
     }
-    else {
-        channelnum = Mix_PlayChannelTimed(-1, chunk, loops, playtime);
+    st->pending_channel = channel;
+    if (_pg_pending_push(&stream_pending, st)) {
+        return -1;
     }
-    Py_END_ALLOW_THREADS;
-    if (channelnum == -1)
-        Py_RETURN_NONE;
-
-    Py_XDECREF(channeldata[channelnum].sound);
-    Py_XDECREF(channeldata[channelnum].queue);
-    channeldata[channelnum].queue = NULL;
-    channeldata[channelnum].sound = self;
-    Py_INCREF(self);
+    Mix_GroupChannel(channel, (int)(intptr_t)st->chunk);
+    return 0;
+}
 
-    // make sure volume on this arbitrary channel is set to full
-    Mix_Volume(channelnum, 128);
+/* Voices.
 
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_GroupChannel(channelnum, (int)(intptr_t)chunk);
-    Py_END_ALLOW_THREADS;
+   A channel gets a voice when its playback rate is first set. Sounds
+   started on it by Channel.play() or Channel.queue() then loop forever as
+   far as SDL_mixer knows, while a channel effect renders the output from
+   the samples of the chunk at a fractional position, and lets the channel
+   expire once the loops asked for are done. Rate changes are smoothed over
+   a few milliseconds, so sweeping the rate does not step audibly.
 
-    return pgChannel_New(channelnum);
-}
+   Voices also play the sounds scheduled on the sample clock, starting
+   and stopping them at an exact frame of a callback: until its start the
+   voice renders silence, and from its stop on it lets the channel expire.
 
-static PyObject *
-snd_get_num_channels(PyObject *self, PyObject *_null)
+   The loops of a voice may repeat a region of the chunk only: the first
+   pass plays from the start to the end of the region, every other pass the
+   region again, and the last pass goes on to the end of the chunk, giving
+   an intro, a loop and an outro from the samples of a single Sound.
+*/
+#define PG_VOICE_BLOCK 256 /* frames rendered at a time */
+#define PG_VOICE_MAX_RATE 8
+#define PG_VOICE_RATE_ONE 65536 /* rates are 16.16 fixed point */
+#define PG_VOICE_SMOOTH_MS 10
+
+typedef struct pgVoice {
+    struct pgVoice *next; /* voice_list link */
+    int channel;
+    int type; /* converter sample type of the mixer */
+    int channels;
+    int frame_size;
+    float smooth;        /* one pole coefficient for rate changes */
+    SDL_atomic_t target; /* rate asked for */
+    Mix_Chunk *pending_chunk;
+    Uint64 stop_at; /* on the sample clock, 0 for none, under stop_lock */
+    SDL_SpinLock stop_lock;
+
+    /* audio thread side, or set while the channel is not playing */
+    Mix_Chunk *chunk;
+    Uint32 frames; /* frames in the chunk */
+    /* the region the loops repeat, the whole chunk by default */
+    Uint32 loop_start;
+    Uint32 loop_end;
+    Uint64 pos; /* position in the current pass, 32.32 fixed point */
+    int loops;  /* passes left after this one, -1 repeats forever */
+    int looped;
+    int expiring;
+    float rate;
+    Uint64 start_at; /* on the sample clock, 0 to start right away */
+    Uint64 clock;    /* sample_clock on the last call */
+    int offset;      /* frames already rendered in this callback */
+    Uint64 steps[PG_VOICE_BLOCK];
+    float *in;
+    float *out;
+} pgVoice;
+
+static pgVoice *voice_list = NULL;
+
+/* Queued sounds waiting for the post mix effect to start them on a
+   voice */
+static pgPendingQueue voice_pending = {{NULL}, _pg_voice_start_pending,
+                                       NULL};
+
+static pgVoice *
+_pg_voice_new(int channel, int type, int channels)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
-
-    CHECK_CHUNK_VALID(chunk, NULL);
+    pgVoice *v = (pgVoice *)PyMem_Calloc(1, sizeof(pgVoice));
 
-    MIXER_INIT_CHECK();
-    return PyLong_FromLong(Mix_GroupCount((int)(intptr_t)chunk));
+    if (!v) {
+        return NULL;
+    }
+    v->in = (float *)PyMem_Malloc(
+        (PG_VOICE_BLOCK * PG_VOICE_MAX_RATE + 4) * channels * sizeof(float));
+    v->out = (float *)PyMem_Malloc(PG_VOICE_BLOCK * channels * sizeof(float));
+    if (!v->in || !v->out) {
+        PyMem_Free(v->in);
+        PyMem_Free(v->out);
+        PyMem_Free(v);
+        return NULL;
+    }
+    v->channel = channel;
+    v->type = type;
+    v->channels = channels;
+    v->frame_size = PG_CVT_SIZE(type) * channels;
+    v->smooth = (float)(1.0 - SDL_exp(-1000.0 / (PG_VOICE_SMOOTH_MS *
+                                                   (double)mixer_frequency)));
+    v->rate = 1.0f;
+    SDL_AtomicSet(&v->target, PG_VOICE_RATE_ONE);
+    v->next = voice_list;
+    voice_list = v;
+    return v;
 }
 
-static PyObject *
-snd_fadeout(PyObject *self, PyObject *args)
+static void
+_pg_voice_free_all(void)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
-    int _time;
-
-    CHECK_CHUNK_VALID(chunk, NULL);
+    pgVoice *v;
+
+    while (voice_list) {
+        v = voice_list;
+        voice_list = v->next;
+        PyMem_Free(v->in);
+        PyMem_Free(v->out);
+        PyMem_Free(v);
+    }
+}
 
-    if (!PyArg_ParseTuple(args, "i", &_time))
-        return NULL;
+/* Move on to the next pass while past the end of this one */
+static void
+_pg_voice_wrap(pgVoice *v)
+{
+    Uint32 len = v->loop_end - v->loop_start;
 
-    MIXER_INIT_CHECK();
+    while (len && (v->pos >> 32) >= v->loop_end && v->loops) {
+        v->pos -= (Uint64)len << 32;
+        v->looped = 1;
+        if (v->loops > 0) {
+            v->loops--;
+        }
+    }
+}
 
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_FadeOutGroup((int)(intptr_t)chunk, _time);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+/* Convert count frames from frame first of the current pass on to floats,
+   with silence outside of the passes left to play. Past the end of the
+   loop region, the frames come from the region again while passes are
+   left, then from the rest of the chunk. first may be the frame before the
+   current pass, -1 or, once looped, the one before the region. */
+static void
+_pg_voice_gather(pgVoice *v, Sint64 first, Uint32 count, float *dst)
+{
+    Sint64 len = v->loop_end - v->loop_start;
+    Sint64 looping = len * v->loops; /* in the passes left, if any */
+    Sint64 k;
+    Uint32 n, j, stop;
+
+    while (count) {
+        if (first < (v->looped ? (Sint64)v->loop_start : 0)) {
+            n = 1;
+            if (v->looped) {
+                pg_audio_to_f32(v->chunk->abuf + (size_t)(v->loop_end - 1) *
+                                                     v->frame_size,
+                                v->type, dst, v->channels);
+            }
+            else {
+                memset(dst, 0, v->channels * sizeof(float));
+            }
+        }
+        else if (!v->frames ||
+                 (v->loops >= 0 && first >= v->frames + looping)) {
+            memset(dst, 0, (size_t)count * v->channels * sizeof(float));
+            return;
+        }
+        else {
+            k = first - v->loop_end;
+            if (k < 0) {
+                j = (Uint32)first;
+                stop = v->loop_end;
+            }
+            else if (v->loops < 0 || k < looping) {
+                j = v->loop_start + (Uint32)(k % len);
+                stop = v->loop_end;
+            }
+            else {
+                j = v->loop_end + (Uint32)(k - looping);
+                stop = v->frames;
+            }
+            n = stop - j < count ? stop - j : count;
+            pg_audio_to_f32(v->chunk->abuf + (size_t)j * v->frame_size,
+                            v->type, dst, (size_t)n * v->channels);
+        }
+        dst += (size_t)n * v->channels;
+        first += n;
+        count -= n;
+    }
 }
 
-static PyObject *
-snd_stop(PyObject *self, PyObject *_null)
+/* Copy up to n frames as they are, for a rate of exactly 1. Returns the
+   frames copied, fewer than n once the last pass ends. */
+static int
+_pg_voice_copy(pgVoice *v, Uint8 *dst, int n)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
-
-    CHECK_CHUNK_VALID(chunk, NULL);
+    int done = 0;
+    Uint32 at, stop, count;
+
+    while (done < n) {
+        _pg_voice_wrap(v);
+        at = (Uint32)(v->pos >> 32);
+        stop = v->loops ? v->loop_end : v->frames;
+        if (at >= stop) {
+            break;
+        }
+        count = stop - at;
+        if (count > (Uint32)(n - done)) {
+            count = (Uint32)(n - done);
+        }
+        memcpy(dst + (size_t)done * v->frame_size,
+               v->chunk->abuf + (size_t)at * v->frame_size,
+               (size_t)count * v->frame_size);
+        v->pos += (Uint64)count << 32;
+        done += (int)count;
+    }
+    return done;
+}
 
-    MIXER_INIT_CHECK();
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_HaltGroup((int)(intptr_t)chunk);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+/* Render up to n frames with cubic Hermite interpolation, moving the rate
+   towards target. Returns the frames rendered, as _pg_voice_copy. */
+static int
+_pg_voice_resample(pgVoice *v, Uint8 *dst, int n, float target)
+{
+    Uint64 p, last;
+    Sint64 first, end, at, len;
+    float rate = v->rate, next, t, c1, c2, c3;
+    const float *x;
+    float *out = v->out;
+    int k, c, ch = v->channels;
+
+    _pg_voice_wrap(v);
+    last = v->pos;
+    for (k = 0; k < n; k++) {
+        v->steps[k] = (Uint64)((double)rate * 4294967296.0);
+        if (k < n - 1) {
+            last += v->steps[k];
+        }
+        next = rate + (target - rate) * v->smooth;
+        rate = next == rate || SDL_fabs(target - next) < 1e-6 ? target : next;
+    }
+    /* from the frame before the first position to two after the last */
+    p = v->pos;
+    first = (Sint64)(p >> 32) - 1;
+    _pg_voice_gather(v, first, (Uint32)((Sint64)(last >> 32) + 3 - first),
+                     v->in);
+
+    len = v->loop_end - v->loop_start;
+    end = v->loops < 0 ? -1 : (Sint64)v->frames + len * v->loops;
+    for (k = 0; k < n; k++, out += ch) {
+        at = (Sint64)(p >> 32);
+        if (end >= 0 && at >= end) {
+            break;
+        }
+        t = (float)(p & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+        x = v->in + (size_t)(at - first - 1) * ch;
+        for (c = 0; c < ch; c++) {
+            c1 = 0.5f * (x[2 * ch + c] - x[c]);
+            c2 = x[c] - 2.5f * x[ch + c] + 2.0f * x[2 * ch + c] -
+                 0.5f * x[3 * ch + c];
+            c3 = 0.5f * (x[3 * ch + c] - x[c]) +
+                 1.5f * (x[ch + c] - x[2 * ch + c]);
+            out[c] = ((c3 * t + c2) * t + c1) * t + x[ch + c];
+        }
+        p += v->steps[k];
+    }
+    pg_audio_from_f32(v->out, dst, v->type, (size_t)k * ch);
+    v->pos = p;
+    v->rate = rate;
+    return k;
 }
 
-static PyObject *
-snd_set_volume(PyObject *self, PyObject *args)
+/* Channel effect: render the chunk of a voice at its rate */
+static void
+_pg_voice_effect(int chan, void *stream, int len, void *udata)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
-    float volume;
+    pgVoice *v = (pgVoice *)udata;
+    Uint8 *dst = (Uint8 *)stream;
+    int play = len / v->frame_size, want, n = 0, ended = 0;
+    float target = (float)SDL_AtomicGet(&v->target) / PG_VOICE_RATE_ONE;
+    Uint64 now, stop;
+
+    _pg_stats_begin();
+    /* SDL_mixer calls the effect again when the chunk loops within a
+       callback */
+    if (v->clock != sample_clock) {
+        v->clock = sample_clock;
+        v->offset = 0;
+    }
+    now = sample_clock + v->offset;
+    v->offset += play;
+
+    if (v->start_at > now) {
+        n = v->start_at - now < (Uint64)play ? (int)(v->start_at - now)
+                                             : play;
+        _pg_fill_silence(dst, n * v->frame_size);
+        dst += n * v->frame_size;
+        play -= n;
+        now += n;
+    }
+    SDL_AtomicLock(&v->stop_lock);
+    stop = v->stop_at;
+    SDL_AtomicUnlock(&v->stop_lock);
+    if (stop && stop < now + play) {
+        play = stop > now ? (int)(stop - now) : 0;
+        ended = 1;
+    }
 
-    CHECK_CHUNK_VALID(chunk, NULL);
+    while (play > 0) {
+        want = play < PG_VOICE_BLOCK ? play : PG_VOICE_BLOCK;
+        if (v->rate == 1.0f && target == 1.0f &&
+            !(v->pos & 0xFFFFFFFFu)) {
+            n = _pg_voice_copy(v, dst, want);
+        }
+        else {
+            n = _pg_voice_resample(v, dst, want, target);
+        }
+        dst += n * v->frame_size;
+        play -= n;
+        if (n < want) {
+            ended = 1;
+            break;
+        }
+    }
 
-    if (!PyArg_ParseTuple(args, "f", &volume))
-        return NULL;
+    if (ended) {
+        _pg_fill_silence(dst, len - (int)(dst - (Uint8 *)stream));
+        if (!v->expiring) {
+            /* as for streams, halting from an effect is not allowed */
+            v->expiring = 1;
+            Mix_ExpireChannel(chan, 1);
+        }
+    }
+}
 
-    MIXER_INIT_CHECK();
+static void
+_pg_voice_cancel(pgVoice *v)
+{
+    _pg_pending_cancel(&voice_pending, NULL, v);
+}
 
-    Mix_VolumeChunk(chunk, (int)(volume * 128));
-    Py_RETURN_NONE;
+/* Start chunk on the channel of v, which must not be playing, at frame at
+   of the sample clock or right away if 0, looping the frames from
+   loop_start to loop_end, or the whole chunk if loop_end is 0. Call
+   without the GIL, or from the post mix effect. */
+static int
+_pg_voice_start(pgVoice *v, Mix_Chunk *chunk, int loops, int playtime,
+                int fade_ms, Uint64 at, Uint32 loop_start, Uint32 loop_end)
+{
+    struct ChannelData *cd = &channeldata[v->channel];
+    int channel = v->channel;
+
+    v->chunk = chunk;
+    v->frames = chunk->alen / v->frame_size;
+    v->loop_start = loop_end ? loop_start : 0;
+    v->loop_end = loop_end ? loop_end : v->frames;
+    v->pos = 0;
+    v->loops = loops < 0 ? -1 : loops;
+    v->looped = 0;
+    v->expiring = 0;
+    v->rate = (float)SDL_AtomicGet(&v->target) / PG_VOICE_RATE_ONE;
+    v->start_at = at;
+    SDL_AtomicLock(&v->stop_lock);
+    v->stop_at = 0;
+    SDL_AtomicUnlock(&v->stop_lock);
+
+    /* Register before playing, so no callback can mix the chunk as is.
+       Effects run in the order they were registered, so the voice goes
+       before a panning or source location set while the channel was idle,
+       which is cleared and set again to move it after, and the bus effect
+       goes last. Other effects are left alone. */
+    Mix_UnregisterEffect(channel, _pg_voice_effect);
+    if (SDL_AtomicCAS(&cd->bus_attached, 1, 0)) {
+        Mix_UnregisterEffect(channel, _pg_bus_effect);
+    }
+    if (!Mix_RegisterEffect(channel, _pg_voice_effect, NULL, v)) {
+        return -1;
+    }
+    if (cd->position == 1) {
+        Mix_SetPanning(channel, 255, 255);
+        Mix_SetPanning(channel, cd->left, cd->right);
+    }
+    else if (cd->position == 2) {
+        Mix_SetPosition(channel, 0, 0);
+        Mix_SetPosition(channel, cd->angle, cd->distance);
+    }
+    _pg_bus_attach(channel);
+    if (fade_ms > 0) {
+        channel = Mix_FadeInChannelTimed(channel, chunk, -1, fade_ms,
+                                         playtime);
+    }
+    else {
+        channel = Mix_PlayChannelTimed(channel, chunk, -1, playtime);
+    }
+    if (channel == -1) {
+        Mix_UnregisterEffect(v->channel, _pg_voice_effect);
+    }
+    return channel;
 }
 
-static PyObject *
-snd_get_volume(PyObject *self, PyObject *_null)
+static int
+_pg_voice_defer(pgVoice *v, Mix_Chunk *chunk)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    v->pending_chunk = chunk;
+    return _pg_pending_push(&voice_pending, v);
+}
 
-    CHECK_CHUNK_VALID(chunk, NULL);
+/* Start a queued sound on its voice, from the post mix effect */
+static void
+_pg_voice_start_pending(void *item)
+{
+    pgVoice *v = (pgVoice *)item;
 
-    int volume;
-    MIXER_INIT_CHECK();
+    if (Mix_Playing(v->channel)) {
+        return;
+    }
+    if (_pg_voice_start(v, v->pending_chunk, 0, -1, 0, 0, 0, 0) != -1) {
+        Mix_GroupChannel(v->channel, (int)(intptr_t)v->pending_chunk);
+    }
+}
 
-    volume = Mix_VolumeChunk(chunk, -1);
-    return PyFloat_FromDouble(volume / 128.0);
+/* Buses and effects.
+
+   A channel sent to a Bus with Channel.set_bus() is mixed into the float
+   buffer of the bus by a channel effect instead of into the output. As
+   that effect silences the channel, it must come after any other effect
+   on the channel. Once all channels are mixed, the post mix effect runs
+   the effect chain of each bus over its buffer, applies its gain and adds
+   the result into the parent bus, children first, or into the output.
+
+   The same channel effect runs the effects set with Channel.set_effects().
+   While mixer.music has effects, it also moves the channels that are not
+   on a bus out of the way, so that the post mix effect finds the music
+   alone in the output, runs the effects over it and adds the channels
+   back.
+
+   The bus graph, the effect chains and the settings of the effects only
+   change with bus_lock held, which the audio thread takes too. Nothing may
+   call into SDL_mixer with bus_lock held, as SDL_mixer takes its audio
+   lock first.
+*/
+#define PG_BUS_FRAMES 4096 /* the longest callback a bus can take */
+
+/* The base of the native effects. process is called by the audio thread
+   with bus_lock held, on interleaved floats in the layout of the mixer. */
+typedef struct pgEffectObject {
+    PyObject_HEAD void (*process)(struct pgEffectObject *self, float *buf,
+                                  int frames, int channels);
+    int in_use;    /* in an effect chain */
+    int changed;   /* the settings changed since the last buffer */
+    int frequency; /* of the mixer in the last buffer */
+} pgEffectObject;
+
+typedef struct pgBusObject {
+    PyObject_HEAD PyObject *name;
+    struct pgBusObject *parent; /* NULL for the output */
+    int depth;                  /* the number of buses above */
+    PyObject *effects;          /* tuple of Effects, or NULL */
+    float gain;
+    int mute;
+    float level; /* peak of the last buffer, audio thread side */
+    float *buf;  /* NULL until initialized */
+} pgBusObject;
+
+static SDL_mutex *bus_lock = NULL;
+static pgBusObject **bus_order = NULL; /* the deepest buses first */
+static int num_buses = 0;
+static PyObject *music_effects = NULL; /* tuple of Effects, or NULL */
+static PyObject *output_effects = NULL; /* on everything mixed */
+static Uint32 bus_tick = 0; /* callbacks mixed, audio thread side */
+static float bus_scratch[PG_BUS_FRAMES * PG_DSP_MAX_CHANNELS];
+/* the channels not on a bus, while the music has effects */
+static float bus_direct[PG_BUS_FRAMES * PG_DSP_MAX_CHANNELS];
+
+/* Whether the channel effect should work on a channel */
+#define PG_BUS_WANTED(cd) ((cd)->bus || (cd)->effects || music_effects)
+
+/* Whether the settings of an effect need working out again, from its
+   process function */
+static int
+_pg_effect_update(pgEffectObject *effect)
+{
+    if (!effect->changed && effect->frequency == mixer_frequency) {
+        return 0;
+    }
+    effect->changed = 0;
+    effect->frequency = mixer_frequency;
+    return 1;
 }
 
-static PyObject *
-snd_get_length(PyObject *self, PyObject *_null)
+static void
+_pg_effects_run(PyObject *effects, float *buf, int frames)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    pgEffectObject *effect;
+    Py_ssize_t i;
 
-    CHECK_CHUNK_VALID(chunk, NULL);
+    for (i = 0; i < PyTuple_GET_SIZE(effects); i++) {
+        effect = (pgEffectObject *)PyTuple_GET_ITEM(effects, i);
+        effect->process(effect, buf, frames, mixer_channels);
+    }
+}
 
-    int freq, channels, mixerbytes, numsamples;
-    Uint16 format;
-    MIXER_INIT_CHECK();
+/* Run the effects of a channel and move its samples into the buffer of
+   its bus, at the volume SDL_mixer would have mixed them with. Call with
+   bus_lock held. */
+static void
+_pg_bus_take(int chan, void *stream, int len)
+{
+    struct ChannelData *cd = &channeldata[chan];
+    Mix_Chunk *chunk;
+    float volume, *dst = NULL;
+    int frames, n, i;
 
-    Mix_QuerySpec(&freq, &format, &channels);
-    if (format == AUDIO_S8 || format == AUDIO_U8)
-        mixerbytes = 1;
-    else if (format == AUDIO_F32LSB || format == AUDIO_F32MSB) {
-        mixerbytes = 4;
+    frames = len / (PG_CVT_SIZE(mixer_type) * mixer_channels);
+    if (frames > PG_BUS_FRAMES) {
+        return;
+    }
+    if (cd->bus_tick != bus_tick) {
+        cd->bus_tick = bus_tick;
+        cd->bus_offset = 0;
+    }
+    /* a chunk ending in the middle of the callback is followed by the
+       next pass or the queued sound, in another call */
+    if (cd->bus_offset + frames <= PG_BUS_FRAMES) {
+        dst = cd->bus ? cd->bus->buf : music_effects ? bus_direct : NULL;
+    }
+    if (!dst && !cd->effects) {
+        return;
     }
-    else
-        mixerbytes = 2;
-    numsamples = chunk->alen / mixerbytes / channels;
 
-    return PyFloat_FromDouble((float)numsamples / (float)freq);
+    n = frames * mixer_channels;
+    pg_audio_to_f32(stream, mixer_type, bus_scratch, n);
+    if (cd->effects) {
+        _pg_effects_run(cd->effects, bus_scratch, frames);
+    }
+    if (!dst) {
+        /* SDL_mixer applies the volume */
+        pg_audio_from_f32(bus_scratch, stream, mixer_type, n);
+        return;
+    }
+    chunk = Mix_GetChunk(chan);
+    volume = (float)Mix_Volume(chan, -1) *
+             (float)(chunk ? chunk->volume : MIX_MAX_VOLUME) /
+             (MIX_MAX_VOLUME * MIX_MAX_VOLUME);
+    dst += (size_t)cd->bus_offset * mixer_channels;
+    for (i = 0; i < n; i++) {
+        dst[i] += bus_scratch[i] * volume;
+    }
+    cd->bus_offset += frames;
+    _pg_fill_silence((Uint8 *)stream, len);
 }
 
-static PyObject *
-snd_get_raw(PyObject *self, PyObject *_null)
+/* Channel effect: the effects and the bus of a channel */
+static void
+_pg_bus_effect(int chan, void *stream, int len, void *udata)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
-
-    CHECK_CHUNK_VALID(chunk, NULL);
-    MIXER_INIT_CHECK();
-
-    return PyBytes_FromStringAndSize((const char *)chunk->abuf,
-                                     (Py_ssize_t)chunk->alen);
+    _pg_stats_begin();
+    SDL_LockMutex(bus_lock);
+    if (channeldata && chan < numchanneldata &&
+        mixer_channels <= PG_DSP_MAX_CHANNELS) {
+        _pg_bus_take(chan, stream, len);
+    }
+    SDL_UnlockMutex(bus_lock);
 }
 
-static PyObject *
-snd_get_arraystruct(PyObject *self, void *closure)
+/* Put the bus effect of a channel after its other effects, or remove it
+   when the channel needs none. Call without the GIL, or from the post mix
+   effect. */
+static void
+_pg_bus_attach(int channel)
 {
-    Py_buffer view;
-    PyObject *cobj;
+    struct ChannelData *cd = &channeldata[channel];
 
-    if (snd_getbuffer(self, &view, PyBUF_RECORDS)) {
-        return 0;
+    if (SDL_AtomicCAS(&cd->bus_attached, 1, 0)) {
+        Mix_UnregisterEffect(channel, _pg_bus_effect);
+    }
+    if (PG_BUS_WANTED(cd) && SDL_AtomicCAS(&cd->bus_attached, 0, 1) &&
+        !Mix_RegisterEffect(channel, _pg_bus_effect, NULL, NULL)) {
+        SDL_AtomicSet(&cd->bus_attached, 0);
     }
-    cobj = pgBuffer_AsArrayStruct(&view);
-    snd_releasebuffer(view.obj, &view);
-    Py_XDECREF(view.obj);
-    return cobj;
 }
 
-static PyObject *
-snd_get_arrayinterface(PyObject *self, void *closure)
+/* Run the music effects and the buses, and mix them into the output, then
+   run the output effects, from the post mix effect */
+static void
+_pg_bus_mix(void *stream, int len)
 {
-    Py_buffer view;
-    PyObject *dict;
+    pgBusObject *bus;
+    float gain, peak, sample, *dst;
+    int frames, n, i, j;
 
-    if (snd_getbuffer(self, &view, PyBUF_RECORDS)) {
-        return 0;
+    if (!bus_lock) {
+        return;
     }
-    dict = pgBuffer_AsArrayInterface(&view);
-    snd_releasebuffer(self, &view);
-    Py_DECREF(self);
-    return dict;
+    SDL_LockMutex(bus_lock);
+    if ((num_buses || music_effects || output_effects) &&
+        mixer_channels <= PG_DSP_MAX_CHANNELS) {
+        /* callbacks longer than the buffers only go through the buses for
+           as long as the buffers are */
+        frames = len / (PG_CVT_SIZE(mixer_type) * mixer_channels);
+        if (frames > PG_BUS_FRAMES) {
+            frames = PG_BUS_FRAMES;
+        }
+        n = frames * mixer_channels;
+        pg_audio_to_f32(stream, mixer_type, bus_scratch, n);
+        if (music_effects) {
+            _pg_effects_run(music_effects, bus_scratch, frames);
+            for (j = 0; j < n; j++) {
+                bus_scratch[j] += bus_direct[j];
+            }
+            memset(bus_direct, 0, (size_t)n * sizeof(float));
+        }
+        for (i = 0; i < num_buses; i++) {
+            bus = bus_order[i];
+            if (bus->effects) {
+                _pg_effects_run(bus->effects, bus->buf, frames);
+            }
+            gain = bus->mute ? 0.0f : bus->gain;
+            dst = bus->parent ? bus->parent->buf : bus_scratch;
+            peak = 0.0f;
+            for (j = 0; j < n; j++) {
+                sample = bus->buf[j] * gain;
+                dst[j] += sample;
+                sample = sample < 0.0f ? -sample : sample;
+                peak = sample > peak ? sample : peak;
+            }
+            bus->level = peak;
+            memset(bus->buf, 0, (size_t)n * sizeof(float));
+        }
+        if (output_effects) {
+            _pg_effects_run(output_effects, bus_scratch, frames);
+        }
+        pg_audio_from_f32(bus_scratch, stream, mixer_type, n);
+    }
+    bus_tick++;
+    SDL_UnlockMutex(bus_lock);
 }
 
-static PyObject *
-snd_get_samples_address(PyObject *self, PyObject *closure)
-{
-    Mix_Chunk *chunk = pgSound_AsChunk(self);
+/* Channel settings changed together by mixer.set_volumes() and
+   mixer.set_source_locations(). They are appended to batch_items, and the
+   post mix effect applies all of them at once, with the audio device
+   already locked, instead of each SDL_mixer call locking it. */
+#define PG_BATCH_VOLUME 0   /* volume, no panning */
+#define PG_BATCH_PANNING 1  /* left and right */
+#define PG_BATCH_LOCATION 2 /* angle and distance */
+
+typedef struct {
+    int channel;
+    int op; /* PG_BATCH_* */
+    int volume;
+    Uint8 left, right;
+    Sint16 angle;
+    Uint8 distance;
+} pgBatchItem;
 
-    CHECK_CHUNK_VALID(chunk, NULL);
+static SDL_SpinLock batch_lock = 0; /* of the three below */
+static pgBatchItem *batch_items = NULL;
+static int batch_count = 0;
+static int batch_size = 0;
 
-    MIXER_INIT_CHECK();
+static void
+_pg_batch_apply(void)
+{
+    pgBatchItem *item;
+    int i;
 
-#if SIZEOF_VOID_P > SIZEOF_LONG
-    return PyLong_FromUnsignedLongLong((unsigned PY_LONG_LONG)chunk->abuf);
-#else
-    return PyLong_FromUnsignedLong((unsigned long)chunk->abuf);
-#endif
+    /* Python holding the lock only delays the batch to the next buffer */
+    if (!batch_count || !SDL_AtomicTryLock(&batch_lock)) {
+        return;
+    }
+    for (i = 0; i < batch_count; ++i) {
+        item = &batch_items[i];
+        if (item->channel >= numchanneldata) {
+            continue;
+        }
+        if (item->op == PG_BATCH_LOCATION) {
+            Mix_SetPosition(item->channel, item->angle, item->distance);
+        }
+        else {
+            Mix_SetPanning(item->channel, item->left, item->right);
+            Mix_Volume(item->channel, item->volume);
+        }
+        _pg_bus_attach(item->channel);
+    }
+    batch_count = 0;
+    SDL_AtomicUnlock(&batch_lock);
 }
 
-PyMethodDef sound_methods[] = {
-    {"play", (PyCFunction)pgSound_Play, METH_VARARGS | METH_KEYWORDS,
-     DOC_MIXER_SOUND_PLAY},
-    {"get_num_channels", snd_get_num_channels, METH_NOARGS,
-     DOC_MIXER_SOUND_GETNUMCHANNELS},
-    {"fadeout", snd_fadeout, METH_VARARGS, DOC_MIXER_SOUND_FADEOUT},
-    {"stop", snd_stop, METH_NOARGS, DOC_MIXER_SOUND_STOP},
-    {"set_volume", snd_set_volume, METH_VARARGS, DOC_MIXER_SOUND_SETVOLUME},
-    {"get_volume", snd_get_volume, METH_NOARGS, DOC_MIXER_SOUND_GETVOLUME},
-    {"get_length", snd_get_length, METH_NOARGS, DOC_MIXER_SOUND_GETLENGTH},
-    {"get_raw", snd_get_raw, METH_NOARGS, DOC_MIXER_SOUND_GETRAW},
-    {NULL, NULL, 0, NULL}};
-
-static PyGetSetDef sound_getset[] = {
-    {"__array_struct__", snd_get_arraystruct, NULL, "Version 3", NULL},
-    {"__array_interface__", snd_get_arrayinterface, NULL, "Version 3", NULL},
-    {"_samples_address", (getter)snd_get_samples_address, NULL,
-     "samples buffer address (readonly)", NULL},
-    {NULL, NULL, NULL, NULL, NULL}};
+static void
+_pg_mixer_post_effect(int chan, void *stream, int len, void *udata)
+{
+    int i;
+    int frames =
+        len / (SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels);
+
+    _pg_stats_begin();
+    _pg_bus_mix(stream, len);
+
+    _pg_pending_run(&stream_pending);
+    _pg_pending_run(&voice_pending);
+    _pg_pending_run(&virtual_pending);
+    _pg_batch_apply();
+
+    /* the queued sounds started by endsound_callback */
+    for (i = 0; channeldata && i < numchanneldata; ++i) {
+        if (PG_BUS_WANTED(&channeldata[i]) &&
+            !SDL_AtomicGet(&channeldata[i].bus_attached) && Mix_Playing(i)) {
+            _pg_bus_attach(i);
+        }
+    }
 
-/*buffer protocol*/
+    SDL_AtomicLock(&clock_lock);
+    sample_clock += frames;
+    SDL_AtomicUnlock(&clock_lock);
+    _pg_stats_end(frames);
 
-/*
-snd_buffer_iteminfo converts between SDL and python format constants.
+    if (offline_device) {
+        _pg_offline_take((Uint8 *)stream, (size_t)len);
+    }
+}
 
-https://wiki.libsdl.org/SDL_AudioSpec
-https://docs.python.org/3/library/struct.html#format-characters
+/* Release the buffers of a stream, but not its RWops */
+static void
+_pg_stream_close(pgSoundStream *st)
+{
+    if (st->cvt) {
+        SDL_FreeAudioStream(st->cvt);
+    }
+    PyMem_Free(st->ring);
+    PyMem_Free(st->src_buf);
+    PyMem_Free(st);
+}
 
-returns:
-    -1 on error, else 0.
-    format: buffer string showing the format.
-    itemsize: bytes for each item.
-*/
+/* Set up the converter and ring of a stream for the format of the mixer.
+   Returns -1 with a Python exception set on failure, leaving neither. */
 static int
-snd_buffer_iteminfo(char **format, Py_ssize_t *itemsize, int *channels)
+_pg_stream_setup(pgSoundStream *st)
 {
-    static char fmt_AUDIO_U8[] = "B";
-    static char fmt_AUDIO_S8[] = "b";
-    static char fmt_AUDIO_U16SYS[] = "=H";
-    static char fmt_AUDIO_S16SYS[] = "=h";
-
-    static char fmt_AUDIO_S32LSB[] = "<i";
-    static char fmt_AUDIO_S32MSB[] = ">i";
-    static char fmt_AUDIO_F32LSB[] = "<f";
-    static char fmt_AUDIO_F32MSB[] = ">f";
-
-    int freq = 0;
-    Uint16 mixer_format = 0;
-
-    Mix_QuerySpec(&freq, &mixer_format, channels);
+    st->cvt = SDL_NewAudioStream(st->src_format, (Uint8)st->src_channels,
+                                 st->src_freq, mixer_format,
+                                 (Uint8)mixer_channels, mixer_frequency);
+    if (!st->cvt) {
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        return -1;
+    }
+    st->frame_size =
+        (Uint32)(SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels);
+    st->ring_size =
+        st->frame_size * PG_STREAM_BLOCK_FRAMES * PG_STREAM_RING_BLOCKS;
+    st->ring = (Uint8 *)PyMem_Malloc(st->ring_size);
+    if (!st->ring) {
+        SDL_FreeAudioStream(st->cvt);
+        st->cvt = NULL;
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
 
-    switch (mixer_format) {
-        case AUDIO_U8:
-            *format = fmt_AUDIO_U8;
-            *itemsize = 1;
-            return 0;
-
-        case AUDIO_S8:
-            *format = fmt_AUDIO_S8;
-            *itemsize = 1;
-            return 0;
-
-        case AUDIO_U16SYS:
-            *format = fmt_AUDIO_U16SYS;
-            *itemsize = 2;
-            return 0;
-
-        case AUDIO_S16SYS:
-            *format = fmt_AUDIO_S16SYS;
-            *itemsize = 2;
-            return 0;
-
-        case AUDIO_S32LSB:
-            *format = fmt_AUDIO_S32LSB;
-            *itemsize = 4;
-            return 0;
-
-        case AUDIO_S32MSB:
-            *format = fmt_AUDIO_S32MSB;
-            *itemsize = 4;
-            return 0;
-
-        case AUDIO_F32LSB:
-            *format = fmt_AUDIO_F32LSB;
-            *itemsize = 4;
-            return 0;
+/* Open a WAV file for streaming. Returns NULL with a Python exception
+   set on failure. The RWops is owned by the stream on success. */
+static pgSoundStream *
+_pg_stream_open(SDL_RWops *rw)
+{
+    pgSoundStream *st;
+    Uint8 hdr[40];
+    Uint32 tag, size;
+    Uint16 wformat = 0, bits = 0;
+    int have_fmt = 0;
+    Sint64 pos, total;
+    SDL_AudioFormat src_format;
+
+    st = (pgSoundStream *)PyMem_Calloc(1, sizeof(pgSoundStream));
+    if (!st) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    st->rw = rw;
+    st->pending_channel = -1;
+    st->gain = st->gain_target = st->gain_to = 1.0f;
+
+    if (SDL_RWread(rw, hdr, 12, 1) != 1 ||
+        _pg_read_le32(hdr) != PG_FOURCC('R', 'I', 'F', 'F') ||
+        _pg_read_le32(hdr + 8) != PG_FOURCC('W', 'A', 'V', 'E')) {
+        PyErr_SetString(PyExc_ValueError,
+                        "stream=True only supports WAV files");
+        goto error;
+    }
+    for (;;) {
+        if (SDL_RWread(rw, hdr, 8, 1) != 1) {
+            PyErr_SetString(PyExc_ValueError, "WAV file has no data chunk");
+            goto error;
+        }
+        tag = _pg_read_le32(hdr);
+        size = _pg_read_le32(hdr + 4);
+        pos = SDL_RWtell(rw);
+        if (pos < 0) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
+            goto error;
+        }
+        if (tag == PG_FOURCC('f', 'm', 't', ' ')) {
+            if (size < 16 || SDL_RWread(rw, hdr, size < 40 ? size : 40, 1) !=
+                                 1) {
+                PyErr_SetString(PyExc_ValueError, "invalid WAV fmt chunk");
+                goto error;
+            }
+            wformat = _pg_read_le16(hdr);
+            st->src_channels = _pg_read_le16(hdr + 2);
+            st->src_freq = (int)_pg_read_le32(hdr + 4);
+            bits = _pg_read_le16(hdr + 14);
+            if (wformat == 0xFFFE && size >= 26) {
+                /* WAVE_FORMAT_EXTENSIBLE, the sub format GUID starts
+                   with the real format tag */
+                wformat = _pg_read_le16(hdr + 24);
+            }
+            have_fmt = 1;
+        }
+        else if (tag == PG_FOURCC('d', 'a', 't', 'a')) {
+            st->data_start = pos;
+            st->data_len = size;
+            total = SDL_RWsize(rw);
+            if (total >= 0 && pos + st->data_len > total) {
+                st->data_len = total - pos;
+            }
+            break;
+        }
+        if (SDL_RWseek(rw, pos + size + (size & 1), RW_SEEK_SET) < 0) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
+            goto error;
+        }
+    }
+    if (!have_fmt || st->src_channels < 1 || st->src_freq <= 0) {
+        PyErr_SetString(PyExc_ValueError, "invalid WAV fmt chunk");
+        goto error;
+    }
 
-        case AUDIO_F32MSB:
-            *format = fmt_AUDIO_F32MSB;
-            *itemsize = 4;
-            return 0;
+    if (wformat == 1 && bits == 8) {
+        src_format = AUDIO_U8;
+    }
+    else if (wformat == 1 && bits == 16) {
+        src_format = AUDIO_S16LSB;
+    }
+    else if (wformat == 1 && (bits == 24 || bits == 32)) {
+        src_format = AUDIO_S32LSB;
+    }
+    else if (wformat == 3 && bits == 32) {
+        src_format = AUDIO_F32LSB;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "stream=True only supports uncompressed WAV data, "
+                     "got format %d with %d bit samples",
+                     (int)wformat, (int)bits);
+        goto error;
+    }
+    st->src_width = bits / 8;
+    st->src_format = src_format;
+    st->src_frames = st->data_len / (st->src_width * st->src_channels);
+    st->data_len = st->src_frames * st->src_width * st->src_channels;
+
+    st->src_buf = (Uint8 *)PyMem_Malloc(PG_STREAM_BLOCK_FRAMES * 4 *
+                                        st->src_channels);
+    if (!st->src_buf) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    if (_pg_stream_setup(st)) {
+        goto error;
     }
+    return st;
 
-    PyErr_Format(PyExc_SystemError,
-                 "Pygame bug (mixer.Sound): unknown mixer format %d",
-                 (int)mixer_format);
-    return -1;
+error:
+    _pg_stream_close(st);
+    return NULL;
 }
 
+/* Hand a stream to the worker thread, starting it if needed */
 static int
-snd_getbuffer(PyObject *obj, Py_buffer *view, int flags)
+_pg_stream_attach(pgSoundStream *st)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk(obj);
-    int channels;
-    char *format;
-    int ndim = 0;
-    Py_ssize_t *shape = 0;
-    Py_ssize_t *strides = 0;
-    Py_ssize_t itemsize;
-    Py_ssize_t samples;
-
-    CHECK_CHUNK_VALID(chunk, -1);
+    SDL_Thread *thread;
+    int failed = 0;
 
-    view->obj = 0;
-    if (snd_buffer_iteminfo(&format, &itemsize, &channels)) {
-        return -1;
-    }
-    if (channels != 1 && PyBUF_HAS_FLAG(flags, PyBUF_F_CONTIGUOUS)) {
-        PyErr_SetString(pgExc_BufferError,
-                        "polyphonic sound is not Fortran contiguous");
-        return -1;
-    }
-    if (PyBUF_HAS_FLAG(flags, PyBUF_ND)) {
-        ndim = channels > 1 ? 2 : 1;
-        samples = chunk->alen / (itemsize * channels);
-        shape = PyMem_New(Py_ssize_t, 2 * ndim);
-        if (!shape) {
-            PyErr_NoMemory();
+    if (!stream_lock) {
+        stream_lock = SDL_CreateMutex();
+        stream_cond = SDL_CreateCond();
+        if (!stream_lock || !stream_cond) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
             return -1;
         }
-        shape[ndim - 1] = channels;
-        shape[0] = samples;
-        if (PyBUF_HAS_FLAG(flags, PyBUF_STRIDES)) {
-            strides = shape + ndim;
-            strides[0] = itemsize * channels;
-            strides[ndim - 1] = itemsize;
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex(stream_lock);
+    st->next = stream_list;
+    stream_list = st;
+    if (!stream_worker_running) {
+        /* the last worker ran out of streams, and is done with the lock */
+        SDL_WaitThread(stream_thread, NULL);
+        stream_thread = NULL;
+        thread = SDL_CreateThread(_pg_stream_worker, "pygame stream", NULL);
+        if (thread) {
+            stream_thread = thread;
+            stream_worker_running = 1;
+        }
+        else {
+            stream_list = st->next;
+            failed = 1;
         }
     }
-    Py_INCREF(obj);
-    view->obj = obj;
-    view->buf = chunk->abuf;
-    view->len = (Py_ssize_t)chunk->alen;
-    view->readonly = 0;
-    view->itemsize = itemsize;
-    view->format = PyBUF_HAS_FLAG(flags, PyBUF_FORMAT) ? format : 0;
-    view->ndim = ndim;
-    view->shape = shape;
-    view->strides = strides;
-    view->suboffsets = 0;
-    view->internal = shape;
-    return 0;
-}
+    SDL_UnlockMutex(stream_lock);
+    Py_END_ALLOW_THREADS;
 
-static void
-snd_releasebuffer(PyObject *obj, Py_buffer *view)
-{
-    if (view->internal) {
-        PyMem_Free(view->internal);
-        view->internal = 0;
+    if (failed) {
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        return -1;
     }
+    return 0;
 }
 
-static PyBufferProcs sound_as_buffer[] = {{snd_getbuffer, snd_releasebuffer}};
-
-/*sound object internals*/
+/* Free a stream whose chunk has already been freed, so no channel can
+   still be reading from it */
 static void
-sound_dealloc(pgSoundObject *self)
+_pg_stream_free(pgSoundStream *st)
 {
-    Mix_Chunk *chunk = pgSound_AsChunk((PyObject *)self);
-    if (chunk) {
+    pgSoundStream **link;
+
+    if (stream_lock) {
         Py_BEGIN_ALLOW_THREADS;
-        Mix_FreeChunk(chunk);
+        SDL_LockMutex(stream_lock);
+        for (link = &stream_list; *link; link = &(*link)->next) {
+            if (*link == st) {
+                *link = st->next;
+                break;
+            }
+        }
+        SDL_UnlockMutex(stream_lock);
+        SDL_CondSignal(stream_cond);
         Py_END_ALLOW_THREADS;
     }
-    if (self->mem)
-        PyMem_Free(self->mem);
-    if (self->weakreflist)
-        PyObject_ClearWeakRefs((PyObject *)self);
-    Py_TYPE(self)->tp_free((PyObject *)self);
-}
 
-static PyTypeObject pgSound_Type = {
-    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Sound",
-    .tp_basicsize = sizeof(pgSoundObject),
-    .tp_dealloc = (destructor)sound_dealloc,
-    .tp_as_buffer = sound_as_buffer,
-    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE),
-    .tp_doc = DOC_MIXER_SOUND,
-    .tp_weaklistoffset = offsetof(pgSoundObject, weakreflist),
-    .tp_methods = sound_methods,
-    .tp_getset = sound_getset,
-    .tp_init = sound_init,
-    .tp_new = PyType_GenericNew,
-};
+    SDL_RWclose(st->rw);
+    _pg_stream_close(st);
+}
 
-/* channel object methods */
-static PyObject *
-chan_play(PyObject *self, PyObject *args, PyObject *kwargs)
+/* Stop the worker thread on mixer.quit(), and drop the converters and
+   rings of the streams, which are in the format of the mixer. The
+   streams stay with their Sounds, and _pg_stream_ready() sets them up
+   again the next time they play. Needs the GIL. */
+static void
+_pg_stream_quit(void)
 {
-    int channelnum = pgChannel_AsInt(self);
-    PyObject *sound;
-    Mix_Chunk *chunk;
-    int loops = 0, playtime = -1, fade_ms = 0;
-
-    char *kwids[] = {"Sound", "loops", "maxtime", "fade_ms", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|iii", kwids,
-                                     &pgSound_Type, &sound, &loops, &playtime,
-                                     &fade_ms))
-        return NULL;
-    chunk = pgSound_AsChunk(sound);
-    CHECK_CHUNK_VALID(chunk, NULL);
+    pgSoundStream *st, *next;
 
-    Py_BEGIN_ALLOW_THREADS;
-    if (fade_ms > 0) {
-        channelnum = Mix_FadeInChannelTimed(channelnum, chunk, loops, fade_ms,
-                                            playtime);
-    }
-    else {
-        channelnum = Mix_PlayChannelTimed(channelnum, chunk, loops, playtime);
+    if (!stream_lock) {
+        return;
     }
-    if (channelnum != -1)
-        Mix_GroupChannel(channelnum, (int)(intptr_t)chunk);
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex(stream_lock);
+    st = stream_list;
+    stream_list = NULL;
+    SDL_UnlockMutex(stream_lock);
+    /* the worker finds no streams left, and returns */
+    SDL_CondSignal(stream_cond);
+    SDL_WaitThread(stream_thread, NULL);
+    stream_thread = NULL;
+    stream_worker_running = 0;
+    SDL_DestroyCond(stream_cond);
+    SDL_DestroyMutex(stream_lock);
+    stream_cond = NULL;
+    stream_lock = NULL;
     Py_END_ALLOW_THREADS;
 
-    Py_XDECREF(channeldata[channelnum].sound);
-    Py_XDECREF(channeldata[channelnum].queue);
-    channeldata[channelnum].sound = sound;
-    channeldata[channelnum].queue = NULL;
-    Py_INCREF(sound);
-    Py_RETURN_NONE;
+    for (; st; st = next) {
+        next = st->next;
+        st->next = NULL;
+        SDL_FreeAudioStream(st->cvt);
+        st->cvt = NULL;
+        PyMem_Free(st->ring);
+        st->ring = NULL;
+    }
 }
 
-static PyObject *
-chan_get_id(PyObject *self, PyObject *empty_args)
+/* Set up the stream of sound again after mixer.quit(), for the mixer as
+   it is now, the silent block it plays included. Needs the GIL. */
+static int
+_pg_stream_ready(pgSoundObject *sound)
 {
-    int channelnum = pgChannel_AsInt(self);
+    pgSoundStream *st = sound->stream;
+    Uint32 len;
+    Uint8 *mem;
 
-    MIXER_INIT_CHECK();
+    if (st->cvt) {
+        return 0;
+    }
+    if (_pg_stream_setup(st)) {
+        return -1;
+    }
+    len = st->frame_size * PG_STREAM_BLOCK_FRAMES;
+    mem = (Uint8 *)PyMem_Malloc(len);
+    if (!mem) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    if (_pg_stream_attach(st)) {
+        PyMem_Free(mem);
+        goto error;
+    }
+    _pg_fill_silence(mem, (int)len);
+    st->chunk->abuf = mem;
+    st->chunk->alen = len;
+    PyMem_Free(sound->mem);
+    sound->mem = mem;
+    return 0;
 
-    return PyLong_FromLong(channelnum);
+error:
+    SDL_FreeAudioStream(st->cvt);
+    st->cvt = NULL;
+    PyMem_Free(st->ring);
+    st->ring = NULL;
+    return -1;
 }
 
-static PyObject *
-chan_queue(PyObject *self, PyObject *sound)
-{
-    int channelnum = pgChannel_AsInt(self);
+/* Music playlists.
+
+   SDL_mixer plays one Mix_Music at a time, and starting the next one from
+   the music finished callback leaves a gap of a buffer or more. A playlist
+   instead has its tracks decoded whole, into chunks in the mixer format,
+   by a thread that keeps one track ahead of the one playing, and mixes
+   them itself as the music, through Mix_HookMusic(). The next track starts
+   on the frame after the last one ends, or overlaps its end by the
+   crossfade, with equal power gains. Tracks are handed over under
+   playlist_lock, which the decoder never holds while decoding or freeing.
+*/
+#define PG_PLAYLIST_FRAMES 512 /* mixed at a time */
+
+typedef struct pgTrack {
+    struct pgTrack *next; /* playlist_spent link */
     Mix_Chunk *chunk;
+    Py_ssize_t index; /* in the playlist */
+    Uint32 frames;    /* to play, fewer than the chunk has after a skip */
+    Uint32 pos;
+} pgTrack;
+
+static SDL_mutex *playlist_lock = NULL;
+static SDL_cond *playlist_cond = NULL;
+static SDL_Thread *playlist_thread = NULL;
+
+/* the decoder side */
+static PyObject *playlist_paths = NULL; /* list of encoded paths */
+static Py_ssize_t playlist_next = 0;    /* to decode */
+static int playlist_loops = 0;
+static int playlist_decoded = 0; /* in this pass over the list */
+static int playlist_decoding = 0;
+static Uint32 playlist_gen = 0; /* changes when a playlist is dropped */
+static int playlist_quit = 0;
+static pgTrack *playlist_spent = NULL; /* for the decoder to free */
+
+/* the audio side */
+static int playlist_playing = 0;
+static pgTrack *playlist_ready = NULL; /* decoded, up next */
+static pgTrack *playlist_current = NULL;
+static pgTrack *playlist_outgoing = NULL; /* fading out */
+static Uint32 playlist_fade_len = 0;
+static Uint32 playlist_crossfade = 0; /* frames */
+static Uint32 playlist_stop_len = 0;  /* frames of the fade out, if any */
+static Uint32 playlist_stop_pos = 0;
+static int *playlist_endevent = NULL;
+static float playlist_buf[PG_PLAYLIST_FRAMES * PG_DSP_MAX_CHANNELS];
+static float playlist_from[PG_PLAYLIST_FRAMES * PG_DSP_MAX_CHANNELS];
 
-    if (!pgSound_Check(sound)) {
-        return RAISE(PyExc_TypeError,
-                     "The argument must be an instance of Sound");
+static void
+_pg_tracks_free(pgTrack *track)
+{
+    pgTrack *next;
+
+    for (; track; track = next) {
+        next = track->next;
+        Mix_FreeChunk(track->chunk);
+        SDL_free(track);
     }
+}
 
-    chunk = pgSound_AsChunk(sound);
-    CHECK_CHUNK_VALID(chunk, NULL);
-    if (!channeldata[channelnum].sound) /*nothing playing*/
-    {
-        Py_BEGIN_ALLOW_THREADS;
-        channelnum = Mix_PlayChannelTimed(channelnum, chunk, 0, -1);
-        if (channelnum != -1)
-            Mix_GroupChannel(channelnum, (int)(intptr_t)chunk);
-        Py_END_ALLOW_THREADS;
+static pgTrack *
+_pg_track_new(Mix_Chunk *chunk, Py_ssize_t index)
+{
+    pgTrack *track = (pgTrack *)SDL_calloc(1, sizeof(pgTrack));
+    Uint32 frame_size =
+        (Uint32)(SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels);
 
-        channeldata[channelnum].sound = sound;
-        Py_INCREF(sound);
+    if (!track) {
+        Mix_FreeChunk(chunk);
+        return NULL;
     }
-    else {
-        Py_XDECREF(channeldata[channelnum].queue);
-        channeldata[channelnum].queue = sound;
-        Py_INCREF(sound);
+    track->chunk = chunk;
+    track->index = index;
+    track->frames = chunk->alen / frame_size;
+    return track;
+}
+
+/* Hand a track over for the decoder to free. Call with playlist_lock. */
+static void
+_pg_track_spend(pgTrack *track)
+{
+    if (track) {
+        track->next = playlist_spent;
+        playlist_spent = track;
+        SDL_CondBroadcast(playlist_cond);
     }
-    Py_RETURN_NONE;
 }
 
-static PyObject *
-chan_get_busy(PyObject *self, PyObject *_null)
+/* Call with playlist_lock, from the audio thread */
+static void
+_pg_track_ended(void)
 {
-    int channelnum = pgChannel_AsInt(self);
-    MIXER_INIT_CHECK();
+    if (playlist_endevent && *playlist_endevent &&
+        SDL_WasInit(SDL_INIT_VIDEO)) {
+        pg_post_event(*playlist_endevent, NULL);
+    }
+}
 
-    return PyBool_FromLong(Mix_Playing(channelnum));
+/* If more tracks are coming. Call with playlist_lock. */
+static int
+_pg_playlist_more(void)
+{
+    if (!playlist_paths) {
+        return 0;
+    }
+    if (playlist_decoding ||
+        playlist_next < PyList_GET_SIZE(playlist_paths)) {
+        return 1;
+    }
+    /* a pass where every track failed stops the loops */
+    return playlist_loops != 0 && playlist_decoded;
 }
 
-static PyObject *
-chan_fadeout(PyObject *self, PyObject *args)
+/* The path of the next track to decode, to SDL_free(), or NULL if there
+   is none. Call with playlist_lock. */
+static char *
+_pg_playlist_take(Py_ssize_t *index)
 {
-    int channelnum = pgChannel_AsInt(self);
-    int _time;
-    if (!PyArg_ParseTuple(args, "i", &_time))
+    if (playlist_ready || !_pg_playlist_more()) {
         return NULL;
-
-    MIXER_INIT_CHECK();
-
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_FadeOutChannel(channelnum, _time);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+    }
+    if (playlist_next >= PyList_GET_SIZE(playlist_paths)) {
+        if (playlist_loops > 0) {
+            --playlist_loops;
+        }
+        playlist_next = 0;
+        playlist_decoded = 0;
+    }
+    *index = playlist_next++;
+    return SDL_strdup(
+        PyBytes_AS_STRING(PyList_GET_ITEM(playlist_paths, *index)));
 }
 
-static PyObject *
-chan_stop(PyObject *self, PyObject *_null)
+static int SDLCALL
+_pg_playlist_worker(void *unused)
 {
-    int channelnum = pgChannel_AsInt(self);
-    MIXER_INIT_CHECK();
+    pgTrack *track;
+    Mix_Chunk *chunk;
+    SDL_RWops *rw;
+    Py_ssize_t index;
+    Uint32 gen;
+    char *path;
+
+    SDL_LockMutex(playlist_lock);
+    while (!playlist_quit) {
+        if (playlist_spent) {
+            track = playlist_spent;
+            playlist_spent = NULL;
+            SDL_UnlockMutex(playlist_lock);
+            _pg_tracks_free(track);
+            SDL_LockMutex(playlist_lock);
+            continue;
+        }
+        path = _pg_playlist_take(&index);
+        if (!path) {
+            SDL_CondWait(playlist_cond, playlist_lock);
+            continue;
+        }
+        gen = playlist_gen;
+        playlist_decoding = 1;
+        SDL_UnlockMutex(playlist_lock);
+
+        /* tracks that fail to decode are skipped */
+        track = NULL;
+        rw = SDL_RWFromFile(path, "rb");
+        SDL_free(path);
+        chunk = rw ? Mix_LoadWAV_RW(rw, 1) : NULL;
+        if (chunk) {
+            track = _pg_track_new(chunk, index);
+        }
 
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_HaltChannel(channelnum);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+        SDL_LockMutex(playlist_lock);
+        playlist_decoding = 0;
+        if (track && track->frames && gen == playlist_gen) {
+            playlist_ready = track;
+            ++playlist_decoded;
+        }
+        else {
+            _pg_track_spend(track);
+        }
+        SDL_CondBroadcast(playlist_cond);
+    }
+    SDL_UnlockMutex(playlist_lock);
+    return 0;
 }
 
-static PyObject *
-chan_pause(PyObject *self, PyObject *_null)
+/* Offline, nothing is real time, so wait for the decoder rather than
+   leave a gap, which keeps renders the same from one run to the next.
+   Call with playlist_lock. */
+static void
+_pg_playlist_wait(void)
 {
-    int channelnum = pgChannel_AsInt(self);
-    MIXER_INIT_CHECK();
+    while (offline_device && !playlist_ready && playlist_playing &&
+           !playlist_quit && _pg_playlist_more()) {
+        SDL_CondWait(playlist_cond, playlist_lock);
+    }
+}
 
-    Mix_Pause(channelnum);
-    Py_RETURN_NONE;
+/* Drop every track. Call with playlist_lock. */
+static void
+_pg_playlist_drop(void)
+{
+    _pg_track_spend(playlist_current);
+    _pg_track_spend(playlist_outgoing);
+    _pg_track_spend(playlist_ready);
+    playlist_current = playlist_outgoing = playlist_ready = NULL;
+    playlist_playing = 0;
+    playlist_loops = 0;
+    if (playlist_paths) {
+        playlist_next = PyList_GET_SIZE(playlist_paths);
+    }
+    ++playlist_gen;
 }
 
-static PyObject *
-chan_unpause(PyObject *self, PyObject *_null)
+/* Music hook, mixing the playlist as the music */
+static void
+_pg_playlist_mix(void *udata, Uint8 *stream, int len)
 {
-    int channelnum = pgChannel_AsInt(self);
-    MIXER_INIT_CHECK();
+    int ch = mixer_channels, frame_size, frames, done = 0, n;
+    Uint32 fade, left;
+    float volume;
+    pgTrack *cur, *out;
 
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_Resume(channelnum);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+    if (Mix_PausedMusic() || ch > PG_DSP_MAX_CHANNELS) {
+        return;
+    }
+    frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * ch;
+    frames = len / frame_size;
+    volume = Mix_VolumeMusic(-1) / (float)MIX_MAX_VOLUME;
+
+    SDL_LockMutex(playlist_lock);
+    while (done < frames && playlist_playing) {
+        cur = playlist_current;
+        if (cur && cur->pos >= cur->frames) {
+            _pg_track_spend(cur);
+            playlist_current = cur = NULL;
+            _pg_track_ended();
+        }
+        if (!cur) {
+            _pg_playlist_wait();
+            if (!playlist_ready) {
+                if (!_pg_playlist_more()) {
+                    playlist_playing = 0;
+                }
+                break;
+            }
+            playlist_current = cur = playlist_ready;
+            playlist_ready = NULL;
+            SDL_CondBroadcast(playlist_cond);
+        }
+        if (playlist_crossfade && !playlist_outgoing &&
+            cur->frames - cur->pos <= playlist_crossfade) {
+            _pg_playlist_wait();
+            if (playlist_ready &&
+                cur->frames - cur->pos <= playlist_ready->frames) {
+                playlist_outgoing = cur;
+                playlist_fade_len = cur->frames - cur->pos;
+                playlist_current = cur = playlist_ready;
+                playlist_ready = NULL;
+                SDL_CondBroadcast(playlist_cond);
+            }
+        }
+        out = playlist_outgoing;
+
+        n = frames - done;
+        if (n > PG_PLAYLIST_FRAMES) {
+            n = PG_PLAYLIST_FRAMES;
+        }
+        if ((Uint32)n > cur->frames - cur->pos) {
+            n = (int)(cur->frames - cur->pos);
+        }
+        /* stop where the crossfade should start */
+        if (playlist_crossfade && !out) {
+            fade = playlist_crossfade;
+            if (playlist_ready && playlist_ready->frames < fade) {
+                fade = playlist_ready->frames;
+            }
+            left = cur->frames - cur->pos;
+            if (left > fade && (Uint32)n > left - fade) {
+                n = (int)(left - fade);
+            }
+        }
+        if (out && (Uint32)n > out->frames - out->pos) {
+            n = (int)(out->frames - out->pos);
+        }
+        if (playlist_stop_len &&
+            (Uint32)n > playlist_stop_len - playlist_stop_pos) {
+            n = (int)(playlist_stop_len - playlist_stop_pos);
+        }
+        pg_audio_to_f32(cur->chunk->abuf + (size_t)cur->pos * frame_size,
+                        mixer_type, playlist_buf, (size_t)n * ch);
+        if (out) {
+            pg_audio_to_f32(
+                out->chunk->abuf + (size_t)out->pos * frame_size, mixer_type,
+                playlist_from, (size_t)n * ch);
+            pg_crossfade(playlist_buf, playlist_from, n, ch,
+                         playlist_fade_len - (out->frames - out->pos),
+                         playlist_fade_len);
+            out->pos += n;
+            if (out->pos >= out->frames) {
+                _pg_track_spend(out);
+                playlist_outgoing = NULL;
+                _pg_track_ended();
+            }
+        }
+        if (playlist_stop_len) {
+            pg_ramp(playlist_buf, n, ch,
+                    volume * (1.0f - (float)playlist_stop_pos /
+                                         playlist_stop_len),
+                    volume * (1.0f - (float)(playlist_stop_pos + n) /
+                                         playlist_stop_len));
+            playlist_stop_pos += n;
+        }
+        else if (volume != 1.0f) {
+            pg_ramp(playlist_buf, n, ch, volume, volume);
+        }
+        pg_audio_from_f32(playlist_buf, stream + (size_t)done * frame_size,
+                          mixer_type, (size_t)n * ch);
+        cur->pos += n;
+        done += n;
+
+        if (playlist_stop_len && playlist_stop_pos >= playlist_stop_len) {
+            _pg_playlist_drop();
+            _pg_track_ended();
+        }
+    }
+    SDL_UnlockMutex(playlist_lock);
 }
 
-static PyObject *
-chan_set_source_location(PyObject *self, PyObject *args)
+/* Stop the decoder for good, before the mixer closes. Call without the
+   GIL. */
+static void
+_pg_playlist_quit(void)
 {
-    int channelnum = pgChannel_AsInt(self);
+    if (!playlist_thread) {
+        return;
+    }
+    Mix_HookMusic(NULL, NULL);
+    SDL_LockMutex(playlist_lock);
+    _pg_playlist_drop();
+    playlist_quit = 1;
+    SDL_CondBroadcast(playlist_cond);
+    SDL_UnlockMutex(playlist_lock);
+    SDL_WaitThread(playlist_thread, NULL);
+    playlist_thread = NULL;
+    playlist_quit = 0;
+    _pg_tracks_free(playlist_spent);
+    playlist_spent = NULL;
+}
+
+/* Voice management.
+
+   Sounds have a priority. When Sound.play() finds no free channel, it
+   takes over the least important one: the one playing a sound of lower
+   priority, or, once virtual voices are on, of the same priority but less
+   audible. Audibility is the channel and sound volumes, times the
+   attenuation asked for with Channel.set_volume() or
+   Channel.set_source_location(). Without virtual voices a sound cut off is
+   lost, so one of the same priority is never cut off then.
+
+   After mixer.set_num_virtual(), a sound pushed off its channel that way,
+   or played while no channel could be taken, lives on as a virtual voice
+   that only keeps time. When a channel finishes playing by itself,
+   endsound_callback resumes the most important virtual voice on it, at the
+   point the sound would have reached by then.
+*/
+#define PG_VIRTUAL_MAX 1024
+#define PG_VIRTUAL_FREE 0
+#define PG_VIRTUAL_WAITING 1 /* for a channel to free up */
+#define PG_VIRTUAL_TAKEN 2   /* being changed by either side */
+#define PG_VIRTUAL_PLAYING 3 /* resumed, the channel plays the view */
+
+typedef struct pgVirtualVoice {
+    SDL_atomic_t state;
+    PyObject *sound; /* reference held while waiting */
+    Mix_Chunk *chunk;
+    int priority;
+    float audibility;
+    Uint64 start; /* the sample clock when the sound started */
+    int loops;
+    int playtime;
+    /* the panning or source location of the channel it left */
+    int position;
+    Uint8 left, right;
     Sint16 angle;
-    float angle_f;
     Uint8 distance;
-    float distance_f;
-    PyThreadState *_save;
 
-    if (!PyArg_ParseTuple(args, "ff", &angle_f, &distance_f))
-        return NULL;
+    /* audio thread side, once resumed */
+    int channel;
+    Uint32 frame; /* where to start in the chunk */
+    int passes;   /* passes left after that one, -1 repeats forever */
+    Mix_Chunk view;
+} pgVirtualVoice;
 
-    angle = (Sint16)roundf(fmodf(angle_f, 360));
-    distance_f = roundf(distance_f);
-    if (0 > distance_f || 256 <= distance_f) {
-        return RAISE(PyExc_ValueError,
-                     "distance out of range, expected (0, 255)");
-    }
-    distance = (Uint8)distance_f;
+static pgVirtualVoice virtual_voices[PG_VIRTUAL_MAX];
+static SDL_atomic_t num_virtual;
 
-    MIXER_INIT_CHECK();
-    _save = PyEval_SaveThread();
-    if (!Mix_SetPosition(channelnum, angle, distance)) {
-        PyEval_RestoreThread(_save);
-        return RAISE(pgExc_SDLError, Mix_GetError());
-    }
-    PyEval_RestoreThread(_save);
-    Py_RETURN_NONE;
+/* Resumed voices waiting for the post mix effect to start them */
+static pgPendingQueue virtual_pending = {
+    {NULL}, _pg_virtual_start_pending, _pg_virtual_drop_pending};
+
+/* Messages from endsound_callback to the interpreter.
+
+   SDL_mixer calls endsound_callback with its audio lock held, from the
+   audio thread or from a thread halting the channel, so there is only ever
+   one producer at a time. The consumer is whoever holds the GIL, and
+   applies the messages to the Python side of the channels in
+   _pg_channel_sync() before looking at them.
+*/
+#define PG_MSG_RING_SIZE 1024 /* a power of two */
+#define PG_MSG_DONE 1         /* the sound ended, nothing followed */
+#define PG_MSG_NEXT 2         /* the sound ended, the queued one started */
+#define PG_MSG_RESUME 3 /* the sound ended, a virtual voice took over */
+
+typedef struct {
+    int type;
+    int channel;
+    Uint32 gen; /* of the sound that ended */
+    /* how the sound that followed was started, as in ChannelData */
+    Uint64 start;
+    int loops;
+    int playtime;
+    PyObject *sound; /* a resumed Sound, with its reference */
+} pgMixerMsg;
+
+static pgMixerMsg msg_ring[PG_MSG_RING_SIZE];
+static SDL_atomic_t msg_head; /* next message written */
+static SDL_atomic_t msg_tail; /* next message read */
+static SDL_atomic_t msg_lost; /* the ring was full */
+
+static char queue_closed;
+#define PG_QUEUE_CLOSED ((void *)&queue_closed)
+
+static int
+_pg_msg_room(void)
+{
+    return PG_MSG_RING_SIZE - (int)((Uint32)SDL_AtomicGet(&msg_head) -
+                                    (Uint32)SDL_AtomicGet(&msg_tail));
 }
 
-static PyObject *
-chan_set_volume(PyObject *self, PyObject *args)
+/* Push a message, about the virtual voice v resumed on the channel if
+   not NULL */
+static void
+_pg_msg_push(int type, int channel, Uint32 gen, pgVirtualVoice *v)
 {
-    int channelnum = pgChannel_AsInt(self);
-    float volume, stereovolume = -1.11f;
-#ifdef Py_DEBUG
-    int result;
-#endif
-    Uint8 left, right;
-    PyThreadState *_save;
+    Uint32 head = (Uint32)SDL_AtomicGet(&msg_head);
+    pgMixerMsg *msg;
+
+    if (head - (Uint32)SDL_AtomicGet(&msg_tail) >= PG_MSG_RING_SIZE) {
+        SDL_AtomicSet(&msg_lost, 1);
+        SDL_AtomicLock(&stats_lock);
+        mixer_stats.events_lost++;
+        SDL_AtomicUnlock(&stats_lock);
+        return;
+    }
+    msg = &msg_ring[head & (PG_MSG_RING_SIZE - 1)];
+    msg->type = type;
+    msg->channel = channel;
+    msg->gen = gen;
+    msg->start = v ? v->start : _pg_sample_clock();
+    msg->loops = v ? v->loops : 0;
+    msg->playtime = v ? v->playtime : -1;
+    msg->sound = v ? v->sound : NULL;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&msg_head, (int)(head + 1));
+}
 
-    if (!PyArg_ParseTuple(args, "f|f", &volume, &stereovolume))
-        return NULL;
+/* Bring the Python side of the channels up to date. Needs the GIL.
 
-    MIXER_INIT_CHECK();
-    if ((stereovolume <= -1.10f) && (stereovolume >= -1.12f)) {
-        /* The normal volume will be used. No panning. so panning is
-         * set to full. this is in case it was set previously to
-         * something else. NOTE: there is no way to GetPanning
-         * variables.
-         */
-        left = 255;
-        right = 255;
+   Dropping a Sound can release the GIL and let another thread in here,
+   so each message is taken off the ring before it is applied, and no
+   reference is dropped while the channel still points to it. */
+static void
+_pg_channel_sync(void)
+{
+    struct ChannelData *cd;
+    pgMixerMsg msg;
+    PyObject *old, *old_queue;
+    void *slot;
+    Uint32 tail;
+    int i;
 
-        _save = PyEval_SaveThread();
-        if (!Mix_SetPanning(channelnum, left, right)) {
-            PyEval_RestoreThread(_save);
-            return RAISE(pgExc_SDLError, Mix_GetError());
+    if (!channeldata) {
+        return;
+    }
+    for (;;) {
+        tail = (Uint32)SDL_AtomicGet(&msg_tail);
+        if (tail == (Uint32)SDL_AtomicGet(&msg_head)) {
+            break;
         }
-        PyEval_RestoreThread(_save);
+        SDL_MemoryBarrierAcquire();
+        msg = msg_ring[tail & (PG_MSG_RING_SIZE - 1)];
+        SDL_AtomicSet(&msg_tail, (int)(tail + 1));
+        if (!channeldata || msg.channel >= numchanneldata) {
+            Py_XDECREF(msg.sound);
+            continue;
+        }
+        cd = &channeldata[msg.channel];
+        old = NULL;
+        if (msg.type == PG_MSG_NEXT) {
+            /* the queued Sound is the one that was in queue_slot, it
+               could not be replaced until now */
+            old = cd->sound;
+            cd->sound = cd->queue;
+            cd->queue = NULL;
+        }
+        else if (msg.type == PG_MSG_RESUME) {
+            old = cd->sound;
+            cd->sound = msg.sound;
+        }
+        else if (cd->sound_gen == msg.gen) {
+            old = cd->sound;
+            cd->sound = NULL;
+        }
+        if (msg.type != PG_MSG_DONE) {
+            cd->sound_gen = msg.gen + 1;
+            cd->priority =
+                cd->sound ? ((pgSoundObject *)cd->sound)->priority : 0;
+            cd->start = msg.start;
+            cd->loops = msg.loops;
+            cd->playtime = msg.playtime;
+            cd->region = 0;
+        }
+        Py_XDECREF(old);
     }
-    else {
-        /* NOTE: here the volume will be set to 1.0 and the panning will
-         * be used. */
-        left = (Uint8)(volume * 255);
-        right = (Uint8)(stereovolume * 255);
-        /*
-        printf("left:%d:  right:%d:\n", left, right);
-        */
 
-        _save = PyEval_SaveThread();
-        if (!Mix_SetPanning(channelnum, left, right)) {
-            PyEval_RestoreThread(_save);
-            return RAISE(pgExc_SDLError, Mix_GetError());
+    if (channeldata && SDL_AtomicSet(&msg_lost, 0)) {
+        /* start over from what the channels are doing */
+        for (i = 0; channeldata && i < numchanneldata; ++i) {
+            cd = &channeldata[i];
+            slot = SDL_AtomicGetPtr(&cd->queue_slot);
+            old = cd->sound;
+            old_queue = NULL;
+            if (slot == PG_QUEUE_CLOSED) {
+                old_queue = cd->queue;
+                cd->sound = NULL;
+                cd->queue = NULL;
+            }
+            else if (cd->queue && !slot) {
+                cd->sound = cd->queue;
+                cd->queue = NULL;
+            }
+            else {
+                old = NULL;
+            }
+            cd->sound_gen = cd->gen;
+            Py_XDECREF(old);
+            Py_XDECREF(old_queue);
         }
-        PyEval_RestoreThread(_save);
-
-        volume = 1.0f;
     }
+}
 
-#ifdef Py_DEBUG
-    result =
-#endif
-        Mix_Volume(channelnum, (int)(volume * 128));
-    Py_RETURN_NONE;
+/* Let go of a resumed voice taken back out before it started */
+static void
+_pg_virtual_drop_pending(void *item)
+{
+    pgVirtualVoice *v = (pgVirtualVoice *)item;
+
+    /* the channel sits idle after all, which the Python side only learns
+       by looking at it again */
+    SDL_AtomicSetPtr(&channeldata[v->channel].queue_slot, PG_QUEUE_CLOSED);
+    Mix_GroupChannel(v->channel, -1);
+    SDL_AtomicSet(&v->state, PG_VIRTUAL_FREE);
+    SDL_AtomicSet(&msg_lost, 1);
 }
 
-static PyObject *
-chan_get_volume(PyObject *self, PyObject *_null)
+typedef struct {
+    int channel;
+    Mix_Chunk *chunk;
+} pgVirtualMatch;
+
+static int
+_pg_virtual_match(void *item, void *arg)
 {
-    int channelnum = pgChannel_AsInt(self);
-    int volume;
+    pgVirtualVoice *v = (pgVirtualVoice *)item;
+    pgVirtualMatch *m = (pgVirtualMatch *)arg;
 
-    MIXER_INIT_CHECK();
+    return (m->channel == -1 || v->channel == m->channel) &&
+           (!m->chunk || v->chunk == m->chunk);
+}
 
-    volume = Mix_Volume(channelnum, -1);
+/* Drop the resumed voices not started yet on the channel, of the chunk,
+   or all of them when -1 and NULL. Call without the GIL. */
+static void
+_pg_virtual_cancel_pending(int channel, Mix_Chunk *chunk)
+{
+    pgVirtualMatch m;
 
-    return PyFloat_FromDouble(volume / 128.0);
+    m.channel = channel;
+    m.chunk = chunk;
+    _pg_pending_cancel(&virtual_pending, _pg_virtual_match, &m);
 }
 
-static PyObject *
-chan_get_sound(PyObject *self, PyObject *_null)
+/* Get a channel ready to start a new sound: drop its queue, stop what
+   it plays, and open its queue slot. Call without the GIL. */
+static void
+_pg_channel_open(int channel)
 {
-    int channelnum = pgChannel_AsInt(self);
-    PyObject *sound;
+    struct ChannelData *cd = &channeldata[channel];
 
-    sound = channeldata[channelnum].sound;
-    if (!sound)
-        Py_RETURN_NONE;
+    SDL_AtomicSetPtr(&cd->queue_slot, PG_QUEUE_CLOSED);
+    _pg_pending_cancel(&stream_pending, _pg_stream_on_channel, &channel);
+    if (cd->voice) {
+        _pg_voice_cancel(cd->voice);
+    }
+    _pg_virtual_cancel_pending(channel, NULL);
+    if (Mix_Playing(channel)) {
+        _pg_halt_channel(channel);
+    }
+    cd->gen++;
+    SDL_AtomicSetPtr(&cd->queue_slot, NULL);
+}
 
-    Py_INCREF(sound);
-    return sound;
+/* Undo _pg_channel_open() when the sound could not be started */
+static void
+_pg_channel_close(int channel)
+{
+    SDL_AtomicSetPtr(&channeldata[channel].queue_slot, PG_QUEUE_CLOSED);
 }
 
-static PyObject *
-chan_get_queue(PyObject *self, PyObject *_null)
+/* A channel that is free for Sound.play(), or -1. Call without the GIL. */
+static int
+_pg_channel_find_free(void)
 {
-    int channelnum = pgChannel_AsInt(self);
-    PyObject *sound;
+    int i, numchans = Mix_GroupCount(-1);
 
-    sound = channeldata[channelnum].queue;
-    if (!sound)
-        Py_RETURN_NONE;
+    for (i = numreserved; i < numchans && i < numchanneldata; ++i) {
+        if (!Mix_Playing(i) && SDL_AtomicGetPtr(&channeldata[i].queue_slot) ==
+                                   PG_QUEUE_CLOSED) {
+            return i;
+        }
+    }
+    return -1;
+}
 
+/* Record sound as started on channel by _pg_channel_open(). Needs the
+   GIL. */
+static void
+_pg_channel_set_sound(int channel, PyObject *sound, int loops, int playtime)
+{
+    struct ChannelData *cd;
+    PyObject *old, *old_queue;
+
+    _pg_channel_sync();
+    cd = &channeldata[channel];
+    old = cd->sound;
+    old_queue = cd->queue;
+    cd->sound = sound;
+    cd->queue = NULL;
+    cd->sound_gen = cd->gen;
+    cd->priority = ((pgSoundObject *)sound)->priority;
+    cd->start = _pg_sample_clock();
+    cd->loops = loops;
+    cd->playtime = playtime;
+    cd->region = 0;
     Py_INCREF(sound);
-    return sound;
+    if (SDL_AtomicGetPtr(&cd->queue_slot) == PG_QUEUE_CLOSED) {
+        /* it already finished, and the message may have been drained */
+        Py_CLEAR(cd->sound);
+    }
+    Py_XDECREF(old);
+    Py_XDECREF(old_queue);
 }
 
-static PyObject *
-chan_set_endevent(PyObject *self, PyObject *args)
+/* Whether a sound of priority p1 and audibility a1 matters less than one
+   of priority p2 and audibility a2 */
+static int
+_pg_less_important(int p1, float a1, int p2, float a2)
 {
-    int channelnum = pgChannel_AsInt(self);
-    int event = SDL_NOEVENT;
+    return p1 < p2 || (p1 == p2 && a1 < a2);
+}
 
-    if (!PyArg_ParseTuple(args, "|i", &event))
-        return NULL;
+/* Milliseconds mixed from start to now on the sample clock */
+static Uint32
+_pg_clock_ms(Uint64 start, Uint64 now)
+{
+    Uint64 ms;
 
-    channeldata[channelnum].endevent = event;
-    Py_RETURN_NONE;
+    if (now <= start || !mixer_frequency) {
+        return 0;
+    }
+    ms = (now - start) * 1000 / mixer_frequency;
+    return ms > INT_MAX ? INT_MAX : (Uint32)ms;
 }
 
-static PyObject *
-chan_get_endevent(PyObject *self, PyObject *_null)
+/* Where v would be by now, on the sample clock: the pass it is in and the
+   frame in that pass. Returns 0 once the sound would have ended. */
+static int
+_pg_virtual_position(pgVirtualVoice *v, Uint64 now, int *pass,
+                     Uint32 *frame)
 {
-    int channelnum = pgChannel_AsInt(self);
+    int frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels;
+    Uint32 frames = frame_size ? v->chunk->alen / frame_size : 0;
+    Uint64 done = now > v->start ? now - v->start : 0;
 
-    return PyLong_FromLong(channeldata[channelnum].endevent);
+    if (!frames || (v->playtime >= 0 &&
+                    _pg_clock_ms(v->start, now) >= (Uint32)v->playtime)) {
+        return 0;
+    }
+    if (v->loops >= 0 && done / frames > (Uint64)v->loops) {
+        return 0;
+    }
+    *pass = (int)MIN(done / frames, INT_MAX);
+    *frame = (Uint32)(done % frames);
+    return 1;
 }
 
-static PyGetSetDef _channel_getsets[] = {
-    {"id", (getter)chan_get_id, NULL, DOC_MIXER_CHANNEL_ID, NULL},
-    {NULL, NULL, NULL, NULL, NULL}};
+/* How loud the channel plays, from 0.0 to 1.0. Needs the GIL. */
+static float
+_pg_channel_audibility(int channel)
+{
+    struct ChannelData *cd = &channeldata[channel];
+    float volume = Mix_Volume(channel, -1) / 128.0f;
 
-static PyMethodDef channel_methods[] = {
-    {"play", (PyCFunction)chan_play, METH_VARARGS | METH_KEYWORDS,
-     DOC_MIXER_CHANNEL_PLAY},
-    {"queue", chan_queue, METH_O, DOC_MIXER_CHANNEL_QUEUE},
-    {"get_busy", (PyCFunction)chan_get_busy, METH_NOARGS,
-     DOC_MIXER_CHANNEL_GETBUSY},
-    {"fadeout", chan_fadeout, METH_VARARGS, DOC_MIXER_CHANNEL_FADEOUT},
-    {"stop", (PyCFunction)chan_stop, METH_NOARGS, DOC_MIXER_CHANNEL_STOP},
-    {"pause", (PyCFunction)chan_pause, METH_NOARGS, DOC_MIXER_CHANNEL_PAUSE},
-    {"unpause", (PyCFunction)chan_unpause, METH_NOARGS,
-     DOC_MIXER_CHANNEL_UNPAUSE},
-    {"set_source_location", chan_set_source_location, METH_VARARGS,
-     DOC_MIXER_CHANNEL_SETSOURCELOCATION},
-    {"set_volume", chan_set_volume, METH_VARARGS, DOC_MIXER_CHANNEL_SETVOLUME},
-    {"get_volume", (PyCFunction)chan_get_volume, METH_NOARGS,
-     DOC_MIXER_CHANNEL_GETVOLUME},
+    if (cd->sound) {
+        volume *= Mix_VolumeChunk(pgSound_AsChunk(cd->sound), -1) / 128.0f;
+    }
+    if (cd->position == 1) {
+        volume *= MAX(cd->left, cd->right) / 255.0f;
+    }
+    else if (cd->position == 2) {
+        volume *= (255 - cd->distance) / 255.0f;
+    }
+    return volume;
+}
 
-    {"get_sound", (PyCFunction)chan_get_sound, METH_NOARGS,
-     DOC_MIXER_CHANNEL_GETSOUND},
-    {"get_queue", (PyCFunction)chan_get_queue, METH_NOARGS,
-     DOC_MIXER_CHANNEL_GETQUEUE},
+/* The unreserved channel playing the least important sound, the oldest
+   of those that matter as little, if it matters less than a sound of the
+   given priority and audibility. Unless by_audibility, only a sound of
+   lower priority matters less. Otherwise -1. Needs the GIL. */
+static int
+_pg_channel_find_victim(int priority, float audibility, int by_audibility)
+{
+    int i, found = -1, numchans = Mix_GroupCount(-1);
+    struct ChannelData *cd;
+    float volume;
 
-    {"set_endevent", chan_set_endevent, METH_VARARGS,
-     DOC_MIXER_CHANNEL_SETENDEVENT},
-    {"get_endevent", (PyCFunction)chan_get_endevent, METH_NOARGS,
-     DOC_MIXER_CHANNEL_GETENDEVENT},
+    _pg_channel_sync();
+    for (i = numreserved; i < numchans && i < numchanneldata; ++i) {
+        cd = &channeldata[i];
+        if (!by_audibility && cd->priority >= priority) {
+            continue;
+        }
+        volume = _pg_channel_audibility(i);
+        if (_pg_less_important(cd->priority, volume, priority, audibility) ||
+            (found != -1 && cd->priority == priority &&
+             volume == audibility &&
+             cd->start < channeldata[found].start)) {
+            found = i;
+            priority = cd->priority;
+            audibility = volume;
+        }
+    }
+    return found;
+}
 
-    {NULL, NULL, 0, NULL}};
+/* Keep sound as a virtual voice, in place of a less important one if
+   they are all taken. from is the channel it is pushed off, or NULL.
+   Needs the GIL. */
+static void
+_pg_virtual_add(PyObject *sound, float audibility, Uint64 start, int loops,
+                int playtime, struct ChannelData *from)
+{
+    int i, pass, state, n = SDL_AtomicGet(&num_virtual);
+    int priority = ((pgSoundObject *)sound)->priority;
+    Uint64 now = _pg_sample_clock();
+    Uint32 frame;
+    pgVirtualVoice *v, *found = NULL;
+    PyObject *old = NULL;
+
+    if (((pgSoundObject *)sound)->stream) {
+        return; /* they can't be started part way */
+    }
+    for (i = 0; i < n; ++i) {
+        v = &virtual_voices[i];
+        state = SDL_AtomicGet(&v->state);
+        if (state == PG_VIRTUAL_FREE ||
+            (state == PG_VIRTUAL_WAITING &&
+             !_pg_virtual_position(v, now, &pass, &frame))) {
+            found = v;
+            break;
+        }
+        if (state == PG_VIRTUAL_WAITING &&
+            _pg_less_important(v->priority, v->audibility, priority,
+                               audibility) &&
+            (!found || _pg_less_important(v->priority, v->audibility,
+                                          found->priority,
+                                          found->audibility))) {
+            found = v;
+        }
+    }
+    if (!found) {
+        return;
+    }
+    state = SDL_AtomicGet(&found->state);
+    if (state == PG_VIRTUAL_FREE) {
+        if (!SDL_AtomicCAS(&found->state, state, PG_VIRTUAL_TAKEN)) {
+            return;
+        }
+    }
+    else if (state != PG_VIRTUAL_WAITING ||
+             !SDL_AtomicCAS(&found->state, state, PG_VIRTUAL_TAKEN)) {
+        return; /* resumed meanwhile */
+    }
+    else {
+        old = found->sound;
+    }
 
-/* channel object internals */
+    Py_INCREF(sound);
+    found->sound = sound;
+    found->chunk = pgSound_AsChunk(sound);
+    found->priority = priority;
+    found->audibility = audibility;
+    found->start = start;
+    found->loops = loops;
+    found->playtime = playtime;
+    found->position = from ? from->position : 0;
+    if (from) {
+        found->left = from->left;
+        found->right = from->right;
+        found->angle = from->angle;
+        found->distance = from->distance;
+    }
+    SDL_AtomicSet(&found->state, PG_VIRTUAL_WAITING);
+    Py_XDECREF(old);
+}
 
+/* Drop the waiting virtual voices of sound, or all of them if NULL, from
+   the first one on. Needs the GIL. */
 static void
-channel_dealloc(PyObject *self)
+_pg_virtual_cancel(PyObject *sound, int first)
 {
-    Py_TYPE(self)->tp_free(self);
+    pgVirtualVoice *v;
+    PyObject *old;
+    int i;
+
+    for (i = first; i < PG_VIRTUAL_MAX; ++i) {
+        v = &virtual_voices[i];
+        if ((!sound || v->sound == sound) &&
+            SDL_AtomicCAS(&v->state, PG_VIRTUAL_WAITING, PG_VIRTUAL_TAKEN)) {
+            old = v->sound;
+            v->sound = NULL;
+            SDL_AtomicSet(&v->state, PG_VIRTUAL_FREE);
+            Py_DECREF(old);
+        }
+    }
 }
 
 static int
-_channel_init(pgChannelObject *self, int channelnum)
+_pg_virtual_defer(pgVirtualVoice *v)
 {
-    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
-        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
-        return -1;
+    return !_pg_pending_push(&virtual_pending, v);
+}
+
+/* Resume the most important virtual voice on a channel that finished by
+   itself, from endsound_callback. gen is that of the sound that ended. */
+static int
+_pg_virtual_resume(int channel, Uint32 gen)
+{
+    struct ChannelData *cd = &channeldata[channel];
+    int i, pass, best_pass = 0, n = SDL_AtomicGet(&num_virtual);
+    Uint32 frame, best_frame = 0;
+    Uint64 now = _pg_sample_clock();
+    pgVirtualVoice *v, *best = NULL;
+
+    /* the Sound reference is handed over in a message that must not get
+       lost */
+    if (!n || SDL_AtomicGet(&halting) || channel < numreserved ||
+        cd->voice || _pg_msg_room() < 2) {
+        return 0;
     }
-    if (channelnum < 0 || channelnum >= Mix_GroupCount(-1)) {
-        PyErr_SetString(PyExc_IndexError, "invalid channel index");
-        return -1;
+    for (i = 0; i < n; ++i) {
+        v = &virtual_voices[i];
+        if (SDL_AtomicGet(&v->state) == PG_VIRTUAL_WAITING &&
+            _pg_virtual_position(v, now, &pass, &frame) &&
+            (!best || _pg_less_important(best->priority, best->audibility,
+                                         v->priority, v->audibility))) {
+            best = v;
+            best_pass = pass;
+            best_frame = frame;
+        }
     }
-    self->chan = channelnum;
-    return 0;
+    if (!best || !SDL_AtomicCAS(&best->state, PG_VIRTUAL_WAITING,
+                                PG_VIRTUAL_TAKEN)) {
+        return 0;
+    }
+    best->channel = channel;
+    best->frame = best_frame;
+    best->passes = best->loops < 0 ? -1 : best->loops - best_pass;
+    if (!_pg_virtual_defer(best)) {
+        SDL_AtomicSet(&best->state, PG_VIRTUAL_WAITING);
+        return 0;
+    }
+    cd->position = best->position;
+    cd->left = best->left;
+    cd->right = best->right;
+    cd->angle = best->angle;
+    cd->distance = best->distance;
+    Mix_GroupChannel(channel, (int)(intptr_t)best->chunk);
+    cd->gen = gen + 1;
+    SDL_AtomicSetPtr(&cd->queue_slot, NULL);
+    _pg_msg_push(PG_MSG_RESUME, channel, gen, best);
+    return 1;
 }
 
+/* Play the passes left of the voice resumed on the channel, from
+   endsound_callback, or let it go */
 static int
-channel_init(pgChannelObject *self, PyObject *args, PyObject *kwargs)
+_pg_virtual_continue(int channel)
 {
-    int channelnum;
-    if (!PyArg_ParseTuple(args, "i", &channelnum)) {
-        return -1;
+    struct ChannelData *cd = &channeldata[channel];
+    pgVirtualVoice *v = cd->resumed;
+
+    cd->resumed = NULL;
+    if (v->passes && !SDL_AtomicGet(&halting) &&
+        (v->playtime < 0 ||
+         _pg_clock_ms(v->start, _pg_sample_clock()) <
+             (Uint32)v->playtime)) {
+        v->frame = 0;
+        v->passes = v->passes > 0 ? v->passes - 1 : -1;
+        if (_pg_virtual_defer(v)) {
+            return 1;
+        }
     }
-
-    return _channel_init(self, channelnum);
+    SDL_AtomicSet(&v->state, PG_VIRTUAL_FREE);
+    return 0;
 }
 
-static PyTypeObject pgChannel_Type = {
-    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Channel",
-    .tp_basicsize = sizeof(pgChannelObject),
-    .tp_dealloc = channel_dealloc,
-    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE),
-    .tp_doc = DOC_MIXER_CHANNEL,
-    .tp_methods = channel_methods,
-    .tp_init = (initproc)channel_init,
-    .tp_new = PyType_GenericNew,
-    .tp_getset = _channel_getsets,
-};
+/* Let go of a resumed voice that could not be started, and of the
+   channel it was resumed on, which then sits idle */
+static void
+_pg_virtual_drop(pgVirtualVoice *v)
+{
+    struct ChannelData *cd = &channeldata[v->channel];
 
-/*mixer module methods*/
+    SDL_AtomicSetPtr(&cd->queue_slot, PG_QUEUE_CLOSED);
+    Mix_GroupChannel(v->channel, -1);
+    cd->position = 0;
+    _pg_msg_push(PG_MSG_DONE, v->channel, cd->gen, NULL);
+    SDL_AtomicSet(&v->state, PG_VIRTUAL_FREE);
+}
 
-static PyObject *
-get_num_channels(PyObject *self, PyObject *_null)
+/* Start a resumed voice, from the post mix effect */
+static void
+_pg_virtual_start_pending(void *item)
 {
-    MIXER_INIT_CHECK();
-    return PyLong_FromLong(Mix_GroupCount(-1));
+    pgVirtualVoice *v = (pgVirtualVoice *)item;
+    struct ChannelData *cd;
+    Mix_Chunk *chunk;
+    Uint32 elapsed;
+    int loops, playtime, frame_size;
+
+    if (!channeldata || v->channel >= numchanneldata) {
+        SDL_AtomicSet(&v->state, PG_VIRTUAL_FREE);
+        return;
+    }
+    if (Mix_Playing(v->channel)) {
+        _pg_virtual_drop(v);
+        return;
+    }
+    cd = &channeldata[v->channel];
+    playtime = -1;
+    if (v->playtime >= 0) {
+        elapsed = _pg_clock_ms(v->start, _pg_sample_clock());
+        playtime = MAX(v->playtime - (int)elapsed, 0);
+    }
+    chunk = v->chunk;
+    loops = v->passes;
+    if (v->frame) {
+        /* the rest of the pass, then the passes left */
+        frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels;
+        v->view.allocated = 0;
+        v->view.abuf = chunk->abuf + v->frame * frame_size;
+        v->view.alen = chunk->alen - v->frame * frame_size;
+        v->view.volume = chunk->volume;
+        chunk = &v->view;
+        loops = 0;
+    }
+    if (cd->position == 1) {
+        Mix_SetPanning(v->channel, cd->left, cd->right);
+    }
+    else if (cd->position == 2) {
+        Mix_SetPosition(v->channel, cd->angle, cd->distance);
+    }
+    _pg_bus_attach(v->channel);
+    if (playtime == 0 ||
+        Mix_PlayChannelTimed(v->channel, chunk, loops, playtime) == -1) {
+        Mix_UnregisterAllEffects(v->channel);
+        SDL_AtomicSet(&cd->bus_attached, 0);
+        _pg_virtual_drop(v);
+        return;
+    }
+    if (chunk == &v->view) {
+        cd->resumed = v;
+        SDL_AtomicSet(&v->state, PG_VIRTUAL_PLAYING);
+    }
+    else {
+        SDL_AtomicSet(&v->state, PG_VIRTUAL_FREE);
+    }
 }
 
-static PyObject *
-set_num_channels(PyObject *self, PyObject *args)
+static void
+_pg_free_dictproxy(pgEventDictProxy *proxy)
 {
-    int numchans, i;
-    if (!PyArg_ParseTuple(args, "i", &numchans))
-        return NULL;
+    int is_fully_freed;
 
-    MIXER_INIT_CHECK();
-    if (numchans > numchanneldata) {
-        struct ChannelData *cd_org = channeldata;
-        channeldata = (struct ChannelData *)realloc(
-            channeldata, sizeof(struct ChannelData) * numchans);
-        if (!channeldata) {
-            /* Restore the original to avoid leaking it */
-            channeldata = cd_org;
-            return PyErr_NoMemory();
-        }
-        for (i = numchanneldata; i < numchans; ++i) {
-            channeldata[i].sound = NULL;
-            channeldata[i].queue = NULL;
-            channeldata[i].endevent = 0;
-        }
-        numchanneldata = numchans;
+    if (!proxy) {
+        return;
+    }
+    /* as for event timers, the event functions free a proxy that is still
+       on the event queue */
+    SDL_AtomicLock(&proxy->lock);
+    is_fully_freed = proxy->num_on_queue <= 0;
+    if (!is_fully_freed) {
+        proxy->do_free_at_end = 1;
+    }
+    SDL_AtomicUnlock(&proxy->lock);
+    if (is_fully_freed) {
+        Py_DECREF(proxy->dict);
+        free(proxy);
     }
-
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_AllocateChannels(numchans);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
 }
 
-static PyObject *
-set_reserved(PyObject *self, PyObject *args)
+static void
+endsound_callback(int channel)
 {
-    int numchans_requested;
-    int numchans_reserved;
-    if (!PyArg_ParseTuple(args, "i", &numchans_requested))
-        return NULL;
+    struct ChannelData *cd;
+    pgSoundObject *queued;
+    Uint32 gen;
+    int started = -1;
 
-    MIXER_INIT_CHECK();
+    if (!channeldata || channel >= numchanneldata) {
+        return;
+    }
+    cd = &channeldata[channel];
+    /* SDL_mixer removes the effects of the channel once we return */
+    SDL_AtomicSet(&cd->bus_attached, 0);
+    if (cd->resumed && _pg_virtual_continue(channel)) {
+        return;
+    }
 
-    numchans_reserved = Mix_ReserveChannels(numchans_requested);
-    return PyLong_FromLong(numchans_reserved);
+    cd->position = 0;
+
+    if (cd->endevent && SDL_WasInit(SDL_INIT_VIDEO)) {
+        pg_post_event_dictproxy(
+            (Uint32)cd->endevent,
+            cd->endevent >= PGE_USEREVENT && cd->endevent < PG_NUMEVENTS
+                ? cd->endevent_proxy
+                : NULL);
+    }
+
+    gen = cd->gen;
+    queued = (pgSoundObject *)SDL_AtomicSetPtr(&cd->queue_slot,
+                                               PG_QUEUE_CLOSED);
+    if (!queued || queued == PG_QUEUE_CLOSED) {
+        if (!queued && _pg_virtual_resume(channel, gen)) {
+            return;
+        }
+        _pg_msg_push(PG_MSG_DONE, channel, gen, NULL);
+        Mix_GroupChannel(channel, -1);
+        return;
+    }
+
+    /* The queued Sound object is kept alive by the Python side until it
+       reads the message, and only its C fields are used here. */
+    cd->gen = gen + 1;
+    SDL_AtomicSetPtr(&cd->queue_slot, NULL);
+    _pg_msg_push(PG_MSG_NEXT, channel, gen, NULL);
+    if (queued->stream) {
+        started = _pg_stream_defer(queued->stream, channel);
+    }
+    else if (cd->voice) {
+        started = _pg_voice_defer(cd->voice, queued->chunk);
+    }
+    else if (Mix_PlayChannelTimed(channel, queued->chunk, 0, -1) != -1) {
+        Mix_GroupChannel(channel, (int)(intptr_t)queued->chunk);
+        started = 0;
+    }
+    if (started == -1) {
+        SDL_AtomicSetPtr(&cd->queue_slot, PG_QUEUE_CLOSED);
+        _pg_msg_push(PG_MSG_DONE, channel, gen + 1, NULL);
+    }
 }
 
 static PyObject *
-get_busy(PyObject *self, PyObject *_null)
+import_music(void)
 {
-    if (!SDL_WasInit(SDL_INIT_AUDIO))
-        return PyBool_FromLong(0);
-
-    return PyBool_FromLong(Mix_Playing(-1));
+    PyObject *music = PyImport_ImportModule(IMPPREFIX "mixer_music");
+    if (music == NULL) {
+        PyErr_Clear();
+        music = PyImport_ImportModule(RELATIVE_MODULE("mixer_music"));
+    }
+    return music;
 }
 
 static PyObject *
-mixer_find_channel(PyObject *self, PyObject *args, PyObject *kwargs)
+_init(int freq, int size, int channels, int chunk, char *devicename,
+      int allowedchanges, int offline)
 {
-    int chan, force = 0;
-    static char *keywords[] = {"force", NULL};
+    Uint16 fmt = 0;
+    int i, result;
+    char *saved_env[PG_OFFLINE_ENV];
+    PyObject *music;
+    char *drivername;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", keywords, &force)) {
-        return NULL;
+    if (!freq) {
+        freq = request_frequency;
+    }
+    if (!size) {
+        size = request_size;
     }
 
-    MIXER_INIT_CHECK();
+    if (allowedchanges == -1) {
+        allowedchanges = request_allowedchanges;
+    }
 
-    chan = Mix_GroupAvailable(-1);
-    if (chan == -1) {
-        if (!force)
-            Py_RETURN_NONE;
-        chan = Mix_GroupOldest(-1);
+    if (!channels) {
+        channels = request_channels;
+    }
+    if (allowedchanges & SDL_AUDIO_ALLOW_CHANNELS_CHANGE) {
+        if (channels <= 1)
+            channels = 1;
+        else if (channels <= 3)
+            channels = 2;
+        else if (channels <= 5)
+            channels = 4;
+        else
+            channels = 6;
+    }
+    else {
+        switch (channels) {
+            case 1:
+            case 2:
+            case 4:
+            case 6:
+                break;
+            default:
+                return RAISE(PyExc_ValueError,
+                             "'channels' must be 1, 2, 4, or 6");
+        }
+    }
+
+    if (!chunk) {
+        chunk = offline ? PG_OFFLINE_BUFFER : request_chunksize;
+    }
+
+    if (!devicename) {
+        devicename = request_devicename;
+    }
+
+    /* printf("size:%d:\n", size); */
+
+    switch (size) {
+        case 8:
+            fmt = AUDIO_U8;
+            break;
+        case -8:
+            fmt = AUDIO_S8;
+            break;
+        case 16:
+            fmt = AUDIO_U16SYS;
+            break;
+        case -16:
+            fmt = AUDIO_S16SYS;
+            break;
+        case 32:
+            fmt = AUDIO_F32SYS;
+            break;
+        case -32:
+            fmt = AUDIO_S32SYS;
+            break;
+        default:
+            PyErr_Format(PyExc_ValueError, "unsupported size %i", size);
+            return NULL;
+    }
+
+    /* printf("size:%d:\n", size); */
+
+    /*make chunk a power of 2*/
+    for (i = 0; 1 << i < chunk; ++i)
+        ;                     /*yes, semicolon on for loop*/
+    chunk = MAX(1 << i, 256); /*do this after for loop exits*/
+
+    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
+        if (!channeldata) { /*should always be null*/
+            channeldata = (struct ChannelData *)malloc(
+                sizeof(struct ChannelData) * MIX_CHANNELS);
+            if (!channeldata) {
+                return PyErr_NoMemory();
+            }
+            numchanneldata = MIX_CHANNELS;
+            for (i = 0; i < numchanneldata; ++i) {
+                channeldata[i].sound = NULL;
+                channeldata[i].queue = NULL;
+                channeldata[i].sound_gen = 0;
+                channeldata[i].endevent = 0;
+                channeldata[i].endevent_proxy = NULL;
+                channeldata[i].queue_slot = PG_QUEUE_CLOSED;
+                channeldata[i].gen = 0;
+                channeldata[i].voice = NULL;
+                channeldata[i].priority = 0;
+                channeldata[i].start = 0;
+                channeldata[i].loops = 0;
+                channeldata[i].playtime = -1;
+                channeldata[i].resumed = NULL;
+                channeldata[i].position = 0;
+                channeldata[i].bus = NULL;
+                channeldata[i].effects = NULL;
+                SDL_AtomicSet(&channeldata[i].bus_attached, 0);
+                channeldata[i].bus_tick = 0;
+                channeldata[i].bus_offset = 0;
+            }
+        }
+
+        /* Compatibility:
+            pulse and dsound audio drivers were renamed in SDL2,
+            and we don't want it to fail.
+        */
+        drivername = SDL_getenv("SDL_AUDIODRIVER");
+        if (drivername && SDL_strncasecmp("pulse", drivername,
+                                          SDL_strlen(drivername)) == 0) {
+            SDL_setenv("SDL_AUDIODRIVER", "pulseaudio", 1);
+        }
+        else if (drivername && SDL_strncasecmp("dsound", drivername,
+                                               SDL_strlen(drivername)) == 0) {
+            SDL_setenv("SDL_AUDIODRIVER", "directsound", 1);
+        }
+
+        if (offline) {
+            devicename = NULL;
+        }
+
+        if (SDL_InitSubSystem(SDL_INIT_AUDIO))
+            return RAISE(pgExc_SDLError, SDL_GetError());
+
+        if (offline && (SDL_AudioInit("disk") ||
+                        !(offline_done = SDL_CreateSemaphore(0)) ||
+                        !(offline_go = SDL_CreateSemaphore(0)))) {
+            _pg_offline_close();
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            return RAISE(pgExc_SDLError, SDL_GetError());
+        }
+
+        sample_clock = 0;
+        SDL_zero(mixer_stats);
+
+        if (offline) {
+            _pg_offline_env_set(saved_env);
+        }
+        result = Mix_OpenAudioDevice(freq, fmt, channels, chunk, devicename,
+                                     allowedchanges);
+        if (offline) {
+            _pg_offline_env_restore(saved_env);
+        }
+        if (result == -1) {
+            _pg_offline_close();
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            return RAISE(pgExc_SDLError, SDL_GetError());
+        }
+        if (offline && _pg_offline_open()) {
+            Mix_CloseAudio();
+            _pg_offline_close();
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+            return RAISE(pgExc_SDLError, "no offline audio device");
+        }
+        Mix_QuerySpec(&mixer_frequency, &mixer_format, &mixer_channels);
+        mixer_type = _format_audio_type(mixer_format);
+        mixer_buffer = chunk;
+        Mix_ChannelFinished(endsound_callback);
+        Mix_RegisterEffect(MIX_CHANNEL_POST, _pg_mixer_post_effect, NULL,
+                           NULL);
+        Mix_VolumeMusic(127);
+        if (offline_device) {
+            Py_BEGIN_ALLOW_THREADS;
+            _pg_offline_start();
+            Py_END_ALLOW_THREADS;
+        }
+    }
+
+    mx_current_music = NULL;
+    mx_queue_music = NULL;
+
+    music = import_music();
+    if (music) {
+        PyObject *ptr;
+        ptr = PyObject_GetAttrString(music, "_MUSIC_POINTER");
+        if (ptr) {
+            mx_current_music =
+                (Mix_Music **)PyCapsule_GetPointer(ptr,
+                                                   "pygame.music_mixer."
+                                                   "_MUSIC_POINTER");
+            if (!mx_current_music) {
+                PyErr_Clear();
+            }
+        }
+        else {
+            PyErr_Clear();
+        }
+
+        ptr = PyObject_GetAttrString(music, "_QUEUE_POINTER");
+        if (ptr) {
+            mx_queue_music =
+                (Mix_Music **)PyCapsule_GetPointer(ptr,
+                                                   "pygame.music_mixer."
+                                                   "_QUEUE_POINTER");
+            if (!mx_queue_music) {
+                PyErr_Clear();
+            }
+        }
+        else {
+            PyErr_Clear();
+        }
+
+        Py_DECREF(music);
+    }
+    else {
+        PyErr_Clear();
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+pgMixer_AutoInit(PyObject *self, PyObject *_null)
+{
+    /* Return init with defaults */
+    return _init(0, 0, 0, 0, NULL, -1, 0);
+}
+
+static PyObject *
+mixer_quit(PyObject *self, PyObject *_null)
+{
+    int i, numchans;
+    struct ChannelData *cd;
+    if (SDL_WasInit(SDL_INIT_AUDIO)) {
+        Py_BEGIN_ALLOW_THREADS;
+        _pg_offline_release();
+        Mix_HaltMusic();
+        /* Loader threads use the mixer, and need the GIL to finish. They
+           stop after the file they are loading. */
+        SDL_AtomicSet(&loaders_cancelled, 1);
+        if (loaders_lock && loaders_done) {
+            SDL_LockMutex(loaders_lock);
+            while (SDL_AtomicGet(&loaders_active) > 0) {
+                SDL_CondWait(loaders_done, loaders_lock);
+            }
+            SDL_UnlockMutex(loaders_lock);
+        }
+        SDL_AtomicSet(&loaders_cancelled, 0);
+        _pg_playlist_quit();
+        Py_END_ALLOW_THREADS;
+        Py_CLEAR(playlist_paths);
+
+        _pg_pending_clear(&stream_pending);
+        _pg_pending_clear(&voice_pending);
+        _pg_pending_clear(&virtual_pending);
+        /* Freed once the audio thread is gone, as endsound_callback may
+           still use the queued Sounds until then */
+        cd = channeldata;
+        numchans = numchanneldata;
+        channeldata = NULL;
+        numchanneldata = 0;
+        numreserved = 0;
+
+        if (mx_current_music) {
+            if (*mx_current_music) {
+                Py_BEGIN_ALLOW_THREADS;
+                Mix_FreeMusic(*mx_current_music);
+                Py_END_ALLOW_THREADS;
+                *mx_current_music = NULL;
+            }
+            mx_current_music = NULL;
+        }
+        if (mx_queue_music) {
+            if (*mx_queue_music) {
+                Py_BEGIN_ALLOW_THREADS;
+                Mix_FreeMusic(*mx_queue_music);
+                Py_END_ALLOW_THREADS;
+                *mx_queue_music = NULL;
+            }
+            mx_queue_music = NULL;
+        }
+
+        Py_BEGIN_ALLOW_THREADS;
+        Mix_CloseAudio();
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        Py_END_ALLOW_THREADS;
+        _pg_offline_close();
+        /* with the audio thread gone, nothing reads the rings anymore */
+        _pg_stream_quit();
+
+        if (cd) {
+            for (i = 0; i < numchans; ++i) {
+                Py_XDECREF(cd[i].sound);
+                Py_XDECREF(cd[i].queue);
+                Py_XDECREF(cd[i].bus);
+                _pg_effects_release(&cd[i].effects);
+                _pg_free_dictproxy(cd[i].endevent_proxy);
+            }
+            free(cd);
+        }
+        _pg_effects_release(&music_effects);
+        _pg_effects_release(&output_effects);
+        PyMem_Free(batch_items);
+        batch_items = NULL;
+        batch_count = batch_size = 0;
+        SDL_AtomicSet(&msg_head, 0);
+        SDL_AtomicSet(&msg_tail, 0);
+        SDL_AtomicSet(&msg_lost, 0);
+        _pg_voice_free_all();
+        _pg_virtual_cancel(NULL, 0);
+        for (i = 0; i < PG_VIRTUAL_MAX; ++i) {
+            SDL_AtomicSet(&virtual_voices[i].state, PG_VIRTUAL_FREE);
+        }
+        SDL_AtomicSet(&num_virtual, 0);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+pg_mixer_init(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    int freq = 0, size = 0, channels = 0, chunk = 0, allowedchanges = -1;
+    int offline = 0;
+    char *devicename = NULL;
+
+    static char *kwids[] = {"frequency",      "size",    "channels",
+                            "buffer",         "devicename",
+                            "allowedchanges", "offline", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|iiiizip", kwids, &freq,
+                                     &size, &channels, &chunk, &devicename,
+                                     &allowedchanges, &offline)) {
+        return NULL;
+    }
+    return _init(freq, size, channels, chunk, devicename, allowedchanges,
+                 offline);
+}
+
+static PyObject *
+pg_mixer_get_init(PyObject *self, PyObject *_null)
+{
+    int freq, channels, realform;
+    Uint16 format;
+
+    if (!SDL_WasInit(SDL_INIT_AUDIO))
+        Py_RETURN_NONE;
+
+    if (!Mix_QuerySpec(&freq, &format, &channels))
+        Py_RETURN_NONE;
+
+    // create a signed or unsigned number of bits per sample
+    realform = SDL_AUDIO_BITSIZE(format);
+    if (SDL_AUDIO_ISSIGNED(format)) {
+        realform = -realform;
+    }
+    return Py_BuildValue("(iii)", freq, realform, channels);
+}
+
+static PyObject *
+pg_mixer_get_driver(PyObject *self, PyObject *_null)
+{
+    const char *name = NULL;
+    MIXER_INIT_CHECK();
+    name = SDL_GetCurrentAudioDriver();
+    if (!name) {
+        name = "unknown";
+    }
+    return PyUnicode_FromString(name);
+}
+
+static PyObject *
+pre_init(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    static char *kwids[] = {"frequency", "size",       "channels",
+                            "buffer",    "devicename", "allowedchanges",
+                            NULL};
+
+    request_frequency = 0;
+    request_size = 0;
+    request_channels = 0;
+    request_chunksize = 0;
+    request_devicename = NULL;
+    request_allowedchanges = -1;
+    if (!PyArg_ParseTupleAndKeywords(
+            args, keywds, "|iiiizi", kwids, &request_frequency, &request_size,
+            &request_channels, &request_chunksize, &request_devicename,
+            &request_allowedchanges))
+        return NULL;
+    if (!request_frequency) {
+        request_frequency = PYGAME_MIXER_DEFAULT_FREQUENCY;
+    }
+    if (!request_size) {
+        request_size = PYGAME_MIXER_DEFAULT_SIZE;
+    }
+    if (!request_channels) {
+        request_channels = PYGAME_MIXER_DEFAULT_CHANNELS;
+    }
+    if (!request_chunksize) {
+        request_chunksize = PYGAME_MIXER_DEFAULT_CHUNKSIZE;
+    }
+    if (request_allowedchanges == -1) {
+        request_allowedchanges = PYGAME_MIXER_DEFAULT_ALLOWEDCHANGES;
+    }
+    Py_RETURN_NONE;
+}
+
+/* sound object methods */
+
+static PyObject *
+pgSound_Play(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    pgSoundStream *stream = ((pgSoundObject *)self)->stream;
+    int channelnum = -1, free_channel;
+    int loops = 0, playtime = -1, fade_ms = 0;
+    struct ChannelData *cd;
+    float audibility;
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    char *kwids[] = {"loops", "maxtime", "fade_ms", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iii", kwids, &loops,
+                                     &playtime, &fade_ms))
+        return NULL;
+    if (stream) {
+        MIXER_INIT_CHECK();
+        if (_pg_stream_ready((pgSoundObject *)self)) {
+            return NULL;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    free_channel = _pg_channel_find_free();
+    Py_END_ALLOW_THREADS;
+    if (free_channel == -1) {
+        /* take over a channel playing something less important, which
+           then goes on as a virtual voice, or go on virtually */
+        audibility = Mix_VolumeChunk(chunk, -1) / 128.0f;
+        free_channel = _pg_channel_find_victim(
+            ((pgSoundObject *)self)->priority, audibility,
+            SDL_AtomicGet(&num_virtual) > 0);
+        if (free_channel == -1) {
+            _pg_virtual_add(self, audibility, _pg_sample_clock(), loops,
+                            playtime, NULL);
+            Py_RETURN_NONE;
+        }
+        cd = &channeldata[free_channel];
+        if (cd->sound && !cd->region) {
+            _pg_virtual_add(cd->sound, _pg_channel_audibility(free_channel),
+                            cd->start, cd->loops, cd->playtime, cd);
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_channel_open(free_channel);
+    _pg_bus_attach(free_channel);
+    if (stream) {
+        channelnum = _pg_stream_start(stream, free_channel, loops, playtime,
+                                      fade_ms, 0);
+    }
+    else if (fade_ms > 0) {
+        channelnum = Mix_FadeInChannelTimed(free_channel, chunk, loops,
+                                            fade_ms, playtime);
+    }
+    else {
+        channelnum =
+            Mix_PlayChannelTimed(free_channel, chunk, loops, playtime);
+    }
+    if (channelnum == -1) {
+        _pg_channel_close(free_channel);
+    }
+    Py_END_ALLOW_THREADS;
+    if (channelnum == -1)
+        Py_RETURN_NONE;
+
+    _pg_channel_set_sound(channelnum, self, loops, playtime);
+
+    // make sure volume on this arbitrary channel is set to full
+    Mix_Volume(channelnum, 128);
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_GroupChannel(channelnum, (int)(intptr_t)chunk);
+    Py_END_ALLOW_THREADS;
+
+    return pgChannel_New(channelnum);
+}
+
+static PyObject *
+snd_get_num_channels(PyObject *self, PyObject *_null)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    MIXER_INIT_CHECK();
+    return PyLong_FromLong(Mix_GroupCount((int)(intptr_t)chunk));
+}
+
+static PyObject *
+snd_fadeout(PyObject *self, PyObject *args)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    int _time;
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    if (!PyArg_ParseTuple(args, "i", &_time))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_FadeOutGroup((int)(intptr_t)chunk, _time);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+snd_stop(PyObject *self, PyObject *_null)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    MIXER_INIT_CHECK();
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_halt_group((int)(intptr_t)chunk);
+    _pg_virtual_cancel_pending(-1, chunk);
+    Py_END_ALLOW_THREADS;
+    _pg_virtual_cancel(self, 0);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+snd_set_volume(PyObject *self, PyObject *args)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    float volume;
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    if (!PyArg_ParseTuple(args, "f", &volume))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+
+    Mix_VolumeChunk(chunk, (int)(volume * 128));
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+snd_get_volume(PyObject *self, PyObject *_null)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    int volume;
+    MIXER_INIT_CHECK();
+
+    volume = Mix_VolumeChunk(chunk, -1);
+    return PyFloat_FromDouble(volume / 128.0);
+}
+
+static PyObject *
+snd_set_priority(PyObject *self, PyObject *args)
+{
+    int priority;
+
+    if (!PyArg_ParseTuple(args, "i", &priority))
+        return NULL;
+
+    ((pgSoundObject *)self)->priority = priority;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+snd_get_priority(PyObject *self, PyObject *_null)
+{
+    return PyLong_FromLong(((pgSoundObject *)self)->priority);
+}
+
+static PyObject *
+snd_get_length(PyObject *self, PyObject *_null)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    pgSoundStream *stream = ((pgSoundObject *)self)->stream;
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    int freq, channels, mixerbytes, numsamples;
+    Uint16 format;
+    MIXER_INIT_CHECK();
+
+    if (stream) {
+        return PyFloat_FromDouble((double)stream->src_frames /
+                                  (double)stream->src_freq);
+    }
+
+    Mix_QuerySpec(&freq, &format, &channels);
+    if (format == AUDIO_S8 || format == AUDIO_U8)
+        mixerbytes = 1;
+    else if (format == AUDIO_F32LSB || format == AUDIO_F32MSB) {
+        mixerbytes = 4;
+    }
+    else
+        mixerbytes = 2;
+    numsamples = chunk->alen / mixerbytes / channels;
+
+    return PyFloat_FromDouble((float)numsamples / (float)freq);
+}
+
+static PyObject *
+snd_get_raw(PyObject *self, PyObject *_null)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+    MIXER_INIT_CHECK();
+
+    if (((pgSoundObject *)self)->stream) {
+        return RAISE(PyExc_TypeError,
+                     "get_raw() is not supported by streaming Sounds");
+    }
+
+    return PyBytes_FromStringAndSize((const char *)chunk->abuf,
+                                     (Py_ssize_t)chunk->alen);
+}
+
+static PyObject *
+snd_resample(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    Mix_Chunk *newchunk;
+    PyObject *sound;
+    Py_ssize_t len;
+    Uint8 *mem;
+    int rate, freq, channels;
+    int quality = PG_RESAMPLE_MEDIUM;
+    Uint16 format;
+    static char *kwids[] = {"rate", "quality", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i|i", kwids, &rate,
+                                     &quality)) {
+        return NULL;
+    }
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+    MIXER_INIT_CHECK();
+
+    if (((pgSoundObject *)self)->stream) {
+        return RAISE(PyExc_TypeError,
+                     "resample() is not supported by streaming Sounds");
+    }
+
+    Mix_QuerySpec(&freq, &format, &channels);
+    mem = _resample_samples(chunk->abuf, (Py_ssize_t)chunk->alen, rate, freq,
+                            quality, &len);
+    if (!mem) {
+        return NULL;
+    }
+    newchunk = Mix_QuickLoad_RAW(mem, (Uint32)len);
+    if (!newchunk) {
+        PyMem_Free(mem);
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    newchunk->volume = chunk->volume;
+    sound = pgSound_New(newchunk);
+    if (!sound) {
+        Mix_FreeChunk(newchunk);
+        PyMem_Free(mem);
+        return NULL;
+    }
+    ((pgSoundObject *)sound)->mem = mem;
+    ((pgSoundObject *)sound)->priority = ((pgSoundObject *)self)->priority;
+    return sound;
+}
+
+/* The frame seconds into a sound of frames frames, at most frames.
+   Returns -1 with a ValueError naming name for a negative time. */
+static Sint64
+_pg_sound_frame(PyObject *obj, Uint32 frames, const char *name)
+{
+    double seconds = PyFloat_AsDouble(obj);
+    double at = seconds * mixer_frequency + 0.5;
+
+    if (seconds == -1.0 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (!(seconds >= 0.0)) {
+        PyErr_Format(PyExc_ValueError, "%s can't be negative", name);
+        return -1;
+    }
+    return at >= frames ? (Sint64)frames : (Sint64)at;
+}
+
+static PyObject *
+snd_subsound(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+    PyObject *sound, *start_obj, *end_obj = Py_None;
+    pg_buffer *pg_view;
+    Sint64 first, last;
+    Uint32 frames;
+    int frame_size;
+    static char *kwids[] = {"start", "end", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", kwids, &start_obj,
+                                     &end_obj)) {
+        return NULL;
+    }
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+    MIXER_INIT_CHECK();
+
+    if (((pgSoundObject *)self)->stream) {
+        return RAISE(PyExc_TypeError,
+                     "subsound() is not supported by streaming Sounds");
+    }
+
+    frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels;
+    frames = chunk->alen / frame_size;
+    first = _pg_sound_frame(start_obj, frames, "start");
+    if (first < 0) {
+        return NULL;
+    }
+    last = frames;
+    if (end_obj != Py_None) {
+        last = _pg_sound_frame(end_obj, frames, "end");
+        if (last < 0) {
+            return NULL;
+        }
+    }
+    if (last <= first) {
+        return RAISE(PyExc_ValueError, "the subsound is empty");
+    }
+
+    sound = pgSound_Type.tp_new(&pgSound_Type, NULL, NULL);
+    if (!sound) {
+        return NULL;
+    }
+    pg_view = PyMem_New(pg_buffer, 1);
+    if (!pg_view) {
+        Py_DECREF(sound);
+        return PyErr_NoMemory();
+    }
+    /* The view of the parent keeps it, and so the samples, alive. Being
+       read-only, or not, follows the parent. */
+    pg_view->view.obj = 0;
+    pg_view->consumer = sound;
+    pg_view->release_buffer = PyBuffer_Release;
+    if (PyObject_GetBuffer(self, (Py_buffer *)pg_view, PyBUF_SIMPLE)) {
+        PyMem_Free(pg_view);
+        Py_DECREF(sound);
+        return NULL;
+    }
+    if (_chunk_from_view((pgSoundObject *)sound, pg_view,
+                         chunk->abuf + (size_t)first * frame_size,
+                         (Py_ssize_t)(last - first) * frame_size)) {
+        Py_DECREF(sound);
+        return NULL;
+    }
+    ((pgSoundObject *)sound)->chunk->volume = chunk->volume;
+    ((pgSoundObject *)sound)->priority = ((pgSoundObject *)self)->priority;
+    return sound;
+}
+
+static PyObject *
+snd_get_arraystruct(PyObject *self, void *closure)
+{
+    Py_buffer view;
+    PyObject *cobj;
+
+    if (snd_getbuffer(self, &view, PyBUF_RECORDS)) {
+        return 0;
+    }
+    cobj = pgBuffer_AsArrayStruct(&view);
+    snd_releasebuffer(view.obj, &view);
+    Py_XDECREF(view.obj);
+    return cobj;
+}
+
+static PyObject *
+snd_get_arrayinterface(PyObject *self, void *closure)
+{
+    Py_buffer view;
+    PyObject *dict;
+
+    if (snd_getbuffer(self, &view, PyBUF_RECORDS)) {
+        return 0;
+    }
+    dict = pgBuffer_AsArrayInterface(&view);
+    snd_releasebuffer(self, &view);
+    Py_DECREF(self);
+    return dict;
+}
+
+static PyObject *
+snd_get_samples_address(PyObject *self, PyObject *closure)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(self);
+
+    CHECK_CHUNK_VALID(chunk, NULL);
+
+    MIXER_INIT_CHECK();
+
+#if SIZEOF_VOID_P > SIZEOF_LONG
+    return PyLong_FromUnsignedLongLong((unsigned PY_LONG_LONG)chunk->abuf);
+#else
+    return PyLong_FromUnsignedLong((unsigned long)chunk->abuf);
+#endif
+}
+
+PyMethodDef sound_methods[] = {
+    {"play", (PyCFunction)pgSound_Play, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_SOUND_PLAY},
+    {"get_num_channels", snd_get_num_channels, METH_NOARGS,
+     DOC_MIXER_SOUND_GETNUMCHANNELS},
+    {"fadeout", snd_fadeout, METH_VARARGS, DOC_MIXER_SOUND_FADEOUT},
+    {"stop", snd_stop, METH_NOARGS, DOC_MIXER_SOUND_STOP},
+    {"set_volume", snd_set_volume, METH_VARARGS, DOC_MIXER_SOUND_SETVOLUME},
+    {"get_volume", snd_get_volume, METH_NOARGS, DOC_MIXER_SOUND_GETVOLUME},
+    {"set_priority", snd_set_priority, METH_VARARGS,
+     DOC_MIXER_SOUND_SETPRIORITY},
+    {"get_priority", snd_get_priority, METH_NOARGS,
+     DOC_MIXER_SOUND_GETPRIORITY},
+    {"get_length", snd_get_length, METH_NOARGS, DOC_MIXER_SOUND_GETLENGTH},
+    {"get_raw", snd_get_raw, METH_NOARGS, DOC_MIXER_SOUND_GETRAW},
+    {"resample", (PyCFunction)snd_resample, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_SOUND_RESAMPLE},
+    {"subsound", (PyCFunction)snd_subsound, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_SOUND_SUBSOUND},
+    {NULL, NULL, 0, NULL}};
+
+static PyGetSetDef sound_getset[] = {
+    {"__array_struct__", snd_get_arraystruct, NULL, "Version 3", NULL},
+    {"__array_interface__", snd_get_arrayinterface, NULL, "Version 3", NULL},
+    {"_samples_address", (getter)snd_get_samples_address, NULL,
+     "samples buffer address (readonly)", NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+/*buffer protocol*/
+
+/*
+snd_buffer_iteminfo converts between SDL and python format constants.
+
+https://wiki.libsdl.org/SDL_AudioSpec
+https://docs.python.org/3/library/struct.html#format-characters
+
+Every format SDL can open the device in has a format string, giving the
+byte order of samples that are not in the system order.
+
+returns:
+    -1 on error, else 0.
+    format: buffer string showing the format.
+    itemsize: bytes for each item.
+*/
+static int
+snd_buffer_iteminfo(char **format, Py_ssize_t *itemsize, int *channels)
+{
+    static char fmt_AUDIO_U8[] = "B";
+    static char fmt_AUDIO_S8[] = "b";
+    static char fmt_AUDIO_U16SYS[] = "=H";
+    static char fmt_AUDIO_S16SYS[] = "=h";
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    static char fmt_AUDIO_U16MSB[] = ">H";
+    static char fmt_AUDIO_S16MSB[] = ">h";
+#else
+    static char fmt_AUDIO_U16LSB[] = "<H";
+    static char fmt_AUDIO_S16LSB[] = "<h";
+#endif
+
+    static char fmt_AUDIO_S32LSB[] = "<i";
+    static char fmt_AUDIO_S32MSB[] = ">i";
+    static char fmt_AUDIO_F32LSB[] = "<f";
+    static char fmt_AUDIO_F32MSB[] = ">f";
+
+    int freq = 0;
+    Uint16 mixer_format = 0;
+
+    Mix_QuerySpec(&freq, &mixer_format, channels);
+
+    switch (mixer_format) {
+        case AUDIO_U8:
+            *format = fmt_AUDIO_U8;
+            *itemsize = 1;
+            return 0;
+
+        case AUDIO_S8:
+            *format = fmt_AUDIO_S8;
+            *itemsize = 1;
+            return 0;
+
+        case AUDIO_U16SYS:
+            *format = fmt_AUDIO_U16SYS;
+            *itemsize = 2;
+            return 0;
+
+        case AUDIO_S16SYS:
+            *format = fmt_AUDIO_S16SYS;
+            *itemsize = 2;
+            return 0;
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        case AUDIO_U16MSB:
+            *format = fmt_AUDIO_U16MSB;
+            *itemsize = 2;
+            return 0;
+
+        case AUDIO_S16MSB:
+            *format = fmt_AUDIO_S16MSB;
+            *itemsize = 2;
+            return 0;
+#else
+        case AUDIO_U16LSB:
+            *format = fmt_AUDIO_U16LSB;
+            *itemsize = 2;
+            return 0;
+
+        case AUDIO_S16LSB:
+            *format = fmt_AUDIO_S16LSB;
+            *itemsize = 2;
+            return 0;
+#endif
+
+        case AUDIO_S32LSB:
+            *format = fmt_AUDIO_S32LSB;
+            *itemsize = 4;
+            return 0;
+
+        case AUDIO_S32MSB:
+            *format = fmt_AUDIO_S32MSB;
+            *itemsize = 4;
+            return 0;
+
+        case AUDIO_F32LSB:
+            *format = fmt_AUDIO_F32LSB;
+            *itemsize = 4;
+            return 0;
+
+        case AUDIO_F32MSB:
+            *format = fmt_AUDIO_F32MSB;
+            *itemsize = 4;
+            return 0;
+    }
+
+    PyErr_Format(PyExc_SystemError,
+                 "Pygame bug (mixer.Sound): unknown mixer format %d",
+                 (int)mixer_format);
+    return -1;
+}
+
+static int
+snd_getbuffer(PyObject *obj, Py_buffer *view, int flags)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk(obj);
+    int channels;
+    char *format;
+    int ndim = 0;
+    Py_ssize_t *shape = 0;
+    Py_ssize_t *strides = 0;
+    Py_ssize_t itemsize;
+    Py_ssize_t samples;
+
+    CHECK_CHUNK_VALID(chunk, -1);
+
+    view->obj = 0;
+    if (((pgSoundObject *)obj)->stream) {
+        PyErr_SetString(pgExc_BufferError,
+                        "streaming Sounds do not export a sample buffer");
+        return -1;
+    }
+    if (((pgSoundObject *)obj)->readonly &&
+        PyBUF_HAS_FLAG(flags, PyBUF_WRITABLE)) {
+        PyErr_SetString(pgExc_BufferError,
+                        "Sound shares a read-only buffer");
+        return -1;
+    }
+    if (snd_buffer_iteminfo(&format, &itemsize, &channels)) {
+        return -1;
+    }
+    if (channels != 1 && PyBUF_HAS_FLAG(flags, PyBUF_F_CONTIGUOUS)) {
+        PyErr_SetString(pgExc_BufferError,
+                        "polyphonic sound is not Fortran contiguous");
+        return -1;
+    }
+    if (PyBUF_HAS_FLAG(flags, PyBUF_ND)) {
+        ndim = channels > 1 ? 2 : 1;
+        samples = chunk->alen / (itemsize * channels);
+        shape = PyMem_New(Py_ssize_t, 2 * ndim);
+        if (!shape) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        shape[ndim - 1] = channels;
+        shape[0] = samples;
+        if (PyBUF_HAS_FLAG(flags, PyBUF_STRIDES)) {
+            strides = shape + ndim;
+            strides[0] = itemsize * channels;
+            strides[ndim - 1] = itemsize;
+        }
+    }
+    Py_INCREF(obj);
+    view->obj = obj;
+    view->buf = chunk->abuf;
+    view->len = (Py_ssize_t)chunk->alen;
+    view->readonly = ((pgSoundObject *)obj)->readonly;
+    view->itemsize = itemsize;
+    view->format = PyBUF_HAS_FLAG(flags, PyBUF_FORMAT) ? format : 0;
+    view->ndim = ndim;
+    view->shape = shape;
+    view->strides = strides;
+    view->suboffsets = 0;
+    view->internal = shape;
+    return 0;
+}
+
+static void
+snd_releasebuffer(PyObject *obj, Py_buffer *view)
+{
+    if (view->internal) {
+        PyMem_Free(view->internal);
+        view->internal = 0;
+    }
+}
+
+static PyBufferProcs sound_as_buffer[] = {{snd_getbuffer, snd_releasebuffer}};
+
+/*sound object internals*/
+static void
+sound_dealloc(pgSoundObject *self)
+{
+    Mix_Chunk *chunk = pgSound_AsChunk((PyObject *)self);
+    if (self->stream) {
+        _pg_stream_cancel(self->stream);
+    }
+    if (chunk) {
+        Py_BEGIN_ALLOW_THREADS;
+        Mix_FreeChunk(chunk);
+        Py_END_ALLOW_THREADS;
+    }
+    if (self->stream) {
+        _pg_stream_free(self->stream);
+    }
+    if (self->view) {
+        pgBuffer_Release(self->view);
+        PyMem_Free(self->view);
+    }
+    if (self->mem)
+        PyMem_Free(self->mem);
+    if (self->weakreflist)
+        PyObject_ClearWeakRefs((PyObject *)self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyTypeObject pgSound_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Sound",
+    .tp_basicsize = sizeof(pgSoundObject),
+    .tp_dealloc = (destructor)sound_dealloc,
+    .tp_as_buffer = sound_as_buffer,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE),
+    .tp_doc = DOC_MIXER_SOUND,
+    .tp_weaklistoffset = offsetof(pgSoundObject, weakreflist),
+    .tp_methods = sound_methods,
+    .tp_getset = sound_getset,
+    .tp_init = sound_init,
+    .tp_new = PyType_GenericNew,
+};
+
+/* channel object methods */
+
+/* The voice of a channel, made when first needed */
+static pgVoice *
+_pg_channel_voice(int channelnum)
+{
+    pgVoice *voice = channeldata[channelnum].voice;
+    int type;
+
+    if (!voice) {
+        type = _format_audio_type(mixer_format);
+        if (type < 0) {
+            return NULL;
+        }
+        voice = _pg_voice_new(channelnum, type, mixer_channels);
+        if (!voice) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        channeldata[channelnum].voice = voice;
+    }
+    return voice;
+}
+
+static Uint64
+_pg_sample_clock(void)
+{
+    Uint64 clock;
+
+    SDL_AtomicLock(&clock_lock);
+    clock = sample_clock;
+    SDL_AtomicUnlock(&clock_lock);
+    return clock;
+}
+
+/* Read a frame of the sample clock from a Python int */
+static int
+_pg_sample_arg(PyObject *obj, Uint64 *sample)
+{
+    long long value = PyLong_AsLongLong(obj);
+
+    if (value == -1 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (value < 0) {
+        PyErr_SetString(PyExc_ValueError, "at_sample can't be negative");
+        return -1;
+    }
+    *sample = (Uint64)value;
+    return 0;
+}
+
+static PyObject *
+chan_play(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int channel = pgChannel_AsInt(self);
+    int channelnum;
+    PyObject *sound;
+    Mix_Chunk *chunk;
+    pgSoundStream *stream;
+    pgVoice *voice;
+    int loops = 0, playtime = -1, fade_ms = 0;
+    PyObject *at_obj = Py_None;
+    PyObject *loop_start_obj = Py_None, *loop_end_obj = Py_None;
+    Uint64 at = 0, now;
+    Sint64 loop_start = 0, loop_end = 0;
+    Uint32 frames;
+
+    char *kwids[] = {"Sound",     "loops",      "maxtime",  "fade_ms",
+                     "at_sample", "loop_start", "loop_end", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|iiiOOO", kwids,
+                                     &pgSound_Type, &sound, &loops, &playtime,
+                                     &fade_ms, &at_obj, &loop_start_obj,
+                                     &loop_end_obj))
+        return NULL;
+    chunk = pgSound_AsChunk(sound);
+    CHECK_CHUNK_VALID(chunk, NULL);
+    stream = ((pgSoundObject *)sound)->stream;
+    if (stream && _pg_stream_ready((pgSoundObject *)sound)) {
+        return NULL;
+    }
+    voice = stream ? NULL : channeldata[channel].voice;
+    if (loop_start_obj != Py_None || loop_end_obj != Py_None) {
+        MIXER_INIT_CHECK();
+        if (stream) {
+            return RAISE(PyExc_TypeError,
+                         "loop regions are not supported by streaming "
+                         "Sounds");
+        }
+        /* loop regions play on a voice */
+        voice = _pg_channel_voice(channel);
+        if (!voice) {
+            return NULL;
+        }
+        frames = chunk->alen / voice->frame_size;
+        loop_end = frames;
+        if (loop_start_obj != Py_None) {
+            loop_start = _pg_sound_frame(loop_start_obj, frames, "loop_start");
+            if (loop_start < 0) {
+                return NULL;
+            }
+        }
+        if (loop_end_obj != Py_None) {
+            loop_end = _pg_sound_frame(loop_end_obj, frames, "loop_end");
+            if (loop_end < 0) {
+                return NULL;
+            }
+        }
+        if (loop_end <= loop_start) {
+            return RAISE(PyExc_ValueError, "the loop region is empty");
+        }
+    }
+    if (at_obj != Py_None) {
+        MIXER_INIT_CHECK();
+        if (_pg_sample_arg(at_obj, &at)) {
+            return NULL;
+        }
+        /* scheduled sounds play on a voice, unless streamed */
+        if (!stream) {
+            voice = _pg_channel_voice(channel);
+            if (!voice) {
+                return NULL;
+            }
+        }
+        /* maxtime counts from the start */
+        now = _pg_sample_clock();
+        if (playtime >= 0 && at > now) {
+            playtime += (int)((at - now) * 1000 / mixer_frequency);
+        }
+    }
+
+    _pg_channel_sync();
+    Py_BEGIN_ALLOW_THREADS;
+    /* Drops the queue first, so halting the channel can't start it */
+    _pg_channel_open(channel);
+    _pg_bus_attach(channel);
+    if (stream) {
+        channelnum =
+            _pg_stream_start(stream, channel, loops, playtime, fade_ms, at);
+    }
+    else if (voice) {
+        channelnum =
+            _pg_voice_start(voice, chunk, loops, playtime, fade_ms, at,
+                            (Uint32)loop_start, (Uint32)loop_end);
+    }
+    else if (fade_ms > 0) {
+        channelnum =
+            Mix_FadeInChannelTimed(channel, chunk, loops, fade_ms, playtime);
+    }
+    else {
+        channelnum = Mix_PlayChannelTimed(channel, chunk, loops, playtime);
+    }
+    if (channelnum != -1)
+        Mix_GroupChannel(channelnum, (int)(intptr_t)chunk);
+    else
+        _pg_channel_close(channel);
+    Py_END_ALLOW_THREADS;
+    if (channelnum == -1) {
+        return RAISE(pgExc_SDLError, Mix_GetError());
+    }
+
+    _pg_channel_set_sound(channelnum, sound, loops, playtime);
+    channeldata[channelnum].region = loop_end != 0;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_get_id(PyObject *self, PyObject *empty_args)
+{
+    int channelnum = pgChannel_AsInt(self);
+
+    MIXER_INIT_CHECK();
+
+    return PyLong_FromLong(channelnum);
+}
+
+static PyObject *
+chan_queue(PyObject *self, PyObject *sound)
+{
+    int channel = pgChannel_AsInt(self);
+    int channelnum;
+    struct ChannelData *cd;
+    Mix_Chunk *chunk;
+    pgSoundStream *stream;
+    PyObject *old;
+    void *slot;
+
+    MIXER_INIT_CHECK();
+    if (!pgSound_Check(sound)) {
+        return RAISE(PyExc_TypeError,
+                     "The argument must be an instance of Sound");
+    }
+
+    chunk = pgSound_AsChunk(sound);
+    CHECK_CHUNK_VALID(chunk, NULL);
+    stream = ((pgSoundObject *)sound)->stream;
+    if (stream && _pg_stream_ready((pgSoundObject *)sound)) {
+        return NULL;
+    }
+    if (stream) {
+        /* A stream only feeds one channel at a time. Stop it and decode
+           its first blocks now, so it is ready when it gets its turn. */
+        Py_BEGIN_ALLOW_THREADS;
+        _pg_stream_cancel(stream);
+        _pg_halt_group((int)(intptr_t)chunk);
+        _pg_stream_rewind(stream, 0);
+        Py_END_ALLOW_THREADS;
+    }
+    for (;;) {
+        _pg_channel_sync();
+        cd = &channeldata[channel];
+        slot = SDL_AtomicGetPtr(&cd->queue_slot);
+        if (slot == PG_QUEUE_CLOSED) {
+            break; /* nothing playing */
+        }
+        /* fails if the channel moved on meanwhile, then look again */
+        if (SDL_AtomicCASPtr(&cd->queue_slot, slot, sound)) {
+            old = cd->queue;
+            Py_INCREF(sound);
+            cd->queue = sound;
+            Py_XDECREF(old);
+            Py_RETURN_NONE;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_channel_open(channel);
+    _pg_bus_attach(channel);
+    if (stream) {
+        channelnum = _pg_stream_start(stream, channel, 0, -1, 0, 0);
+    }
+    else if (cd->voice) {
+        channelnum = _pg_voice_start(cd->voice, chunk, 0, -1, 0, 0, 0, 0);
+        if (channelnum != -1)
+            Mix_GroupChannel(channelnum, (int)(intptr_t)chunk);
+    }
+    else {
+        channelnum = Mix_PlayChannelTimed(channel, chunk, 0, -1);
+        if (channelnum != -1)
+            Mix_GroupChannel(channelnum, (int)(intptr_t)chunk);
+    }
+    if (channelnum == -1)
+        _pg_channel_close(channel);
+    Py_END_ALLOW_THREADS;
+    if (channelnum == -1) {
+        return RAISE(pgExc_SDLError, Mix_GetError());
+    }
+
+    _pg_channel_set_sound(channelnum, sound, 0, -1);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_get_busy(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    MIXER_INIT_CHECK();
+
+    return PyBool_FromLong(Mix_Playing(channelnum));
+}
+
+static PyObject *
+chan_fadeout(PyObject *self, PyObject *args)
+{
+    int channelnum = pgChannel_AsInt(self);
+    int _time;
+    if (!PyArg_ParseTuple(args, "i", &_time))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_FadeOutChannel(channelnum, _time);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_stop(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int channelnum = pgChannel_AsInt(self);
+    struct ChannelData *cd;
+    PyObject *at_obj = Py_None;
+    Uint64 at, now;
+
+    static char *kwids[] = {"at_sample", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwids, &at_obj))
+        return NULL;
+    MIXER_INIT_CHECK();
+
+    if (at_obj != Py_None) {
+        if (_pg_sample_arg(at_obj, &at)) {
+            return NULL;
+        }
+        cd = &channeldata[channelnum];
+        now = _pg_sample_clock();
+        if (at > now && cd->voice && cd->sound &&
+            !((pgSoundObject *)cd->sound)->stream) {
+            /* exact to the frame for the sounds playing on a voice */
+            SDL_AtomicLock(&cd->voice->stop_lock);
+            cd->voice->stop_at = at;
+            SDL_AtomicUnlock(&cd->voice->stop_lock);
+            Py_RETURN_NONE;
+        }
+        if (at > now) {
+            Mix_ExpireChannel(channelnum,
+                              MAX((int)((at - now) * 1000 / mixer_frequency),
+                                  1));
+            Py_RETURN_NONE;
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_virtual_cancel_pending(channelnum, NULL);
+    _pg_halt_channel(channelnum);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_pause(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    MIXER_INIT_CHECK();
+
+    Mix_Pause(channelnum);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_unpause(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    MIXER_INIT_CHECK();
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_Resume(channelnum);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_set_source_location(PyObject *self, PyObject *args)
+{
+    int channelnum = pgChannel_AsInt(self);
+    Sint16 angle;
+    float angle_f;
+    Uint8 distance;
+    float distance_f;
+    PyThreadState *_save;
+
+    if (!PyArg_ParseTuple(args, "ff", &angle_f, &distance_f))
+        return NULL;
+
+    angle = (Sint16)roundf(fmodf(angle_f, 360));
+    distance_f = roundf(distance_f);
+    if (0 > distance_f || 256 <= distance_f) {
+        return RAISE(PyExc_ValueError,
+                     "distance out of range, expected (0, 255)");
+    }
+    distance = (Uint8)distance_f;
+
+    MIXER_INIT_CHECK();
+    _save = PyEval_SaveThread();
+    if (!Mix_SetPosition(channelnum, angle, distance)) {
+        PyEval_RestoreThread(_save);
+        return RAISE(pgExc_SDLError, Mix_GetError());
+    }
+    _pg_bus_attach(channelnum);
+    PyEval_RestoreThread(_save);
+    channeldata[channelnum].position = 2;
+    channeldata[channelnum].angle = angle;
+    channeldata[channelnum].distance = distance;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_set_volume(PyObject *self, PyObject *args)
+{
+    int channelnum = pgChannel_AsInt(self);
+    float volume, stereovolume = -1.11f;
+#ifdef Py_DEBUG
+    int result;
+#endif
+    Uint8 left, right;
+    PyThreadState *_save;
+
+    if (!PyArg_ParseTuple(args, "f|f", &volume, &stereovolume))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+    if ((stereovolume <= -1.10f) && (stereovolume >= -1.12f)) {
+        /* The normal volume will be used. No panning. so panning is
+         * set to full. this is in case it was set previously to
+         * something else. NOTE: there is no way to GetPanning
+         * variables.
+         */
+        left = 255;
+        right = 255;
+
+        _save = PyEval_SaveThread();
+        if (!Mix_SetPanning(channelnum, left, right)) {
+            PyEval_RestoreThread(_save);
+            return RAISE(pgExc_SDLError, Mix_GetError());
+        }
+        _pg_bus_attach(channelnum);
+        PyEval_RestoreThread(_save);
+        if (channeldata[channelnum].position == 1) {
+            channeldata[channelnum].position = 0;
+        }
+    }
+    else {
+        /* NOTE: here the volume will be set to 1.0 and the panning will
+         * be used. */
+        left = (Uint8)(volume * 255);
+        right = (Uint8)(stereovolume * 255);
+        /*
+        printf("left:%d:  right:%d:\n", left, right);
+        */
+
+        _save = PyEval_SaveThread();
+        if (!Mix_SetPanning(channelnum, left, right)) {
+            PyEval_RestoreThread(_save);
+            return RAISE(pgExc_SDLError, Mix_GetError());
+        }
+        _pg_bus_attach(channelnum);
+        PyEval_RestoreThread(_save);
+        channeldata[channelnum].position = 1;
+        channeldata[channelnum].left = left;
+        channeldata[channelnum].right = right;
+
+        volume = 1.0f;
+    }
+
+#ifdef Py_DEBUG
+    result =
+#endif
+        Mix_Volume(channelnum, (int)(volume * 128));
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_get_volume(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    int volume;
+
+    MIXER_INIT_CHECK();
+
+    volume = Mix_Volume(channelnum, -1);
+
+    return PyFloat_FromDouble(volume / 128.0);
+}
+
+static PyObject *
+chan_set_rate(PyObject *self, PyObject *args)
+{
+    int channelnum = pgChannel_AsInt(self);
+    pgVoice *voice;
+    float rate;
+
+    if (!PyArg_ParseTuple(args, "f", &rate))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+    if (!(rate > 0.0f && rate <= PG_VOICE_MAX_RATE)) {
+        return RAISE(PyExc_ValueError, "rate must be above 0 and at most 8");
+    }
+
+    voice = _pg_channel_voice(channelnum);
+    if (!voice) {
+        return NULL;
+    }
+    SDL_AtomicSet(&voice->target,
+                  MAX((int)(rate * PG_VOICE_RATE_ONE + 0.5f), 1));
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_get_rate(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    pgVoice *voice;
+
+    MIXER_INIT_CHECK();
+
+    voice = channeldata[channelnum].voice;
+    if (!voice) {
+        return PyFloat_FromDouble(1.0);
+    }
+    return PyFloat_FromDouble((double)SDL_AtomicGet(&voice->target) /
+                              PG_VOICE_RATE_ONE);
+}
+
+static PyObject *
+chan_get_sound(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    PyObject *sound;
+
+    MIXER_INIT_CHECK();
+    _pg_channel_sync();
+    sound = channeldata[channelnum].sound;
+    if (!sound)
+        Py_RETURN_NONE;
+
+    Py_INCREF(sound);
+    return sound;
+}
+
+static PyObject *
+chan_get_queue(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    PyObject *sound;
+
+    MIXER_INIT_CHECK();
+    _pg_channel_sync();
+    sound = channeldata[channelnum].queue;
+    if (!sound)
+        Py_RETURN_NONE;
+
+    Py_INCREF(sound);
+    return sound;
+}
+
+static PyObject *
+chan_set_endevent(PyObject *self, PyObject *args)
+{
+    int channelnum = pgChannel_AsInt(self);
+    int event = SDL_NOEVENT;
+    struct ChannelData *cd;
+    pgEventDictProxy *proxy;
+    PyObject *dict;
+
+    if (!PyArg_ParseTuple(args, "|i", &event))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+    cd = &channeldata[channelnum];
+    if (event >= PGE_USEREVENT && event < PG_NUMEVENTS &&
+        !cd->endevent_proxy) {
+        /* made once, so endsound_callback can post it without the GIL */
+        dict = Py_BuildValue("{si}", "code", channelnum);
+        if (!dict) {
+            return NULL;
+        }
+        proxy = (pgEventDictProxy *)malloc(sizeof(pgEventDictProxy));
+        if (!proxy) {
+            Py_DECREF(dict);
+            return PyErr_NoMemory();
+        }
+        proxy->dict = dict;
+        proxy->lock = 0;
+        proxy->num_on_queue = 0;
+        proxy->do_free_at_end = 0;
+        cd->endevent_proxy = proxy;
+    }
+    cd->endevent = event;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_get_endevent(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+
+    return PyLong_FromLong(channeldata[channelnum].endevent);
+}
+
+static PyObject *
+chan_set_bus(PyObject *self, PyObject *arg)
+{
+    int channelnum = pgChannel_AsInt(self);
+    pgBusObject *bus = NULL, *old;
+
+    MIXER_INIT_CHECK();
+    if (arg != Py_None) {
+        if (!PyObject_TypeCheck(arg, &pgBus_Type)) {
+            return RAISE(PyExc_TypeError,
+                         "The argument must be a Bus or None");
+        }
+        CHECK_BUS_VALID(arg, NULL);
+        bus = (pgBusObject *)arg;
+    }
+    if (_pg_bus_lock_init()) {
+        return NULL;
+    }
+
+    Py_XINCREF(bus);
+    SDL_LockMutex(bus_lock);
+    old = channeldata[channelnum].bus;
+    channeldata[channelnum].bus = bus;
+    SDL_UnlockMutex(bus_lock);
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_bus_attach(channelnum);
+    Py_END_ALLOW_THREADS;
+    Py_XDECREF(old);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_get_bus(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+    PyObject *bus;
+
+    MIXER_INIT_CHECK();
+    bus = (PyObject *)channeldata[channelnum].bus;
+    if (!bus) {
+        Py_RETURN_NONE;
+    }
+    Py_INCREF(bus);
+    return bus;
+}
+
+static PyObject *
+chan_set_effects(PyObject *self, PyObject *arg)
+{
+    int channelnum = pgChannel_AsInt(self);
+
+    MIXER_INIT_CHECK();
+    if (_pg_bus_lock_init() ||
+        _pg_effects_set(&channeldata[channelnum].effects, arg)) {
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_bus_attach(channelnum);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+chan_get_effects(PyObject *self, PyObject *_null)
+{
+    int channelnum = pgChannel_AsInt(self);
+
+    MIXER_INIT_CHECK();
+    return _pg_effects_get(channeldata[channelnum].effects);
+}
+
+static PyGetSetDef _channel_getsets[] = {
+    {"id", (getter)chan_get_id, NULL, DOC_MIXER_CHANNEL_ID, NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyMethodDef channel_methods[] = {
+    {"play", (PyCFunction)chan_play, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_CHANNEL_PLAY},
+    {"queue", chan_queue, METH_O, DOC_MIXER_CHANNEL_QUEUE},
+    {"get_busy", (PyCFunction)chan_get_busy, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETBUSY},
+    {"fadeout", chan_fadeout, METH_VARARGS, DOC_MIXER_CHANNEL_FADEOUT},
+    {"stop", (PyCFunction)chan_stop, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_CHANNEL_STOP},
+    {"pause", (PyCFunction)chan_pause, METH_NOARGS, DOC_MIXER_CHANNEL_PAUSE},
+    {"unpause", (PyCFunction)chan_unpause, METH_NOARGS,
+     DOC_MIXER_CHANNEL_UNPAUSE},
+    {"set_source_location", chan_set_source_location, METH_VARARGS,
+     DOC_MIXER_CHANNEL_SETSOURCELOCATION},
+    {"set_volume", chan_set_volume, METH_VARARGS, DOC_MIXER_CHANNEL_SETVOLUME},
+    {"get_volume", (PyCFunction)chan_get_volume, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETVOLUME},
+    {"set_rate", chan_set_rate, METH_VARARGS, DOC_MIXER_CHANNEL_SETRATE},
+    {"get_rate", (PyCFunction)chan_get_rate, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETRATE},
+    {"set_bus", chan_set_bus, METH_O, DOC_MIXER_CHANNEL_SETBUS},
+    {"get_bus", (PyCFunction)chan_get_bus, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETBUS},
+    {"set_effects", chan_set_effects, METH_O, DOC_MIXER_CHANNEL_SETEFFECTS},
+    {"get_effects", (PyCFunction)chan_get_effects, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETEFFECTS},
+
+    {"get_sound", (PyCFunction)chan_get_sound, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETSOUND},
+    {"get_queue", (PyCFunction)chan_get_queue, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETQUEUE},
+
+    {"set_endevent", chan_set_endevent, METH_VARARGS,
+     DOC_MIXER_CHANNEL_SETENDEVENT},
+    {"get_endevent", (PyCFunction)chan_get_endevent, METH_NOARGS,
+     DOC_MIXER_CHANNEL_GETENDEVENT},
+
+    {NULL, NULL, 0, NULL}};
+
+/* channel object internals */
+
+static void
+channel_dealloc(PyObject *self)
+{
+    Py_TYPE(self)->tp_free(self);
+}
+
+static int
+_channel_init(pgChannelObject *self, int channelnum)
+{
+    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return -1;
+    }
+    if (channelnum < 0 || channelnum >= Mix_GroupCount(-1)) {
+        PyErr_SetString(PyExc_IndexError, "invalid channel index");
+        return -1;
+    }
+    self->chan = channelnum;
+    return 0;
+}
+
+static int
+channel_init(pgChannelObject *self, PyObject *args, PyObject *kwargs)
+{
+    int channelnum;
+    if (!PyArg_ParseTuple(args, "i", &channelnum)) {
+        return -1;
+    }
+
+    return _channel_init(self, channelnum);
+}
+
+static PyTypeObject pgChannel_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Channel",
+    .tp_basicsize = sizeof(pgChannelObject),
+    .tp_dealloc = channel_dealloc,
+    .tp_flags = (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE),
+    .tp_doc = DOC_MIXER_CHANNEL,
+    .tp_methods = channel_methods,
+    .tp_init = (initproc)channel_init,
+    .tp_new = PyType_GenericNew,
+    .tp_getset = _channel_getsets,
+};
+
+/* buses and effects */
+
+static int
+_pg_bus_lock_init(void)
+{
+    if (!bus_lock && !(bus_lock = SDL_CreateMutex())) {
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        return -1;
+    }
+    return 0;
+}
+
+static int
+_pg_effects_contain(PyObject *effects, Py_ssize_t n, PyObject *effect)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < n; ++i) {
+        if (PyTuple_GET_ITEM(effects, i) == effect) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Replace the effect chain *chain with the effects of seq, which can't be
+   used anywhere else. The chain is NULL when empty. */
+static int
+_pg_effects_set(PyObject **chain, PyObject *seq)
+{
+    PyObject *effects, *old;
+    pgEffectObject *effect;
+    Py_ssize_t i, n;
+
+    effects = PySequence_Tuple(seq);
+    if (!effects) {
+        return -1;
+    }
+    n = PyTuple_GET_SIZE(effects);
+    for (i = 0; i < n; ++i) {
+        effect = (pgEffectObject *)PyTuple_GET_ITEM(effects, i);
+        if (!PyObject_TypeCheck(effect, &pgEffect_Type)) {
+            Py_DECREF(effects);
+            PyErr_SetString(PyExc_TypeError,
+                            "effects must be a sequence of Effect objects");
+            return -1;
+        }
+        /* an effect keeps state from one buffer to the next */
+        if (_pg_effects_contain(effects, i, (PyObject *)effect) ||
+            (effect->in_use &&
+             !(*chain && _pg_effects_contain(*chain, PyTuple_GET_SIZE(*chain),
+                                             (PyObject *)effect)))) {
+            Py_DECREF(effects);
+            PyErr_SetString(PyExc_ValueError,
+                            "an effect can only be used once");
+            return -1;
+        }
+    }
+    if (!n) {
+        Py_CLEAR(effects);
+    }
+
+    SDL_LockMutex(bus_lock);
+    old = *chain;
+    *chain = effects;
+    SDL_UnlockMutex(bus_lock);
+    for (i = 0; old && i < PyTuple_GET_SIZE(old); ++i) {
+        ((pgEffectObject *)PyTuple_GET_ITEM(old, i))->in_use = 0;
+    }
+    for (i = 0; i < n; ++i) {
+        ((pgEffectObject *)PyTuple_GET_ITEM(effects, i))->in_use = 1;
+    }
+    Py_XDECREF(old);
+    return 0;
+}
+
+/* Drop an effect chain nothing runs anymore */
+static void
+_pg_effects_release(PyObject **chain)
+{
+    Py_ssize_t i;
+
+    for (i = 0; *chain && i < PyTuple_GET_SIZE(*chain); ++i) {
+        ((pgEffectObject *)PyTuple_GET_ITEM(*chain, i))->in_use = 0;
+    }
+    Py_CLEAR(*chain);
+}
+
+static PyObject *
+_pg_effects_get(PyObject *effects)
+{
+    if (!effects) {
+        return PyTuple_New(0);
+    }
+    Py_INCREF(effects);
+    return effects;
+}
+
+static int
+bus_init(pgBusObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *name, *parent = Py_None;
+    pgBusObject **order, **old;
+    int at;
+
+    static char *keywords[] = {"name", "parent", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "U|O", keywords, &name,
+                                     &parent)) {
+        return -1;
+    }
+    if (self->buf) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "__init__() was already called on Bus object");
+        return -1;
+    }
+    if (parent != Py_None) {
+        if (!PyObject_TypeCheck(parent, &pgBus_Type)) {
+            PyErr_SetString(PyExc_TypeError, "parent must be a Bus or None");
+            return -1;
+        }
+        CHECK_BUS_VALID(parent, -1);
+    }
+    if (_pg_bus_lock_init()) {
+        return -1;
+    }
+
+    self->buf = (float *)PyMem_Calloc(
+        PG_BUS_FRAMES * PG_DSP_MAX_CHANNELS, sizeof(float));
+    order = PyMem_New(pgBusObject *, num_buses + 1);
+    if (!self->buf || !order) {
+        PyMem_Free(self->buf);
+        PyMem_Free(order);
+        self->buf = NULL;
+        PyErr_NoMemory();
+        return -1;
+    }
+    Py_INCREF(name);
+    self->name = name;
+    if (parent != Py_None) {
+        Py_INCREF(parent);
+        self->parent = (pgBusObject *)parent;
+        self->depth = self->parent->depth + 1;
+    }
+    self->gain = 1.0f;
+
+    /* keep the children of a bus before it */
+    for (at = 0; at < num_buses && bus_order[at]->depth >= self->depth;
+         ++at)
+        ;
+    if (num_buses) {
+        memcpy(order, bus_order, at * sizeof(pgBusObject *));
+        memcpy(order + at + 1, bus_order + at,
+               (num_buses - at) * sizeof(pgBusObject *));
+    }
+    order[at] = self;
+    SDL_LockMutex(bus_lock);
+    old = bus_order;
+    bus_order = order;
+    num_buses++;
+    SDL_UnlockMutex(bus_lock);
+    PyMem_Free(old);
+    return 0;
+}
+
+static void
+bus_dealloc(pgBusObject *self)
+{
+    int at;
+
+    if (self->buf) {
+        SDL_LockMutex(bus_lock);
+        for (at = 0; bus_order[at] != self; ++at)
+            ;
+        memmove(bus_order + at, bus_order + at + 1,
+                (num_buses - at - 1) * sizeof(pgBusObject *));
+        num_buses--;
+        SDL_UnlockMutex(bus_lock);
+        PyMem_Free(self->buf);
+    }
+    _pg_effects_release(&self->effects);
+    Py_XDECREF(self->name);
+    Py_XDECREF(self->parent);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+bus_set_gain(PyObject *self, PyObject *args)
+{
+    float gain;
+
+    if (!PyArg_ParseTuple(args, "f", &gain)) {
+        return NULL;
+    }
+    if (!(gain >= 0.0f)) {
+        return RAISE(PyExc_ValueError, "gain can't be negative");
+    }
+    ((pgBusObject *)self)->gain = gain;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+bus_get_gain(PyObject *self, PyObject *_null)
+{
+    return PyFloat_FromDouble(((pgBusObject *)self)->gain);
+}
+
+static PyObject *
+bus_set_mute(PyObject *self, PyObject *args)
+{
+    int mute;
+
+    if (!PyArg_ParseTuple(args, "p", &mute)) {
+        return NULL;
+    }
+    ((pgBusObject *)self)->mute = mute;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+bus_get_mute(PyObject *self, PyObject *_null)
+{
+    return PyBool_FromLong(((pgBusObject *)self)->mute);
+}
+
+static PyObject *
+bus_set_effects(PyObject *self, PyObject *arg)
+{
+    CHECK_BUS_VALID(self, NULL);
+    if (_pg_effects_set(&((pgBusObject *)self)->effects, arg)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+bus_get_effects(PyObject *self, PyObject *_null)
+{
+    CHECK_BUS_VALID(self, NULL);
+    return _pg_effects_get(((pgBusObject *)self)->effects);
+}
+
+static PyObject *
+bus_get_name(PyObject *self, void *closure)
+{
+    PyObject *name = ((pgBusObject *)self)->name;
+
+    CHECK_BUS_VALID(self, NULL);
+    Py_INCREF(name);
+    return name;
+}
+
+static PyObject *
+bus_get_parent(PyObject *self, void *closure)
+{
+    PyObject *parent = (PyObject *)((pgBusObject *)self)->parent;
+
+    if (!parent) {
+        Py_RETURN_NONE;
+    }
+    Py_INCREF(parent);
+    return parent;
+}
+
+static PyObject *
+bus_repr(PyObject *self)
+{
+    CHECK_BUS_VALID(self, NULL);
+    return PyUnicode_FromFormat("<Bus(%R)>", ((pgBusObject *)self)->name);
+}
+
+static PyMethodDef bus_methods[] = {
+    {"set_gain", bus_set_gain, METH_VARARGS, DOC_MIXER_BUS_SETGAIN},
+    {"get_gain", bus_get_gain, METH_NOARGS, DOC_MIXER_BUS_GETGAIN},
+    {"set_mute", bus_set_mute, METH_VARARGS, DOC_MIXER_BUS_SETMUTE},
+    {"get_mute", bus_get_mute, METH_NOARGS, DOC_MIXER_BUS_GETMUTE},
+    {"set_effects", bus_set_effects, METH_O, DOC_MIXER_BUS_SETEFFECTS},
+    {"get_effects", bus_get_effects, METH_NOARGS, DOC_MIXER_BUS_GETEFFECTS},
+    {NULL, NULL, 0, NULL}};
+
+static PyGetSetDef bus_getsets[] = {
+    {"name", bus_get_name, NULL, DOC_MIXER_BUS_NAME, NULL},
+    {"parent", bus_get_parent, NULL, DOC_MIXER_BUS_PARENT, NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgBus_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Bus",
+    .tp_basicsize = sizeof(pgBusObject),
+    .tp_dealloc = (destructor)bus_dealloc,
+    .tp_repr = bus_repr,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_BUS,
+    .tp_methods = bus_methods,
+    .tp_getset = bus_getsets,
+    .tp_init = (initproc)bus_init,
+    .tp_new = PyType_GenericNew,
+};
+
+/* Effects are only created through their subtypes, which set process */
+static PyTypeObject pgEffect_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Effect",
+    .tp_basicsize = sizeof(pgEffectObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_EFFECT,
+};
+
+static PyObject *
+_pg_effect_new(PyTypeObject *type,
+               void (*process)(pgEffectObject *, float *, int, int))
+{
+    pgEffectObject *self;
+
+    if (_pg_bus_lock_init()) {
+        return NULL;
+    }
+    self = (pgEffectObject *)type->tp_alloc(type, 0);
+    if (self) {
+        self->process = process;
+        self->changed = 1;
+    }
+    return (PyObject *)self;
+}
+
+/* Most settings of the effects are floats in the effect object, checked
+   against a range, and read by the audio thread with bus_lock held */
+typedef struct {
+    size_t offset;
+    float min;
+    int open; /* whether min itself is out of the range */
+    float max;
+    const char *error;
+} pgEffectSetting;
+
+static PyObject *
+effect_get_setting(PyObject *self, void *closure)
+{
+    pgEffectSetting *setting = (pgEffectSetting *)closure;
+
+    return PyFloat_FromDouble(*(float *)((char *)self + setting->offset));
+}
+
+static int
+effect_set_setting(PyObject *self, PyObject *value, void *closure)
+{
+    pgEffectSetting *setting = (pgEffectSetting *)closure;
+    double x;
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "can't delete effect settings");
+        return -1;
+    }
+    x = PyFloat_AsDouble(value);
+    if (x == -1.0 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (!(x >= setting->min && x <= setting->max) ||
+        (setting->open && x == setting->min)) {
+        PyErr_SetString(PyExc_ValueError, setting->error);
+        return -1;
+    }
+    SDL_LockMutex(bus_lock);
+    *(float *)((char *)self + setting->offset) = (float)x;
+    ((pgEffectObject *)self)->changed = 1;
+    SDL_UnlockMutex(bus_lock);
+    return 0;
+}
+
+/* Parse the arguments of an effect constructor, all of them "O", and set
+   the attributes of the same names from them. The defaults are set by
+   tp_new. */
+#define PG_EFFECT_MAX_ARGS 8
+
+static int
+_pg_effect_configure(PyObject *self, PyObject *args, PyObject *kwargs,
+                     const char *format, char **keywords)
+{
+    PyObject *values[PG_EFFECT_MAX_ARGS] = {NULL};
+    int i;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, format, keywords,
+                                     &values[0], &values[1], &values[2],
+                                     &values[3], &values[4], &values[5],
+                                     &values[6], &values[7])) {
+        return -1;
+    }
+    for (i = 0; keywords[i]; ++i) {
+        if (values[i] &&
+            PyObject_SetAttrString(self, keywords[i], values[i])) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    pgEffectObject base;
+    pgBusObject *sidechain;
+    float depth;
+    float threshold;
+    float attack_ms;
+    float release_ms;
+
+    /* audio thread side */
+    float attack;
+    float release;
+    float gain;
+} pgDuckerObject;
+
+static float
+_pg_smoothing(float ms)
+{
+    if (ms <= 0.0f) {
+        return 0.0f;
+    }
+    return (float)SDL_exp(-1000.0 / (ms * (double)mixer_frequency));
+}
+
+/* Lower the gain while the sidechain bus is loud, going by its level in
+   the last buffer it mixed */
+static void
+_pg_ducker_process(pgEffectObject *effect, float *buf, int frames,
+                   int channels)
+{
+    pgDuckerObject *self = (pgDuckerObject *)effect;
+    float level = self->sidechain ? self->sidechain->level : 0.0f;
+    float target, coef;
+    int i, c;
+
+    if (_pg_effect_update(effect)) {
+        self->attack = _pg_smoothing(self->attack_ms);
+        self->release = _pg_smoothing(self->release_ms);
+    }
+    target = 1.0f - self->depth * (level < self->threshold
+                                       ? level / self->threshold
+                                       : 1.0f);
+    coef = target < self->gain ? self->attack : self->release;
+    for (i = 0; i < frames; ++i, buf += channels) {
+        self->gain = target + (self->gain - target) * coef;
+        for (c = 0; c < channels; ++c) {
+            buf[c] *= self->gain;
+        }
+    }
+}
+
+static PyObject *
+ducker_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    pgDuckerObject *self =
+        (pgDuckerObject *)_pg_effect_new(type, _pg_ducker_process);
+
+    if (self) {
+        self->depth = 0.5f;
+        self->threshold = 0.05f;
+        self->attack_ms = 10.0f;
+        self->release_ms = 250.0f;
+        self->gain = 1.0f;
+    }
+    return (PyObject *)self;
+}
+
+static int
+ducker_init(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"sidechain", "depth",   "threshold",
+                               "attack",    "release", NULL};
+    return _pg_effect_configure(self, args, kwargs, "O|OOOO", keywords);
+}
+
+static void
+ducker_dealloc(pgDuckerObject *self)
+{
+    Py_XDECREF(self->sidechain);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+ducker_get_sidechain(PyObject *self, void *closure)
+{
+    PyObject *sidechain = (PyObject *)((pgDuckerObject *)self)->sidechain;
+
+    if (!sidechain) {
+        return RAISE(PyExc_RuntimeError,
+                     "__init__() was not called on Ducker object");
+    }
+    Py_INCREF(sidechain);
+    return sidechain;
+}
+
+static int
+ducker_set_sidechain(PyObject *self, PyObject *value, void *closure)
+{
+    pgDuckerObject *ducker = (pgDuckerObject *)self;
+    pgBusObject *old;
+
+    if (!value || !PyObject_TypeCheck(value, &pgBus_Type)) {
+        PyErr_SetString(PyExc_TypeError, "sidechain must be a Bus");
+        return -1;
+    }
+    CHECK_BUS_VALID(value, -1);
+
+    Py_INCREF(value);
+    SDL_LockMutex(bus_lock);
+    old = ducker->sidechain;
+    ducker->sidechain = (pgBusObject *)value;
+    SDL_UnlockMutex(bus_lock);
+    Py_XDECREF(old);
+    return 0;
+}
+
+static pgEffectSetting ducker_settings[] = {
+    {offsetof(pgDuckerObject, depth), 0.0f, 0, 1.0f,
+     "depth must be between 0 and 1"},
+    {offsetof(pgDuckerObject, threshold), 0.0f, 1, HUGE_VALF,
+     "threshold must be positive"},
+    {offsetof(pgDuckerObject, attack_ms), 0.0f, 0, HUGE_VALF,
+     "attack can't be negative"},
+    {offsetof(pgDuckerObject, release_ms), 0.0f, 0, HUGE_VALF,
+     "release can't be negative"},
+};
+
+static PyGetSetDef ducker_getsets[] = {
+    {"sidechain", ducker_get_sidechain, ducker_set_sidechain,
+     DOC_MIXER_DUCKER_SIDECHAIN, NULL},
+    {"depth", effect_get_setting, effect_set_setting,
+     DOC_MIXER_DUCKER_DEPTH, &ducker_settings[0]},
+    {"threshold", effect_get_setting, effect_set_setting,
+     DOC_MIXER_DUCKER_THRESHOLD, &ducker_settings[1]},
+    {"attack", effect_get_setting, effect_set_setting,
+     DOC_MIXER_DUCKER_ATTACK, &ducker_settings[2]},
+    {"release", effect_get_setting, effect_set_setting,
+     DOC_MIXER_DUCKER_RELEASE, &ducker_settings[3]},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgDucker_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Ducker",
+    .tp_basicsize = sizeof(pgDuckerObject),
+    .tp_dealloc = (destructor)ducker_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_DUCKER,
+    .tp_getset = ducker_getsets,
+    .tp_base = &pgEffect_Type,
+    .tp_init = ducker_init,
+    .tp_new = ducker_new,
+};
+
+static const char *_pg_biquad_types[] = {
+    "lowpass", "highpass", "bandpass",  "notch",
+    "peaking", "lowshelf", "highshelf", NULL};
+
+typedef struct {
+    pgEffectObject base;
+    int type; /* PG_BIQUAD_* */
+    float frequency;
+    float q;
+    float gain_db;
+
+    pgBiquad biquad; /* audio thread side */
+} pgBiquadObject;
+
+static void
+_pg_biquad_effect(pgEffectObject *effect, float *buf, int frames,
+                  int channels)
+{
+    pgBiquadObject *self = (pgBiquadObject *)effect;
+
+    if (_pg_effect_update(effect)) {
+        pg_biquad_design(&self->biquad, self->type, self->frequency,
+                         self->q, self->gain_db, mixer_frequency);
+    }
+    pg_biquad_process(&self->biquad, buf, frames, channels);
+}
+
+static PyObject *
+biquad_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    pgBiquadObject *self =
+        (pgBiquadObject *)_pg_effect_new(type, _pg_biquad_effect);
+
+    if (self) {
+        self->type = PG_BIQUAD_LOWPASS;
+        self->frequency = 1000.0f;
+        self->q = 0.7071f;
+    }
+    return (PyObject *)self;
+}
+
+static int
+biquad_init(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"type", "frequency", "q", "gain", NULL};
+    return _pg_effect_configure(self, args, kwargs, "|OOOO", keywords);
+}
+
+static PyObject *
+biquad_get_type(PyObject *self, void *closure)
+{
+    return PyUnicode_FromString(
+        _pg_biquad_types[((pgBiquadObject *)self)->type]);
+}
+
+static int
+biquad_set_type(PyObject *self, PyObject *value, void *closure)
+{
+    const char *name;
+    int type;
+
+    if (!value || !PyUnicode_Check(value)) {
+        PyErr_SetString(PyExc_TypeError, "type must be a string");
+        return -1;
+    }
+    name = PyUnicode_AsUTF8(value);
+    if (!name) {
+        return -1;
+    }
+    for (type = 0; _pg_biquad_types[type]; ++type) {
+        if (!strcmp(name, _pg_biquad_types[type])) {
+            break;
+        }
+    }
+    if (!_pg_biquad_types[type]) {
+        PyErr_Format(PyExc_ValueError, "unknown filter type '%s'", name);
+        return -1;
+    }
+    SDL_LockMutex(bus_lock);
+    ((pgBiquadObject *)self)->type = type;
+    ((pgEffectObject *)self)->changed = 1;
+    SDL_UnlockMutex(bus_lock);
+    return 0;
+}
+
+static pgEffectSetting biquad_settings[] = {
+    {offsetof(pgBiquadObject, frequency), 0.0f, 1, HUGE_VALF,
+     "frequency must be positive"},
+    {offsetof(pgBiquadObject, q), 0.0f, 1, HUGE_VALF,
+     "q must be positive"},
+    {offsetof(pgBiquadObject, gain_db), -120.0f, 0, 120.0f,
+     "gain must be between -120 and 120"},
+};
+
+static PyGetSetDef biquad_getsets[] = {
+    {"type", biquad_get_type, biquad_set_type, DOC_MIXER_BIQUAD_TYPE, NULL},
+    {"frequency", effect_get_setting, effect_set_setting,
+     DOC_MIXER_BIQUAD_FREQUENCY, &biquad_settings[0]},
+    {"q", effect_get_setting, effect_set_setting,
+     DOC_MIXER_BIQUAD_Q, &biquad_settings[1]},
+    {"gain", effect_get_setting, effect_set_setting,
+     DOC_MIXER_BIQUAD_GAIN, &biquad_settings[2]},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgBiquad_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Biquad",
+    .tp_basicsize = sizeof(pgBiquadObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_BIQUAD,
+    .tp_getset = biquad_getsets,
+    .tp_base = &pgEffect_Type,
+    .tp_init = biquad_init,
+    .tp_new = biquad_new,
+};
+
+typedef struct {
+    pgEffectObject base;
+    float threshold_db;
+    float ratio;
+    float attack_ms;
+    float release_ms;
+    float makeup_db;
+
+    pgCompressor compressor; /* audio thread side */
+} pgCompressorObject;
+
+static void
+_pg_compressor_effect(pgEffectObject *effect, float *buf, int frames,
+                      int channels)
+{
+    pgCompressorObject *self = (pgCompressorObject *)effect;
+
+    if (_pg_effect_update(effect)) {
+        pg_compressor_design(&self->compressor, self->threshold_db,
+                             self->ratio, self->attack_ms, self->release_ms,
+                             self->makeup_db, mixer_frequency);
+    }
+    pg_compressor_process(&self->compressor, buf, frames, channels);
+}
+
+static PyObject *
+compressor_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    pgCompressorObject *self =
+        (pgCompressorObject *)_pg_effect_new(type, _pg_compressor_effect);
+
+    if (self) {
+        self->threshold_db = -12.0f;
+        self->ratio = 4.0f;
+        self->attack_ms = 5.0f;
+        self->release_ms = 100.0f;
+    }
+    return (PyObject *)self;
+}
+
+static int
+compressor_init(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"threshold", "ratio",  "attack",
+                               "release",   "makeup", NULL};
+    return _pg_effect_configure(self, args, kwargs, "|OOOOO", keywords);
+}
+
+static pgEffectSetting compressor_settings[] = {
+    {offsetof(pgCompressorObject, threshold_db), -120.0f, 0, 0.0f,
+     "threshold must be between -120 and 0"},
+    {offsetof(pgCompressorObject, ratio), 1.0f, 0, HUGE_VALF,
+     "ratio must be at least 1"},
+    {offsetof(pgCompressorObject, attack_ms), 0.0f, 0, HUGE_VALF,
+     "attack can't be negative"},
+    {offsetof(pgCompressorObject, release_ms), 0.0f, 0, HUGE_VALF,
+     "release can't be negative"},
+    {offsetof(pgCompressorObject, makeup_db), -120.0f, 0, 120.0f,
+     "makeup must be between -120 and 120"},
+};
+
+static PyGetSetDef compressor_getsets[] = {
+    {"threshold", effect_get_setting, effect_set_setting,
+     DOC_MIXER_COMPRESSOR_THRESHOLD, &compressor_settings[0]},
+    {"ratio", effect_get_setting, effect_set_setting,
+     DOC_MIXER_COMPRESSOR_RATIO, &compressor_settings[1]},
+    {"attack", effect_get_setting, effect_set_setting,
+     DOC_MIXER_COMPRESSOR_ATTACK, &compressor_settings[2]},
+    {"release", effect_get_setting, effect_set_setting,
+     DOC_MIXER_COMPRESSOR_RELEASE, &compressor_settings[3]},
+    {"makeup", effect_get_setting, effect_set_setting,
+     DOC_MIXER_COMPRESSOR_MAKEUP, &compressor_settings[4]},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgCompressor_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Compressor",
+    .tp_basicsize = sizeof(pgCompressorObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_COMPRESSOR,
+    .tp_getset = compressor_getsets,
+    .tp_base = &pgEffect_Type,
+    .tp_init = compressor_init,
+    .tp_new = compressor_new,
+};
+
+#define PG_DELAY_MAX_MS 10000.0f
+
+typedef struct {
+    pgEffectObject base;
+    float time_ms;
+    float feedback;
+    float mix;
+    int channels; /* of the delay line */
+
+    pgDelay delay; /* the line changes with bus_lock held */
+} pgDelayObject;
+
+static void
+_pg_delay_effect(pgEffectObject *effect, float *buf, int frames,
+                 int channels)
+{
+    pgDelayObject *self = (pgDelayObject *)effect;
+    int delay;
+
+    /* the line was made for another mixer */
+    if (!self->delay.line || self->channels != channels) {
+        return;
+    }
+    if (_pg_effect_update(effect)) {
+        delay = (int)(self->time_ms * mixer_frequency / 1000.0f + 0.5f);
+        if (delay > self->delay.size) {
+            delay = self->delay.size;
+        }
+        self->delay.delay = delay > 0 ? delay : 1;
+        self->delay.feedback = self->feedback;
+        self->delay.mix = self->mix;
+    }
+    pg_delay_process(&self->delay, buf, frames, channels);
+}
+
+static PyObject *
+delay_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    pgDelayObject *self =
+        (pgDelayObject *)_pg_effect_new(type, _pg_delay_effect);
+
+    if (self) {
+        self->time_ms = 250.0f;
+        self->feedback = 0.35f;
+        self->mix = 0.35f;
+    }
+    return (PyObject *)self;
+}
+
+/* Make the delay line long enough for time milliseconds at the current
+   mixer settings, keeping the line while it is */
+static int
+_pg_delay_resize(pgDelayObject *self, float time)
+{
+    float *line = NULL, *old = NULL;
+    int size;
+
+    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return -1;
+    }
+    size = (int)(time * mixer_frequency / 1000.0f + 0.5f) + 1;
+    if (!self->delay.line || self->channels != mixer_channels ||
+        self->delay.size < size) {
+        line = (float *)PyMem_Calloc((size_t)size * mixer_channels,
+                                     sizeof(float));
+        if (!line) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    SDL_LockMutex(bus_lock);
+    if (line) {
+        old = self->delay.line;
+        self->delay.line = line;
+        self->delay.size = size;
+        self->delay.pos = 0;
+        self->channels = mixer_channels;
+    }
+    self->time_ms = time;
+    self->base.changed = 1;
+    SDL_UnlockMutex(bus_lock);
+    PyMem_Free(old);
+    return 0;
+}
+
+static int
+delay_init(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {"time", "feedback", "mix", NULL};
+    if (_pg_effect_configure(self, args, kwargs, "|OOO", keywords)) {
+        return -1;
+    }
+    return _pg_delay_resize((pgDelayObject *)self,
+                            ((pgDelayObject *)self)->time_ms);
+}
+
+static void
+delay_dealloc(pgDelayObject *self)
+{
+    PyMem_Free(self->delay.line);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+delay_get_time(PyObject *self, void *closure)
+{
+    return PyFloat_FromDouble(((pgDelayObject *)self)->time_ms);
+}
+
+static int
+delay_set_time(PyObject *self, PyObject *value, void *closure)
+{
+    double time;
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "can't delete effect settings");
+        return -1;
+    }
+    time = PyFloat_AsDouble(value);
+    if (time == -1.0 && PyErr_Occurred()) {
+        return -1;
+    }
+    if (!(time > 0.0 && time <= PG_DELAY_MAX_MS)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "time must be between 0 and 10000 milliseconds");
+        return -1;
+    }
+    return _pg_delay_resize((pgDelayObject *)self, (float)time);
+}
+
+static pgEffectSetting delay_settings[] = {
+    {offsetof(pgDelayObject, feedback), 0.0f, 0, 0.99f,
+     "feedback must be between 0 and 0.99"},
+    {offsetof(pgDelayObject, mix), 0.0f, 0, 1.0f,
+     "mix must be between 0 and 1"},
+};
+
+static PyGetSetDef delay_getsets[] = {
+    {"time", delay_get_time, delay_set_time, DOC_MIXER_DELAY_TIME, NULL},
+    {"feedback", effect_get_setting, effect_set_setting,
+     DOC_MIXER_DELAY_FEEDBACK, &delay_settings[0]},
+    {"mix", effect_get_setting, effect_set_setting,
+     DOC_MIXER_DELAY_MIX, &delay_settings[1]},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgDelay_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Delay",
+    .tp_basicsize = sizeof(pgDelayObject),
+    .tp_dealloc = (destructor)delay_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_DELAY,
+    .tp_getset = delay_getsets,
+    .tp_base = &pgEffect_Type,
+    .tp_init = delay_init,
+    .tp_new = delay_new,
+};
+
+typedef struct {
+    pgEffectObject base;
+    float room_size;
+    float damping;
+    float mix;
+    /* the filters were made for */
+    int frequency;
+    int channels;
+    float *mem; /* changes with bus_lock held */
+
+    pgReverb reverb; /* audio thread side */
+} pgReverbObject;
+
+static void
+_pg_reverb_effect(pgEffectObject *effect, float *buf, int frames,
+                  int channels)
+{
+    pgReverbObject *self = (pgReverbObject *)effect;
+
+    /* the filters were made for another mixer */
+    if (!self->mem || self->frequency != mixer_frequency ||
+        self->channels != channels) {
+        return;
+    }
+    if (_pg_effect_update(effect)) {
+        pg_reverb_design(&self->reverb, self->room_size, self->damping,
+                         self->mix);
+    }
+    pg_reverb_process(&self->reverb, buf, frames, channels);
+}
+
+static PyObject *
+reverb_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    pgReverbObject *self =
+        (pgReverbObject *)_pg_effect_new(type, _pg_reverb_effect);
+
+    if (self) {
+        self->room_size = 0.5f;
+        self->damping = 0.5f;
+        self->mix = 0.3f;
+    }
+    return (PyObject *)self;
+}
+
+static int
+reverb_init(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgReverbObject *reverb = (pgReverbObject *)self;
+    float *mem, *old;
+
+    static char *keywords[] = {"room_size", "damping", "mix", NULL};
+    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return -1;
+    }
+    if (_pg_effect_configure(self, args, kwargs, "|OOO", keywords)) {
+        return -1;
+    }
+    mem = (float *)PyMem_Calloc(
+        pg_reverb_size(mixer_frequency, mixer_channels), sizeof(float));
+    if (!mem) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    SDL_LockMutex(bus_lock);
+    old = reverb->mem;
+    reverb->mem = mem;
+    reverb->frequency = mixer_frequency;
+    reverb->channels = mixer_channels;
+    pg_reverb_init(&reverb->reverb, mem, mixer_frequency, mixer_channels);
+    SDL_UnlockMutex(bus_lock);
+    PyMem_Free(old);
+    return 0;
+}
+
+static void
+reverb_dealloc(pgReverbObject *self)
+{
+    PyMem_Free(self->mem);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static pgEffectSetting reverb_settings[] = {
+    {offsetof(pgReverbObject, room_size), 0.0f, 0, 1.0f,
+     "room_size must be between 0 and 1"},
+    {offsetof(pgReverbObject, damping), 0.0f, 0, 1.0f,
+     "damping must be between 0 and 1"},
+    {offsetof(pgReverbObject, mix), 0.0f, 0, 1.0f,
+     "mix must be between 0 and 1"},
+};
+
+static PyGetSetDef reverb_getsets[] = {
+    {"room_size", effect_get_setting, effect_set_setting,
+     DOC_MIXER_REVERB_ROOMSIZE, &reverb_settings[0]},
+    {"damping", effect_get_setting, effect_set_setting,
+     DOC_MIXER_REVERB_DAMPING, &reverb_settings[1]},
+    {"mix", effect_get_setting, effect_set_setting,
+     DOC_MIXER_REVERB_MIX, &reverb_settings[2]},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgReverb_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Reverb",
+    .tp_basicsize = sizeof(pgReverbObject),
+    .tp_dealloc = (destructor)reverb_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_REVERB,
+    .tp_getset = reverb_getsets,
+    .tp_base = &pgEffect_Type,
+    .tp_init = reverb_init,
+    .tp_new = reverb_new,
+};
+
+#define PG_ANALYZER_MIN_FFT 64
+#define PG_ANALYZER_MAX_FFT 16384
+#define PG_ANALYZER_MAX_BANDS 64
+#define PG_ANALYZER_LOW 20.0 /* Hz, where the lowest band starts */
+/* smoothing of the average spectral flux, per FFT */
+#define PG_ANALYZER_FLUX_AVERAGE 0.1f
+#define PG_ANALYZER_FLUX_FLOOR 1e-3f /* the least flux of an onset */
+
+/* The spectrum goes from the audio thread to Python through two copies:
+   ready, written at the end of each FFT with lock held, and front, which
+   update() copies ready into and the memoryviews of get_spectrum() see */
+typedef struct {
+    pgEffectObject base;
+    float threshold;
+    int fft_size;
+    int bands;
+    float *mem; /* changes with bus_lock held */
+    Py_ssize_t exports;
+
+    SDL_SpinLock lock;
+    float *ready;
+    float *ready_bands;
+    Uint32 serial; /* of ready */
+    int onset;     /* in an FFT since the last update() */
+
+    /* Python side */
+    float *front;
+    float *front_bands;
+    int front_onset;
+    Uint32 seen; /* the serial of front */
+    Py_ssize_t shape;
+
+    /* audio thread side */
+    float *input; /* the last fft_size mono samples, a ring */
+    int pos;
+    int filled; /* samples since the last FFT */
+    float *window;
+    float *re;
+    float *im;
+    float *cos_table;
+    float *sin_table;
+    float *spectrum; /* of the last FFT */
+    float flux;      /* average */
+    int edges[PG_ANALYZER_MAX_BANDS + 1]; /* the first bin of each band */
+} pgAnalyzerObject;
+
+static int
+_pg_analyzer_bin(pgAnalyzerObject *self, double frequency)
+{
+    return (int)(frequency * self->fft_size / mixer_frequency + 0.5);
+}
+
+/* Log spaced bands from PG_ANALYZER_LOW to half the mixer frequency, at
+   least a bin wide each while there are bins left */
+static void
+_pg_analyzer_edges(pgAnalyzerObject *self)
+{
+    int bins = self->fft_size / 2 + 1, b, bin;
+    double ratio = mixer_frequency / 2.0 / PG_ANALYZER_LOW, f;
+
+    bin = _pg_analyzer_bin(self, PG_ANALYZER_LOW);
+    self->edges[0] = bin > 1 ? bin : 1;
+    for (b = 1; b <= self->bands; b++) {
+        f = PG_ANALYZER_LOW * SDL_pow(ratio, (double)b / self->bands);
+        bin = b == self->bands ? bins : _pg_analyzer_bin(self, f);
+        if (bin <= self->edges[b - 1]) {
+            bin = self->edges[b - 1] + 1;
+        }
+        self->edges[b] = bin < bins ? bin : bins;
+    }
+}
+
+/* The FFT of the last fft_size samples, its bands, and whether the
+   spectral flux jumped above its average */
+static void
+_pg_analyzer_run(pgAnalyzerObject *self)
+{
+    int n = self->fft_size, bins = n / 2 + 1, onset, k, b;
+    float scale = 4.0f / n, *re = self->re, *im = self->im;
+    float mag, diff, flux = 0.0f, energy;
+
+    for (k = 0; k < n; k++) {
+        re[k] = self->input[(self->pos + k) & (n - 1)] * self->window[k];
+        im[k] = 0.0f;
+    }
+    pg_fft(re, im, self->cos_table, self->sin_table, n);
+    /* a full scale sine comes out at 1 in its bin, through the Hann
+       window */
+    for (k = 0; k < bins; k++) {
+        mag = SDL_sqrtf(re[k] * re[k] + im[k] * im[k]) * scale;
+        if (k == 0 || k == n / 2) {
+            mag *= 0.5f;
+        }
+        diff = mag - self->spectrum[k];
+        flux += diff > 0.0f ? diff : 0.0f;
+        self->spectrum[k] = mag;
+    }
+    onset = flux > self->threshold * self->flux + PG_ANALYZER_FLUX_FLOOR;
+    self->flux += (flux - self->flux) * PG_ANALYZER_FLUX_AVERAGE;
+
+    SDL_AtomicLock(&self->lock);
+    memcpy(self->ready, self->spectrum, (size_t)bins * sizeof(float));
+    for (b = 0; b < self->bands; b++) {
+        energy = 0.0f;
+        for (k = self->edges[b]; k < self->edges[b + 1]; k++) {
+            energy += self->spectrum[k] * self->spectrum[k];
+        }
+        self->ready_bands[b] = SDL_sqrtf(energy);
+    }
+    self->onset |= onset;
+    self->serial++;
+    SDL_AtomicUnlock(&self->lock);
+}
+
+/* Mix down to mono, and take an FFT every half fft_size samples. The
+   samples go through unchanged. */
+static void
+_pg_analyzer_effect(pgEffectObject *effect, float *buf, int frames,
+                    int channels)
+{
+    pgAnalyzerObject *self = (pgAnalyzerObject *)effect;
+    int n = self->fft_size, i, c;
+    float sum;
+
+    if (!self->mem) {
+        return;
+    }
+    if (_pg_effect_update(effect)) {
+        _pg_analyzer_edges(self);
+    }
+    for (i = 0; i < frames; i++, buf += channels) {
+        sum = 0.0f;
+        for (c = 0; c < channels; c++) {
+            sum += buf[c];
+        }
+        self->input[self->pos] = sum / channels;
+        self->pos = (self->pos + 1) & (n - 1);
+        if (++self->filled == n / 2) {
+            self->filled = 0;
+            _pg_analyzer_run(self);
+        }
+    }
+}
+
+static PyObject *
+analyzer_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    pgAnalyzerObject *self =
+        (pgAnalyzerObject *)_pg_effect_new(type, _pg_analyzer_effect);
+
+    if (self) {
+        self->threshold = 1.5f;
+    }
+    return (PyObject *)self;
+}
+
+static int
+analyzer_init(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgAnalyzerObject *analyzer = (pgAnalyzerObject *)self;
+    PyObject *threshold = NULL;
+    float *mem, *old, *p;
+    int fft_size = 1024, bands = 16, bins, k;
+
+    static char *keywords[] = {"fft_size", "bands", "threshold", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iiO", keywords,
+                                     &fft_size, &bands, &threshold)) {
+        return -1;
+    }
+    if (fft_size < PG_ANALYZER_MIN_FFT || fft_size > PG_ANALYZER_MAX_FFT ||
+        (fft_size & (fft_size - 1))) {
+        PyErr_SetString(PyExc_ValueError,
+                        "fft_size must be a power of two from 64 to 16384");
+        return -1;
+    }
+    if (bands < 1 || bands > PG_ANALYZER_MAX_BANDS) {
+        PyErr_SetString(PyExc_ValueError, "bands must be between 1 and 64");
+        return -1;
+    }
+    if (analyzer->exports) {
+        PyErr_SetString(PyExc_BufferError,
+                        "the spectrum is in use by a memoryview");
+        return -1;
+    }
+    if (threshold && PyObject_SetAttrString(self, "threshold", threshold)) {
+        return -1;
+    }
+    /* the input, the window, re and im, the twiddles, then the spectrum
+       three times, and the bands twice */
+    bins = fft_size / 2 + 1;
+    mem = (float *)PyMem_Calloc(
+        (size_t)fft_size * 5 + (size_t)bins * 3 + (size_t)bands * 2,
+        sizeof(float));
+    if (!mem) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (k = 0; k < fft_size; k++) {
+        mem[fft_size + k] =
+            (float)(0.5 - 0.5 * SDL_cos(2.0 * M_PI * k / fft_size));
+    }
+    pg_fft_twiddles(mem + fft_size * 4, mem + fft_size * 4 + fft_size / 2,
+                    fft_size);
+
+    SDL_LockMutex(bus_lock);
+    old = analyzer->mem;
+    analyzer->mem = p = mem;
+    analyzer->fft_size = fft_size;
+    analyzer->bands = bands;
+    analyzer->input = p;
+    analyzer->window = p += fft_size;
+    analyzer->re = p += fft_size;
+    analyzer->im = p += fft_size;
+    analyzer->cos_table = p += fft_size;
+    analyzer->sin_table = p += fft_size / 2;
+    analyzer->spectrum = p += fft_size / 2;
+    analyzer->ready = p += bins;
+    analyzer->front = p += bins;
+    analyzer->ready_bands = p += bins;
+    analyzer->front_bands = p += bands;
+    analyzer->shape = bins;
+    analyzer->pos = analyzer->filled = 0;
+    analyzer->flux = 0.0f;
+    analyzer->onset = analyzer->front_onset = 0;
+    analyzer->seen = analyzer->serial;
+    analyzer->base.changed = 1;
+    SDL_UnlockMutex(bus_lock);
+    PyMem_Free(old);
+    return 0;
+}
+
+static void
+analyzer_dealloc(pgAnalyzerObject *self)
+{
+    PyMem_Free(self->mem);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+#define CHECK_ANALYZER_INIT(self, ret)                                       \
+    if (!((pgAnalyzerObject *)(self))->mem) {                                \
+        PyErr_SetString(PyExc_RuntimeError,                                  \
+                        "__init__() was not called on Analyzer object");     \
+        return ret;                                                          \
+    }
+
+static PyObject *
+analyzer_update(PyObject *self, PyObject *_null)
+{
+    pgAnalyzerObject *analyzer = (pgAnalyzerObject *)self;
+    int fresh;
+
+    CHECK_ANALYZER_INIT(self, NULL);
+
+    SDL_AtomicLock(&analyzer->lock);
+    fresh = analyzer->seen != analyzer->serial;
+    if (fresh) {
+        memcpy(analyzer->front, analyzer->ready,
+               (size_t)analyzer->shape * sizeof(float));
+        memcpy(analyzer->front_bands, analyzer->ready_bands,
+               (size_t)analyzer->bands * sizeof(float));
+        analyzer->front_onset = analyzer->onset;
+        analyzer->onset = 0;
+        analyzer->seen = analyzer->serial;
+    }
+    SDL_AtomicUnlock(&analyzer->lock);
+    return PyBool_FromLong(fresh);
+}
+
+static PyObject *
+analyzer_get_spectrum(PyObject *self, PyObject *_null)
+{
+    CHECK_ANALYZER_INIT(self, NULL);
+    return PyMemoryView_FromObject(self);
+}
+
+static PyObject *
+analyzer_get_bands(PyObject *self, PyObject *_null)
+{
+    pgAnalyzerObject *analyzer = (pgAnalyzerObject *)self;
+    PyObject *bands, *value;
+    int b;
+
+    CHECK_ANALYZER_INIT(self, NULL);
+
+    bands = PyTuple_New(analyzer->bands);
+    for (b = 0; bands && b < analyzer->bands; b++) {
+        value = PyFloat_FromDouble(analyzer->front_bands[b]);
+        if (!value) {
+            Py_CLEAR(bands);
+            break;
+        }
+        PyTuple_SET_ITEM(bands, b, value);
+    }
+    return bands;
+}
+
+static PyObject *
+analyzer_get_onset(PyObject *self, PyObject *_null)
+{
+    CHECK_ANALYZER_INIT(self, NULL);
+    return PyBool_FromLong(((pgAnalyzerObject *)self)->front_onset);
+}
+
+static PyObject *
+analyzer_get_fft_size(PyObject *self, void *closure)
+{
+    return PyLong_FromLong(((pgAnalyzerObject *)self)->fft_size);
+}
+
+static PyObject *
+analyzer_get_num_bands(PyObject *self, void *closure)
+{
+    return PyLong_FromLong(((pgAnalyzerObject *)self)->bands);
+}
+
+/* The front spectrum, as read only float32 */
+static int
+analyzer_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+    pgAnalyzerObject *analyzer = (pgAnalyzerObject *)self;
+
+    CHECK_ANALYZER_INIT(self, -1);
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "the spectrum is read only");
+        return -1;
+    }
+    view->buf = analyzer->front;
+    view->obj = self;
+    Py_INCREF(self);
+    view->len = analyzer->shape * (Py_ssize_t)sizeof(float);
+    view->readonly = 1;
+    view->itemsize = sizeof(float);
+    view->format = (flags & PyBUF_FORMAT) ? "f" : NULL;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &analyzer->shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES) ? &view->itemsize : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    analyzer->exports++;
+    return 0;
+}
+
+static void
+analyzer_releasebuffer(PyObject *self, Py_buffer *view)
+{
+    ((pgAnalyzerObject *)self)->exports--;
+}
+
+static PyBufferProcs analyzer_as_buffer = {analyzer_getbuffer,
+                                           analyzer_releasebuffer};
+
+static PyMethodDef analyzer_methods[] = {
+    {"update", analyzer_update, METH_NOARGS, DOC_MIXER_ANALYZER_UPDATE},
+    {"get_spectrum", analyzer_get_spectrum, METH_NOARGS,
+     DOC_MIXER_ANALYZER_GETSPECTRUM},
+    {"get_bands", analyzer_get_bands, METH_NOARGS,
+     DOC_MIXER_ANALYZER_GETBANDS},
+    {"get_onset", analyzer_get_onset, METH_NOARGS,
+     DOC_MIXER_ANALYZER_GETONSET},
+    {NULL, NULL, 0, NULL}};
+
+static pgEffectSetting analyzer_settings[] = {
+    {offsetof(pgAnalyzerObject, threshold), 1.0f, 0, HUGE_VALF,
+     "threshold can't be less than 1"},
+};
+
+static PyGetSetDef analyzer_getsets[] = {
+    {"fft_size", analyzer_get_fft_size, NULL, DOC_MIXER_ANALYZER_FFTSIZE,
+     NULL},
+    {"bands", analyzer_get_num_bands, NULL, DOC_MIXER_ANALYZER_BANDS,
+     NULL},
+    {"threshold", effect_get_setting, effect_set_setting,
+     DOC_MIXER_ANALYZER_THRESHOLD, &analyzer_settings[0]},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgAnalyzer_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Analyzer",
+    .tp_basicsize = sizeof(pgAnalyzerObject),
+    .tp_dealloc = (destructor)analyzer_dealloc,
+    .tp_as_buffer = &analyzer_as_buffer,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_ANALYZER,
+    .tp_methods = analyzer_methods,
+    .tp_getset = analyzer_getsets,
+    .tp_base = &pgEffect_Type,
+    .tp_init = analyzer_init,
+    .tp_new = analyzer_new,
+};
+
+static PyObject *
+mixer_set_output_effects(PyObject *self, PyObject *arg)
+{
+    MIXER_INIT_CHECK();
+
+    if (_pg_bus_lock_init() || _pg_effects_set(&output_effects, arg)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_get_output_effects(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+
+    return _pg_effects_get(output_effects);
+}
+
+/* 3D audio.
+
+   The listener and the emitters have a position and a velocity, in any
+   unit as long as the speed of sound is in the same unit per second.
+   Between two changes from Python, the audio thread moves them along
+   their velocity at each buffer, so nothing needs updating every frame.
+
+   An Emitter effect makes the sound of its channel a point source. Its
+   distance sets the gain, and the delay of the sound, whose change is the
+   doppler shift. Its direction sets the panning, or with binaural, the
+   delay between the ears and the shadow of the head, after a spherical
+   head model. */
+#define PG_EMITTER_MAX_DELAY 0.25 /* seconds the sound can travel */
+#define PG_HEAD_DELAY 0.00066     /* seconds between the ears */
+#define PG_HEAD_SHADOW 1500.0     /* Hz, the far ear for a side source */
+#define PG_HEAD_BEHIND 6000.0     /* Hz, both ears for a source behind */
+#define PG_HEAD_OPEN 20000.0      /* Hz, no filter at all */
+#define PG_HEAD_LEVEL 0.3f        /* the far ear is quieter, up to that */
+
+typedef struct {
+    float position[3];
+    float velocity[3];
+    float forward[3];
+    float up[3];
+    float speed_of_sound;
+    Uint64 clock; /* of the sample clock when the position was set */
+} pgListener;
+
+/* changed with bus_lock held */
+static pgListener listener = {
+    {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f},
+    {0.0f, 1.0f, 0.0f}, 343.0f,             0};
+
+static int
+_pg_vec3_from_obj(PyObject *obj, float *v, const char *name)
+{
+    if (!PySequence_Check(obj) || PySequence_Length(obj) != 3 ||
+        !pg_FloatFromObjIndex(obj, 0, &v[0]) ||
+        !pg_FloatFromObjIndex(obj, 1, &v[1]) ||
+        !pg_FloatFromObjIndex(obj, 2, &v[2])) {
+        PyErr_Format(PyExc_TypeError,
+                     "%s must be a sequence of three numbers", name);
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+_pg_vec3_new(const float *v)
+{
+    PyObject *math, *vector;
+
+    math = PyImport_ImportModule(IMPPREFIX "math");
+    if (!math) {
+        return NULL;
+    }
+    vector = PyObject_CallMethod(math, "Vector3", "ddd", (double)v[0],
+                                 (double)v[1], (double)v[2]);
+    Py_DECREF(math);
+    return vector;
+}
+
+static float
+_pg_vec3_dot(const float *a, const float *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void
+_pg_vec3_cross(const float *a, const float *b, float *out)
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/* Where something set at clock is at the sample clock now */
+static void
+_pg_vec3_move(const float *position, const float *velocity, Uint64 clock,
+              Uint64 now, float *out)
+{
+    float t = 0.0f;
+    int i;
+
+    if (now > clock && mixer_frequency) {
+        t = (float)(now - clock) / mixer_frequency;
+    }
+    for (i = 0; i < 3; i++) {
+        out[i] = position[i] + velocity[i] * t;
+    }
+}
+
+static PyObject *
+mixer_set_listener(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *position = NULL, *velocity = NULL, *forward = NULL;
+    PyObject *up = NULL, *speed = NULL;
+    pgListener values;
+    float side[3];
+    double x;
+    Uint64 clock;
+
+    static char *keywords[] = {"position", "velocity",       "forward",
+                               "up",       "speed_of_sound", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOOOO", keywords,
+                                     &position, &velocity, &forward, &up,
+                                     &speed)) {
+        return NULL;
+    }
+    if (_pg_bus_lock_init()) {
+        return NULL;
+    }
+    values = listener;
+    if ((position &&
+         _pg_vec3_from_obj(position, values.position, "position")) ||
+        (velocity &&
+         _pg_vec3_from_obj(velocity, values.velocity, "velocity")) ||
+        (forward && _pg_vec3_from_obj(forward, values.forward, "forward")) ||
+        (up && _pg_vec3_from_obj(up, values.up, "up"))) {
+        return NULL;
+    }
+    _pg_vec3_cross(values.forward, values.up, side);
+    if (_pg_vec3_dot(side, side) < 1e-12f) {
+        return RAISE(PyExc_ValueError,
+                     "forward and up must be non zero and not parallel");
+    }
+    if (speed) {
+        x = PyFloat_AsDouble(speed);
+        if (x == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (!(x > 0.0 && x < HUGE_VAL)) {
+            return RAISE(PyExc_ValueError, "speed_of_sound must be positive");
+        }
+        values.speed_of_sound = (float)x;
+    }
+    clock = _pg_sample_clock();
+
+    SDL_LockMutex(bus_lock);
+    if (position || velocity) {
+        /* a new velocity carries on from where the listener is now */
+        if (!position) {
+            _pg_vec3_move(listener.position, listener.velocity,
+                          listener.clock, clock, values.position);
+        }
+        values.clock = clock;
+    }
+    listener = values;
+    SDL_UnlockMutex(bus_lock);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_get_listener(PyObject *self, PyObject *_null)
+{
+    pgListener values = listener;
+    PyObject *position = _pg_vec3_new(values.position);
+    PyObject *velocity = _pg_vec3_new(values.velocity);
+    PyObject *forward = _pg_vec3_new(values.forward);
+    PyObject *up = _pg_vec3_new(values.up);
+    PyObject *dict = NULL;
+
+    if (position && velocity && forward && up) {
+        dict = Py_BuildValue("{sOsOsOsOsd}", "position", position,
+                             "velocity", velocity, "forward", forward, "up",
+                             up, "speed_of_sound",
+                             (double)values.speed_of_sound);
+    }
+    Py_XDECREF(position);
+    Py_XDECREF(velocity);
+    Py_XDECREF(forward);
+    Py_XDECREF(up);
+    return dict;
+}
+
+#define PG_EMITTER_INVERSE 0
+#define PG_EMITTER_LINEAR 1
+#define PG_EMITTER_EXPONENTIAL 2
+
+static const char *_pg_emitter_models[] = {"inverse", "linear",
+                                           "exponential", NULL};
+
+typedef struct {
+    pgEffectObject base;
+    float position[3];
+    float velocity[3];
+    Uint64 clock; /* of the sample clock when the position was set */
+    int model;    /* PG_EMITTER_* */
+    float min_distance;
+    float max_distance;
+    float rolloff;
+    float doppler;
+    int binaural;
+
+    pgSpatial spatial; /* its line changes with bus_lock held */
+} pgEmitterObject;
+
+/* The gain at distance, after the distance models of OpenAL, clamped */
+static float
+_pg_emitter_gain(pgEmitterObject *self, float distance)
+{
+    float low = self->min_distance, high = self->max_distance, gain;
+
+    high = high > low ? high : low;
+    distance = distance < low ? low : distance > high ? high : distance;
+    switch (self->model) {
+        case PG_EMITTER_LINEAR:
+            gain = high > low ? 1.0f - self->rolloff * (distance - low) /
+                                           (high - low)
+                              : 1.0f;
+            break;
+        case PG_EMITTER_EXPONENTIAL:
+            gain = SDL_powf(distance / low, -self->rolloff);
+            break;
+        default: /* PG_EMITTER_INVERSE */
+            gain = low / (low + self->rolloff * (distance - low));
+    }
+    return gain > 0.0f ? gain : 0.0f;
+}
+
+static float
+_pg_emitter_lowpass(double cutoff)
+{
+    if (cutoff >= PG_HEAD_OPEN) {
+        return 0.0f;
+    }
+    return (float)SDL_exp(-2.0 * M_PI * cutoff / mixer_frequency);
+}
+
+/* Work out the parameters of the ears at the end of this buffer */
+static void
+_pg_emitter_params(pgEmitterObject *self, int frames, pgSpatialParams *p)
+{
+    Uint64 now = sample_clock + frames;
+    float source[3], ears[3], rel[3], side[3], distance, gain, x, z;
+    float delay, itd = 0.0f, limit = (float)(self->spatial.size - 2);
+    double theta, near_cut = PG_HEAD_OPEN, far_cut = PG_HEAD_OPEN;
+    int i, near;
+
+    _pg_vec3_move(self->position, self->velocity, self->clock, now, source);
+    _pg_vec3_move(listener.position, listener.velocity, listener.clock, now,
+                  ears);
+    for (i = 0; i < 3; i++) {
+        rel[i] = source[i] - ears[i];
+    }
+    distance = SDL_sqrtf(_pg_vec3_dot(rel, rel));
+    gain = _pg_emitter_gain(self, distance);
+
+    /* how far to the right, and to the front, of the listener, from -1
+       to 1 */
+    x = 0.0f;
+    z = 1.0f;
+    _pg_vec3_cross(listener.forward, listener.up, side);
+    if (distance > 1e-6f) {
+        x = _pg_vec3_dot(rel, side) /
+            (distance * SDL_sqrtf(_pg_vec3_dot(side, side)));
+        z = _pg_vec3_dot(rel, listener.forward) /
+            (distance *
+             SDL_sqrtf(_pg_vec3_dot(listener.forward, listener.forward)));
+        x = x < -1.0f ? -1.0f : x > 1.0f ? 1.0f : x;
+    }
+    near = x >= 0.0f;
+    delay = self->doppler * distance / listener.speed_of_sound *
+            mixer_frequency;
+    delay = delay < limit ? delay : limit;
+
+    if (self->binaural) {
+        /* Woodworth's delay around a sphere */
+        theta = SDL_asin(x < 0.0f ? -x : x);
+        itd = (float)(PG_HEAD_DELAY * mixer_frequency *
+                      (theta + SDL_sin(theta)) / (M_PI / 2.0 + 1.0));
+        if (z < 0.0f) {
+            near_cut = PG_HEAD_OPEN + (PG_HEAD_BEHIND - PG_HEAD_OPEN) * -z;
+        }
+        far_cut = PG_HEAD_SHADOW * SDL_pow(PG_HEAD_OPEN / PG_HEAD_SHADOW,
+                                           1.0 - theta / (M_PI / 2.0));
+        far_cut = far_cut < near_cut ? far_cut : near_cut;
+        p->gain[near] = gain;
+        p->gain[!near] = gain * (1.0f - PG_HEAD_LEVEL * (x < 0.0f ? -x : x));
+    }
+    else {
+        /* equal power panning */
+        p->gain[0] = gain * SDL_cosf((x + 1.0f) * (float)M_PI / 4.0f);
+        p->gain[1] = gain * SDL_sinf((x + 1.0f) * (float)M_PI / 4.0f);
+    }
+    p->delay[near] = delay;
+    p->delay[!near] = delay + itd < limit ? delay + itd : limit;
+    p->lowpass[near] = _pg_emitter_lowpass(near_cut);
+    p->lowpass[!near] = _pg_emitter_lowpass(far_cut);
+}
+
+static void
+_pg_emitter_effect(pgEffectObject *effect, float *buf, int frames,
+                   int channels)
+{
+    pgEmitterObject *self = (pgEmitterObject *)effect;
+    pgSpatialParams params;
+
+    if (!self->spatial.line) {
+        return;
+    }
+    _pg_emitter_params(self, frames, &params);
+    pg_spatial_process(&self->spatial, &params, buf, frames, channels);
+}
+
+static PyObject *
+emitter_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    pgEmitterObject *self =
+        (pgEmitterObject *)_pg_effect_new(type, _pg_emitter_effect);
+
+    if (self) {
+        self->min_distance = 1.0f;
+        self->max_distance = 1000.0f;
+        self->rolloff = 1.0f;
+        self->doppler = 1.0f;
+        self->binaural = 1;
+    }
+    return (PyObject *)self;
+}
+
+static int
+emitter_init(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgEmitterObject *emitter = (pgEmitterObject *)self;
+    float *line, *old;
+    int size = 1;
+
+    static char *keywords[] = {"position", "velocity",     "model",
+                               "min_distance", "max_distance", "rolloff",
+                               "doppler",  "binaural",     NULL};
+    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return -1;
+    }
+    if (_pg_effect_configure(self, args, kwargs, "|OOOOOOOO", keywords)) {
+        return -1;
+    }
+    while (size < (PG_EMITTER_MAX_DELAY + PG_HEAD_DELAY) * mixer_frequency +
+                      2) {
+        size *= 2;
+    }
+    line = (float *)PyMem_Calloc(size, sizeof(float));
+    if (!line) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    SDL_LockMutex(bus_lock);
+    old = emitter->spatial.line;
+    memset(&emitter->spatial, 0, sizeof(pgSpatial));
+    emitter->spatial.line = line;
+    emitter->spatial.size = size;
+    SDL_UnlockMutex(bus_lock);
+    PyMem_Free(old);
+    return 0;
+}
+
+static void
+emitter_dealloc(pgEmitterObject *self)
+{
+    PyMem_Free(self->spatial.line);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+emitter_get_position(PyObject *self, void *closure)
+{
+    return _pg_vec3_new(((pgEmitterObject *)self)->position);
+}
+
+static int
+emitter_set_position(PyObject *self, PyObject *value, void *closure)
+{
+    pgEmitterObject *emitter = (pgEmitterObject *)self;
+    Uint64 clock = _pg_sample_clock();
+    float v[3];
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "can't delete effect settings");
+        return -1;
+    }
+    if (_pg_vec3_from_obj(value, v, "position")) {
+        return -1;
+    }
+    SDL_LockMutex(bus_lock);
+    memcpy(emitter->position, v, sizeof(v));
+    emitter->clock = clock;
+    SDL_UnlockMutex(bus_lock);
+    return 0;
+}
+
+static PyObject *
+emitter_get_velocity(PyObject *self, void *closure)
+{
+    return _pg_vec3_new(((pgEmitterObject *)self)->velocity);
+}
+
+static int
+emitter_set_velocity(PyObject *self, PyObject *value, void *closure)
+{
+    pgEmitterObject *emitter = (pgEmitterObject *)self;
+    Uint64 clock = _pg_sample_clock();
+    float v[3];
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "can't delete effect settings");
+        return -1;
+    }
+    if (_pg_vec3_from_obj(value, v, "velocity")) {
+        return -1;
+    }
+    /* carry on from where the emitter is now */
+    SDL_LockMutex(bus_lock);
+    _pg_vec3_move(emitter->position, emitter->velocity, emitter->clock,
+                  clock, emitter->position);
+    memcpy(emitter->velocity, v, sizeof(v));
+    emitter->clock = clock;
+    SDL_UnlockMutex(bus_lock);
+    return 0;
+}
+
+static PyObject *
+emitter_get_model(PyObject *self, void *closure)
+{
+    return PyUnicode_FromString(
+        _pg_emitter_models[((pgEmitterObject *)self)->model]);
+}
+
+static int
+emitter_set_model(PyObject *self, PyObject *value, void *closure)
+{
+    const char *name;
+    int model;
+
+    if (!value || !PyUnicode_Check(value)) {
+        PyErr_SetString(PyExc_TypeError, "model must be a string");
+        return -1;
+    }
+    name = PyUnicode_AsUTF8(value);
+    if (!name) {
+        return -1;
+    }
+    for (model = 0; _pg_emitter_models[model]; ++model) {
+        if (!strcmp(name, _pg_emitter_models[model])) {
+            break;
+        }
+    }
+    if (!_pg_emitter_models[model]) {
+        PyErr_Format(PyExc_ValueError, "unknown distance model '%s'", name);
+        return -1;
+    }
+    SDL_LockMutex(bus_lock);
+    ((pgEmitterObject *)self)->model = model;
+    SDL_UnlockMutex(bus_lock);
+    return 0;
+}
+
+static PyObject *
+emitter_get_binaural(PyObject *self, void *closure)
+{
+    return PyBool_FromLong(((pgEmitterObject *)self)->binaural);
+}
+
+static int
+emitter_set_binaural(PyObject *self, PyObject *value, void *closure)
+{
+    int binaural;
+
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "can't delete effect settings");
+        return -1;
+    }
+    binaural = PyObject_IsTrue(value);
+    if (binaural == -1) {
+        return -1;
+    }
+    SDL_LockMutex(bus_lock);
+    ((pgEmitterObject *)self)->binaural = binaural;
+    SDL_UnlockMutex(bus_lock);
+    return 0;
+}
+
+static PyObject *
+emitter_get_distance(PyObject *self, PyObject *_null)
+{
+    pgEmitterObject *emitter = (pgEmitterObject *)self;
+    Uint64 clock = _pg_sample_clock();
+    float source[3], ears[3], rel[3];
+    int i;
+
+    if (!bus_lock) {
+        return PyFloat_FromDouble(0.0);
+    }
+    SDL_LockMutex(bus_lock);
+    _pg_vec3_move(emitter->position, emitter->velocity, emitter->clock,
+                  clock, source);
+    _pg_vec3_move(listener.position, listener.velocity, listener.clock,
+                  clock, ears);
+    SDL_UnlockMutex(bus_lock);
+    for (i = 0; i < 3; i++) {
+        rel[i] = source[i] - ears[i];
+    }
+    return PyFloat_FromDouble(SDL_sqrt(_pg_vec3_dot(rel, rel)));
+}
+
+static PyMethodDef emitter_methods[] = {
+    {"get_distance", emitter_get_distance, METH_NOARGS,
+     DOC_MIXER_EMITTER_GETDISTANCE},
+    {NULL, NULL, 0, NULL}};
+
+static pgEffectSetting emitter_settings[] = {
+    {offsetof(pgEmitterObject, min_distance), 0.0f, 1, HUGE_VALF,
+     "min_distance must be positive"},
+    {offsetof(pgEmitterObject, max_distance), 0.0f, 1, HUGE_VALF,
+     "max_distance must be positive"},
+    {offsetof(pgEmitterObject, rolloff), 0.0f, 0, HUGE_VALF,
+     "rolloff can't be negative"},
+    {offsetof(pgEmitterObject, doppler), 0.0f, 0, HUGE_VALF,
+     "doppler can't be negative"},
+};
+
+static PyGetSetDef emitter_getsets[] = {
+    {"position", emitter_get_position, emitter_set_position,
+     DOC_MIXER_EMITTER_POSITION, NULL},
+    {"velocity", emitter_get_velocity, emitter_set_velocity,
+     DOC_MIXER_EMITTER_VELOCITY, NULL},
+    {"model", emitter_get_model, emitter_set_model, DOC_MIXER_EMITTER_MODEL,
+     NULL},
+    {"min_distance", effect_get_setting, effect_set_setting,
+     DOC_MIXER_EMITTER_MINDISTANCE, &emitter_settings[0]},
+    {"max_distance", effect_get_setting, effect_set_setting,
+     DOC_MIXER_EMITTER_MAXDISTANCE, &emitter_settings[1]},
+    {"rolloff", effect_get_setting, effect_set_setting,
+     DOC_MIXER_EMITTER_ROLLOFF, &emitter_settings[2]},
+    {"doppler", effect_get_setting, effect_set_setting,
+     DOC_MIXER_EMITTER_DOPPLER, &emitter_settings[3]},
+    {"binaural", emitter_get_binaural, emitter_set_binaural,
+     DOC_MIXER_EMITTER_BINAURAL, NULL},
+    {NULL, NULL, NULL, NULL, NULL}};
+
+static PyTypeObject pgEmitter_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.Emitter",
+    .tp_basicsize = sizeof(pgEmitterObject),
+    .tp_dealloc = (destructor)emitter_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_EMITTER,
+    .tp_methods = emitter_methods,
+    .tp_getset = emitter_getsets,
+    .tp_base = &pgEffect_Type,
+    .tp_init = emitter_init,
+    .tp_new = emitter_new,
+};
+
+/* mixer.music effects, through the C API */
+static int
+pgMixer_SetMusicEffects(PyObject *effects)
+{
+    int i;
+
+    if (_pg_bus_lock_init() || _pg_effects_set(&music_effects, effects)) {
+        return -1;
+    }
+    Py_BEGIN_ALLOW_THREADS;
+    for (i = 0; i < numchanneldata; ++i) {
+        _pg_bus_attach(i);
+    }
+    Py_END_ALLOW_THREADS;
+    return 0;
+}
+
+static PyObject *
+pgMixer_GetMusicEffects(void)
+{
+    return _pg_effects_get(music_effects);
+}
+
+/* mixer.music playlists, through the C API */
+static int
+_pg_playlist_init(void)
+{
+    if (!playlist_lock) {
+        playlist_lock = SDL_CreateMutex();
+        playlist_cond = SDL_CreateCond();
+        if (!playlist_lock || !playlist_cond) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
+            return -1;
+        }
+    }
+    if (!playlist_thread) {
+        playlist_thread =
+            SDL_CreateThread(_pg_playlist_worker, "pygame playlist", NULL);
+        if (!playlist_thread) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* A list of the encoded paths of the tracks */
+static PyObject *
+_pg_playlist_encode(PyObject *tracks)
+{
+    PyObject *seq, *paths, *path, *encoded;
+    Py_ssize_t i, n;
+
+    seq = PySequence_Fast(tracks, "tracks must be a sequence of paths");
+    if (!seq) {
+        return NULL;
+    }
+    n = PySequence_Fast_GET_SIZE(seq);
+    paths = PyList_New(n);
+    if (!paths) {
+        Py_DECREF(seq);
+        return NULL;
+    }
+    for (i = 0; i < n; ++i) {
+        path = PySequence_Fast_GET_ITEM(seq, i);
+        encoded = pg_EncodeFilePath(path, NULL);
+        if (encoded && Py_IsNone(encoded)) {
+            Py_DECREF(encoded);
+            encoded = NULL;
+            PyErr_Format(PyExc_TypeError,
+                         "tracks must be str, bytes or os.PathLike, not %s",
+                         Py_TYPE(path)->tp_name);
+        }
+        if (!encoded) {
+            Py_DECREF(paths);
+            Py_DECREF(seq);
+            return NULL;
+        }
+        PyList_SET_ITEM(paths, i, encoded);
+    }
+    Py_DECREF(seq);
+    return paths;
+}
+
+static int
+pgMixer_PlayPlaylist(PyObject *tracks, int loops, int crossfade_ms,
+                     int *endevent)
+{
+    PyObject *paths, *old;
+    SDL_RWops *rw;
+    Mix_Chunk *chunk;
+    pgTrack *track;
+
+    if (crossfade_ms < 0) {
+        PyErr_SetString(PyExc_ValueError, "crossfade can't be negative");
+        return -1;
+    }
+    paths = _pg_playlist_encode(tracks);
+    if (!paths) {
+        return -1;
+    }
+    if (!PyList_GET_SIZE(paths)) {
+        Py_DECREF(paths);
+        PyErr_SetString(PyExc_ValueError, "the playlist has no tracks");
+        return -1;
+    }
+    if (_pg_playlist_init()) {
+        Py_DECREF(paths);
+        return -1;
+    }
+
+    /* the first track is decoded here, so that playback starts at once,
+       and a bad first track raises */
+    Py_BEGIN_ALLOW_THREADS;
+    rw = SDL_RWFromFile(PyBytes_AS_STRING(PyList_GET_ITEM(paths, 0)), "rb");
+    chunk = rw ? Mix_LoadWAV_RW(rw, 1) : NULL;
+    Py_END_ALLOW_THREADS;
+    if (!chunk) {
+        Py_DECREF(paths);
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        return -1;
+    }
+    track = _pg_track_new(chunk, 0);
+    if (!track) {
+        Py_DECREF(paths);
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    SDL_LockMutex(playlist_lock);
+    _pg_playlist_drop();
+    old = playlist_paths;
+    playlist_paths = paths;
+    playlist_next = 1;
+    playlist_loops = loops;
+    playlist_decoded = 1;
+    playlist_ready = track;
+    playlist_crossfade =
+        (Uint32)((Sint64)crossfade_ms * mixer_frequency / 1000);
+    playlist_stop_len = playlist_stop_pos = 0;
+    playlist_endevent = endevent;
+    playlist_playing = 1;
+    SDL_CondBroadcast(playlist_cond);
+    SDL_UnlockMutex(playlist_lock);
+    Py_XDECREF(old);
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_HookMusic(_pg_playlist_mix, NULL);
+    Py_END_ALLOW_THREADS;
+    return 0;
+}
+
+/* The list of paths is only changed with the GIL and playlist_lock both
+   held, and only read by the decoder with playlist_lock */
+static int
+pgMixer_ExtendPlaylist(PyObject *tracks)
+{
+    PyObject *paths;
+    Py_ssize_t n;
+    int failed = -1;
+
+    paths = _pg_playlist_encode(tracks);
+    if (!paths) {
+        return -1;
+    }
+    if (playlist_lock) {
+        SDL_LockMutex(playlist_lock);
+        if (playlist_playing) {
+            n = PyList_GET_SIZE(playlist_paths);
+            failed = PyList_SetSlice(playlist_paths, n, n, paths);
+            SDL_CondBroadcast(playlist_cond);
+        }
+        SDL_UnlockMutex(playlist_lock);
+    }
+    Py_DECREF(paths);
+    if (failed && !PyErr_Occurred()) {
+        PyErr_SetString(pgExc_SDLError, "no playlist is playing");
+    }
+    return failed;
+}
+
+/* Move on to the next track, crossfading into it if a crossfade is set */
+static int
+pgMixer_SkipTrack(void)
+{
+    pgTrack *cur;
+    int playing = 0;
+
+    if (playlist_lock) {
+        Py_BEGIN_ALLOW_THREADS;
+        SDL_LockMutex(playlist_lock);
+        playing = playlist_playing;
+        if (playing && playlist_outgoing) {
+            _pg_track_spend(playlist_outgoing);
+            playlist_outgoing = NULL;
+            _pg_track_ended();
+        }
+        cur = playlist_current;
+        if (playing && cur && cur->frames - cur->pos > playlist_crossfade) {
+            cur->frames = cur->pos + playlist_crossfade;
+        }
+        SDL_UnlockMutex(playlist_lock);
+        Py_END_ALLOW_THREADS;
+    }
+    if (!playing) {
+        PyErr_SetString(pgExc_SDLError, "no playlist is playing");
+        return -1;
+    }
+    return 0;
+}
+
+/* Stop at once, or fade out over fade_ms */
+static void
+pgMixer_StopPlaylist(int fade_ms)
+{
+    int unhook = 0;
+
+    if (!playlist_lock) {
+        return;
+    }
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex(playlist_lock);
+    if (fade_ms > 0 && playlist_playing) {
+        playlist_stop_len =
+            (Uint32)((Sint64)fade_ms * mixer_frequency / 1000) + 1;
+        playlist_stop_pos = 0;
+        _pg_track_spend(playlist_ready);
+        playlist_ready = NULL;
+        playlist_loops = 0;
+        playlist_next = PyList_GET_SIZE(playlist_paths);
+        ++playlist_gen;
+    }
+    else {
+        _pg_playlist_drop();
+        unhook = 1;
+    }
+    SDL_UnlockMutex(playlist_lock);
+    if (unhook) {
+        Mix_HookMusic(NULL, NULL);
+    }
+    Py_END_ALLOW_THREADS;
+}
+
+/* If a playlist is playing, with the index of the track and how far it
+   has played */
+static int
+pgMixer_GetPlaylistState(Py_ssize_t *index, Sint64 *ms)
+{
+    int playing = 0;
+
+    *index = -1;
+    *ms = 0;
+    if (playlist_lock) {
+        SDL_LockMutex(playlist_lock);
+        playing = playlist_playing;
+        if (playing && playlist_current) {
+            *index = playlist_current->index;
+            *ms = (Sint64)playlist_current->pos * 1000 / mixer_frequency;
+        }
+        else if (playing && playlist_ready) {
+            *index = playlist_ready->index;
+        }
+        SDL_UnlockMutex(playlist_lock);
+    }
+    return playing;
+}
+
+/* asynchronous sound loading */
+
+typedef struct {
+    PyObject_HEAD PyObject *paths; /* the path objects, as given */
+    PyObject *encoded;             /* tuple of encoded file names */
+    PyObject *sounds;              /* list, None until loaded */
+    PyObject *errors;              /* list, None or the error message */
+    Py_ssize_t count;
+    int event;
+    SDL_atomic_t next;      /* index of the next file to load */
+    SDL_atomic_t finished;  /* files loaded or failed */
+    SDL_atomic_t running;   /* worker threads still going */
+    SDL_atomic_t cancelled;
+    SDL_mutex *lock;
+    SDL_cond *cond;
+} pgSoundLoaderObject;
+
+static void
+_pg_loader_finish(pgSoundLoaderObject *self, Py_ssize_t index,
+                  Mix_Chunk *chunk, const char *error)
+{
+    PyObject *sound = Py_None, *message = Py_None, *dict;
+    PyGILState_STATE gstate = PyGILState_Ensure();
+
+    if (chunk) {
+        sound = pgSound_New(chunk);
+        if (!sound) {
+            Mix_FreeChunk(chunk);
+            PyErr_Clear();
+            sound = Py_None;
+            error = "out of memory";
+        }
+    }
+    if (error) {
+        message = PyUnicode_FromFormat("Unable to load '%s': %s",
+                                       PyBytes_AS_STRING(PyTuple_GET_ITEM(
+                                           self->encoded, index)),
+                                       error);
+        if (!message) {
+            PyErr_Clear();
+            message = Py_None;
+        }
+    }
+    if (sound == Py_None) {
+        Py_INCREF(sound);
+    }
+    if (message == Py_None) {
+        Py_INCREF(message);
+    }
+    /* the lists steal the references */
+    PyList_SetItem(self->sounds, index, sound);
+    PyList_SetItem(self->errors, index, message);
+
+    if (self->event && SDL_WasInit(SDL_INIT_VIDEO)) {
+        dict = Py_BuildValue("{sOsOsnsO}", "sound", sound, "path",
+                             PyTuple_GET_ITEM(self->paths, index), "index",
+                             index, "error", message);
+        if (dict) {
+            pg_post_event(self->event, dict);
+            Py_DECREF(dict);
+        }
+        else {
+            PyErr_Clear();
+        }
+    }
+    PyGILState_Release(gstate);
+
+    SDL_LockMutex(self->lock);
+    SDL_AtomicAdd(&self->finished, 1);
+    SDL_CondBroadcast(self->cond);
+    SDL_UnlockMutex(self->lock);
+}
+
+/* Count a loader thread out, waking mixer_quit after the last one */
+static void
+_pg_loaders_exit(void)
+{
+    SDL_LockMutex(loaders_lock);
+    if (SDL_AtomicAdd(&loaders_active, -1) == 1) {
+        SDL_CondBroadcast(loaders_done);
+    }
+    SDL_UnlockMutex(loaders_lock);
+}
+
+static int SDLCALL
+_pg_loader_worker(void *data)
+{
+    pgSoundLoaderObject *self = (pgSoundLoaderObject *)data;
+    Py_ssize_t index;
+    SDL_RWops *rw;
+    Mix_Chunk *chunk;
+    PyGILState_STATE gstate;
+
+    for (;;) {
+        if (SDL_AtomicGet(&self->cancelled) ||
+            SDL_AtomicGet(&loaders_cancelled)) {
+            break;
+        }
+        index = SDL_AtomicAdd(&self->next, 1);
+        if (index >= self->count) {
+            break;
+        }
+        chunk = NULL;
+        rw = SDL_RWFromFile(
+            PyBytes_AS_STRING(PyTuple_GET_ITEM(self->encoded, index)), "rb");
+        if (rw) {
+            chunk = Mix_LoadWAV_RW(rw, 1);
+        }
+        _pg_loader_finish(self, index, chunk, chunk ? NULL : SDL_GetError());
+    }
+
+    SDL_LockMutex(self->lock);
+    SDL_AtomicAdd(&self->running, -1);
+    SDL_CondBroadcast(self->cond);
+    SDL_UnlockMutex(self->lock);
+    _pg_loaders_exit();
+
+    /* drop the reference the pool held on the loader */
+    gstate = PyGILState_Ensure();
+    Py_DECREF(self);
+    PyGILState_Release(gstate);
+    return 0;
+}
+
+static int
+_pg_loader_is_done(pgSoundLoaderObject *self)
+{
+    return SDL_AtomicGet(&self->finished) >= self->count ||
+           SDL_AtomicGet(&self->running) == 0;
+}
+
+static PyObject *
+loader_done(PyObject *self, PyObject *_null)
+{
+    return PyBool_FromLong(_pg_loader_is_done((pgSoundLoaderObject *)self));
+}
+
+static PyObject *
+loader_cancel(PyObject *self, PyObject *_null)
+{
+    SDL_AtomicSet(&((pgSoundLoaderObject *)self)->cancelled, 1);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+loader_get_progress(PyObject *self, PyObject *_null)
+{
+    pgSoundLoaderObject *loader = (pgSoundLoaderObject *)self;
+
+    return Py_BuildValue("(in)", SDL_AtomicGet(&loader->finished),
+                         loader->count);
+}
+
+static PyObject *
+loader_result(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSoundLoaderObject *loader = (pgSoundLoaderObject *)self;
+    PyObject *timeout_obj = Py_None;
+    double timeout = -1.0;
+    Uint64 deadline = 0, now;
+    int done;
+    Py_ssize_t i;
+    PyObject *error;
+
+    static char *keywords[] = {"timeout", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords,
+                                     &timeout_obj)) {
+        return NULL;
+    }
+    if (!Py_IsNone(timeout_obj)) {
+        timeout = PyFloat_AsDouble(timeout_obj);
+        if (timeout == -1.0 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (timeout < 0) {
+            return RAISE(PyExc_ValueError, "timeout must be non-negative");
+        }
+        deadline = PG_GetTicks() + (Uint64)(timeout * 1000.0);
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex(loader->lock);
+    while (!(done = _pg_loader_is_done(loader))) {
+        if (timeout < 0) {
+            SDL_CondWait(loader->cond, loader->lock);
+            continue;
+        }
+        now = PG_GetTicks();
+        if (now >= deadline) {
+            break;
+        }
+        SDL_CondWaitTimeout(loader->cond, loader->lock,
+                            (Uint32)(deadline - now));
+    }
+    SDL_UnlockMutex(loader->lock);
+    Py_END_ALLOW_THREADS;
+
+    if (!done) {
+        return RAISE(PyExc_TimeoutError, "sounds are still loading");
+    }
+    for (i = 0; i < loader->count; ++i) {
+        error = PyList_GET_ITEM(loader->errors, i);
+        if (!Py_IsNone(error)) {
+            PyErr_SetObject(pgExc_SDLError, error);
+            return NULL;
+        }
+    }
+    return PyList_GetSlice(loader->sounds, 0, loader->count);
+}
+
+static PyMethodDef loader_methods[] = {
+    {"done", loader_done, METH_NOARGS, DOC_MIXER_SOUNDLOADER_DONE},
+    {"result", (PyCFunction)loader_result, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_SOUNDLOADER_RESULT},
+    {"cancel", loader_cancel, METH_NOARGS, DOC_MIXER_SOUNDLOADER_CANCEL},
+    {"get_progress", loader_get_progress, METH_NOARGS,
+     DOC_MIXER_SOUNDLOADER_GETPROGRESS},
+    {NULL, NULL, 0, NULL}};
+
+static void
+loader_dealloc(pgSoundLoaderObject *self)
+{
+    Py_XDECREF(self->paths);
+    Py_XDECREF(self->encoded);
+    Py_XDECREF(self->sounds);
+    Py_XDECREF(self->errors);
+    if (self->cond) {
+        SDL_DestroyCond(self->cond);
+    }
+    if (self->lock) {
+        SDL_DestroyMutex(self->lock);
+    }
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyTypeObject pgSoundLoader_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.SoundLoader",
+    .tp_basicsize = sizeof(pgSoundLoaderObject),
+    .tp_dealloc = (destructor)loader_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_SOUNDLOADER,
+    .tp_methods = loader_methods,
+};
+
+static PyObject *
+mixer_load_sounds_async(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *paths_obj, *path, *encoded;
+    pgSoundLoaderObject *loader;
+    SDL_Thread *thread;
+    int workers = 0, event = 0, started = 0, i;
+    Py_ssize_t n;
+
+    static char *keywords[] = {"paths", "workers", "event", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ii", keywords,
+                                     &paths_obj, &workers, &event)) {
+        return NULL;
+    }
+
+    MIXER_INIT_CHECK();
+
+    if (workers < 0) {
+        return RAISE(PyExc_ValueError, "workers must be positive");
+    }
+    if (event < 0 || event >= PG_NUMEVENTS) {
+        return RAISE(PyExc_ValueError, "event type out of range");
+    }
+
+    loader = PyObject_New(pgSoundLoaderObject, &pgSoundLoader_Type);
+    if (!loader) {
+        return NULL;
+    }
+    loader->encoded = NULL;
+    loader->sounds = NULL;
+    loader->errors = NULL;
+    loader->lock = NULL;
+    loader->cond = NULL;
+    loader->event = event;
+    SDL_AtomicSet(&loader->next, 0);
+    SDL_AtomicSet(&loader->finished, 0);
+    SDL_AtomicSet(&loader->running, 0);
+    SDL_AtomicSet(&loader->cancelled, 0);
+
+    loader->paths = PySequence_Tuple(paths_obj);
+    if (!loader->paths) {
+        goto error;
+    }
+    n = PyTuple_GET_SIZE(loader->paths);
+    loader->count = n;
+    loader->encoded = PyTuple_New(n);
+    loader->sounds = PyList_New(n);
+    loader->errors = PyList_New(n);
+    if (!loader->encoded || !loader->sounds || !loader->errors) {
+        goto error;
+    }
+    for (i = 0; i < n; ++i) {
+        path = PyTuple_GET_ITEM(loader->paths, i);
+        encoded = pg_EncodeFilePath(path, NULL);
+        if (!encoded) {
+            goto error;
+        }
+        if (Py_IsNone(encoded)) {
+            Py_DECREF(encoded);
+            PyErr_Format(PyExc_TypeError,
+                         "paths must be str, bytes or os.PathLike, not %s",
+                         Py_TYPE(path)->tp_name);
+            goto error;
+        }
+        PyTuple_SET_ITEM(loader->encoded, i, encoded);
+        Py_INCREF(Py_None);
+        PyList_SET_ITEM(loader->sounds, i, Py_None);
+        Py_INCREF(Py_None);
+        PyList_SET_ITEM(loader->errors, i, Py_None);
+    }
+
+    loader->lock = SDL_CreateMutex();
+    loader->cond = SDL_CreateCond();
+    if (!loaders_lock) {
+        loaders_lock = SDL_CreateMutex();
+    }
+    if (!loaders_done) {
+        loaders_done = SDL_CreateCond();
+    }
+    if (!loader->lock || !loader->cond || !loaders_lock || !loaders_done) {
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        goto error;
+    }
+
+    if (!workers) {
+        workers = SDL_GetCPUCount();
+    }
+    if (workers > n) {
+        workers = (int)n;
+    }
+    for (i = 0; i < workers; ++i) {
+        /* each worker holds a reference, dropped when it exits */
+        Py_INCREF(loader);
+        SDL_AtomicAdd(&loader->running, 1);
+        SDL_AtomicAdd(&loaders_active, 1);
+        thread = SDL_CreateThread(_pg_loader_worker, "pygame sound loader",
+                                  loader);
+        if (!thread) {
+            SDL_AtomicAdd(&loader->running, -1);
+            _pg_loaders_exit();
+            Py_DECREF(loader);
+            break;
+        }
+        SDL_DetachThread(thread);
+        ++started;
+    }
+    if (!started && n) {
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        goto error;
+    }
+    return (PyObject *)loader;
+
+error:
+    Py_DECREF(loader);
+    return NULL;
+}
+
+/*mixer module methods*/
+
+static PyObject *
+get_num_channels(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+    return PyLong_FromLong(Mix_GroupCount(-1));
+}
+
+static PyObject *
+set_num_channels(PyObject *self, PyObject *args)
+{
+    int numchans, i;
+    if (!PyArg_ParseTuple(args, "i", &numchans))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+    if (numchans > numchanneldata) {
+        struct ChannelData *cd_org = channeldata;
+        /* _pg_bus_effect looks at the channels with bus_lock held */
+        if (bus_lock) {
+            SDL_LockMutex(bus_lock);
+        }
+        channeldata = (struct ChannelData *)realloc(
+            channeldata, sizeof(struct ChannelData) * numchans);
+        if (bus_lock) {
+            SDL_UnlockMutex(bus_lock);
+        }
+        if (!channeldata) {
+            /* Restore the original to avoid leaking it */
+            channeldata = cd_org;
+            return PyErr_NoMemory();
+        }
+        for (i = numchanneldata; i < numchans; ++i) {
+            channeldata[i].sound = NULL;
+            channeldata[i].queue = NULL;
+            channeldata[i].sound_gen = 0;
+            channeldata[i].endevent = 0;
+            channeldata[i].endevent_proxy = NULL;
+            channeldata[i].queue_slot = PG_QUEUE_CLOSED;
+            channeldata[i].gen = 0;
+            channeldata[i].voice = NULL;
+            channeldata[i].priority = 0;
+            channeldata[i].start = 0;
+            channeldata[i].loops = 0;
+            channeldata[i].playtime = -1;
+            channeldata[i].resumed = NULL;
+            channeldata[i].position = 0;
+            channeldata[i].bus = NULL;
+            channeldata[i].effects = NULL;
+            SDL_AtomicSet(&channeldata[i].bus_attached, 0);
+            channeldata[i].bus_tick = 0;
+            channeldata[i].bus_offset = 0;
+        }
+        numchanneldata = numchans;
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_AllocateChannels(numchans);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+set_reserved(PyObject *self, PyObject *args)
+{
+    int numchans_requested;
+    int numchans_reserved;
+    if (!PyArg_ParseTuple(args, "i", &numchans_requested))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+
+    numchans_reserved = Mix_ReserveChannels(numchans_requested);
+    numreserved = numchans_reserved;
+    return PyLong_FromLong(numchans_reserved);
+}
+
+static PyObject *
+set_num_virtual(PyObject *self, PyObject *args)
+{
+    int count;
+    if (!PyArg_ParseTuple(args, "i", &count))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+    if (count < 0 || count > PG_VIRTUAL_MAX) {
+        return PyErr_Format(PyExc_ValueError,
+                            "count must be between 0 and %d", PG_VIRTUAL_MAX);
+    }
+
+    SDL_AtomicSet(&num_virtual, count);
+    _pg_virtual_cancel(NULL, count);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+get_num_virtual(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+    return PyLong_FromLong(SDL_AtomicGet(&num_virtual));
+}
+
+static PyObject *
+get_busy(PyObject *self, PyObject *_null)
+{
+    if (!SDL_WasInit(SDL_INIT_AUDIO))
+        return PyBool_FromLong(0);
+
+    return PyBool_FromLong(Mix_Playing(-1));
+}
+
+static PyObject *
+get_stats(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgMixerStats stats;
+    double tick_ms = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    double mean_ms = 0.0;
+    int i, reset = 0, waiting = 0;
+
+    static char *keywords[] = {"reset", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", keywords, &reset)) {
+        return NULL;
+    }
+    MIXER_INIT_CHECK();
+
+    SDL_AtomicLock(&stats_lock);
+    stats = mixer_stats;
+    if (reset) {
+        mixer_stats.callbacks = 0;
+        mixer_stats.busy_total = 0;
+        mixer_stats.busy_max = 0;
+        mixer_stats.xruns = 0;
+        mixer_stats.events_lost = 0;
+    }
+    SDL_AtomicUnlock(&stats_lock);
+
+    if (stats.callbacks) {
+        mean_ms = (double)stats.busy_total * tick_ms / stats.callbacks;
+    }
+    for (i = 0; i < PG_VIRTUAL_MAX; ++i) {
+        if (SDL_AtomicGet(&virtual_voices[i].state) == PG_VIRTUAL_WAITING) {
+            waiting++;
+        }
+    }
+    return Py_BuildValue("{s:K,s:d,s:d,s:K,s:i,s:d,s:i,s:i,s:K}",
+                         "callbacks", (unsigned long long)stats.callbacks,
+                         "mean_callback_ms", mean_ms, "max_callback_ms",
+                         (double)stats.busy_max * tick_ms, "xruns",
+                         (unsigned long long)stats.xruns, "buffer",
+                         stats.frames, "latency_ms",
+                         2000.0 * stats.frames / mixer_frequency, "playing",
+                         Mix_Playing(-1), "virtual", waiting, "events_lost",
+                         (unsigned long long)stats.events_lost);
+}
+
+static PyObject *
+get_sample_clock(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+
+    return PyLong_FromUnsignedLongLong(_pg_sample_clock());
+}
+
+#define PG_WAV_HEADER 44 /* bytes, of a plain PCM WAV file */
+
+static void
+_pg_put_le(Uint8 *p, Uint32 value, int bytes)
+{
+    int i;
+
+    for (i = 0; i < bytes; i++, value >>= 8) {
+        p[i] = (Uint8)value;
+    }
+}
+
+static Uint32
+_pg_get_le(const Uint8 *p, int bytes)
+{
+    Uint32 value = 0;
+
+    while (bytes--) {
+        value = value << 8 | p[bytes];
+    }
+    return value;
+}
+
+/* The header of a WAV file of len bytes of samples in the mixer format */
+static void
+_pg_wav_header(Uint8 header[PG_WAV_HEADER], size_t len)
+{
+    int bytes = SDL_AUDIO_BITSIZE(mixer_format) / 8;
+    int block = bytes * mixer_channels;
+
+    memcpy(header, "RIFF", 4);
+    _pg_put_le(header + 4, (Uint32)(PG_WAV_HEADER - 8 + len), 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    _pg_put_le(header + 16, 16, 4);
+    _pg_put_le(header + 20, SDL_AUDIO_ISFLOAT(mixer_format) ? 3 : 1, 2);
+    _pg_put_le(header + 22, mixer_channels, 2);
+    _pg_put_le(header + 24, mixer_frequency, 4);
+    _pg_put_le(header + 28, mixer_frequency * block, 4);
+    _pg_put_le(header + 32, block, 2);
+    _pg_put_le(header + 34, bytes * 8, 2);
+    memcpy(header + 36, "data", 4);
+    _pg_put_le(header + 40, (Uint32)len, 4);
+}
+
+/* Change samples in the mixer format in place to the byte order and
+   signedness of WAV files */
+static void
+_pg_wav_samples(Uint8 *buf, size_t len)
+{
+    int bytes = SDL_AUDIO_BITSIZE(mixer_format) / 8;
+    int flip = !SDL_AUDIO_ISFLOAT(mixer_format) &&
+               (bytes == 1) == !!SDL_AUDIO_ISSIGNED(mixer_format);
+    Uint8 *p, t;
+    int i;
+
+    for (p = buf; p < buf + len; p += bytes) {
+        if (SDL_AUDIO_ISBIGENDIAN(mixer_format)) {
+            for (i = 0; i < bytes / 2; i++) {
+                t = p[i];
+                p[i] = p[bytes - 1 - i];
+                p[bytes - 1 - i] = t;
+            }
+        }
+        /* 8 bit samples are unsigned, wider ones signed */
+        if (flip) {
+            p[bytes - 1] ^= 0x80;
+        }
+    }
+}
+
+/* Write buf, of len bytes in the mixer format, as a WAV file. The samples
+   are changed in place. */
+static int
+_pg_wav_write(SDL_RWops *rw, Uint8 *buf, size_t len)
+{
+    Uint8 header[PG_WAV_HEADER];
+
+    _pg_wav_samples(buf, len);
+    _pg_wav_header(header, len);
+    if (SDL_RWwrite(rw, header, sizeof(header), 1) != 1 ||
+        (len && SDL_RWwrite(rw, buf, len, 1) != 1)) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Find the samples of the WAV file in buf, and their format, 0 if SDL has
+   no AUDIO_ value for it. Returns 0 if buf doesn't hold a WAV file, and
+   raises a ValueError if it holds a broken one. */
+static int
+_pg_wav_find(const Uint8 *buf, size_t len, Uint16 *format, int *channels,
+             int *frequency, size_t *offset, size_t *size)
+{
+    size_t pos = 12, chunk_size;
+    const Uint8 *fmt = NULL;
+    Uint32 tag = 0, bits = 0;
+
+    if (len < 12 || memcmp(buf, "RIFF", 4) || memcmp(buf + 8, "WAVE", 4)) {
+        return 0;
+    }
+    while (pos + 8 <= len) {
+        chunk_size = _pg_get_le(buf + pos + 4, 4);
+        if (!memcmp(buf + pos, "fmt ", 4) && chunk_size >= 16 &&
+            pos + 8 + 16 <= len) {
+            fmt = buf + pos + 8;
+            tag = _pg_get_le(fmt, 2);
+            bits = _pg_get_le(fmt + 14, 2);
+            if (tag == 0xFFFE && chunk_size >= 40 && pos + 8 + 40 <= len) {
+                /* WAVE_FORMAT_EXTENSIBLE, the tag starts the GUID */
+                tag = _pg_get_le(fmt + 24, 2);
+            }
+        }
+        else if (!memcmp(buf + pos, "data", 4) && fmt) {
+            *format = 0;
+            if (tag == 1 && bits == 8) {
+                *format = AUDIO_U8;
+            }
+            else if (tag == 1 && bits == 16) {
+                *format = AUDIO_S16LSB;
+            }
+            else if (tag == 1 && bits == 32) {
+                *format = AUDIO_S32LSB;
+            }
+            else if (tag == 3 && bits == 32) {
+                *format = AUDIO_F32LSB;
+            }
+            *channels = (int)_pg_get_le(fmt + 2, 2);
+            *frequency = (int)_pg_get_le(fmt + 4, 4);
+            *offset = pos + 8;
+            *size = len - *offset < chunk_size ? len - *offset : chunk_size;
+            return 1;
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+    PyErr_SetString(PyExc_ValueError, "not a valid WAV file");
+    return -1;
+}
+
+/* Open a path or a Python file object to write to */
+static SDL_RWops *
+_pg_rw_for_writing(PyObject *file)
+{
+    PyObject *encoded;
+    SDL_RWops *rw;
+
+    encoded = pg_EncodeString(file, "UTF-8", NULL, pgExc_SDLError);
+    if (!encoded) {
+        return NULL;
+    }
+    if (encoded == Py_None) {
+        rw = pgRWops_FromFileObject(file);
+    }
+    else {
+        rw = SDL_RWFromFile(PyBytes_AS_STRING(encoded), "wb");
+        if (!rw) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        }
+    }
+    Py_DECREF(encoded);
+    return rw;
+}
+
+static PyObject *
+render_offline(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    double seconds;
+    PyObject *file = Py_None, *bytes;
+    SDL_RWops *rw;
+    Uint8 *buf;
+    size_t len, pos, n, frame_size, slice;
+    int result;
+
+    static char *keywords[] = {"seconds", "file", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "d|O", keywords,
+                                     &seconds, &file)) {
+        return NULL;
+    }
+    MIXER_INIT_CHECK();
+    if (!offline_device) {
+        return RAISE(pgExc_SDLError,
+                     "the mixer was not initialized with offline=True");
+    }
+    if (offline_rendering) {
+        return RAISE(pgExc_SDLError, "the mixer is already rendering");
+    }
+    if (!(seconds >= 0.0)) {
+        return RAISE(PyExc_ValueError, "seconds can't be negative");
+    }
+    frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels;
+    if (seconds * mixer_frequency * frame_size >=
+        (file == Py_None ? (double)PY_SSIZE_T_MAX : 4294967295.0 - 36)) {
+        return RAISE(PyExc_ValueError, "too many seconds to render");
+    }
+    len = (size_t)(seconds * mixer_frequency + 0.5) * frame_size;
+    bytes = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)len);
+    if (!bytes) {
+        return NULL;
+    }
+    buf = (Uint8 *)PyBytes_AS_STRING(bytes);
+
+    /* the end of the last callback of the previous render */
+    pos = offline_carry_len < len ? offline_carry_len : len;
+    if (pos) {
+        memcpy(buf, offline_carry, pos);
+        offline_carry_len -= pos;
+        memmove(offline_carry, offline_carry + pos, offline_carry_len);
+    }
+
+    /* a second at a time, taking in the channel end messages in between
+       so that the ring doesn't fill up */
+    slice = (size_t)mixer_frequency * frame_size;
+    offline_rendering = 1;
+    while (pos < len) {
+        n = len - pos < slice ? len - pos : slice;
+        offline_pos = pos;
+        offline_len = pos + n;
+        offline_buf = buf;
+        Py_BEGIN_ALLOW_THREADS;
+        SDL_SemPost(offline_go);
+        SDL_SemWait(offline_done);
+        Py_END_ALLOW_THREADS;
+        pos += n;
+        _pg_channel_sync();
+        if (PyErr_CheckSignals()) {
+            offline_rendering = 0;
+            Py_DECREF(bytes);
+            return NULL;
+        }
+    }
+    offline_rendering = 0;
+
+    if (file == Py_None) {
+        return bytes;
+    }
+    rw = _pg_rw_for_writing(file);
+    if (!rw) {
+        Py_DECREF(bytes);
+        return NULL;
+    }
+    result = _pg_wav_write(rw, buf, len);
+    if (SDL_RWclose(rw)) {
+        result = -1;
+    }
+    Py_DECREF(bytes);
+    if (result) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        }
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_find_channel(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int chan, force = 0;
+    static char *keywords[] = {"force", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", keywords, &force)) {
+        return NULL;
+    }
+
+    MIXER_INIT_CHECK();
+
+    chan = Mix_GroupAvailable(-1);
+    if (chan == -1) {
+        if (!force)
+            Py_RETURN_NONE;
+        /* anything matters less than this */
+        chan = _pg_channel_find_victim(INT_MAX, 2.0f, 1);
+        if (chan == -1)
+            chan = Mix_GroupOldest(-1);
+    }
+    return pgChannel_New(chan);
+}
+
+static PyObject *
+mixer_set_soundfont(PyObject *self, PyObject *args)
+{
+    int paths_set;
+    PyObject *path = Py_None;
+    const char *string_path = "";
+
+    if (!PyArg_ParseTuple(args, "|O", &path)) {
+        return NULL;
+    }
+
+    MIXER_INIT_CHECK();
+
+    if (PyUnicode_Check(path)) {
+        string_path = PyUnicode_AsUTF8(path);
+    }
+    else if (!Py_IsNone(path)) {
+        return RAISE(PyExc_TypeError,
+                     "Must pass string or None to set_soundfont");
+    }
+
+    if (strlen(string_path) == 0) {
+        paths_set = Mix_SetSoundFonts(NULL);
+    }
+    else {
+        paths_set = Mix_SetSoundFonts(string_path);
+    }
+
+    if (paths_set == 0) {
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_get_soundfont(PyObject *self, PyObject *_null)
+{
+    const char *paths;
+
+    MIXER_INIT_CHECK();
+
+    paths = Mix_GetSoundFonts();
+
+    if (paths) {
+        return PyUnicode_FromString(paths);
+    }
+
+    Py_RETURN_NONE;
+}
+
+/* The channel number of an int or a Channel */
+static int
+_pg_batch_channel(PyObject *obj, int *channel)
+{
+    long n;
+
+    if (PyObject_TypeCheck(obj, &pgChannel_Type)) {
+        n = pgChannel_AsInt(obj);
+    }
+    else {
+        n = PyLong_AsLong(obj);
+        if (n == -1 && PyErr_Occurred()) {
+            PyErr_SetString(PyExc_TypeError,
+                            "channels must be Channel objects or ints");
+            return -1;
+        }
+    }
+    if (n < 0 || n >= numchanneldata) {
+        PyErr_SetString(PyExc_IndexError, "invalid channel index");
+        return -1;
+    }
+    *channel = (int)n;
+    return 0;
+}
+
+/* Hand n items over to the post mix effect, and update the Python side of
+   their channels */
+static int
+_pg_batch_post(pgBatchItem *items, Py_ssize_t n)
+{
+    struct ChannelData *cd;
+    pgBatchItem *grown, *old = NULL;
+    Py_ssize_t i;
+    int size;
+
+    /* the audio thread only ever empties the batch */
+    if (batch_count + n > batch_size) {
+        size = (int)(batch_count + n) * 2;
+        grown = (pgBatchItem *)PyMem_Malloc(size * sizeof(pgBatchItem));
+        if (!grown) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        SDL_AtomicLock(&batch_lock);
+        memcpy(grown, batch_items, batch_count * sizeof(pgBatchItem));
+        old = batch_items;
+        batch_items = grown;
+        batch_size = size;
+        SDL_AtomicUnlock(&batch_lock);
+        PyMem_Free(old);
+    }
+    SDL_AtomicLock(&batch_lock);
+    memcpy(batch_items + batch_count, items, n * sizeof(pgBatchItem));
+    batch_count += (int)n;
+    SDL_AtomicUnlock(&batch_lock);
+
+    for (i = 0; i < n; ++i) {
+        cd = &channeldata[items[i].channel];
+        switch (items[i].op) {
+            case PG_BATCH_VOLUME:
+                if (cd->position == 1) {
+                    cd->position = 0;
+                }
+                break;
+            case PG_BATCH_PANNING:
+                cd->position = 1;
+                cd->left = items[i].left;
+                cd->right = items[i].right;
+                break;
+            default: /* PG_BATCH_LOCATION */
+                cd->position = 2;
+                cd->angle = items[i].angle;
+                cd->distance = items[i].distance;
+        }
+    }
+    return 0;
+}
+
+/* Parse channels and the matching values into items, calling parse on
+   each value. Returns the items, to free with PyMem_Free. */
+static pgBatchItem *
+_pg_batch_parse(PyObject *channels, PyObject *values, Py_ssize_t *count,
+                int (*parse)(PyObject *, pgBatchItem *))
+{
+    PyObject *chans, *vals = NULL;
+    pgBatchItem *items = NULL;
+    Py_ssize_t n, i;
+
+    chans = PySequence_Fast(channels, "channels must be a sequence");
+    if (!chans) {
+        return NULL;
+    }
+    vals = PySequence_Fast(values, "the values must be a sequence");
+    if (!vals) {
+        goto end;
+    }
+    n = PySequence_Fast_GET_SIZE(chans);
+    if (PySequence_Fast_GET_SIZE(vals) != n) {
+        PyErr_SetString(PyExc_ValueError,
+                        "there must be as many values as channels");
+        goto end;
+    }
+    items = (pgBatchItem *)PyMem_Calloc(n ? n : 1, sizeof(pgBatchItem));
+    if (!items) {
+        PyErr_NoMemory();
+        goto end;
+    }
+    for (i = 0; i < n; ++i) {
+        if (_pg_batch_channel(PySequence_Fast_GET_ITEM(chans, i),
+                              &items[i].channel) ||
+            parse(PySequence_Fast_GET_ITEM(vals, i), &items[i])) {
+            PyMem_Free(items);
+            items = NULL;
+            goto end;
+        }
+    }
+    *count = n;
+end:
+    Py_DECREF(chans);
+    Py_XDECREF(vals);
+    return items;
+}
+
+static float
+_pg_batch_clamp(double x)
+{
+    return x < 0.0 ? 0.0f : x > 1.0 ? 1.0f : (float)x;
+}
+
+/* A volume, as in Channel.set_volume(), or a (left, right) pair */
+static int
+_pg_batch_volume(PyObject *obj, pgBatchItem *item)
+{
+    float left, right;
+    double x;
+
+    if (PySequence_Check(obj)) {
+        if (!pg_TwoFloatsFromObj(obj, &left, &right)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "volumes must be numbers or (left, right) pairs");
+            return -1;
+        }
+        item->op = PG_BATCH_PANNING;
+        item->volume = MIX_MAX_VOLUME;
+        item->left = (Uint8)(_pg_batch_clamp(left) * 255);
+        item->right = (Uint8)(_pg_batch_clamp(right) * 255);
+        return 0;
+    }
+    x = PyFloat_AsDouble(obj);
+    if (x == -1.0 && PyErr_Occurred()) {
+        PyErr_SetString(PyExc_TypeError,
+                        "volumes must be numbers or (left, right) pairs");
+        return -1;
+    }
+    item->op = PG_BATCH_VOLUME;
+    item->volume = (int)(_pg_batch_clamp(x) * MIX_MAX_VOLUME);
+    item->left = item->right = 255;
+    return 0;
+}
+
+/* An (angle, distance) pair, as in Channel.set_source_location() */
+static int
+_pg_batch_location(PyObject *obj, pgBatchItem *item)
+{
+    float angle, distance;
+
+    if (!pg_TwoFloatsFromObj(obj, &angle, &distance)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "locations must be (angle, distance) pairs");
+        return -1;
+    }
+    distance = roundf(distance);
+    if (0 > distance || 256 <= distance) {
+        PyErr_SetString(PyExc_ValueError,
+                        "distance out of range, expected (0, 255)");
+        return -1;
+    }
+    item->op = PG_BATCH_LOCATION;
+    item->angle = (Sint16)roundf(fmodf(angle, 360));
+    item->distance = (Uint8)distance;
+    return 0;
+}
+
+static PyObject *
+_pg_batch_set(PyObject *args, PyObject *kwargs, char *name,
+              int (*parse)(PyObject *, pgBatchItem *))
+{
+    PyObject *channels, *values;
+    pgBatchItem *items;
+    Py_ssize_t n = 0;
+    int failed;
+
+    char *keywords[] = {"channels", name, NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", keywords, &channels,
+                                     &values)) {
+        return NULL;
+    }
+    MIXER_INIT_CHECK();
+
+    items = _pg_batch_parse(channels, values, &n, parse);
+    if (!items) {
+        return NULL;
+    }
+    failed = _pg_batch_post(items, n);
+    PyMem_Free(items);
+    if (failed) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_set_volumes(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return _pg_batch_set(args, kwargs, "volumes", _pg_batch_volume);
+}
+
+static PyObject *
+mixer_set_source_locations(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return _pg_batch_set(args, kwargs, "locations", _pg_batch_location);
+}
+
+static PyObject *
+mixer_fadeout(PyObject *self, PyObject *args)
+{
+    int _time;
+    if (!PyArg_ParseTuple(args, "i", &_time))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_FadeOutChannel(-1, _time);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_stop(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_virtual_cancel_pending(-1, NULL);
+    _pg_halt_channel(-1);
+    Py_END_ALLOW_THREADS;
+    _pg_virtual_cancel(NULL, 0);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_pause(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+
+    Mix_Pause(-1);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+mixer_unpause(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_Resume(-1);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+/* Function to get the SDL mixer version data (linked or compiled).
+ *
+ * Ref:
+ * https://www.libsdl.org/projects/SDL_mixer/docs/SDL_mixer_8.html#SEC8
+ */
+static PyObject *
+mixer_get_sdl_mixer_version(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int linked = 1; /* Default is linked version. */
+
+    static char *keywords[] = {"linked", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", keywords, &linked)) {
+        return NULL; /* Exception already set. */
+    }
+
+    /* MIXER_INIT_CHECK() is not required for these methods. */
+
+    if (linked) {
+        /* linked version */
+        const SDL_version *v = Mix_Linked_Version();
+        return Py_BuildValue("iii", v->major, v->minor, v->patch);
+    }
+    else {
+        /* compiled version */
+        SDL_version v;
+        SDL_MIXER_VERSION(&v);
+        return Py_BuildValue("iii", v.major, v.minor, v.patch);
+    }
+}
+
+static int
+_chunk_from_buf(const void *buf, Py_ssize_t len, Mix_Chunk **chunk,
+                Uint8 **mem)
+{
+    Uint8 *m = (Uint8 *)PyMem_Malloc((size_t)len);
+
+    if (!m) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    *chunk = Mix_QuickLoad_RAW(m, (Uint32)len);
+    if (!*chunk) {
+        PyMem_Free(m);
+        PyErr_NoMemory();
+        return -1;
+    }
+    memcpy(m, (Uint8 *)buf, (size_t)len);
+    *mem = m;
+    return 0;
+}
+
+static int
+_array_shape_check(int ndim, Py_ssize_t *shape, int channels)
+{
+    if (channels == 1) {
+        if (ndim != 1) {
+            PyErr_SetString(PyExc_ValueError,
+                            "Array must be 1-dimensional for mono mixer");
+            return -1;
+        }
+    }
+    else {
+        if (ndim != 2) {
+            PyErr_SetString(
+                PyExc_ValueError,
+                "Array must be 2-dimensional for multichannel mixer");
+            return -1;
+        }
+        if (shape[1] != channels) {
+            PyErr_SetString(PyExc_ValueError,
+                            "Array depth must match number of mixer channels");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Point a chunk straight at len bytes from buf, in the memory of an
+   exporter's buffer, which the Sound then holds on to. Steals pg_view,
+   releasing it on error. */
+static int
+_chunk_from_view(pgSoundObject *self, pg_buffer *pg_view, Uint8 *buf,
+                 Py_ssize_t len)
+{
+    Py_buffer *view = (Py_buffer *)pg_view;
+    Mix_Chunk *chunk;
+
+    if (len > (Py_ssize_t)SDL_MAX_UINT32) {
+        PyErr_SetString(PyExc_ValueError, "buffer is too large for a Sound");
+        goto error;
+    }
+    chunk = Mix_QuickLoad_RAW(buf, (Uint32)len);
+    if (!chunk) {
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        goto error;
+    }
+    self->chunk = chunk;
+    self->view = pg_view;
+    self->readonly = view->readonly;
+    return 0;
+
+error:
+    pgBuffer_Release(pg_view);
+    PyMem_Free(pg_view);
+    return -1;
+}
+
+/* Can the array be played as it is, without converting its samples? */
+static int
+_array_matches_mixer(Py_buffer *view, PG_sample_format_t view_format)
+{
+    int freq, channels;
+    Uint16 format;
+
+    if (!Mix_QuerySpec(&freq, &format, &channels)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return -1;
+    }
+    if (_array_shape_check(view->ndim, view->shape, channels)) {
+        return -1;
+    }
+    if (PG_SAMPLE_SIZE(view_format) != SDL_AUDIO_BITSIZE(format) / 8 ||
+        (SDL_AUDIO_ISFLOAT(format) != 0) !=
+            ((view_format & PG_SAMPLE_FLOAT) != 0) ||
+        (!SDL_AUDIO_ISFLOAT(format) &&
+         ((view_format & PG_SAMPLE_SIGNED) != 0) !=
+             (SDL_AUDIO_ISSIGNED(format) != 0)) ||
+        (PG_SAMPLE_SIZE(view_format) > 1 &&
+         ((view_format & PG_SAMPLE_NATIVE_ENDIAN) != 0) !=
+             (SDL_AUDIO_ISBIGENDIAN(format) == SDL_AUDIO_ISBIGENDIAN(
+                                                   AUDIO_S16SYS)))) {
+        PyErr_SetString(PyExc_ValueError,
+                        "copy=False needs an array in the mixer's sample "
+                        "format");
+        return -1;
+    }
+    return 0;
+}
+
+/* Converter sample type for a mixer format. -1 if unsupported. */
+static int
+_format_audio_type(Uint16 format)
+{
+    int type = _format_itemsize(format);
+
+    if (type < 0) {
+        return -1;
+    }
+    if (SDL_AUDIO_ISFLOAT(format)) {
+        type |= PG_CVT_FLOAT;
+    }
+    else if (!SDL_AUDIO_ISSIGNED(format)) {
+        type |= PG_CVT_UNSIGNED;
+    }
+    return type;
+}
+
+/* Converter sample type for an array item format */
+static int
+_view_audio_type(PG_sample_format_t view_format)
+{
+    int type = (int)PG_SAMPLE_SIZE(view_format);
+
+    if (view_format & PG_SAMPLE_FLOAT) {
+        type |= PG_CVT_FLOAT;
+    }
+    else if (!(view_format & PG_SAMPLE_SIGNED)) {
+        type |= PG_CVT_UNSIGNED;
+    }
+    return type;
+}
+
+#define _PG_GATHER_LOOP(T)                                   \
+    for (frame = 0; frame < frames; frame++, src += step1) { \
+        for (c = 0; c < channels; c++, dst += sizeof(T)) {   \
+            *(T *)dst = *(T *)(src + c * step2);             \
+        }                                                    \
+    }
+
+/* Copy frames of strided samples into an interleaved buffer */
+static void
+_gather_frames(Uint8 *src, Py_ssize_t step1, Py_ssize_t step2, int size,
+               int channels, Py_ssize_t frames, Uint8 *dst)
+{
+    Py_ssize_t frame;
+    int c;
+
+    if (channels == 2 && step1 == size) {
+        /* planar stereo, as from a Fortran ordered or transposed array */
+        pg_audio_interleave2(src, src + step2, dst, size, (size_t)frames);
+        return;
+    }
+    switch (size) {
+        case 1:
+            _PG_GATHER_LOOP(Uint8);
+            break;
+        case 2:
+            _PG_GATHER_LOOP(Uint16);
+            break;
+        case 4:
+            _PG_GATHER_LOOP(Uint32);
+            break;
+        case 8:
+            _PG_GATHER_LOOP(Uint64);
+            break;
+    }
+}
+
+/* Reverse the bytes of each of n samples of size bytes, in place */
+static void
+_swap_samples(Uint8 *buf, int size, Py_ssize_t n)
+{
+    Py_ssize_t i;
+
+    switch (size) {
+        case 2:
+            for (i = 0; i < n; ++i) {
+                ((Uint16 *)buf)[i] = SDL_Swap16(((Uint16 *)buf)[i]);
+            }
+            break;
+        case 4:
+            for (i = 0; i < n; ++i) {
+                ((Uint32 *)buf)[i] = SDL_Swap32(((Uint32 *)buf)[i]);
+            }
+            break;
+        case 8:
+            for (i = 0; i < n; ++i) {
+                ((Uint64 *)buf)[i] = SDL_Swap64(((Uint64 *)buf)[i]);
+            }
+            break;
+    }
+}
+
+/* Frames gathered at a time from a strided array that needs converting */
+#define PG_GATHER_FRAMES 1024
+
+static int
+_chunk_from_array(void *buf, PG_sample_format_t view_format, int ndim,
+                  Py_ssize_t *shape, Py_ssize_t *strides, Mix_Chunk **chunk,
+                  Uint8 **mem)
+{
+    /* Samples are converted with the pg_audio_* functions of
+     * mixer_convert.c. As before, integer samples keep their bits, the
+     * integer sign being ignored. Samples in the other byte order are
+     * swapped first. Float arrays and float mixers are scaled to and from
+     * the [-1.0, 1.0) range.
+     */
+    int freq;
+    Uint16 format;
+    int channels;
+    int itemsize;
+    int view_itemsize = PG_SAMPLE_SIZE(view_format);
+    int src_type, dst_type, same_bits, swap, packed;
+    Uint8 *dst, *tmp = NULL;
+    Py_ssize_t memsize;
+    Py_ssize_t frame, count, step1, step2, length;
+
+    if (!Mix_QuerySpec(&freq, &format, &channels)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return -1;
+    }
+
+    /* Check for compatible values.
+     */
+    if (_array_shape_check(ndim, shape, channels)) {
+        return -1;
+    }
+    itemsize = _format_itemsize(format);
+    dst_type = _format_audio_type(format);
+    if (itemsize < 0 || dst_type < 0) {
+        return -1;
+    }
+    if (view_format & PG_SAMPLE_FLOAT) {
+        if (view_itemsize != 4 && view_itemsize != 8) {
+            PyErr_Format(PyExc_ValueError, "Unsupported float size %d",
+                         view_itemsize);
+            return -1;
+        }
+    }
+    else if (view_itemsize != 1 && view_itemsize != 2 &&
+             view_itemsize != 4) {
+        PyErr_Format(PyExc_ValueError, "Unsupported integer size %d",
+                     view_itemsize);
+        return -1;
+    }
+    src_type = _view_audio_type(view_format);
+    /* can samples be copied without looking at them? */
+    same_bits = view_itemsize == itemsize &&
+                (src_type == dst_type || !((src_type | dst_type) &
+                                           PG_CVT_FLOAT));
+    swap = view_itemsize > 1 && !(view_format & PG_SAMPLE_NATIVE_ENDIAN);
+    length = shape[0];
+    step1 = strides ? strides[0] : (Py_ssize_t)view_itemsize * channels;
+    if (ndim == 2) {
+        step2 = strides ? strides[1] : view_itemsize;
+    }
+    else {
+        step2 = step1;
+    }
+    memsize = length * channels * itemsize;
+    packed = step1 == (Py_ssize_t)view_itemsize * channels &&
+             step2 == view_itemsize;
+
+    if (swap || (!same_bits && !packed)) {
+        tmp = (Uint8 *)PyMem_Malloc((size_t)PG_GATHER_FRAMES * channels *
+                                    view_itemsize);
+        if (!tmp) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    /* Create chunk.
+     */
+    dst = (Uint8 *)PyMem_Malloc((size_t)memsize);
+    if (!dst) {
+        PyMem_Free(tmp);
+        PyErr_NoMemory();
+        return -1;
+    }
+    *chunk = Mix_QuickLoad_RAW(dst, (Uint32)memsize);
+    if (!*chunk) {
+        PyMem_Free(tmp);
+        PyMem_Free(dst);
+        PyErr_NoMemory();
+        return -1;
+    }
+    *mem = dst;
+
+    /* Copy samples.
+     */
+    if (packed && !swap) {
+        /* The samples are laid out contiguously, interleaved */
+        if (same_bits) {
+            memcpy(dst, buf, memsize);
+        }
+        else {
+            pg_audio_convert(buf, src_type, dst, dst_type,
+                             (size_t)(length * channels));
+        }
+    }
+    else if (same_bits && !swap) {
+        _gather_frames((Uint8 *)buf, step1, step2, itemsize, channels,
+                       length, dst);
+    }
+    else {
+        for (frame = 0; frame < length; frame += count) {
+            count = length - frame;
+            if (count > PG_GATHER_FRAMES) {
+                count = PG_GATHER_FRAMES;
+            }
+            _gather_frames((Uint8 *)buf + frame * step1, step1, step2,
+                           view_itemsize, channels, count, tmp);
+            if (swap) {
+                _swap_samples(tmp, view_itemsize, count * channels);
+            }
+            pg_audio_convert(tmp, src_type,
+                             dst + frame * channels * itemsize, dst_type,
+                             (size_t)(count * channels));
+        }
+    }
+    PyMem_Free(tmp);
+
+    return 0;
+}
+
+/* Resample len bytes of samples in the mixer format, taken as recorded at
+ * rate Hz, to new_rate Hz. Returns a PyMem buffer of *newlen bytes. */
+static Uint8 *
+_resample_samples(const Uint8 *buf, Py_ssize_t len, int rate, int new_rate,
+                  int quality, Py_ssize_t *newlen)
+{
+    int freq, channels, itemsize, type, result;
+    Uint16 format;
+    size_t frames, new_frames;
+    float *src, *dst;
+    Uint8 *mem;
+
+    if (!Mix_QuerySpec(&freq, &format, &channels)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return NULL;
+    }
+    if (rate <= 0 || new_rate <= 0) {
+        PyErr_SetString(PyExc_ValueError, "sample rate must be positive");
+        return NULL;
+    }
+    if (quality < PG_RESAMPLE_LINEAR || quality > PG_RESAMPLE_BEST) {
+        PyErr_Format(PyExc_ValueError, "quality must be between %d and %d",
+                     PG_RESAMPLE_LINEAR, PG_RESAMPLE_BEST);
+        return NULL;
+    }
+    itemsize = _format_itemsize(format);
+    type = _format_audio_type(format);
+    if (itemsize < 0 || type < 0) {
+        return NULL;
+    }
+    if (len % (itemsize * channels)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "buffer length is not a whole number of frames");
+        return NULL;
+    }
+
+    frames = (size_t)len / (itemsize * channels);
+    new_frames = pg_audio_resample_frames(frames, rate, new_rate);
+    if (new_frames > SDL_MAX_UINT32 / (itemsize * channels)) {
+        PyErr_SetString(PyExc_ValueError, "resampled sound is too large");
+        return NULL;
+    }
+    *newlen = (Py_ssize_t)(new_frames * itemsize * channels);
+
+    /* at least one byte each, so an empty buffer is not an error */
+    mem = (Uint8 *)PyMem_Malloc((size_t)*newlen + 1);
+    src = (float *)PyMem_Malloc((frames * channels + 1) * sizeof(float));
+    dst = (float *)PyMem_Malloc((new_frames * channels + 1) * sizeof(float));
+    if (!mem || !src || !dst) {
+        PyMem_Free(mem);
+        PyMem_Free(src);
+        PyMem_Free(dst);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    pg_audio_to_f32(buf, type, src, frames * channels);
+    result = pg_audio_resample(src, frames, dst, new_frames, channels, rate,
+                               new_rate, quality);
+    if (!result) {
+        pg_audio_from_f32(dst, mem, type, new_frames * channels);
+    }
+    Py_END_ALLOW_THREADS;
+
+    PyMem_Free(src);
+    PyMem_Free(dst);
+    if (result) {
+        PyMem_Free(mem);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    return mem;
+}
+
+static int
+_sound_init_stream(pgSoundObject *self, SDL_RWops *rw)
+{
+    pgSoundStream *st;
+    Uint8 *mem;
+    Mix_Chunk *chunk;
+    Uint32 len;
+
+    st = _pg_stream_open(rw);
+    if (!st) {
+        SDL_RWclose(rw);
+        return -1;
+    }
+
+    /* The chunk that plays on the channel is a silent block, replaced
+       with streamed samples by _pg_stream_effect */
+    len = st->frame_size * PG_STREAM_BLOCK_FRAMES;
+    mem = (Uint8 *)PyMem_Malloc(len);
+    if (!mem) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    _pg_fill_silence(mem, (int)len);
+    chunk = Mix_QuickLoad_RAW(mem, len);
+    if (!chunk) {
+        PyMem_Free(mem);
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+        goto error;
+    }
+    st->chunk = chunk;
+
+    if (_pg_stream_attach(st)) {
+        Mix_FreeChunk(chunk);
+        PyMem_Free(mem);
+        goto error;
+    }
+    self->chunk = chunk;
+    self->mem = mem;
+    self->stream = st;
+    return 0;
+
+error:
+    SDL_RWclose(st->rw);
+    _pg_stream_close(st);
+    return -1;
+}
+
+/* Find the samples of a WAV file in buf, which must be in the mixer's
+   format, or take all of buf as raw samples in the mixer's format */
+static int
+_sound_mapped_samples(const Uint8 *buf, size_t len, int raw, size_t *offset,
+                      size_t *size)
+{
+    size_t frame_size;
+    Uint16 format;
+    int channels, frequency, found = 0;
+
+    frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels;
+    if (raw) {
+        *offset = 0;
+        *size = len;
+    }
+    else {
+        found = _pg_wav_find(buf, len, &format, &channels, &frequency,
+                             offset, size);
+        if (found < 0) {
+            return -1;
+        }
+    }
+    if (!raw && (!found || format != mixer_format ||
+                 channels != mixer_channels ||
+                 frequency != mixer_frequency)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "mmap=True needs a WAV file in the mixer's format, "
+                        "use mmap='raw' for raw samples");
+        return -1;
+    }
+    *size -= *size % frame_size;
+    return 0;
+}
+
+/* Map a file read-only into memory with the mmap module. file is a path
+   or an object with a fileno() method. */
+static PyObject *
+_pg_mmap_file(PyObject *file)
+{
+    PyObject *module, *io, *fileobj = NULL, *fileno = NULL, *map = NULL;
+    PyObject *args = NULL, *kwargs = NULL, *result;
+
+    module = PyImport_ImportModule("mmap");
+    if (!module) {
+        return NULL;
+    }
+    if (PyUnicode_Check(file) || PyBytes_Check(file) ||
+        PyObject_HasAttrString(file, "__fspath__")) {
+        io = PyImport_ImportModule("io");
+        if (!io) {
+            goto end;
+        }
+        fileobj = PyObject_CallMethod(io, "open", "Os", file, "rb");
+        Py_DECREF(io);
+        if (!fileobj) {
+            goto end;
+        }
+    }
+    fileno = PyObject_CallMethod(fileobj ? fileobj : file, "fileno", NULL);
+    if (!fileno) {
+        goto end;
+    }
+    args = Py_BuildValue("(Oi)", fileno, 0);
+    kwargs = PyDict_New();
+    if (!args || !kwargs) {
+        goto end;
+    }
+    result = PyObject_GetAttrString(module, "ACCESS_READ");
+    if (!result || PyDict_SetItemString(kwargs, "access", result)) {
+        Py_XDECREF(result);
+        goto end;
+    }
+    Py_DECREF(result);
+    result = PyObject_GetAttrString(module, "mmap");
+    if (!result) {
+        goto end;
+    }
+    map = PyObject_Call(result, args, kwargs);
+    Py_DECREF(result);
+
+end:
+    /* the map holds on to the file by itself */
+    if (fileobj) {
+        result = PyObject_CallMethod(fileobj, "close", NULL);
+        if (!result) {
+            Py_CLEAR(map);
+        }
+        Py_XDECREF(result);
+        Py_DECREF(fileobj);
+    }
+    Py_XDECREF(fileno);
+    Py_XDECREF(args);
+    Py_XDECREF(kwargs);
+    Py_DECREF(module);
+    return map;
+}
+
+/* A view of the whole of a memory map, for a Sound to hold on to */
+static pg_buffer *
+_pg_map_view(PyObject *map, PyObject *consumer)
+{
+    pg_buffer *pg_view = PyMem_New(pg_buffer, 1);
+
+    if (!pg_view) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    pg_view->view.obj = 0;
+    pg_view->consumer = consumer;
+    pg_view->release_buffer = PyBuffer_Release;
+    if (PyObject_GetBuffer(map, (Py_buffer *)pg_view, PyBUF_SIMPLE)) {
+        PyMem_Free(pg_view);
+        return NULL;
+    }
+    return pg_view;
+}
+
+/* Play a Sound straight from a read-only memory map of a file, which
+   processes mapping the same file share the pages of */
+static int
+_sound_init_mmap(pgSoundObject *self, PyObject *file, int raw)
+{
+    PyObject *map;
+    pg_buffer *pg_view;
+    size_t offset, size;
+
+    map = _pg_mmap_file(file);
+    if (!map) {
+        return -1;
+    }
+    pg_view = _pg_map_view(map, (PyObject *)self);
+    Py_DECREF(map);
+    if (!pg_view) {
+        return -1;
+    }
+    if (_sound_mapped_samples((Uint8 *)pg_view->view.buf,
+                              (size_t)pg_view->view.len, raw, &offset,
+                              &size)) {
+        pgBuffer_Release(pg_view);
+        PyMem_Free(pg_view);
+        return -1;
+    }
+    return _chunk_from_view(self, pg_view,
+                            (Uint8 *)pg_view->view.buf + offset,
+                            (Py_ssize_t)size);
+}
+
+static int
+sound_init(PyObject *self, PyObject *arg, PyObject *kwarg)
+{
+    static const char arg_cnt_err_msg[] =
+        "Sound takes either 1 positional or 1 keyword argument";
+    PyObject *obj = NULL;
+    PyObject *file = NULL;
+    PyObject *buffer = NULL;
+    PyObject *array = NULL;
+    PyObject *keys;
+    PyObject *key;
+    PyObject *kencoded;
+    PyObject *option;
+    SDL_RWops *rw;
+    Mix_Chunk *chunk = NULL;
+    Uint8 *mem = NULL;
+    Py_ssize_t nkwargs = kwarg != NULL ? PyDict_Size(kwarg) : 0;
+    Py_ssize_t i;
+    int stream = 0;
+    int copy = 1;
+    int map = 0;
+
+    ((pgSoundObject *)self)->chunk = NULL;
+    ((pgSoundObject *)self)->mem = NULL;
+    ((pgSoundObject *)self)->stream = NULL;
+    ((pgSoundObject *)self)->view = NULL;
+    ((pgSoundObject *)self)->readonly = 0;
+
+    /* Similar to MIXER_INIT_CHECK(), but different return value. */
+    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
+        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
+        return -1;
+    }
+
+    /* The stream, copy and mmap options may accompany the source
+       argument */
+    if (kwarg != NULL &&
+        (option = PyDict_GetItemString(kwarg, "stream")) != NULL) {
+        stream = PyObject_IsTrue(option);
+        if (stream == -1) {
+            return -1;
+        }
+        --nkwargs;
+    }
+    if (kwarg != NULL &&
+        (option = PyDict_GetItemString(kwarg, "copy")) != NULL) {
+        copy = PyObject_IsTrue(option);
+        if (copy == -1) {
+            return -1;
+        }
+        --nkwargs;
+    }
+    if (kwarg != NULL &&
+        (option = PyDict_GetItemString(kwarg, "mmap")) != NULL) {
+        if (PyUnicode_Check(option)) {
+            if (PyUnicode_CompareWithASCIIString(option, "raw")) {
+                PyErr_SetString(PyExc_ValueError,
+                                "mmap must be True, False or 'raw'");
+                return -1;
+            }
+            map = 2;
+        }
+        else if ((map = PyObject_IsTrue(option)) == -1) {
+            return -1;
+        }
+        --nkwargs;
+    }
+
+    /* Process arguments, returning cleaner error messages than
+       PyArg_ParseTupleAndKeywords would.
+    */
+    if (arg != NULL && PyTuple_GET_SIZE(arg)) {
+        if (nkwargs || /* conditional or */
+            PyTuple_GET_SIZE(arg) != 1) {
+            PyErr_SetString(PyExc_TypeError, arg_cnt_err_msg);
+            return -1;
+        }
+        obj = PyTuple_GET_ITEM(arg, 0);
+
+        if (PyUnicode_Check(obj) ||
+            PyObject_HasAttrString(obj, "__fspath__")) {
+            file = obj;
+            obj = NULL;
+        }
+        else {
+            file = obj;
+            buffer = obj;
+        }
+    }
+    else if (nkwargs) {
+        if (nkwargs != 1) {
+            PyErr_SetString(PyExc_TypeError, arg_cnt_err_msg);
+            return -1;
+        }
+        if ((file = PyDict_GetItemString(kwarg, "file")) == NULL &&
+            (buffer = PyDict_GetItemString(kwarg, "buffer")) == NULL &&
+            (array = PyDict_GetItemString(kwarg, "array")) == NULL) {
+            keys = PyDict_Keys(kwarg);
+            if (keys == NULL) {
+                return -1;
+            }
+            key = NULL;
+            for (i = 0; i < PyList_GET_SIZE(keys); ++i) {
+                key = PyList_GET_ITEM(keys, i);
+                if (!PyUnicode_Check(key) ||
+                    (PyUnicode_CompareWithASCIIString(key, "stream") &&
+                     PyUnicode_CompareWithASCIIString(key, "copy") &&
+                     PyUnicode_CompareWithASCIIString(key, "mmap"))) {
+                    break;
+                }
+            }
+            kencoded = pg_EncodeString(key, NULL, NULL, NULL);
+            Py_DECREF(keys);
+            if (kencoded == NULL) {
+                return -1;
+            }
+            PyErr_Format(PyExc_TypeError,
+                         "Unrecognized keyword argument '%.1024s'",
+                         PyBytes_AS_STRING(kencoded));
+            Py_DECREF(kencoded);
+            return -1;
+        }
+        if (buffer != NULL && PyUnicode_Check(buffer)) { /* conditional and */
+            PyErr_SetString(PyExc_TypeError,
+                            "Unicode object not allowed as buffer object");
+            return -1;
+        }
+    }
+    else {
+        PyErr_SetString(PyExc_TypeError, arg_cnt_err_msg);
+        return -1;
+    }
+
+    if (stream && map) {
+        PyErr_SetString(PyExc_TypeError,
+                        "stream=True and mmap=True can't be combined");
+        return -1;
+    }
+    if (stream) {
+        /* a buffer is not a file, even if pgRWops_FromObject() would take
+           a path from it */
+        if (file == NULL ||
+            (obj != NULL && PyObject_CheckBuffer(obj) &&
+             !PyObject_HasAttrString(obj, "read"))) {
+            PyErr_SetString(PyExc_TypeError,
+                            "stream=True requires a file to stream from");
+            return -1;
+        }
+        rw = pgRWops_FromObject(file, NULL);
+        if (rw == NULL) {
+            return -1;
+        }
+        return _sound_init_stream((pgSoundObject *)self, rw);
+    }
+
+    if (map) {
+        if (file == NULL) {
+            PyErr_SetString(PyExc_TypeError,
+                            "mmap=True requires a file to map");
+            return -1;
+        }
+        return _sound_init_mmap((pgSoundObject *)self, file, map == 2);
+    }
+
+    if (!copy && ((buffer == NULL && array == NULL) ||
+                  (obj != NULL && !PyObject_CheckBuffer(obj)))) {
+        PyErr_SetString(PyExc_TypeError,
+                        "copy=False requires a buffer or array to share");
+        return -1;
+    }
+
+    if (file != NULL && copy) {
+        rw = pgRWops_FromObject(file, NULL);
+
+        if (rw == NULL) {
+            if (obj) {
+                /* use 'buffer' as fallback for single arg */
+                PyErr_Clear();
+                goto LOAD_BUFFER;
+            }
+            return -1;
+        }
+        Py_BEGIN_ALLOW_THREADS;
+        chunk = Mix_LoadWAV_RW(rw, 1);
+        Py_END_ALLOW_THREADS;
+        if (chunk == NULL) {
+            PyErr_SetString(pgExc_SDLError, SDL_GetError());
+            return -1;
+        }
+    }
+
+LOAD_BUFFER:
+
+    if (!chunk && buffer && !copy) {
+        pg_buffer *pg_view = PyMem_New(pg_buffer, 1);
+
+        if (!pg_view) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        pg_view->view.obj = 0;
+        pg_view->consumer = self;
+        pg_view->release_buffer = PyBuffer_Release;
+        if (PyObject_GetBuffer(buffer, (Py_buffer *)pg_view, PyBUF_SIMPLE)) {
+            PyMem_Free(pg_view);
+            if (obj != NULL) {
+                PyErr_Clear();
+            }
+            else {
+                PyErr_Format(PyExc_TypeError,
+                             "Expected object with buffer interface: got a %s",
+                             Py_TYPE(buffer)->tp_name);
+                return -1;
+            }
+        }
+        else {
+            if (_chunk_from_view((pgSoundObject *)self, pg_view,
+                                 (Uint8 *)pg_view->view.buf,
+                                 pg_view->view.len)) {
+                return -1;
+            }
+            chunk = ((pgSoundObject *)self)->chunk;
+        }
+    }
+
+    if (!chunk && buffer && copy) {
+        Py_buffer view;
+        int rcode;
+
+        view.obj = 0;
+        if (PyObject_GetBuffer(buffer, &view, PyBUF_SIMPLE)) {
+            if (obj != NULL) {
+                PyErr_Clear();
+            }
+            else {
+                PyErr_Format(PyExc_TypeError,
+                             "Expected object with buffer interface: got a %s",
+                             Py_TYPE(buffer)->tp_name);
+                return -1;
+            }
+        }
+        else {
+            rcode = _chunk_from_buf(view.buf, view.len, &chunk, &mem);
+            PyBuffer_Release(&view);
+            if (rcode) {
+                return -1;
+            }
+            ((pgSoundObject *)self)->mem = mem;
+        }
+    }
+
+    if (array != NULL && !copy) {
+        pg_buffer *pg_view = PyMem_New(pg_buffer, 1);
+        PG_sample_format_t view_format;
+
+        if (!pg_view) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        pg_view->view.itemsize = 0;
+        pg_view->view.obj = 0;
+        if (pgObject_GetBuffer(array, pg_view, PyBUF_FORMAT | PyBUF_ND)) {
+            PyMem_Free(pg_view);
+            return -1;
+        }
+        view_format = _format_view_to_audio((Py_buffer *)pg_view);
+        if (!view_format ||
+            _array_matches_mixer((Py_buffer *)pg_view, view_format)) {
+            pgBuffer_Release(pg_view);
+            PyMem_Free(pg_view);
+            return -1;
+        }
+        if (_chunk_from_view((pgSoundObject *)self, pg_view,
+                             (Uint8 *)pg_view->view.buf,
+                             pg_view->view.len)) {
+            return -1;
+        }
+        chunk = ((pgSoundObject *)self)->chunk;
+    }
+    else if (array != NULL) {
+        pg_buffer pg_view;
+        PG_sample_format_t view_format;
+        int rcode;
+
+        pg_view.view.itemsize = 0;
+        pg_view.view.obj = 0;
+        if (pgObject_GetBuffer(array, &pg_view, PyBUF_FORMAT | PyBUF_ND)) {
+            return -1;
+        }
+        view_format = _format_view_to_audio((Py_buffer *)&pg_view);
+        if (!view_format) {
+            pgBuffer_Release(&pg_view);
+            return -1;
+        }
+        rcode = _chunk_from_array(pg_view.view.buf, view_format,
+                                  pg_view.view.ndim, pg_view.view.shape,
+                                  pg_view.view.strides, &chunk, &mem);
+        pgBuffer_Release(&pg_view);
+        if (rcode) {
+            return -1;
+        }
+        ((pgSoundObject *)self)->mem = mem;
+    }
+
+    if (chunk == NULL) {
+        if (obj == NULL) {
+            PyErr_SetString(PyExc_TypeError, "Unrecognized argument");
+        }
+        else {
+            PyErr_Format(PyExc_TypeError, "Unrecognized argument (type %s)",
+                         Py_TYPE(obj)->tp_name);
+        }
+        return -1;
+    }
+
+    ((pgSoundObject *)self)->chunk = chunk;
+    return 0;
+}
+
+static PyObject *
+mixer_resample_buffer(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    Py_buffer view;
+    PyObject *bytes;
+    Py_ssize_t len;
+    Uint8 *mem;
+    int rate, freq, channels;
+    int new_rate = 0;
+    int quality = PG_RESAMPLE_MEDIUM;
+    Uint16 format;
+    static char *kwids[] = {"buffer", "rate", "new_rate", "quality", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*i|ii", kwids, &view,
+                                     &rate, &new_rate, &quality)) {
+        return NULL;
+    }
+    if (!Mix_QuerySpec(&freq, &format, &channels)) {
+        PyBuffer_Release(&view);
+        return RAISE(pgExc_SDLError, "mixer not initialized");
+    }
+    if (!new_rate) {
+        new_rate = freq;
+    }
+
+    mem = _resample_samples((const Uint8 *)view.buf, view.len, rate,
+                            new_rate, quality, &len);
+    PyBuffer_Release(&view);
+    if (!mem) {
+        return NULL;
+    }
+    bytes = PyBytes_FromStringAndSize((const char *)mem, len);
+    PyMem_Free(mem);
+    return bytes;
+}
+
+/* Sound banks pack many clips into one file: a header, an index of the
+   clips, then each clip as a WAV file, PCM or IMA ADPCM, 4 byte aligned.
+   All numbers are little endian.
+
+     0   "PGSB"
+     4   u32 version, 1
+     8   u32 number of clips
+     12  u32 size of the index
+     16  the index, for each clip: u32 offset and u32 size of its WAV file,
+         u16 length of its name, and the name in UTF-8 */
+#define PG_BANK_HEADER 16
+#define PG_BANK_VERSION 1
+#define PG_BANK_ENTRY 10     /* bytes of an index entry, before the name */
+#define PG_ADPCM_BLOCK 512   /* bytes of a block, for each channel */
+#define PG_ADPCM_HEADER 60   /* bytes of the WAV header we write */
+#define PG_BANK_ALIGN(n) (((n) + 3) & ~(size_t)3)
+
+typedef struct {
+    PyObject_HEAD Py_buffer view; /* of the whole file */
+    PyObject *map;
+    PyObject *index; /* name: (offset, size) */
+    PyObject *names; /* tuple, in the order of the file */
+} pgSoundBankObject;
+
+static int
+bank_init(pgSoundBankObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *file, *name, *entry;
+    const Uint8 *buf;
+    size_t len, pos, end, offset, size, name_len;
+    Uint32 count, i;
+
+    static char *keywords[] = {"file", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &file)) {
+        return -1;
+    }
+    if (self->map) {
+        PyErr_SetString(pgExc_SDLError, "SoundBank is already open");
+        return -1;
+    }
+    self->map = _pg_mmap_file(file);
+    if (!self->map ||
+        PyObject_GetBuffer(self->map, &self->view, PyBUF_SIMPLE)) {
+        return -1;
+    }
+    buf = (const Uint8 *)self->view.buf;
+    len = (size_t)self->view.len;
+    if (len < PG_BANK_HEADER || memcmp(buf, "PGSB", 4)) {
+        PyErr_SetString(PyExc_ValueError, "not a sound bank");
+        return -1;
+    }
+    if (_pg_get_le(buf + 4, 4) != PG_BANK_VERSION) {
+        PyErr_Format(PyExc_ValueError, "unsupported sound bank version %u",
+                     (unsigned int)_pg_get_le(buf + 4, 4));
+        return -1;
+    }
+    count = _pg_get_le(buf + 8, 4);
+    end = PG_BANK_HEADER + (size_t)_pg_get_le(buf + 12, 4);
+    if (end > len || (size_t)count * PG_BANK_ENTRY > end - PG_BANK_HEADER) {
+        goto broken;
+    }
+
+    self->index = PyDict_New();
+    self->names = PyTuple_New(count);
+    if (!self->index || !self->names) {
+        return -1;
+    }
+    pos = PG_BANK_HEADER;
+    for (i = 0; i < count; i++) {
+        if (pos + PG_BANK_ENTRY > end) {
+            goto broken;
+        }
+        offset = _pg_get_le(buf + pos, 4);
+        size = _pg_get_le(buf + pos + 4, 4);
+        name_len = _pg_get_le(buf + pos + 8, 2);
+        pos += PG_BANK_ENTRY;
+        if (name_len > end - pos || offset > len || size > len - offset) {
+            goto broken;
+        }
+        name = PyUnicode_DecodeUTF8((const char *)buf + pos,
+                                    (Py_ssize_t)name_len, NULL);
+        if (!name) {
+            return -1;
+        }
+        PyTuple_SET_ITEM(self->names, i, name);
+        pos += name_len;
+        entry = Py_BuildValue("(nn)", (Py_ssize_t)offset, (Py_ssize_t)size);
+        if (!entry || PyDict_SetItem(self->index, name, entry)) {
+            Py_XDECREF(entry);
+            return -1;
+        }
+        Py_DECREF(entry);
+    }
+    return 0;
+
+broken:
+    PyErr_SetString(PyExc_ValueError, "the sound bank is broken");
+    return -1;
+}
+
+static void
+bank_dealloc(pgSoundBankObject *self)
+{
+    if (self->view.obj) {
+        PyBuffer_Release(&self->view);
+    }
+    Py_XDECREF(self->map);
+    Py_XDECREF(self->index);
+    Py_XDECREF(self->names);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+#define CHECK_BANK_VALID(BANK)                                           \
+    if (!((pgSoundBankObject *)(BANK))->names) {                         \
+        return RAISE(PyExc_RuntimeError,                                 \
+                     "__init__() was not called on SoundBank object so " \
+                     "it failed to setup correctly.");                   \
     }
-    return pgChannel_New(chan);
-}
 
+/* A Sound of a clip, which plays straight from the map when it is PCM in
+   the mixer's format, and is decoded by SDL otherwise */
 static PyObject *
-mixer_set_soundfont(PyObject *self, PyObject *args)
+bank_load(PyObject *self, PyObject *name)
 {
-    int paths_set;
-    PyObject *path = Py_None;
-    const char *string_path = "";
-
-    if (!PyArg_ParseTuple(args, "|O", &path)) {
-        return NULL;
-    }
+    pgSoundBankObject *bank = (pgSoundBankObject *)self;
+    PyObject *entry, *sound;
+    pg_buffer *pg_view;
+    Mix_Chunk *chunk;
+    SDL_RWops *rw;
+    const Uint8 *clip;
+    size_t size, offset, len, frame_size;
+    Uint16 format;
+    int channels, frequency, found;
 
+    CHECK_BANK_VALID(self);
     MIXER_INIT_CHECK();
 
-    if (PyUnicode_Check(path)) {
-        string_path = PyUnicode_AsUTF8(path);
-    }
-    else if (!Py_IsNone(path)) {
-        return RAISE(PyExc_TypeError,
-                     "Must pass string or None to set_soundfont");
+    entry = PyDict_GetItemWithError(bank->index, name);
+    if (!entry) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetObject(PyExc_KeyError, name);
+        }
+        return NULL;
     }
+    clip = (const Uint8 *)bank->view.buf +
+           PyLong_AsSsize_t(PyTuple_GET_ITEM(entry, 0));
+    size = (size_t)PyLong_AsSsize_t(PyTuple_GET_ITEM(entry, 1));
 
-    if (strlen(string_path) == 0) {
-        paths_set = Mix_SetSoundFonts(NULL);
+    found = _pg_wav_find(clip, size, &format, &channels, &frequency,
+                         &offset, &len);
+    if (found < 0) {
+        return NULL;
     }
-    else {
-        paths_set = Mix_SetSoundFonts(string_path);
+    if (found && format == mixer_format && channels == mixer_channels &&
+        frequency == mixer_frequency) {
+        sound = pgSound_Type.tp_new(&pgSound_Type, NULL, NULL);
+        if (!sound) {
+            return NULL;
+        }
+        pg_view = _pg_map_view(bank->map, sound);
+        frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels;
+        if (!pg_view ||
+            _chunk_from_view((pgSoundObject *)sound, pg_view,
+                             (Uint8 *)clip + offset,
+                             (Py_ssize_t)(len - len % frame_size))) {
+            Py_DECREF(sound);
+            return NULL;
+        }
+        return sound;
     }
 
-    if (paths_set == 0) {
+    rw = SDL_RWFromConstMem(clip, (int)size);
+    if (!rw) {
         return RAISE(pgExc_SDLError, SDL_GetError());
     }
-
-    Py_RETURN_NONE;
+    Py_BEGIN_ALLOW_THREADS;
+    chunk = Mix_LoadWAV_RW(rw, 1);
+    Py_END_ALLOW_THREADS;
+    if (!chunk) {
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    return pgSound_New(chunk);
 }
 
 static PyObject *
-mixer_get_soundfont(PyObject *self, PyObject *_null)
+bank_play(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    const char *paths;
-
-    MIXER_INIT_CHECK();
+    PyObject *name, *sound, *channel;
+    int loops = 0, maxtime = 0, fade_ms = 0;
 
-    paths = Mix_GetSoundFonts();
-
-    if (paths) {
-        return PyUnicode_FromString(paths);
+    static char *keywords[] = {"name", "loops", "maxtime", "fade_ms", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|iii", keywords, &name,
+                                     &loops, &maxtime, &fade_ms)) {
+        return NULL;
     }
-
-    Py_RETURN_NONE;
+    /* the Channel holds on to the Sound until it ends */
+    sound = bank_load(self, name);
+    if (!sound) {
+        return NULL;
+    }
+    channel = PyObject_CallMethod(sound, "play", "iii", loops, maxtime,
+                                  fade_ms);
+    Py_DECREF(sound);
+    return channel;
 }
 
 static PyObject *
-mixer_fadeout(PyObject *self, PyObject *args)
+bank_get_names(PyObject *self, PyObject *_null)
 {
-    int _time;
-    if (!PyArg_ParseTuple(args, "i", &_time))
-        return NULL;
+    CHECK_BANK_VALID(self);
+    Py_INCREF(((pgSoundBankObject *)self)->names);
+    return ((pgSoundBankObject *)self)->names;
+}
 
-    MIXER_INIT_CHECK();
+static Py_ssize_t
+bank_len(PyObject *self)
+{
+    PyObject *names = ((pgSoundBankObject *)self)->names;
 
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_FadeOutChannel(-1, _time);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+    return names ? PyTuple_GET_SIZE(names) : 0;
 }
 
-static PyObject *
-mixer_stop(PyObject *self, PyObject *_null)
+static int
+bank_contains(PyObject *self, PyObject *name)
 {
-    MIXER_INIT_CHECK();
+    PyObject *index = ((pgSoundBankObject *)self)->index;
 
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_HaltChannel(-1);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+    return index ? PyDict_Contains(index, name) : 0;
 }
 
+static PyMethodDef bank_methods[] = {
+    {"load", bank_load, METH_O, DOC_MIXER_SOUNDBANK_LOAD},
+    {"play", (PyCFunction)bank_play, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_SOUNDBANK_PLAY},
+    {"get_names", bank_get_names, METH_NOARGS, DOC_MIXER_SOUNDBANK_GETNAMES},
+    {NULL, NULL, 0, NULL}};
+
+static PySequenceMethods bank_as_sequence = {
+    .sq_length = bank_len,
+    .sq_contains = bank_contains,
+};
+
+static PyTypeObject pgSoundBank_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.SoundBank",
+    .tp_basicsize = sizeof(pgSoundBankObject),
+    .tp_dealloc = (destructor)bank_dealloc,
+    .tp_as_sequence = &bank_as_sequence,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_SOUNDBANK,
+    .tp_methods = bank_methods,
+    .tp_init = (initproc)bank_init,
+    .tp_new = PyType_GenericNew,
+};
+
+/* A clip as a PCM WAV file in the mixer's format */
 static PyObject *
-mixer_pause(PyObject *self, PyObject *_null)
+_pg_bank_pcm(Mix_Chunk *chunk)
 {
-    MIXER_INIT_CHECK();
+    PyObject *bytes;
+    Uint8 *buf;
 
-    Mix_Pause(-1);
-    Py_RETURN_NONE;
+    bytes = PyBytes_FromStringAndSize(NULL, PG_WAV_HEADER + chunk->alen);
+    if (!bytes) {
+        return NULL;
+    }
+    buf = (Uint8 *)PyBytes_AS_STRING(bytes);
+    _pg_wav_header(buf, chunk->alen);
+    memcpy(buf + PG_WAV_HEADER, chunk->abuf, chunk->alen);
+    _pg_wav_samples(buf + PG_WAV_HEADER, chunk->alen);
+    return bytes;
 }
 
+/* A clip as an IMA ADPCM WAV file, a quarter of 16 bit PCM */
 static PyObject *
-mixer_unpause(PyObject *self, PyObject *_null)
+_pg_bank_adpcm(Mix_Chunk *chunk)
 {
-    MIXER_INIT_CHECK();
+    PyObject *bytes = NULL;
+    float *floats;
+    Sint16 *samples;
+    Uint8 *buf;
+    int block_align = PG_ADPCM_BLOCK * mixer_channels;
+    int block_frames = pg_adpcm_block_frames(block_align, mixer_channels);
+    size_t frame_size = SDL_AUDIO_BITSIZE(mixer_format) / 8 * mixer_channels;
+    size_t frames = chunk->alen / frame_size;
+    size_t n = frames * mixer_channels, size;
+
+    size = pg_adpcm_size(frames, mixer_channels, block_align);
+    floats = PyMem_New(float, n);
+    samples = PyMem_New(Sint16, n);
+    if (!floats || !samples) {
+        PyErr_NoMemory();
+        goto end;
+    }
+    pg_audio_to_f32(chunk->abuf, mixer_type, floats, n);
+    pg_audio_from_f32(floats, samples, _format_audio_type(AUDIO_S16SYS), n);
 
-    Py_BEGIN_ALLOW_THREADS;
-    Mix_Resume(-1);
-    Py_END_ALLOW_THREADS;
-    Py_RETURN_NONE;
+    bytes = PyBytes_FromStringAndSize(NULL, PG_ADPCM_HEADER + size);
+    if (!bytes) {
+        goto end;
+    }
+    buf = (Uint8 *)PyBytes_AS_STRING(bytes);
+    memcpy(buf, "RIFF", 4);
+    _pg_put_le(buf + 4, (Uint32)(PG_ADPCM_HEADER - 8 + size), 4);
+    memcpy(buf + 8, "WAVEfmt ", 8);
+    _pg_put_le(buf + 16, 20, 4);
+    _pg_put_le(buf + 20, 0x11, 2);
+    _pg_put_le(buf + 22, mixer_channels, 2);
+    _pg_put_le(buf + 24, mixer_frequency, 4);
+    _pg_put_le(buf + 28,
+               (Uint32)((Uint64)mixer_frequency * block_align / block_frames),
+               4);
+    _pg_put_le(buf + 32, block_align, 2);
+    _pg_put_le(buf + 34, 4, 2);
+    _pg_put_le(buf + 36, 2, 2);
+    _pg_put_le(buf + 38, block_frames, 2);
+    memcpy(buf + 40, "fact", 4);
+    _pg_put_le(buf + 44, 4, 4);
+    _pg_put_le(buf + 48, (Uint32)frames, 4);
+    memcpy(buf + 52, "data", 4);
+    _pg_put_le(buf + 56, (Uint32)size, 4);
+    pg_adpcm_encode(samples, frames, mixer_channels, block_align,
+                    buf + PG_ADPCM_HEADER);
+
+end:
+    PyMem_Free(floats);
+    PyMem_Free(samples);
+    return bytes;
 }
 
-/* Function to get the SDL mixer version data (linked or compiled).
- *
- * Ref:
- * https://www.libsdl.org/projects/SDL_mixer/docs/SDL_mixer_8.html#SEC8
- */
 static PyObject *
-mixer_get_sdl_mixer_version(PyObject *self, PyObject *args, PyObject *kwargs)
+write_sound_bank(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    int linked = 1; /* Default is linked version. */
+    PyObject *file, *sounds, *items = NULL, *seq = NULL, *pair = NULL;
+    PyObject *clips = NULL, *order = NULL, *name, *sound, *data;
+    Uint8 header[PG_BANK_HEADER], entry[PG_BANK_ENTRY];
+    static const Uint8 padding[4] = {0, 0, 0, 0};
+    SDL_RWops *rw = NULL;
+    size_t index_size = 0, pos, size;
+    Py_ssize_t i, n;
+    int adpcm = 0, failed = 0;
+
+    static char *keywords[] = {"file", "sounds", "adpcm", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|p", keywords, &file,
+                                     &sounds, &adpcm)) {
+        return NULL;
+    }
+    MIXER_INIT_CHECK();
 
-    static char *keywords[] = {"linked", NULL};
+    if (PyDict_Check(sounds)) {
+        items = PyDict_Items(sounds);
+    }
+    else if (PyObject_HasAttrString(sounds, "items")) {
+        items = PyObject_CallMethod(sounds, "items", NULL);
+    }
+    else {
+        items = sounds;
+        Py_INCREF(items);
+    }
+    if (!items) {
+        return NULL;
+    }
+    seq = PySequence_Fast(items, "sounds must be a mapping of names to "
+                                 "Sounds, or (name, Sound) pairs");
+    Py_DECREF(items);
+    if (!seq) {
+        return NULL;
+    }
+    n = PySequence_Fast_GET_SIZE(seq);
+    clips = PyDict_New();
+    order = PyList_New(0);
+    if (!clips || !order) {
+        goto end;
+    }
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", keywords, &linked)) {
-        return NULL; /* Exception already set. */
+    for (i = 0; i < n; i++) {
+        pair = PySequence_Tuple(PySequence_Fast_GET_ITEM(seq, i));
+        if (!pair) {
+            goto end;
+        }
+        if (PyTuple_GET_SIZE(pair) != 2 ||
+            !PyUnicode_Check(PyTuple_GET_ITEM(pair, 0)) ||
+            !pgSound_Check(PyTuple_GET_ITEM(pair, 1))) {
+            PyErr_SetString(PyExc_TypeError,
+                            "sounds must be a mapping of names to Sounds, "
+                            "or (name, Sound) pairs");
+            goto end;
+        }
+        sound = PyTuple_GET_ITEM(pair, 1);
+        if (!pgSound_AsChunk(sound)) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "__init__() was not called on Sound object so "
+                            "it failed to setup correctly.");
+            goto end;
+        }
+        if (((pgSoundObject *)sound)->stream) {
+            PyErr_SetString(PyExc_TypeError,
+                            "a streaming Sound can't go in a sound bank");
+            goto end;
+        }
+        name = PyUnicode_AsUTF8String(PyTuple_GET_ITEM(pair, 0));
+        if (!name) {
+            goto end;
+        }
+        if (PyBytes_GET_SIZE(name) > 0xFFFF ||
+            PyDict_GetItem(clips, name)) {
+            PyErr_Format(PyExc_ValueError, "invalid or repeated name %R",
+                         PyTuple_GET_ITEM(pair, 0));
+            Py_DECREF(name);
+            goto end;
+        }
+        index_size += PG_BANK_ENTRY + PyBytes_GET_SIZE(name);
+        data = adpcm && pgSound_AsChunk(sound)->alen
+                   ? _pg_bank_adpcm(pgSound_AsChunk(sound))
+                   : _pg_bank_pcm(pgSound_AsChunk(sound));
+        if (!data || PyDict_SetItem(clips, name, data) ||
+            PyList_Append(order, name)) {
+            Py_XDECREF(data);
+            Py_DECREF(name);
+            goto end;
+        }
+        Py_DECREF(data);
+        Py_DECREF(name);
+        Py_CLEAR(pair);
     }
 
-    /* MIXER_INIT_CHECK() is not required for these methods. */
+    /* where the clips go */
+    pos = PG_BANK_ALIGN(PG_BANK_HEADER + index_size);
+    for (i = 0; i < n; i++) {
+        data = PyDict_GetItem(clips, PyList_GET_ITEM(order, i));
+        pos = PG_BANK_ALIGN(pos + PyBytes_GET_SIZE(data));
+    }
+    if (pos > SDL_MAX_UINT32) {
+        PyErr_SetString(PyExc_ValueError, "too much sound for a sound bank");
+        goto end;
+    }
 
-    if (linked) {
-        /* linked version */
-        const SDL_version *v = Mix_Linked_Version();
-        return Py_BuildValue("iii", v->major, v->minor, v->patch);
+    rw = _pg_rw_for_writing(file);
+    if (!rw) {
+        goto end;
     }
-    else {
-        /* compiled version */
-        SDL_version v;
-        SDL_MIXER_VERSION(&v);
-        return Py_BuildValue("iii", v.major, v.minor, v.patch);
+    memcpy(header, "PGSB", 4);
+    _pg_put_le(header + 4, PG_BANK_VERSION, 4);
+    _pg_put_le(header + 8, (Uint32)n, 4);
+    _pg_put_le(header + 12, (Uint32)index_size, 4);
+    failed = SDL_RWwrite(rw, header, sizeof(header), 1) != 1;
+
+    pos = PG_BANK_ALIGN(PG_BANK_HEADER + index_size);
+    for (i = 0; i < n && !failed; i++) {
+        name = PyList_GET_ITEM(order, i);
+        size = PyBytes_GET_SIZE(PyDict_GetItem(clips, name));
+        _pg_put_le(entry, (Uint32)pos, 4);
+        _pg_put_le(entry + 4, (Uint32)size, 4);
+        _pg_put_le(entry + 8, (Uint32)PyBytes_GET_SIZE(name), 2);
+        failed = SDL_RWwrite(rw, entry, sizeof(entry), 1) != 1 ||
+                 (PyBytes_GET_SIZE(name) &&
+                  SDL_RWwrite(rw, PyBytes_AS_STRING(name),
+                              PyBytes_GET_SIZE(name), 1) != 1);
+        pos = PG_BANK_ALIGN(pos + size);
+    }
+
+    pos = PG_BANK_HEADER + index_size;
+    for (i = 0; i < n && !failed; i++) {
+        data = PyDict_GetItem(clips, PyList_GET_ITEM(order, i));
+        size = PG_BANK_ALIGN(pos) - pos;
+        failed = (size && SDL_RWwrite(rw, padding, size, 1) != 1) ||
+                 SDL_RWwrite(rw, PyBytes_AS_STRING(data),
+                             PyBytes_GET_SIZE(data), 1) != 1;
+        pos = PG_BANK_ALIGN(pos) + PyBytes_GET_SIZE(data);
+    }
+
+end:
+    if (rw && SDL_RWclose(rw)) {
+        failed = 1;
     }
+    if (failed && !PyErr_Occurred()) {
+        PyErr_SetString(pgExc_SDLError, SDL_GetError());
+    }
+    Py_XDECREF(pair);
+    Py_XDECREF(clips);
+    Py_XDECREF(order);
+    Py_DECREF(seq);
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
 }
 
+/* Music streams.
+
+   A MusicStream is a streamed Sound with a volume of its own, which fades
+   in the audio thread on the exact frame. It plays on a channel like any
+   other Sound, so any number of them mix together, through the channel
+   effects and buses. play_streams() starts a group of them on the same
+   frame of the sample clock, which their channel effects keep them locked
+   to even when they get to play late.
+*/
+#define PG_STREAMS_AHEAD 2 /* callbacks play_streams() starts ahead */
+
+typedef struct {
+    PyObject_HEAD PyObject *sound; /* a streamed Sound */
+    float volume;
+} pgMusicStreamObject;
+
 static int
-_chunk_from_buf(const void *buf, Py_ssize_t len, Mix_Chunk **chunk,
-                Uint8 **mem)
+mstream_init(pgMusicStreamObject *self, PyObject *args, PyObject *kwargs)
 {
-    Uint8 *m = (Uint8 *)PyMem_Malloc((size_t)len);
+    PyObject *file, *sound_args, *sound_kwargs;
 
-    if (!m) {
-        PyErr_NoMemory();
+    static char *keywords[] = {"file", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &file)) {
         return -1;
     }
-    *chunk = Mix_QuickLoad_RAW(m, (Uint32)len);
-    if (!*chunk) {
-        PyMem_Free(m);
-        PyErr_NoMemory();
+    if (self->sound) {
+        PyErr_SetString(pgExc_SDLError, "MusicStream is already open");
         return -1;
     }
-    memcpy(m, (Uint8 *)buf, (size_t)len);
-    *mem = m;
-    return 0;
+    sound_args = PyTuple_Pack(1, file);
+    sound_kwargs = Py_BuildValue("{s:O}", "stream", Py_True);
+    if (sound_args && sound_kwargs) {
+        self->sound = PyObject_Call((PyObject *)&pgSound_Type, sound_args,
+                                    sound_kwargs);
+    }
+    Py_XDECREF(sound_args);
+    Py_XDECREF(sound_kwargs);
+    self->volume = 1.0f;
+    return self->sound ? 0 : -1;
 }
 
-static int
-_chunk_from_array(void *buf, PG_sample_format_t view_format, int ndim,
-                  Py_ssize_t *shape, Py_ssize_t *strides, Mix_Chunk **chunk,
-                  Uint8 **mem)
+static void
+mstream_dealloc(pgMusicStreamObject *self)
 {
-    /* TODO: This is taken from _numericsndarray without additions.
-     * So this should be extended to properly handle integer sign
-     * and byte order. These changes will not be backward compatible.
-     */
-    int freq;
-    Uint16 format;
-    int channels;
-    int itemsize;
-    int view_itemsize = PG_SAMPLE_SIZE(view_format);
-    Uint8 *src, *dst;
-    Py_ssize_t memsize;
-    Py_ssize_t loop1, loop2, step1, step2, length, length2 = 0;
+    Py_XDECREF(self->sound);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
 
-    if (!Mix_QuerySpec(&freq, &format, &channels)) {
-        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
-        return -1;
+#define CHECK_MSTREAM_VALID(MSTREAM)                                       \
+    if (!((pgMusicStreamObject *)(MSTREAM))->sound) {                      \
+        return RAISE(PyExc_RuntimeError,                                   \
+                     "__init__() was not called on MusicStream object so " \
+                     "it failed to setup correctly.");                     \
     }
 
-    /* Check for compatible values.
-     */
-    if (channels == 1) {
-        if (ndim != 1) {
-            PyErr_SetString(PyExc_ValueError,
-                            "Array must be 1-dimensional for mono mixer");
-            return -1;
-        }
-    }
-    else {
-        if (ndim != 2) {
-            PyErr_SetString(PyExc_ValueError,
-                            "Array must be 2-dimensional for stereo mixer");
-            return -1;
-        }
-        if (shape[1] != channels) {
-            PyErr_SetString(PyExc_ValueError,
-                            "Array depth must match number of mixer channels");
-            return -1;
-        }
-    }
-    itemsize = _format_itemsize(format);
-    /*
-    printf("!! itemsize: %d\n", itemsize);
-    */
-    if (itemsize < 0) {
-        return -1;
-    }
-    if (view_itemsize != 1 && view_itemsize != 2 && view_itemsize != 4) {
-        PyErr_Format(PyExc_ValueError, "Unsupported integer size %d",
-                     view_itemsize);
+#define PG_MSTREAM_STREAM(self) \
+    (((pgSoundObject *)((pgMusicStreamObject *)(self))->sound)->stream)
+
+static Uint32
+_pg_mstream_fade(int fade_ms)
+{
+    return fade_ms > 0 ? (Uint32)((Sint64)fade_ms * mixer_frequency / 1000)
+                       : 0;
+}
+
+/* Start a music stream on a free channel at frame at of the sample clock,
+   or right away if 0. Returns the channel, or -1 with an exception set. */
+static int
+_pg_mstream_start(pgMusicStreamObject *self, int loops, int fade_ms,
+                  Uint64 at)
+{
+    pgSoundStream *st = PG_MSTREAM_STREAM(self);
+    int channel, started = -1;
+    Uint32 fade = _pg_mstream_fade(fade_ms);
+
+    if (_pg_stream_ready((pgSoundObject *)self->sound)) {
         return -1;
     }
-    length = shape[0];
-    step1 = strides ? strides[0] : (Py_ssize_t)view_itemsize * channels;
-    length2 = ndim;
-    if (ndim == 2) {
-        step2 = strides ? strides[1] : view_itemsize;
-    }
-    else {
-        step2 = step1;
+    Py_BEGIN_ALLOW_THREADS;
+    /* stopped first, so the gain is only taken up by the new playback */
+    _pg_halt_group((int)(intptr_t)st->chunk);
+    _pg_stream_gain(st, fade ? 0.0f : self->volume, self->volume, fade);
+    channel = _pg_channel_find_free();
+    if (channel != -1) {
+        _pg_channel_open(channel);
+        _pg_bus_attach(channel);
+        started = _pg_stream_start(st, channel, loops, -1, 0, at);
+        if (started == -1) {
+            _pg_channel_close(channel);
+        }
     }
-    memsize = length * channels * itemsize;
-    /*
-    printf("memsize: %d\n", (int)memsize);
-    */
-
-    /* Create chunk.
-     */
-    dst = (Uint8 *)PyMem_Malloc((size_t)memsize);
-    if (!dst) {
-        PyErr_NoMemory();
+    Py_END_ALLOW_THREADS;
+    if (channel == -1) {
+        PyErr_SetString(pgExc_SDLError, "no free channel for a MusicStream");
         return -1;
     }
-    *chunk = Mix_QuickLoad_RAW(dst, (Uint32)memsize);
-    if (!*chunk) {
-        PyMem_Free(dst);
-        PyErr_NoMemory();
+    if (started == -1) {
+        PyErr_SetString(pgExc_SDLError, Mix_GetError());
         return -1;
     }
-    *mem = dst;
+    _pg_channel_set_sound(started, self->sound, loops, -1);
+    Mix_Volume(started, 128);
+    return started;
+}
 
-    /*
-    printf("!! step1: %d, step2: %d, view_itemsize: %d, length: %d\n",
-           step1, step2, view_itemsize, length);
-    */
-    /* Copy samples.
-     */
-    if (step1 == (Py_ssize_t)itemsize * channels && step2 == itemsize) {
-        /*OPTIMIZATION: in these cases, we don't need to loop through
-         *the samples individually, because the bytes are already laid
-         *out correctly*/
-        memcpy(dst, buf, memsize);
-    }
-    else if (itemsize == 1) {
-        for (loop1 = 0; loop1 < length; loop1++) {
-            src = (Uint8 *)buf + (loop1 * step1);
-            switch (view_itemsize) {
-                case 1:
-                    for (loop2 = 0; loop2 < length2;
-                         loop2++, dst += 1, src += step2) {
-                        *(Uint8 *)dst = (Uint8) * ((Uint8 *)src);
-                    }
-                    break;
-                case 2:
-                    for (loop2 = 0; loop2 < length2;
-                         loop2++, dst += 1, src += step2) {
-                        *(Uint8 *)dst = (Uint8) * ((Uint16 *)src);
-                    }
-                    break;
-                case 4:
-                    for (loop2 = 0; loop2 < length2;
-                         loop2++, dst += 1, src += step2) {
-                        *(Uint8 *)dst = (Uint8) * ((Uint32 *)src);
-                    }
-                    break;
-            }
-        }
+static PyObject *
+mstream_play(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *at_obj = Py_None;
+    int loops = 0, fade_ms = 0, channel;
+    Uint64 at = 0;
+
+    CHECK_MSTREAM_VALID(self);
+    static char *keywords[] = {"loops", "fade_ms", "at_sample", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|iiO", keywords, &loops,
+                                     &fade_ms, &at_obj)) {
+        return NULL;
     }
-    else {
-        for (loop1 = 0; loop1 < length; loop1++) {
-            src = (Uint8 *)buf + (loop1 * step1);
-            switch (view_itemsize) {
-                case 1:
-                    for (loop2 = 0; loop2 < length2;
-                         loop2++, dst += 2, src += step2) {
-                        *(Uint16 *)dst = (Uint16)(*((Uint8 *)src) << 8);
-                    }
-                    break;
-                case 2:
-                    for (loop2 = 0; loop2 < length2;
-                         loop2++, dst += 2, src += step2) {
-                        *(Uint16 *)dst = (Uint16) * ((Uint16 *)src);
-                    }
-                    break;
-                case 4:
-                    for (loop2 = 0; loop2 < length2;
-                         loop2++, dst += 2, src += step2) {
-                        *(Uint16 *)dst = (Uint16) * ((Uint32 *)src);
-                    }
-                    break;
-            }
-        }
+    MIXER_INIT_CHECK();
+    if (at_obj != Py_None && _pg_sample_arg(at_obj, &at)) {
+        return NULL;
     }
-
-    return 0;
+    channel = _pg_mstream_start((pgMusicStreamObject *)self, loops, fade_ms,
+                                at);
+    if (channel == -1) {
+        return NULL;
+    }
+    return pgChannel_New(channel);
 }
 
-static int
-sound_init(PyObject *self, PyObject *arg, PyObject *kwarg)
+static PyObject *
+mstream_stop(PyObject *self, PyObject *_null)
 {
-    static const char arg_cnt_err_msg[] =
-        "Sound takes either 1 positional or 1 keyword argument";
-    PyObject *obj = NULL;
-    PyObject *file = NULL;
-    PyObject *buffer = NULL;
-    PyObject *array = NULL;
-    PyObject *keys;
-    PyObject *kencoded;
-    SDL_RWops *rw;
-    Mix_Chunk *chunk = NULL;
-    Uint8 *mem = NULL;
+    pgSoundStream *st;
 
-    ((pgSoundObject *)self)->chunk = NULL;
-    ((pgSoundObject *)self)->mem = NULL;
+    CHECK_MSTREAM_VALID(self);
+    MIXER_INIT_CHECK();
+    st = PG_MSTREAM_STREAM(self);
+    Py_BEGIN_ALLOW_THREADS;
+    _pg_stream_cancel(st);
+    _pg_halt_group((int)(intptr_t)st->chunk);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
 
-    /* Similar to MIXER_INIT_CHECK(), but different return value. */
-    if (!SDL_WasInit(SDL_INIT_AUDIO)) {
-        PyErr_SetString(pgExc_SDLError, "mixer not initialized");
-        return -1;
+static PyObject *
+mstream_fadeout(PyObject *self, PyObject *args)
+{
+    pgSoundStream *st;
+    int ms;
+
+    CHECK_MSTREAM_VALID(self);
+    if (!PyArg_ParseTuple(args, "i", &ms)) {
+        return NULL;
     }
+    MIXER_INIT_CHECK();
+    st = PG_MSTREAM_STREAM(self);
+    Py_BEGIN_ALLOW_THREADS;
+    Mix_FadeOutGroup((int)(intptr_t)st->chunk, ms);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
 
-    /* Process arguments, returning cleaner error messages than
-       PyArg_ParseTupleAndKeywords would.
-    */
-    if (arg != NULL && PyTuple_GET_SIZE(arg)) {
-        if ((kwarg != NULL && PyDict_Size(kwarg)) || /* conditional and */
-            PyTuple_GET_SIZE(arg) != 1) {
-            PyErr_SetString(PyExc_TypeError, arg_cnt_err_msg);
-            return -1;
-        }
-        obj = PyTuple_GET_ITEM(arg, 0);
+static PyObject *
+mstream_set_volume(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgMusicStreamObject *ms = (pgMusicStreamObject *)self;
+    float volume;
+    int fade_ms = 0;
 
-        if (PyUnicode_Check(obj) ||
-            PyObject_HasAttrString(obj, "__fspath__")) {
-            file = obj;
-            obj = NULL;
-        }
-        else {
-            file = obj;
-            buffer = obj;
-        }
+    CHECK_MSTREAM_VALID(self);
+    static char *keywords[] = {"value", "fade_ms", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "f|i", keywords, &volume,
+                                     &fade_ms)) {
+        return NULL;
     }
-    else if (kwarg != NULL) {
-        if (PyDict_Size(kwarg) != 1) {
-            PyErr_SetString(PyExc_TypeError, arg_cnt_err_msg);
-            return -1;
-        }
-        if ((file = PyDict_GetItemString(kwarg, "file")) == NULL &&
-            (buffer = PyDict_GetItemString(kwarg, "buffer")) == NULL &&
-            (array = PyDict_GetItemString(kwarg, "array")) == NULL) {
-            keys = PyDict_Keys(kwarg);
-            if (keys == NULL) {
-                return -1;
-            }
-            kencoded =
-                pg_EncodeString(PyList_GET_ITEM(keys, 0), NULL, NULL, NULL);
-            Py_DECREF(keys);
-            if (kencoded == NULL) {
-                return -1;
-            }
-            PyErr_Format(PyExc_TypeError,
-                         "Unrecognized keyword argument '%.1024s'",
-                         PyBytes_AS_STRING(kencoded));
-            Py_DECREF(kencoded);
-            return -1;
-        }
-        if (buffer != NULL && PyUnicode_Check(buffer)) { /* conditional and */
-            PyErr_SetString(PyExc_TypeError,
-                            "Unicode object not allowed as buffer object");
-            return -1;
-        }
+    MIXER_INIT_CHECK();
+    if (volume < 0.0f) {
+        volume = 0.0f;
     }
-    else {
-        PyErr_SetString(PyExc_TypeError, arg_cnt_err_msg);
-        return -1;
+    else if (volume > 1.0f) {
+        volume = 1.0f;
     }
+    ms->volume = volume;
+    _pg_stream_gain(PG_MSTREAM_STREAM(self), -1.0f, volume,
+                    _pg_mstream_fade(fade_ms));
+    Py_RETURN_NONE;
+}
 
-    if (file != NULL) {
-        rw = pgRWops_FromObject(file, NULL);
+static PyObject *
+mstream_get_volume(PyObject *self, PyObject *_null)
+{
+    CHECK_MSTREAM_VALID(self);
+    return PyFloat_FromDouble(((pgMusicStreamObject *)self)->volume);
+}
 
-        if (rw == NULL) {
-            if (obj) {
-                /* use 'buffer' as fallback for single arg */
-                PyErr_Clear();
-                goto LOAD_BUFFER;
-            }
-            return -1;
-        }
-        Py_BEGIN_ALLOW_THREADS;
-        chunk = Mix_LoadWAV_RW(rw, 1);
-        Py_END_ALLOW_THREADS;
-        if (chunk == NULL) {
-            PyErr_SetString(pgExc_SDLError, SDL_GetError());
-            return -1;
-        }
+static PyObject *
+mstream_get_busy(PyObject *self, PyObject *_null)
+{
+    CHECK_MSTREAM_VALID(self);
+    MIXER_INIT_CHECK();
+    return PyBool_FromLong(
+        Mix_GroupCount((int)(intptr_t)PG_MSTREAM_STREAM(self)->chunk) > 0);
+}
+
+static PyObject *
+mstream_get_channel(PyObject *self, PyObject *_null)
+{
+    int channel;
+
+    CHECK_MSTREAM_VALID(self);
+    MIXER_INIT_CHECK();
+    channel = Mix_GroupNewer((int)(intptr_t)PG_MSTREAM_STREAM(self)->chunk);
+    if (channel == -1) {
+        Py_RETURN_NONE;
     }
+    return pgChannel_New(channel);
+}
 
-LOAD_BUFFER:
+static PyObject *
+mstream_get_length(PyObject *self, PyObject *_null)
+{
+    pgSoundStream *st;
 
-    if (!chunk && buffer) {
-        Py_buffer view;
-        int rcode;
+    CHECK_MSTREAM_VALID(self);
+    st = PG_MSTREAM_STREAM(self);
+    return PyFloat_FromDouble((double)st->src_frames / (double)st->src_freq);
+}
 
-        view.obj = 0;
-        if (PyObject_GetBuffer(buffer, &view, PyBUF_SIMPLE)) {
-            if (obj != NULL) {
-                PyErr_Clear();
-            }
-            else {
-                PyErr_Format(PyExc_TypeError,
-                             "Expected object with buffer interface: got a %s",
-                             Py_TYPE(buffer)->tp_name);
-                return -1;
-            }
-        }
-        else {
-            rcode = _chunk_from_buf(view.buf, view.len, &chunk, &mem);
-            PyBuffer_Release(&view);
-            if (rcode) {
-                return -1;
-            }
-            ((pgSoundObject *)self)->mem = mem;
-        }
-    }
+static PyMethodDef mstream_methods[] = {
+    {"play", (PyCFunction)mstream_play, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_MUSICSTREAM_PLAY},
+    {"stop", mstream_stop, METH_NOARGS, DOC_MIXER_MUSICSTREAM_STOP},
+    {"fadeout", mstream_fadeout, METH_VARARGS,
+     DOC_MIXER_MUSICSTREAM_FADEOUT},
+    {"set_volume", (PyCFunction)mstream_set_volume,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_MUSICSTREAM_SETVOLUME},
+    {"get_volume", mstream_get_volume, METH_NOARGS,
+     DOC_MIXER_MUSICSTREAM_GETVOLUME},
+    {"get_busy", mstream_get_busy, METH_NOARGS,
+     DOC_MIXER_MUSICSTREAM_GETBUSY},
+    {"get_channel", mstream_get_channel, METH_NOARGS,
+     DOC_MIXER_MUSICSTREAM_GETCHANNEL},
+    {"get_length", mstream_get_length, METH_NOARGS,
+     DOC_MIXER_MUSICSTREAM_GETLENGTH},
+    {NULL, NULL, 0, NULL}};
 
-    if (array != NULL) {
-        pg_buffer pg_view;
-        PG_sample_format_t view_format;
-        int rcode;
+static PyTypeObject pgMusicStream_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0).tp_name = "pygame.mixer.MusicStream",
+    .tp_basicsize = sizeof(pgMusicStreamObject),
+    .tp_dealloc = (destructor)mstream_dealloc,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = DOC_MIXER_MUSICSTREAM,
+    .tp_methods = mstream_methods,
+    .tp_init = (initproc)mstream_init,
+    .tp_new = PyType_GenericNew,
+};
 
-        pg_view.view.itemsize = 0;
-        pg_view.view.obj = 0;
-        if (pgObject_GetBuffer(array, &pg_view, PyBUF_FORMAT | PyBUF_ND)) {
-            return -1;
+static PyObject *
+play_streams(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *streams, *seq, *at_obj = Py_None, *item;
+    Py_ssize_t i, j, n;
+    int loops = 0;
+    Uint64 at;
+
+    static char *keywords[] = {"streams", "loops", "at_sample", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|iO", keywords,
+                                     &streams, &loops, &at_obj)) {
+        return NULL;
+    }
+    MIXER_INIT_CHECK();
+    seq = PySequence_Fast(streams, "streams must be a sequence");
+    if (!seq) {
+        return NULL;
+    }
+    n = PySequence_Fast_GET_SIZE(seq);
+    for (i = 0; i < n; i++) {
+        item = PySequence_Fast_GET_ITEM(seq, i);
+        if (!PyObject_TypeCheck(item, &pgMusicStream_Type)) {
+            Py_DECREF(seq);
+            return RAISE(PyExc_TypeError,
+                         "streams must be MusicStream objects");
         }
-        view_format = _format_view_to_audio((Py_buffer *)&pg_view);
-        if (!view_format) {
-            pgBuffer_Release(&pg_view);
-            return -1;
+        if (!((pgMusicStreamObject *)item)->sound) {
+            Py_DECREF(seq);
+            return RAISE(PyExc_RuntimeError,
+                         "__init__() was not called on MusicStream object "
+                         "so it failed to setup correctly.");
         }
-        rcode = _chunk_from_array(pg_view.view.buf, view_format,
-                                  pg_view.view.ndim, pg_view.view.shape,
-                                  pg_view.view.strides, &chunk, &mem);
-        pgBuffer_Release(&pg_view);
-        if (rcode) {
-            return -1;
+    }
+    if (at_obj != Py_None) {
+        if (_pg_sample_arg(at_obj, &at)) {
+            Py_DECREF(seq);
+            return NULL;
         }
-        ((pgSoundObject *)self)->mem = mem;
+    }
+    else {
+        /* far enough ahead that none of them has to skip frames */
+        at = _pg_sample_clock() + PG_STREAMS_AHEAD * mixer_buffer;
     }
 
-    if (chunk == NULL) {
-        if (obj == NULL) {
-            PyErr_SetString(PyExc_TypeError, "Unrecognized argument");
-        }
-        else {
-            PyErr_Format(PyExc_TypeError, "Unrecognized argument (type %s)",
-                         Py_TYPE(obj)->tp_name);
+    for (i = 0; i < n; i++) {
+        item = PySequence_Fast_GET_ITEM(seq, i);
+        if (_pg_mstream_start((pgMusicStreamObject *)item, loops, 0, at) ==
+            -1) {
+            for (j = 0; j < i; j++) {
+                Py_XDECREF(mstream_stop(PySequence_Fast_GET_ITEM(seq, j),
+                                        NULL));
+            }
+            Py_DECREF(seq);
+            return NULL;
         }
-        return -1;
     }
-
-    ((pgSoundObject *)self)->chunk = chunk;
-    return 0;
+    Py_DECREF(seq);
+    return PyLong_FromUnsignedLongLong(at);
 }
 
 static PyMethodDef _mixer_methods[] = {
@@ -1962,20 +10309,50 @@ static PyMethodDef _mixer_methods[] = {
     {"set_num_channels", set_num_channels, METH_VARARGS,
      DOC_MIXER_SETNUMCHANNELS},
     {"set_reserved", set_reserved, METH_VARARGS, DOC_MIXER_SETRESERVED},
+    {"set_num_virtual", set_num_virtual, METH_VARARGS,
+     DOC_MIXER_SETNUMVIRTUAL},
+    {"get_num_virtual", (PyCFunction)get_num_virtual, METH_NOARGS,
+     DOC_MIXER_GETNUMVIRTUAL},
 
     {"get_busy", (PyCFunction)get_busy, METH_NOARGS, DOC_MIXER_GETBUSY},
+    {"get_sample_clock", (PyCFunction)get_sample_clock, METH_NOARGS,
+     DOC_MIXER_GETSAMPLECLOCK},
+    {"get_stats", (PyCFunction)get_stats, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_GETSTATS},
+    {"render_offline", (PyCFunction)render_offline,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_RENDEROFFLINE},
+    {"write_sound_bank", (PyCFunction)write_sound_bank,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_WRITESOUNDBANK},
+    {"play_streams", (PyCFunction)play_streams, METH_VARARGS | METH_KEYWORDS,
+     DOC_MIXER_PLAYSTREAMS},
+    {"set_output_effects", mixer_set_output_effects, METH_O,
+     DOC_MIXER_SETOUTPUTEFFECTS},
+    {"get_output_effects", (PyCFunction)mixer_get_output_effects,
+     METH_NOARGS, DOC_MIXER_GETOUTPUTEFFECTS},
+    {"set_listener", (PyCFunction)mixer_set_listener,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_SETLISTENER},
+    {"get_listener", (PyCFunction)mixer_get_listener, METH_NOARGS,
+     DOC_MIXER_GETLISTENER},
     {"find_channel", (PyCFunction)mixer_find_channel,
      METH_VARARGS | METH_KEYWORDS, DOC_MIXER_FINDCHANNEL},
     {"set_soundfont", (PyCFunction)mixer_set_soundfont, METH_VARARGS,
      DOC_MIXER_SETSOUNDFONT},
     {"get_soundfont", (PyCFunction)mixer_get_soundfont, METH_NOARGS,
      DOC_MIXER_GETSOUNDFONT},
+    {"set_volumes", (PyCFunction)mixer_set_volumes,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_SETVOLUMES},
+    {"set_source_locations", (PyCFunction)mixer_set_source_locations,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_SETSOURCELOCATIONS},
     {"fadeout", mixer_fadeout, METH_VARARGS, DOC_MIXER_FADEOUT},
     {"stop", (PyCFunction)mixer_stop, METH_NOARGS, DOC_MIXER_STOP},
     {"pause", (PyCFunction)mixer_pause, METH_NOARGS, DOC_MIXER_PAUSE},
     {"unpause", (PyCFunction)mixer_unpause, METH_NOARGS, DOC_MIXER_UNPAUSE},
     {"get_sdl_mixer_version", (PyCFunction)mixer_get_sdl_mixer_version,
      METH_VARARGS | METH_KEYWORDS, DOC_MIXER_GETSDLMIXERVERSION},
+    {"load_sounds_async", (PyCFunction)mixer_load_sounds_async,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_LOADSOUNDSASYNC},
+    {"resample_buffer", (PyCFunction)mixer_resample_buffer,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_RESAMPLEBUFFER},
     /*  { "lookup_frequency", lookup_frequency, 1, doc_lookup_frequency
        },*/
 
@@ -2057,6 +10434,42 @@ MODINIT_DEFINE(mixer)
     if (PyType_Ready(&pgChannel_Type) < 0) {
         return NULL;
     }
+    if (PyType_Ready(&pgSoundLoader_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgSoundBank_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgMusicStream_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgBus_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgEffect_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgDucker_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgBiquad_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgCompressor_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgDelay_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgReverb_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgAnalyzer_Type) < 0) {
+        return NULL;
+    }
+    if (PyType_Ready(&pgEmitter_Type) < 0) {
+        return NULL;
+    }
 
     /* create the module */
     module = PyModule_Create(&_module);
@@ -2089,12 +10502,96 @@ MODINIT_DEFINE(mixer)
         Py_DECREF(module);
         return NULL;
     }
+    Py_INCREF(&pgSoundLoader_Type);
+    if (PyModule_AddObject(module, "SoundLoader",
+                           (PyObject *)&pgSoundLoader_Type)) {
+        Py_DECREF(&pgSoundLoader_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgSoundBank_Type);
+    if (PyModule_AddObject(module, "SoundBank",
+                           (PyObject *)&pgSoundBank_Type)) {
+        Py_DECREF(&pgSoundBank_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgMusicStream_Type);
+    if (PyModule_AddObject(module, "MusicStream",
+                           (PyObject *)&pgMusicStream_Type)) {
+        Py_DECREF(&pgMusicStream_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgBus_Type);
+    if (PyModule_AddObject(module, "Bus", (PyObject *)&pgBus_Type)) {
+        Py_DECREF(&pgBus_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgEffect_Type);
+    if (PyModule_AddObject(module, "Effect", (PyObject *)&pgEffect_Type)) {
+        Py_DECREF(&pgEffect_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgDucker_Type);
+    if (PyModule_AddObject(module, "Ducker", (PyObject *)&pgDucker_Type)) {
+        Py_DECREF(&pgDucker_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgBiquad_Type);
+    if (PyModule_AddObject(module, "Biquad", (PyObject *)&pgBiquad_Type)) {
+        Py_DECREF(&pgBiquad_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgCompressor_Type);
+    if (PyModule_AddObject(module, "Compressor",
+                           (PyObject *)&pgCompressor_Type)) {
+        Py_DECREF(&pgCompressor_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgDelay_Type);
+    if (PyModule_AddObject(module, "Delay", (PyObject *)&pgDelay_Type)) {
+        Py_DECREF(&pgDelay_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgReverb_Type);
+    if (PyModule_AddObject(module, "Reverb", (PyObject *)&pgReverb_Type)) {
+        Py_DECREF(&pgReverb_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgAnalyzer_Type);
+    if (PyModule_AddObject(module, "Analyzer",
+                           (PyObject *)&pgAnalyzer_Type)) {
+        Py_DECREF(&pgAnalyzer_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_INCREF(&pgEmitter_Type);
+    if (PyModule_AddObject(module, "Emitter", (PyObject *)&pgEmitter_Type)) {
+        Py_DECREF(&pgEmitter_Type);
+        Py_DECREF(module);
+        return NULL;
+    }
     /* export the c api */
     c_api[0] = &pgSound_Type;
     c_api[1] = pgSound_New;
     c_api[2] = pgSound_Play;
     c_api[3] = &pgChannel_Type;
     c_api[4] = pgChannel_New;
+    c_api[5] = pgMixer_SetMusicEffects;
+    c_api[6] = pgMixer_GetMusicEffects;
+    c_api[7] = pgMixer_PlayPlaylist;
+    c_api[8] = pgMixer_ExtendPlaylist;
+    c_api[9] = pgMixer_SkipTrack;
+    c_api[10] = pgMixer_StopPlaylist;
+    c_api[11] = pgMixer_GetPlaylistState;
     apiobj = encapsulate_api(c_api, "mixer");
     if (PyModule_AddObject(module, PYGAMEAPI_LOCAL_ENTRY, apiobj)) {
         Py_XDECREF(apiobj);
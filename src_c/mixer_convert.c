@@ -0,0 +1,472 @@
+/*
+  pygame-ce - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/*
+ *  Sample format conversion for the mixer module. The SIMD kernels are in
+ *  simd_audio_sse2.c and simd_audio_avx2.c, this file holds the scalar
+ *  versions and picks between them at runtime.
+ */
+#define NO_PYGAME_C_API
+
+#include <math.h>
+
+#include "_pygame.h"
+#include "simd_audio.h"
+
+/* Samples converted per block when going through float */
+#define PG_CONVERT_BLOCK 1024
+
+#if !defined(__EMSCRIPTEN__)
+#if PG_ENABLE_SSE_NEON
+#define PG_AUDIO_KERNEL(done, NAME, ...)      \
+    if (pg_audio_has_avx2()) {                \
+        done = NAME##_avx2(__VA_ARGS__);      \
+    }                                         \
+    else if (pg_audio_has_sse_neon()) {       \
+        done = NAME##_sse2(__VA_ARGS__);      \
+    }
+#else
+#define PG_AUDIO_KERNEL(done, NAME, ...) \
+    if (pg_audio_has_avx2()) {           \
+        done = NAME##_avx2(__VA_ARGS__); \
+    }
+#endif /* PG_ENABLE_SSE_NEON */
+#else
+#define PG_AUDIO_KERNEL(done, NAME, ...)
+#endif /* __EMSCRIPTEN__ */
+
+static Sint32
+_pg_float_to_int(float value, float scale, Sint32 max)
+{
+    Sint32 r;
+
+    /* Match the SIMD kernels: round to nearest even, saturating, with NaN
+     * mapping to the minimum */
+    value *= scale;
+    if (value >= 2147483648.0f) {
+        r = SDL_MAX_SINT32;
+    }
+    else if (value >= -2147483648.0f) {
+        r = (Sint32)lrintf(value);
+    }
+    else {
+        r = SDL_MIN_SINT32;
+    }
+    if (r > max) {
+        return max;
+    }
+    if (r < -max - 1) {
+        return -max - 1;
+    }
+    return r;
+}
+
+void
+pg_audio_to_f32(const void *src, int src_type, float *dst, size_t n)
+{
+    int is_unsigned = (src_type & PG_CVT_UNSIGNED) != 0;
+    size_t i = 0;
+
+    switch (PG_CVT_SIZE(src_type)) {
+        case 1: {
+            const Uint8 *s = (const Uint8 *)src;
+            Uint8 flip = is_unsigned ? 0x80 : 0;
+
+            PG_AUDIO_KERNEL(i, pg_audio_s8_to_f32, s, dst, n, is_unsigned);
+            for (; i < n; i++) {
+                dst[i] = (float)(Sint8)(s[i] ^ flip) * (1.0f / 128.0f);
+            }
+            break;
+        }
+        case 2: {
+            const Uint16 *s = (const Uint16 *)src;
+            Uint16 flip = is_unsigned ? 0x8000 : 0;
+
+            PG_AUDIO_KERNEL(i, pg_audio_s16_to_f32, s, dst, n, is_unsigned);
+            for (; i < n; i++) {
+                dst[i] = (float)(Sint16)(s[i] ^ flip) * (1.0f / 32768.0f);
+            }
+            break;
+        }
+        case 4: {
+            const Uint32 *s = (const Uint32 *)src;
+            Uint32 flip = is_unsigned ? 0x80000000u : 0;
+
+            if (src_type & PG_CVT_FLOAT) {
+                memcpy(dst, src, n * sizeof(float));
+                break;
+            }
+            PG_AUDIO_KERNEL(i, pg_audio_s32_to_f32, s, dst, n, is_unsigned);
+            for (; i < n; i++) {
+                dst[i] =
+                    (float)(Sint32)(s[i] ^ flip) * (1.0f / 2147483648.0f);
+            }
+            break;
+        }
+        case 8: {
+            const double *s = (const double *)src;
+
+            for (; i < n; i++) {
+                dst[i] = (float)s[i];
+            }
+            break;
+        }
+    }
+}
+
+void
+pg_audio_from_f32(const float *src, void *dst, int dst_type, size_t n)
+{
+    int is_unsigned = (dst_type & PG_CVT_UNSIGNED) != 0;
+    size_t i = 0;
+
+    switch (PG_CVT_SIZE(dst_type)) {
+        case 1: {
+            Uint8 *d = (Uint8 *)dst;
+            Uint8 flip = is_unsigned ? 0x80 : 0;
+
+            PG_AUDIO_KERNEL(i, pg_audio_f32_to_s8, src, d, n, is_unsigned);
+            for (; i < n; i++) {
+                d[i] = (Uint8)_pg_float_to_int(src[i], 128.0f, 127) ^ flip;
+            }
+            break;
+        }
+        case 2: {
+            Uint16 *d = (Uint16 *)dst;
+            Uint16 flip = is_unsigned ? 0x8000 : 0;
+
+            PG_AUDIO_KERNEL(i, pg_audio_f32_to_s16, src, d, n, is_unsigned);
+            for (; i < n; i++) {
+                d[i] =
+                    (Uint16)_pg_float_to_int(src[i], 32768.0f, 32767) ^ flip;
+            }
+            break;
+        }
+        case 4: {
+            Uint32 *d = (Uint32 *)dst;
+            Uint32 flip = is_unsigned ? 0x80000000u : 0;
+
+            if (dst_type & PG_CVT_FLOAT) {
+                memcpy(dst, src, n * sizeof(float));
+                break;
+            }
+            PG_AUDIO_KERNEL(i, pg_audio_f32_to_s32, src, d, n, is_unsigned);
+            for (; i < n; i++) {
+                d[i] = (Uint32)_pg_float_to_int(src[i], 2147483648.0f,
+                                                SDL_MAX_SINT32) ^
+                       flip;
+            }
+            break;
+        }
+        case 8: {
+            double *d = (double *)dst;
+
+            for (; i < n; i++) {
+                d[i] = (double)src[i];
+            }
+            break;
+        }
+    }
+}
+
+/* Integer to integer, keeping the sample bits like the old Sound(array=...)
+ * code did: shift left when widening, keep the low bits when narrowing.
+ * These loops are simple enough for compilers to vectorize on their own. */
+#define _PG_RESIZE_LOOP(SRC_T, DST_T, EXPR)   \
+    {                                         \
+        const SRC_T *s = (const SRC_T *)src;  \
+        DST_T *d = (DST_T *)dst;              \
+        for (i = 0; i < n; i++) {             \
+            d[i] = (DST_T)(EXPR);             \
+        }                                     \
+    }
+
+static void
+_pg_audio_resize_int(const void *src, int src_size, void *dst, int dst_size,
+                     size_t n)
+{
+    size_t i;
+
+    switch (src_size * 10 + dst_size) {
+        case 12:
+            _PG_RESIZE_LOOP(Uint8, Uint16, s[i] << 8);
+            break;
+        case 14:
+            _PG_RESIZE_LOOP(Uint8, Uint32, (Uint32)s[i] << 24);
+            break;
+        case 21:
+            _PG_RESIZE_LOOP(Uint16, Uint8, s[i]);
+            break;
+        case 24:
+            _PG_RESIZE_LOOP(Uint16, Uint32, (Uint32)s[i] << 16);
+            break;
+        case 41:
+            _PG_RESIZE_LOOP(Uint32, Uint8, s[i]);
+            break;
+        case 42:
+            _PG_RESIZE_LOOP(Uint32, Uint16, s[i]);
+            break;
+        default:
+            memcpy(dst, src, n * src_size);
+            break;
+    }
+}
+
+void
+pg_audio_convert(const void *src, int src_type, void *dst, int dst_type,
+                 size_t n)
+{
+    float block[PG_CONVERT_BLOCK];
+    size_t i, count;
+    int src_size = PG_CVT_SIZE(src_type);
+    int dst_size = PG_CVT_SIZE(dst_type);
+
+    if (src_type == dst_type) {
+        memcpy(dst, src, n * src_size);
+    }
+    else if (!(src_type & PG_CVT_FLOAT) && !(dst_type & PG_CVT_FLOAT)) {
+        _pg_audio_resize_int(src, src_size, dst, dst_size, n);
+    }
+    else if (dst_type == PG_CVT_F32) {
+        pg_audio_to_f32(src, src_type, (float *)dst, n);
+    }
+    else if (src_type == PG_CVT_F32) {
+        pg_audio_from_f32((const float *)src, dst, dst_type, n);
+    }
+    else {
+        for (i = 0; i < n; i += count) {
+            count = n - i < PG_CONVERT_BLOCK ? n - i : PG_CONVERT_BLOCK;
+            pg_audio_to_f32((const Uint8 *)src + i * src_size, src_type,
+                            block, count);
+            pg_audio_from_f32(block, (Uint8 *)dst + i * dst_size, dst_type,
+                              count);
+        }
+    }
+}
+
+void
+pg_audio_interleave2(const void *left, const void *right, void *dst,
+                     int size, size_t frames)
+{
+    const Uint8 *l = (const Uint8 *)left;
+    const Uint8 *r = (const Uint8 *)right;
+    Uint8 *d = (Uint8 *)dst;
+    size_t i = 0;
+
+    PG_AUDIO_KERNEL(i, pg_audio_interleave2, l, r, d, size, frames);
+    for (; i < frames; i++) {
+        memcpy(d + 2 * i * size, l + i * size, size);
+        memcpy(d + (2 * i + 1) * size, r + i * size, size);
+    }
+}
+
+void
+pg_audio_deinterleave2(const void *src, void *left, void *right, int size,
+                       size_t frames)
+{
+    const Uint8 *s = (const Uint8 *)src;
+    Uint8 *l = (Uint8 *)left;
+    Uint8 *r = (Uint8 *)right;
+    size_t i = 0;
+
+    PG_AUDIO_KERNEL(i, pg_audio_deinterleave2, s, l, r, size, frames);
+    for (; i < frames; i++) {
+        memcpy(l + i * size, s + 2 * i * size, size);
+        memcpy(r + i * size, s + (2 * i + 1) * size, size);
+    }
+}
+
+/* Which kernels to use for loops too short to dispatch on every call:
+ * 2 for AVX2, 1 for SSE2/NEON and 0 for scalar code */
+static int
+_pg_audio_isa(void)
+{
+#if !defined(__EMSCRIPTEN__)
+    if (pg_audio_has_avx2()) {
+        return 2;
+    }
+#if PG_ENABLE_SSE_NEON
+    if (pg_audio_has_sse_neon()) {
+        return 1;
+    }
+#endif /* PG_ENABLE_SSE_NEON */
+#endif /* __EMSCRIPTEN__ */
+    return 0;
+}
+
+static float
+_pg_dot_f32(const float *a, const float *b, size_t n, int isa)
+{
+    float sum = 0.0f;
+    size_t i = 0;
+
+    if (isa == 2) {
+        i = pg_audio_dot_f32_avx2(a, b, n, &sum);
+    }
+    else if (isa == 1) {
+        i = pg_audio_dot_f32_sse2(a, b, n, &sum);
+    }
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/* Zeroth order modified Bessel function of the first kind, for the Kaiser
+ * window */
+static double
+_pg_bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    int k;
+
+    for (k = 1; k < 50 && term > sum * 1e-12; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+size_t
+pg_audio_resample_frames(size_t frames, int rate, int new_rate)
+{
+    return (size_t)(((Uint64)frames * new_rate + rate - 1) / rate);
+}
+
+/* A windowed-sinc polyphase filter. The table holds phases + 1 rows of
+ * ntaps coefficients, for fractional positions 0/phases ... phases/phases,
+ * and outputs are interpolated between the two nearest rows. */
+typedef struct {
+    float *table;
+    int ntaps;
+    int phases;
+} _pg_polyphase;
+
+static int
+_pg_polyphase_init(_pg_polyphase *filter, int rate, int new_rate,
+                   int quality)
+{
+    /* zero crossings each side, passband edge and Kaiser beta per tier */
+    double zero_crossings = quality >= PG_RESAMPLE_BEST ? 24.0 : 8.0;
+    double rolloff = quality >= PG_RESAMPLE_BEST ? 0.95 : 0.9;
+    double beta = quality >= PG_RESAMPLE_BEST ? 9.0 : 6.0;
+    double cutoff, half, t, x, window, norm, i0_beta;
+    float *row;
+    int p, k;
+
+    filter->phases = quality >= PG_RESAMPLE_BEST ? 512 : 128;
+
+    /* when downsampling the filter also has to remove what lies above
+     * the new Nyquist frequency, and gets wider to do so */
+    cutoff = rolloff * (new_rate < rate ? (double)new_rate / rate : 1.0);
+    half = zero_crossings / cutoff;
+    filter->ntaps = 2 * (int)SDL_ceil(half);
+    filter->ntaps = (filter->ntaps + 7) & ~7;
+    filter->table = (float *)SDL_malloc(sizeof(float) * filter->ntaps *
+                                        (filter->phases + 1));
+    if (!filter->table) {
+        return -1;
+    }
+
+    i0_beta = _pg_bessel_i0(beta);
+    for (p = 0; p <= filter->phases; p++) {
+        row = filter->table + (size_t)p * filter->ntaps;
+        norm = 0.0;
+        for (k = 0; k < filter->ntaps; k++) {
+            t = (k - filter->ntaps / 2 + 1) - (double)p / filter->phases;
+            if (SDL_fabs(t) >= half) {
+                row[k] = 0.0f;
+                continue;
+            }
+            x = 3.14159265358979323846 * cutoff * t;
+            window = _pg_bessel_i0(beta * SDL_sqrt(1.0 - (t / half) *
+                                                             (t / half))) /
+                     i0_beta;
+            row[k] = (float)((x == 0.0 ? 1.0 : SDL_sin(x) / x) * window);
+            norm += row[k];
+        }
+        /* unity gain at DC for every phase */
+        for (k = 0; k < filter->ntaps; k++) {
+            row[k] = (float)(row[k] / norm);
+        }
+    }
+    return 0;
+}
+
+int
+pg_audio_resample(const float *src, size_t frames, float *dst,
+                  size_t dst_frames, int channels, int rate, int new_rate,
+                  int quality)
+{
+    _pg_polyphase filter = {NULL, 2, 0};
+    float *padded, *in, *row;
+    size_t j, pos, pad;
+    Uint64 num;
+    double frac, fp;
+    float a;
+    int c, p, isa = _pg_audio_isa();
+
+    if (rate == new_rate) {
+        memcpy(dst, src, frames * channels * sizeof(float));
+        return 0;
+    }
+    if (quality > PG_RESAMPLE_LINEAR &&
+        _pg_polyphase_init(&filter, rate, new_rate, quality)) {
+        return -1;
+    }
+
+    /* each channel is copied out on its own with silence either side, so
+     * that the filter can run over contiguous samples without bounds
+     * checks */
+    pad = (size_t)filter.ntaps;
+    padded = (float *)SDL_calloc(frames + 2 * pad, sizeof(float));
+    if (!padded) {
+        SDL_free(filter.table);
+        return -1;
+    }
+
+    for (c = 0; c < channels; c++) {
+        for (j = 0; j < frames; j++) {
+            padded[pad + j] = src[j * channels + c];
+        }
+        for (j = 0; j < dst_frames; j++) {
+            /* exact source position j * rate / new_rate */
+            num = (Uint64)j * rate;
+            pos = (size_t)(num / new_rate);
+            frac = (double)(num % new_rate) / new_rate;
+            if (!filter.table) {
+                in = padded + pad + pos;
+                dst[j * channels + c] =
+                    in[0] + (float)frac * (in[1] - in[0]);
+                continue;
+            }
+            in = padded + pad + pos - filter.ntaps / 2 + 1;
+            fp = frac * filter.phases;
+            p = (int)fp;
+            a = (float)(fp - p);
+            row = filter.table + (size_t)p * filter.ntaps;
+            dst[j * channels + c] =
+                (1.0f - a) * _pg_dot_f32(in, row, filter.ntaps, isa) +
+                a * _pg_dot_f32(in, row + filter.ntaps, filter.ntaps, isa);
+        }
+    }
+
+    SDL_free(padded);
+    SDL_free(filter.table);
+    return 0;
+}
@@ -0,0 +1,584 @@
+/*
+  pygame-ce - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/*
+ *  Signal processing behind the native effects of the mixer module. The
+ *  Python side of the effects is in mixer.c.
+ */
+#include <math.h>
+
+#include "mixer_dsp.h"
+
+#define PG_DSP_PI 3.14159265358979323846
+
+/* Frames processed at a time by the reverb */
+#define PG_REVERB_BLOCK 256
+#define PG_REVERB_RATE 44100 /* of the tuning below */
+#define PG_REVERB_SPREAD 23
+#define PG_REVERB_GAIN 0.015f
+#define PG_REVERB_WET 3.0f
+
+static const int _pg_reverb_combs[PG_REVERB_COMBS] = {
+    1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+static const int _pg_reverb_allpasses[PG_REVERB_ALLPASSES] = {556, 441, 341,
+                                                              225};
+
+static const int _pg_adpcm_steps[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,
+    19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+    337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+    876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+    5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+static const int _pg_adpcm_indices[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+/* Recursive filters decay into denormals, which are slow on most CPUs */
+static float
+_pg_flush(float x)
+{
+    return (x > -1e-15f && x < 1e-15f) ? 0.0f : x;
+}
+
+/* One pole smoothing coefficient reaching about two thirds of the way in
+   ms milliseconds */
+static float
+_pg_one_pole(double ms, int rate)
+{
+    if (ms <= 0.0 || rate <= 0) {
+        return 0.0f;
+    }
+    return (float)exp(-1000.0 / (ms * rate));
+}
+
+void
+pg_biquad_design(pgBiquad *bq, int type, double frequency, double q,
+                 double gain_db, int rate)
+{
+    double w0, cs, alpha, a, sq;
+    double b0, b1, b2, a0, a1, a2;
+
+    /* keep the filter stable and away from the Nyquist frequency */
+    if (frequency > rate * 0.49) {
+        frequency = rate * 0.49;
+    }
+    if (frequency < 1.0) {
+        frequency = 1.0;
+    }
+    w0 = 2.0 * PG_DSP_PI * frequency / rate;
+    cs = cos(w0);
+    alpha = sin(w0) / (2.0 * q);
+    a = pow(10.0, gain_db / 40.0);
+    sq = 2.0 * sqrt(a) * alpha;
+    a0 = 1.0 + alpha;
+    a1 = -2.0 * cs;
+    a2 = 1.0 - alpha;
+
+    switch (type) {
+        case PG_BIQUAD_HIGHPASS:
+            b0 = (1.0 + cs) / 2.0;
+            b1 = -(1.0 + cs);
+            b2 = b0;
+            break;
+        case PG_BIQUAD_BANDPASS:
+            b0 = alpha;
+            b1 = 0.0;
+            b2 = -alpha;
+            break;
+        case PG_BIQUAD_NOTCH:
+            b0 = 1.0;
+            b1 = -2.0 * cs;
+            b2 = 1.0;
+            break;
+        case PG_BIQUAD_PEAKING:
+            b0 = 1.0 + alpha * a;
+            b1 = -2.0 * cs;
+            b2 = 1.0 - alpha * a;
+            a0 = 1.0 + alpha / a;
+            a2 = 1.0 - alpha / a;
+            break;
+        case PG_BIQUAD_LOWSHELF:
+            b0 = a * ((a + 1.0) - (a - 1.0) * cs + sq);
+            b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cs);
+            b2 = a * ((a + 1.0) - (a - 1.0) * cs - sq);
+            a0 = (a + 1.0) + (a - 1.0) * cs + sq;
+            a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cs);
+            a2 = (a + 1.0) + (a - 1.0) * cs - sq;
+            break;
+        case PG_BIQUAD_HIGHSHELF:
+            b0 = a * ((a + 1.0) + (a - 1.0) * cs + sq);
+            b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cs);
+            b2 = a * ((a + 1.0) + (a - 1.0) * cs - sq);
+            a0 = (a + 1.0) - (a - 1.0) * cs + sq;
+            a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cs);
+            a2 = (a + 1.0) - (a - 1.0) * cs - sq;
+            break;
+        default: /* PG_BIQUAD_LOWPASS */
+            b0 = (1.0 - cs) / 2.0;
+            b1 = 1.0 - cs;
+            b2 = b0;
+    }
+    bq->b0 = (float)(b0 / a0);
+    bq->b1 = (float)(b1 / a0);
+    bq->b2 = (float)(b2 / a0);
+    bq->a1 = (float)(a1 / a0);
+    bq->a2 = (float)(a2 / a0);
+}
+
+void
+pg_biquad_process(pgBiquad *bq, float *buf, int frames, int channels)
+{
+    float b0 = bq->b0, b1 = bq->b1, b2 = bq->b2, a1 = bq->a1, a2 = bq->a2;
+    float x, y;
+    int i, c;
+
+    for (i = 0; i < frames; i++, buf += channels) {
+        for (c = 0; c < channels; c++) {
+            x = buf[c];
+            y = b0 * x + bq->z1[c];
+            bq->z1[c] = b1 * x - a1 * y + bq->z2[c];
+            bq->z2[c] = b2 * x - a2 * y;
+            buf[c] = y;
+        }
+    }
+    for (c = 0; c < channels; c++) {
+        bq->z1[c] = _pg_flush(bq->z1[c]);
+        bq->z2[c] = _pg_flush(bq->z2[c]);
+    }
+}
+
+void
+pg_compressor_design(pgCompressor *c, double threshold_db, double ratio,
+                     double attack_ms, double release_ms, double makeup_db,
+                     int rate)
+{
+    c->threshold = (float)pow(10.0, threshold_db / 20.0);
+    c->slope = (float)(1.0 / ratio - 1.0);
+    c->attack = _pg_one_pole(attack_ms, rate);
+    c->release = _pg_one_pole(release_ms, rate);
+    c->makeup = (float)pow(10.0, makeup_db / 20.0);
+}
+
+void
+pg_compressor_process(pgCompressor *c, float *buf, int frames, int channels)
+{
+    float env = c->env, peak, x, gain;
+    int i, ch;
+
+    for (i = 0; i < frames; i++, buf += channels) {
+        peak = 0.0f;
+        for (ch = 0; ch < channels; ch++) {
+            x = buf[ch] < 0.0f ? -buf[ch] : buf[ch];
+            peak = x > peak ? x : peak;
+        }
+        env = peak + (env - peak) * (peak > env ? c->attack : c->release);
+        gain = c->makeup;
+        if (env > c->threshold) {
+            gain *= powf(env / c->threshold, c->slope);
+        }
+        for (ch = 0; ch < channels; ch++) {
+            buf[ch] *= gain;
+        }
+    }
+    c->env = _pg_flush(env);
+}
+
+void
+pg_delay_process(pgDelay *d, float *buf, int frames, int channels)
+{
+    float *in, *out, x, y;
+    int i, c, at;
+
+    for (i = 0; i < frames; i++, buf += channels) {
+        at = d->pos - d->delay;
+        if (at < 0) {
+            at += d->size;
+        }
+        in = d->line + (size_t)d->pos * channels;
+        out = d->line + (size_t)at * channels;
+        for (c = 0; c < channels; c++) {
+            x = buf[c];
+            y = out[c];
+            in[c] = _pg_flush(x + y * d->feedback);
+            buf[c] = x + (y - x) * d->mix;
+        }
+        if (++d->pos == d->size) {
+            d->pos = 0;
+        }
+    }
+}
+
+void
+pg_spatial_process(pgSpatial *s, const pgSpatialParams *to, float *buf,
+                   int frames, int channels)
+{
+    const pgSpatialParams *from = s->primed ? &s->last : to;
+    float step = frames > 0 ? 1.0f / frames : 0.0f, t, x, at, a, b, y;
+    float ear[2];
+    int mask = s->size - 1, i, c, e, k;
+
+    for (i = 0; i < frames; i++, buf += channels) {
+        x = 0.0f;
+        for (c = 0; c < channels; c++) {
+            x += buf[c];
+        }
+        s->line[s->pos] = x / channels;
+        t = (i + 1) * step;
+        for (e = 0; e < 2; e++) {
+            at = from->delay[e] + (to->delay[e] - from->delay[e]) * t;
+            k = (int)at;
+            a = s->line[(s->pos - k) & mask];
+            b = s->line[(s->pos - k - 1) & mask];
+            y = a + (b - a) * (at - k);
+            x = from->lowpass[e] + (to->lowpass[e] - from->lowpass[e]) * t;
+            s->z[e] = _pg_flush(y + (s->z[e] - y) * x);
+            ear[e] = s->z[e] *
+                     (from->gain[e] + (to->gain[e] - from->gain[e]) * t);
+        }
+        if (channels == 1) {
+            buf[0] = (ear[0] + ear[1]) * 0.5f;
+        }
+        else {
+            buf[0] = ear[0];
+            buf[1] = ear[1];
+            for (c = 2; c < channels; c++) {
+                buf[c] = 0.0f;
+            }
+        }
+        s->pos = (s->pos + 1) & mask;
+    }
+    s->last = *to;
+    s->primed = 1;
+}
+
+static int
+_pg_reverb_length(int tuning, int channel, int rate)
+{
+    int n = (int)((double)(tuning + channel * PG_REVERB_SPREAD) * rate /
+                  PG_REVERB_RATE);
+    return n > 0 ? n : 1;
+}
+
+size_t
+pg_reverb_size(int rate, int channels)
+{
+    size_t size = 0;
+    int c, j;
+
+    for (c = 0; c < channels; c++) {
+        for (j = 0; j < PG_REVERB_COMBS; j++) {
+            size += _pg_reverb_length(_pg_reverb_combs[j], c, rate);
+        }
+        for (j = 0; j < PG_REVERB_ALLPASSES; j++) {
+            size += _pg_reverb_length(_pg_reverb_allpasses[j], c, rate);
+        }
+    }
+    return size;
+}
+
+void
+pg_reverb_init(pgReverb *r, float *mem, int rate, int channels)
+{
+    int c, j;
+
+    for (c = 0; c < channels; c++) {
+        for (j = 0; j < PG_REVERB_COMBS; j++) {
+            r->comb[c][j].buf = mem;
+            r->comb[c][j].size = _pg_reverb_length(_pg_reverb_combs[j], c,
+                                                   rate);
+            r->comb[c][j].pos = 0;
+            r->store[c][j] = 0.0f;
+            mem += r->comb[c][j].size;
+        }
+        for (j = 0; j < PG_REVERB_ALLPASSES; j++) {
+            r->allpass[c][j].buf = mem;
+            r->allpass[c][j].size =
+                _pg_reverb_length(_pg_reverb_allpasses[j], c, rate);
+            r->allpass[c][j].pos = 0;
+            mem += r->allpass[c][j].size;
+        }
+    }
+}
+
+void
+pg_reverb_design(pgReverb *r, double room_size, double damping, double mix)
+{
+    r->feedback = (float)(room_size * 0.28 + 0.7);
+    r->damp = (float)(damping * 0.4);
+    r->mix = (float)mix;
+}
+
+void
+pg_reverb_process(pgReverb *r, float *buf, int frames, int channels)
+{
+    float in[PG_REVERB_BLOCK], acc[PG_REVERB_BLOCK];
+    float gain = PG_REVERB_GAIN * 2.0f / channels;
+    float store, y, x;
+    pgReverbLine *line;
+    int n, k, c, j;
+
+    while (frames > 0) {
+        n = frames < PG_REVERB_BLOCK ? frames : PG_REVERB_BLOCK;
+        for (k = 0; k < n; k++) {
+            x = 0.0f;
+            for (c = 0; c < channels; c++) {
+                x += buf[k * channels + c];
+            }
+            in[k] = x * gain;
+        }
+        for (c = 0; c < channels; c++) {
+            for (k = 0; k < n; k++) {
+                acc[k] = 0.0f;
+            }
+            for (j = 0; j < PG_REVERB_COMBS; j++) {
+                line = &r->comb[c][j];
+                store = r->store[c][j];
+                for (k = 0; k < n; k++) {
+                    y = line->buf[line->pos];
+                    store = y + (store - y) * r->damp;
+                    line->buf[line->pos] = in[k] + store * r->feedback;
+                    if (++line->pos == line->size) {
+                        line->pos = 0;
+                    }
+                    acc[k] += y;
+                }
+                r->store[c][j] = _pg_flush(store);
+            }
+            for (j = 0; j < PG_REVERB_ALLPASSES; j++) {
+                line = &r->allpass[c][j];
+                for (k = 0; k < n; k++) {
+                    y = line->buf[line->pos];
+                    line->buf[line->pos] = _pg_flush(acc[k] + y * 0.5f);
+                    acc[k] = y - acc[k];
+                    if (++line->pos == line->size) {
+                        line->pos = 0;
+                    }
+                }
+            }
+            for (k = 0; k < n; k++) {
+                x = buf[k * channels + c];
+                buf[k * channels + c] =
+                    x + (acc[k] * PG_REVERB_WET - x) * r->mix;
+            }
+        }
+        buf += (size_t)n * channels;
+        frames -= n;
+    }
+}
+
+void
+pg_crossfade(float *buf, const float *from, int frames, int channels,
+             Uint32 pos, Uint32 len)
+{
+    int k, c;
+    double angle;
+    float in, out;
+
+    for (k = 0; k < frames; k++) {
+        angle = (pos + k + 0.5) / len * (PG_DSP_PI / 2.0);
+        in = (float)sin(angle);
+        out = (float)cos(angle);
+        for (c = 0; c < channels; c++) {
+            buf[k * channels + c] =
+                buf[k * channels + c] * in + from[k * channels + c] * out;
+        }
+    }
+}
+
+void
+pg_ramp(float *buf, int frames, int channels, float from, float to)
+{
+    int k, c;
+    float gain, step = frames > 0 ? (to - from) / frames : 0.0f;
+
+    for (k = 0; k < frames; k++) {
+        gain = from + step * k;
+        for (c = 0; c < channels; c++) {
+            buf[k * channels + c] *= gain;
+        }
+    }
+}
+
+void
+pg_fft_twiddles(float *cos_table, float *sin_table, int n)
+{
+    int k;
+
+    for (k = 0; k < n / 2; k++) {
+        cos_table[k] = (float)cos(2.0 * PG_DSP_PI * k / n);
+        sin_table[k] = (float)-sin(2.0 * PG_DSP_PI * k / n);
+    }
+}
+
+void
+pg_fft(float *re, float *im, const float *cos_table, const float *sin_table,
+       int n)
+{
+    int i, j, k, len, half, step;
+    float tr, ti, wr, wi;
+
+    /* bit reversed order, then butterflies of doubling length */
+    for (i = 1, j = 0; i < n; i++) {
+        k = n >> 1;
+        while (j & k) {
+            j ^= k;
+            k >>= 1;
+        }
+        j |= k;
+        if (i < j) {
+            tr = re[i];
+            re[i] = re[j];
+            re[j] = tr;
+            ti = im[i];
+            im[i] = im[j];
+            im[j] = ti;
+        }
+    }
+    for (len = 2; len <= n; len <<= 1) {
+        half = len >> 1;
+        step = n / len;
+        for (i = 0; i < n; i += len) {
+            for (k = 0; k < half; k++) {
+                wr = cos_table[k * step];
+                wi = sin_table[k * step];
+                j = i + k + half;
+                tr = re[j] * wr - im[j] * wi;
+                ti = re[j] * wi + im[j] * wr;
+                re[j] = re[i + k] - tr;
+                im[j] = im[i + k] - ti;
+                re[i + k] += tr;
+                im[i + k] += ti;
+            }
+        }
+    }
+}
+
+int
+pg_adpcm_block_frames(int block_align, int channels)
+{
+    /* two samples a byte after the headers, and the one in the header */
+    return (block_align - 4 * channels) * 2 / channels + 1;
+}
+
+size_t
+pg_adpcm_size(size_t frames, int channels, int block_align)
+{
+    size_t per_block = pg_adpcm_block_frames(block_align, channels);
+    size_t rest = frames % per_block;
+    size_t size = frames / per_block * block_align;
+
+    if (rest) {
+        size += 4 * channels + (rest - 1 + 7) / 8 * 4 * channels;
+    }
+    return size;
+}
+
+/* Encode a sample as a 4 bit step from the prediction, and make the
+   prediction the decoder will */
+static int
+_pg_adpcm_nibble(int sample, int *predictor, int *index)
+{
+    int step = _pg_adpcm_steps[*index];
+    int diff = sample - *predictor;
+    int nibble = 0, delta = step >> 3;
+
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+        delta += step;
+    }
+    *predictor += nibble & 8 ? -delta : delta;
+    *predictor = *predictor < -32768  ? -32768
+                 : *predictor > 32767 ? 32767
+                                      : *predictor;
+    *index += _pg_adpcm_indices[nibble & 7];
+    *index = *index < 0 ? 0 : *index > 88 ? 88 : *index;
+    return nibble;
+}
+
+void
+pg_adpcm_encode(const Sint16 *in, size_t frames, int channels,
+                int block_align, Uint8 *out)
+{
+    int predictor[PG_DSP_MAX_CHANNELS], index[PG_DSP_MAX_CHANNELS];
+    size_t per_block = pg_adpcm_block_frames(block_align, channels);
+    size_t n, f, g, groups;
+    const Sint16 *last;
+    int c, k, nibble;
+
+    /* start with a step the size of the first change, rather than the
+       smallest one, which takes a while to catch up */
+    for (c = 0; c < channels; c++) {
+        index[c] = 0;
+        if (frames > 1) {
+            k = in[channels + c] - in[c];
+            k = k < 0 ? -k : k;
+            while (index[c] < 88 && _pg_adpcm_steps[index[c]] < k) {
+                index[c]++;
+            }
+        }
+    }
+    while (frames) {
+        n = frames < per_block ? frames : per_block;
+        last = in + (n - 1) * channels;
+        for (c = 0; c < channels; c++, out += 4) {
+            predictor[c] = in[c];
+            out[0] = (Uint8)(in[c] & 0xFF);
+            out[1] = (Uint8)((in[c] >> 8) & 0xFF);
+            out[2] = (Uint8)index[c];
+            out[3] = 0;
+        }
+        /* past the last frame, the rest of its group repeats it */
+        groups = (n - 1 + 7) / 8;
+        for (g = 0; g < groups; g++) {
+            for (c = 0; c < channels; c++, out += 4) {
+                for (k = 0; k < 8; k++) {
+                    f = 1 + g * 8 + k;
+                    nibble = _pg_adpcm_nibble(
+                        f < n ? in[f * channels + c] : last[c],
+                        &predictor[c], &index[c]);
+                    if (k & 1) {
+                        out[k / 2] |= (Uint8)(nibble << 4);
+                    }
+                    else {
+                        out[k / 2] = (Uint8)nibble;
+                    }
+                }
+            }
+        }
+        in += n * channels;
+        frames -= n;
+    }
+}
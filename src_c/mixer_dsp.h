@@ -0,0 +1,159 @@
+#ifndef MIXER_DSP_H
+#define MIXER_DSP_H
+
+#include <SDL.h>
+
+/* Signal processing for the native mixer effects, in mixer_dsp.c.
+ *
+ * Everything works in place on interleaved float samples of up to
+ * PG_DSP_MAX_CHANNELS channels. Nothing here allocates or locks, so it can
+ * run in the audio thread; the delay lines are handed in by the caller.
+ * The inner loops run over the channels of a frame with the state of each
+ * channel side by side, which compilers can vectorize. */
+#define PG_DSP_MAX_CHANNELS 8
+
+/* Biquad filters, designed after the Audio EQ Cookbook by Robert
+ * Bristow-Johnson, run in transposed direct form II */
+#define PG_BIQUAD_LOWPASS 0
+#define PG_BIQUAD_HIGHPASS 1
+#define PG_BIQUAD_BANDPASS 2
+#define PG_BIQUAD_NOTCH 3
+#define PG_BIQUAD_PEAKING 4
+#define PG_BIQUAD_LOWSHELF 5
+#define PG_BIQUAD_HIGHSHELF 6
+
+typedef struct {
+    float b0, b1, b2, a1, a2;
+    float z1[PG_DSP_MAX_CHANNELS];
+    float z2[PG_DSP_MAX_CHANNELS];
+} pgBiquad;
+
+/* Set the coefficients, keeping the state so that filters can be swept */
+void
+pg_biquad_design(pgBiquad *bq, int type, double frequency, double q,
+                 double gain_db, int rate);
+void
+pg_biquad_process(pgBiquad *bq, float *buf, int frames, int channels);
+
+/* Feed-forward compressor, the channels sharing one peak detector. An
+ * infinite ratio with no attack makes it a limiter. */
+typedef struct {
+    float threshold; /* linear */
+    float slope;     /* 1 / ratio - 1 */
+    float attack;    /* one pole coefficients of the detector */
+    float release;
+    float makeup; /* linear */
+    float env;
+} pgCompressor;
+
+void
+pg_compressor_design(pgCompressor *c, double threshold_db, double ratio,
+                     double attack_ms, double release_ms, double makeup_db,
+                     int rate);
+void
+pg_compressor_process(pgCompressor *c, float *buf, int frames, int channels);
+
+/* Feedback delay, on a line of size frames of the same channels */
+typedef struct {
+    float *line;
+    int size;
+    int pos;
+    int delay; /* frames, from 1 to size */
+    float feedback;
+    float mix;
+} pgDelay;
+
+void
+pg_delay_process(pgDelay *d, float *buf, int frames, int channels);
+
+/* Schroeder reverb with the tuning of Jezar's Freeverb: eight damped comb
+ * filters in parallel, then four allpass filters in series, for each
+ * channel, fed with the sum of the channels. The channels get slightly
+ * longer filters each, which spreads the sound. */
+#define PG_REVERB_COMBS 8
+#define PG_REVERB_ALLPASSES 4
+
+typedef struct {
+    float *buf;
+    int size;
+    int pos;
+} pgReverbLine;
+
+typedef struct {
+    pgReverbLine comb[PG_DSP_MAX_CHANNELS][PG_REVERB_COMBS];
+    pgReverbLine allpass[PG_DSP_MAX_CHANNELS][PG_REVERB_ALLPASSES];
+    float store[PG_DSP_MAX_CHANNELS][PG_REVERB_COMBS];
+    float feedback;
+    float damp;
+    float mix;
+} pgReverb;
+
+/* The number of floats of memory pg_reverb_init() needs */
+size_t
+pg_reverb_size(int rate, int channels);
+void
+pg_reverb_init(pgReverb *r, float *mem, int rate, int channels);
+void
+pg_reverb_design(pgReverb *r, double room_size, double damping, double mix);
+void
+pg_reverb_process(pgReverb *r, float *buf, int frames, int channels);
+
+/* A point source heard by two ears, for the 3D emitters. The channels are
+ * mixed down to one and written to a delay line, which each ear reads
+ * with a fractional delay: the travel time of the sound, whose change
+ * gives the doppler shift, plus the interaural delay. Each ear then has a
+ * one pole low pass, for the shadow of the head, and a gain. The
+ * parameters ramp from the last buffer to this one. The ears go to the
+ * first two channels, or are mixed together on a mono device. */
+typedef struct {
+    float delay[2]; /* frames, at most size - 2 */
+    float gain[2];
+    float lowpass[2]; /* one pole coefficients, 0 is open */
+} pgSpatialParams;
+
+typedef struct {
+    float *line; /* size frames of one channel, size a power of two */
+    int size;
+    int pos;
+    int primed; /* whether last holds the parameters of the last buffer */
+    pgSpatialParams last;
+    float z[2];
+} pgSpatial;
+
+void
+pg_spatial_process(pgSpatial *s, const pgSpatialParams *to, float *buf,
+                   int frames, int channels);
+
+/* Mix buf, fading in, with from, fading out, with equal power gains, for
+ * frames of a fade of len frames that are pos frames into it */
+void
+pg_crossfade(float *buf, const float *from, int frames, int channels,
+             Uint32 pos, Uint32 len);
+/* Scale buf by a gain going linearly from from to to */
+void
+pg_ramp(float *buf, int frames, int channels, float from, float to);
+
+/* In place radix 2 FFT of n complex samples, n a power of two, with the
+ * n / 2 twiddle factors of pg_fft_twiddles() */
+void
+pg_fft_twiddles(float *cos_table, float *sin_table, int n);
+void
+pg_fft(float *re, float *im, const float *cos_table, const float *sin_table,
+       int n);
+
+/* IMA ADPCM encoding, as in WAV files of format 0x11, for sound banks.
+ * Decoding is left to SDL's WAV loader. Each block of block_align bytes
+ * starts with a header per channel, the first sample and step index,
+ * followed by groups of eight 4 bit samples of each channel in turn. The
+ * last block may be shorter, down to the group that holds the last
+ * frame. */
+int
+pg_adpcm_block_frames(int block_align, int channels);
+size_t
+pg_adpcm_size(size_t frames, int channels, int block_align);
+/* Encode frames of interleaved samples into pg_adpcm_size() bytes */
+void
+pg_adpcm_encode(const Sint16 *in, size_t frames, int channels,
+                int block_align, Uint8 *out);
+
+#endif /* MIXER_DSP_H */
@@ -36,17 +36,22 @@ static Mix_Music *current_music = NULL;
 static Mix_Music *queue_music = NULL;
 static int queue_music_loops = 0;
 static int endmusic_event = SDL_NOEVENT;
-static Uint64 music_pos = 0;
+static Uint64 music_pos = 0; /* bytes mixed while the music played */
 static Uint64 music_pos_time = -1;
+static int music_pos_len = 0; /* bytes of the last callback */
 static int music_frequency = 0;
 static Uint16 music_format = 0;
 static int music_channels = 0;
+/* Playlists are mixed by the mixer module, next to the converters they
+   need, so its C api is imported when a playlist starts */
+static int playlist_started = 0;
 
 static void
 mixmusic_callback(void *udata, Uint8 *stream, int len)
 {
     if (!Mix_PausedMusic()) {
         music_pos += len;
+        music_pos_len = len;
         music_pos_time = PG_GetTicks();
     }
 }
@@ -91,6 +96,11 @@ music_play(PyObject *self, PyObject *args, PyObject *keywds)
     if (!current_music)
         return RAISE(pgExc_SDLError, "music not loaded");
 
+    if (playlist_started) {
+        pgMixer_StopPlaylist(0);
+        playlist_started = 0;
+    }
+
     Py_BEGIN_ALLOW_THREADS;
     Mix_HookMusicFinished(endmusic_callback);
     Mix_SetPostMix(mixmusic_callback, NULL);
@@ -113,8 +123,15 @@ music_get_busy(PyObject *self, PyObject *_null)
 {
     int playing;
 
+    Py_ssize_t index;
+    Sint64 ms;
+
     MIXER_INIT_CHECK();
 
+    if (playlist_started && pgMixer_GetPlaylistState(&index, &ms)) {
+        return PyBool_FromLong(!Mix_PausedMusic());
+    }
+
     Py_BEGIN_ALLOW_THREADS;
     playing = (Mix_PlayingMusic() && !Mix_PausedMusic());
     Py_END_ALLOW_THREADS;
@@ -131,6 +148,10 @@ music_fadeout(PyObject *self, PyObject *args)
 
     MIXER_INIT_CHECK();
 
+    if (playlist_started) {
+        pgMixer_StopPlaylist(_time);
+    }
+
     Py_BEGIN_ALLOW_THREADS;
     /* To prevent the queue_music from playing, free it before fading. */
     if (queue_music) {
@@ -150,6 +171,11 @@ music_stop(PyObject *self, PyObject *_null)
 {
     MIXER_INIT_CHECK();
 
+    if (playlist_started) {
+        pgMixer_StopPlaylist(0);
+        playlist_started = 0;
+    }
+
     Py_BEGIN_ALLOW_THREADS;
     /* To prevent the queue_music from playing, free it before stopping. */
     if (queue_music) {
@@ -223,6 +249,35 @@ music_get_volume(PyObject *self, PyObject *_null)
     return PyFloat_FromDouble(volume / 128.0);
 }
 
+/* The effects run in the mixer module, which imports this one, so its C
+   api is only imported once it is needed */
+static PyObject *
+music_set_effects(PyObject *self, PyObject *arg)
+{
+    MIXER_INIT_CHECK();
+
+    import_pygame_mixer();
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+    if (pgMixer_SetMusicEffects(arg)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+music_get_effects(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+
+    import_pygame_mixer();
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+    return pgMixer_GetMusicEffects();
+}
+
 static PyObject *
 music_set_pos(PyObject *self, PyObject *arg)
 {
@@ -248,23 +303,64 @@ music_set_pos(PyObject *self, PyObject *arg)
 static PyObject *
 music_get_pos(PyObject *self, PyObject *_null)
 {
-    Uint64 ticks;
+    Uint64 ticks, elapsed, buffer_ms;
+    Py_ssize_t index;
+    Sint64 ms;
 
     MIXER_INIT_CHECK();
 
+    if (playlist_started && pgMixer_GetPlaylistState(&index, &ms)) {
+        return PyLong_FromLongLong(ms);
+    }
+
     Uint16 intermediate_step = (music_format & 0xff) >> 3;
     long denominator = music_channels * music_frequency * intermediate_step;
-    if (music_pos_time < 0 || denominator == 0) {
+    if (music_pos_time == (Uint64)-1 || denominator == 0) {
         return PyLong_FromLong(-1);
     }
 
     ticks = (long)(1000 * music_pos / denominator);
-    if (!Mix_PausedMusic())
-        ticks += PG_GetTicks() - music_pos_time;
+    if (!Mix_PausedMusic()) {
+        /* the clock only fills in between callbacks, so a stalled or
+           offline device doesn't make the music run ahead */
+        elapsed = PG_GetTicks() - music_pos_time;
+        buffer_ms = 1000 * (Uint64)music_pos_len / denominator;
+        ticks += elapsed < buffer_ms ? elapsed : buffer_ms;
+    }
 
     return PyLong_FromUnsignedLongLong(ticks);
 }
 
+static PyObject *
+music_get_position(PyObject *self, PyObject *_null)
+{
+    Py_ssize_t index;
+    Sint64 ms;
+#if SDL_MIXER_VERSION_ATLEAST(2, 6, 0)
+    double position;
+#endif
+
+    MIXER_INIT_CHECK();
+
+    if (playlist_started && pgMixer_GetPlaylistState(&index, &ms)) {
+        return PyFloat_FromDouble(ms / 1000.0);
+    }
+    if (!current_music)
+        return RAISE(pgExc_SDLError, "music not loaded");
+
+#if SDL_MIXER_VERSION_ATLEAST(2, 6, 0)
+    Py_BEGIN_ALLOW_THREADS;
+    position = Mix_GetMusicPosition(current_music);
+    Py_END_ALLOW_THREADS;
+    if (position < 0.0)
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    return PyFloat_FromDouble(position);
+#else
+    return RAISE(pgExc_SDLError,
+                 "get_position needs SDL_mixer 2.6.0 or newer");
+#endif
+}
+
 static PyObject *
 music_set_endevent(PyObject *self, PyObject *args)
 {
@@ -489,6 +585,83 @@ music_queue(PyObject *self, PyObject *args, PyObject *keywds)
     Py_RETURN_NONE;
 }
 
+static PyObject *
+music_play_playlist(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    PyObject *tracks;
+    int loops = 0, crossfade = 0;
+    static char *kwids[] = {"tracks", "loops", "crossfade", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "O|ii", kwids, &tracks,
+                                     &loops, &crossfade))
+        return NULL;
+
+    MIXER_INIT_CHECK();
+
+    import_pygame_mixer();
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    if (queue_music) {
+        Mix_FreeMusic(queue_music);
+        queue_music = NULL;
+        queue_music_loops = 0;
+    }
+    Mix_HaltMusic();
+    Mix_ResumeMusic();
+    Py_END_ALLOW_THREADS;
+
+    if (pgMixer_PlayPlaylist(tracks, loops, crossfade, &endmusic_event)) {
+        return NULL;
+    }
+    playlist_started = 1;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+music_extend_playlist(PyObject *self, PyObject *arg)
+{
+    MIXER_INIT_CHECK();
+
+    if (!playlist_started) {
+        return RAISE(pgExc_SDLError, "no playlist is playing");
+    }
+    if (pgMixer_ExtendPlaylist(arg)) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+music_skip_track(PyObject *self, PyObject *_null)
+{
+    MIXER_INIT_CHECK();
+
+    if (!playlist_started) {
+        return RAISE(pgExc_SDLError, "no playlist is playing");
+    }
+    if (pgMixer_SkipTrack()) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+music_get_playlist_index(PyObject *self, PyObject *_null)
+{
+    Py_ssize_t index = -1;
+    Sint64 ms;
+
+    MIXER_INIT_CHECK();
+
+    if (playlist_started) {
+        pgMixer_GetPlaylistState(&index, &ms);
+    }
+    return PyLong_FromSsize_t(index);
+}
+
 static PyObject *
 music_get_metadata(PyObject *self, PyObject *args, PyObject *keywds)
 {
@@ -559,8 +732,13 @@ static PyMethodDef _music_methods[] = {
     {"rewind", music_rewind, METH_NOARGS, DOC_MIXER_MUSIC_REWIND},
     {"set_volume", music_set_volume, METH_VARARGS, DOC_MIXER_MUSIC_SETVOLUME},
     {"get_volume", music_get_volume, METH_NOARGS, DOC_MIXER_MUSIC_GETVOLUME},
+    {"set_effects", music_set_effects, METH_O, DOC_MIXER_MUSIC_SETEFFECTS},
+    {"get_effects", music_get_effects, METH_NOARGS,
+     DOC_MIXER_MUSIC_GETEFFECTS},
     {"set_pos", music_set_pos, METH_O, DOC_MIXER_MUSIC_SETPOS},
     {"get_pos", music_get_pos, METH_NOARGS, DOC_MIXER_MUSIC_GETPOS},
+    {"get_position", music_get_position, METH_NOARGS,
+     DOC_MIXER_MUSIC_GETPOSITION},
     {"get_metadata", (PyCFunction)music_get_metadata,
      METH_VARARGS | METH_KEYWORDS, DOC_MIXER_MUSIC_GETMETADATA},
 
@@ -569,6 +747,13 @@ static PyMethodDef _music_methods[] = {
     {"unload", music_unload, METH_NOARGS, DOC_MIXER_MUSIC_UNLOAD},
     {"queue", (PyCFunction)music_queue, METH_VARARGS | METH_KEYWORDS,
      DOC_MIXER_MUSIC_QUEUE},
+    {"play_playlist", (PyCFunction)music_play_playlist,
+     METH_VARARGS | METH_KEYWORDS, DOC_MIXER_MUSIC_PLAYPLAYLIST},
+    {"extend_playlist", music_extend_playlist, METH_O,
+     DOC_MIXER_MUSIC_EXTENDPLAYLIST},
+    {"skip_track", music_skip_track, METH_NOARGS, DOC_MIXER_MUSIC_SKIPTRACK},
+    {"get_playlist_index", music_get_playlist_index, METH_NOARGS,
+     DOC_MIXER_MUSIC_GETPLAYLISTINDEX},
 
     {NULL, NULL, 0, NULL}};
 
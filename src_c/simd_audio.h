@@ -0,0 +1,140 @@
+#ifndef SIMD_AUDIO_H
+#define SIMD_AUDIO_H
+
+#include <SDL.h>
+
+#if !defined(PG_ENABLE_ARM_NEON) && defined(__aarch64__)
+// arm64 has neon optimisations enabled by default, even when fpu=neon is not
+// passed
+#define PG_ENABLE_ARM_NEON 1
+#endif
+
+#if defined(__SSE2__)
+#define PG_ENABLE_SSE_NEON 1
+#elif PG_ENABLE_ARM_NEON
+#define PG_ENABLE_SSE_NEON 1
+#else
+#define PG_ENABLE_SSE_NEON 0
+#endif
+
+/* See simd_transform.h, borrowed from SSE2NEON */
+#define _PG_SIMD_SHUFFLE(fp3, fp2, fp1, fp0) \
+    (((fp3) << 6) | ((fp2) << 4) | ((fp1) << 2) | ((fp0)))
+
+/* Sample types understood by the converters. Samples are always in native
+ * byte order. The low byte is the sample size in bytes, the rest flags.
+ * Integer samples map to floats in [-1.0, 1.0), unsigned ones being offset
+ * by half their range. */
+#define PG_CVT_UNSIGNED 0x100
+#define PG_CVT_FLOAT 0x200
+#define PG_CVT_S8 1
+#define PG_CVT_U8 (1 | PG_CVT_UNSIGNED)
+#define PG_CVT_S16 2
+#define PG_CVT_U16 (2 | PG_CVT_UNSIGNED)
+#define PG_CVT_S32 4
+#define PG_CVT_U32 (4 | PG_CVT_UNSIGNED)
+#define PG_CVT_F32 (4 | PG_CVT_FLOAT)
+#define PG_CVT_F64 (8 | PG_CVT_FLOAT)
+#define PG_CVT_SIZE(type) ((type) & 0xff)
+
+/* Entry points, in mixer_convert.c. These pick the fastest kernel the
+ * running CPU supports and finish any remainder with scalar code. */
+
+/* Convert n samples between any two sample types. Integer to integer
+ * conversions keep the sample bits as Sound(array=...) always has:
+ * widening shifts left and narrowing keeps the low bits. */
+void
+pg_audio_convert(const void *src, int src_type, void *dst, int dst_type,
+                 size_t n);
+void
+pg_audio_to_f32(const void *src, int src_type, float *dst, size_t n);
+void
+pg_audio_from_f32(const float *src, void *dst, int dst_type, size_t n);
+
+/* Stereo (de)interleaving of samples of size 1, 2, 4 or 8 bytes */
+void
+pg_audio_interleave2(const void *left, const void *right, void *dst,
+                     int size, size_t frames);
+void
+pg_audio_deinterleave2(const void *src, void *left, void *right, int size,
+                       size_t frames);
+
+/* Resampling of interleaved float samples, for whole buffers. The output
+ * holds pg_audio_resample_frames() frames. Returns -1 when out of
+ * memory. */
+#define PG_RESAMPLE_LINEAR 0
+#define PG_RESAMPLE_MEDIUM 1
+#define PG_RESAMPLE_BEST 2
+
+size_t
+pg_audio_resample_frames(size_t frames, int rate, int new_rate);
+int
+pg_audio_resample(const float *src, size_t frames, float *dst,
+                  size_t dst_frames, int channels, int rate, int new_rate,
+                  int quality);
+
+/* The kernels below convert as many samples as fill whole vectors and
+ * return how many they did; the caller handles the rest. */
+
+int
+pg_audio_has_avx2(void);
+int
+pg_audio_has_sse_neon(void);
+
+// SSE2 functions
+size_t
+pg_audio_s8_to_f32_sse2(const Uint8 *src, float *dst, size_t n,
+                        int is_unsigned);
+size_t
+pg_audio_s16_to_f32_sse2(const Uint16 *src, float *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_s32_to_f32_sse2(const Uint32 *src, float *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_f32_to_s8_sse2(const float *src, Uint8 *dst, size_t n,
+                        int is_unsigned);
+size_t
+pg_audio_f32_to_s16_sse2(const float *src, Uint16 *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_f32_to_s32_sse2(const float *src, Uint32 *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_interleave2_sse2(const Uint8 *left, const Uint8 *right, Uint8 *dst,
+                          int size, size_t frames);
+size_t
+pg_audio_deinterleave2_sse2(const Uint8 *src, Uint8 *left, Uint8 *right,
+                            int size, size_t frames);
+size_t
+pg_audio_dot_f32_sse2(const float *a, const float *b, size_t n, float *sum);
+
+// AVX2 functions
+size_t
+pg_audio_s8_to_f32_avx2(const Uint8 *src, float *dst, size_t n,
+                        int is_unsigned);
+size_t
+pg_audio_s16_to_f32_avx2(const Uint16 *src, float *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_s32_to_f32_avx2(const Uint32 *src, float *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_f32_to_s8_avx2(const float *src, Uint8 *dst, size_t n,
+                        int is_unsigned);
+size_t
+pg_audio_f32_to_s16_avx2(const float *src, Uint16 *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_f32_to_s32_avx2(const float *src, Uint32 *dst, size_t n,
+                         int is_unsigned);
+size_t
+pg_audio_interleave2_avx2(const Uint8 *left, const Uint8 *right, Uint8 *dst,
+                          int size, size_t frames);
+size_t
+pg_audio_deinterleave2_avx2(const Uint8 *src, Uint8 *left, Uint8 *right,
+                            int size, size_t frames);
+size_t
+pg_audio_dot_f32_avx2(const float *a, const float *b, size_t n, float *sum);
+
+#endif /* SIMD_AUDIO_H */
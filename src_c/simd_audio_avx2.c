@@ -0,0 +1,374 @@
+#define NO_PYGAME_C_API
+#include "_pygame.h"
+#include "simd_audio.h"
+
+#if defined(HAVE_IMMINTRIN_H) && !defined(SDL_DISABLE_IMMINTRIN_H)
+#include <immintrin.h>
+#endif /* defined(HAVE_IMMINTRIN_H) && !defined(SDL_DISABLE_IMMINTRIN_H) */
+
+#define BAD_AVX2_FUNCTION_CALL                                               \
+    printf(                                                                  \
+        "Fatal Error: Attempted calling an AVX2 function when both compile " \
+        "time and runtime support is missing. If you are seeing this "       \
+        "message, you have stumbled across a pygame bug, please report it "  \
+        "to the devs!");                                                     \
+    PG_EXIT(1)
+
+/* helper function that does a runtime check for AVX2. It has the added
+ * functionality of also returning 0 if compile time support is missing */
+int
+pg_audio_has_avx2(void)
+{
+#if defined(__AVX2__) && defined(HAVE_IMMINTRIN_H) && \
+    !defined(SDL_DISABLE_IMMINTRIN_H)
+    return SDL_HasAVX2();
+#else
+    return 0;
+#endif /* defined(__AVX2__) && defined(HAVE_IMMINTRIN_H) && \
+          !defined(SDL_DISABLE_IMMINTRIN_H) */
+}
+
+#if defined(__AVX2__) && defined(HAVE_IMMINTRIN_H) && \
+    !defined(SDL_DISABLE_IMMINTRIN_H)
+
+/* Floats at or above 2^31 convert to INT_MIN on x86, as does NaN. Flipping
+ * every bit of the lanes that overflowed upwards turns them into INT_MAX,
+ * as _pg_float_to_int() in mixer_convert.c gives. */
+#define _PG_CVT_SATURATE_256(v)                                 \
+    _mm256_xor_si256(                                           \
+        _mm256_cvtps_epi32(v),                                  \
+        _mm256_castps_si256(_mm256_cmp_ps(                      \
+            (v), _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ)))
+
+size_t
+pg_audio_s8_to_f32_avx2(const Uint8 *src, float *dst, size_t n,
+                        int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi8(is_unsigned ? (char)0x80 : 0);
+    const __m256 scale = _mm256_set1_ps(1.0f / 128.0f);
+    __m128i mm_src;
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        mm_src = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)),
+                               flip);
+        _mm256_storeu_ps(
+            dst + i,
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(mm_src)),
+                          scale));
+        _mm256_storeu_ps(
+            dst + i + 8,
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(
+                              _mm_srli_si128(mm_src, 8))),
+                          scale));
+    }
+    return i;
+}
+
+size_t
+pg_audio_s16_to_f32_avx2(const Uint16 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi16(is_unsigned ? (short)0x8000 : 0);
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    __m128i mm_lo, mm_hi;
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        mm_lo = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)),
+                              flip);
+        mm_hi = _mm_xor_si128(
+            _mm_loadu_si128((const __m128i *)(src + i + 8)), flip);
+        _mm256_storeu_ps(
+            dst + i,
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(mm_lo)),
+                          scale));
+        _mm256_storeu_ps(
+            dst + i + 8,
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(mm_hi)),
+                          scale));
+    }
+    return i;
+}
+
+size_t
+pg_audio_s32_to_f32_avx2(const Uint32 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m256i flip =
+        _mm256_set1_epi32(is_unsigned ? (int)0x80000000u : 0);
+    const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+    __m256i mm_src;
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        mm_src = _mm256_xor_si256(
+            _mm256_loadu_si256((const __m256i *)(src + i)), flip);
+        _mm256_storeu_ps(dst + i,
+                         _mm256_mul_ps(_mm256_cvtepi32_ps(mm_src), scale));
+    }
+    return i;
+}
+
+size_t
+pg_audio_f32_to_s8_avx2(const float *src, Uint8 *dst, size_t n,
+                        int is_unsigned)
+{
+    const __m256i flip = _mm256_set1_epi8(is_unsigned ? (char)0x80 : 0);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const __m256 scale = _mm256_set1_ps(128.0f);
+    __m256 mm_src;
+    __m256i mm_0, mm_1, mm_2, mm_3;
+    size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        mm_src = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        mm_0 = _PG_CVT_SATURATE_256(mm_src);
+        mm_src = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        mm_1 = _PG_CVT_SATURATE_256(mm_src);
+        mm_src = _mm256_mul_ps(_mm256_loadu_ps(src + i + 16), scale);
+        mm_2 = _PG_CVT_SATURATE_256(mm_src);
+        mm_src = _mm256_mul_ps(_mm256_loadu_ps(src + i + 24), scale);
+        mm_3 = _PG_CVT_SATURATE_256(mm_src);
+        /* the packs work per 128 bit lane, leaving groups of four samples
+         * out of order: put them back with a cross lane permute */
+        mm_0 = _mm256_packs_epi16(_mm256_packs_epi32(mm_0, mm_1),
+                                  _mm256_packs_epi32(mm_2, mm_3));
+        mm_0 = _mm256_permutevar8x32_epi32(mm_0, order);
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_xor_si256(mm_0, flip));
+    }
+    return i;
+}
+
+size_t
+pg_audio_f32_to_s16_avx2(const float *src, Uint16 *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m256i flip = _mm256_set1_epi16(is_unsigned ? (short)0x8000 : 0);
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    __m256 mm_src;
+    __m256i mm_lo, mm_hi;
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        mm_src = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        mm_lo = _PG_CVT_SATURATE_256(mm_src);
+        mm_src = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        mm_hi = _PG_CVT_SATURATE_256(mm_src);
+        mm_lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(mm_lo, mm_hi),
+                                         _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_xor_si256(mm_lo, flip));
+    }
+    return i;
+}
+
+size_t
+pg_audio_f32_to_s32_avx2(const float *src, Uint32 *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m256i flip =
+        _mm256_set1_epi32(is_unsigned ? (int)0x80000000u : 0);
+    const __m256 scale = _mm256_set1_ps(2147483648.0f);
+    __m256 mm_src;
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        mm_src = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        _mm256_storeu_si256(
+            (__m256i *)(dst + i),
+            _mm256_xor_si256(_PG_CVT_SATURATE_256(mm_src), flip));
+    }
+    return i;
+}
+
+size_t
+pg_audio_interleave2_avx2(const Uint8 *left, const Uint8 *right, Uint8 *dst,
+                          int size, size_t frames)
+{
+    size_t nbytes = frames * size;
+    size_t i;
+    __m256i mm_l, mm_r, mm_lo, mm_hi;
+
+    for (i = 0; i + 32 <= nbytes; i += 32) {
+        mm_l = _mm256_loadu_si256((const __m256i *)(left + i));
+        mm_r = _mm256_loadu_si256((const __m256i *)(right + i));
+        switch (size) {
+            case 1:
+                mm_lo = _mm256_unpacklo_epi8(mm_l, mm_r);
+                mm_hi = _mm256_unpackhi_epi8(mm_l, mm_r);
+                break;
+            case 2:
+                mm_lo = _mm256_unpacklo_epi16(mm_l, mm_r);
+                mm_hi = _mm256_unpackhi_epi16(mm_l, mm_r);
+                break;
+            case 4:
+                mm_lo = _mm256_unpacklo_epi32(mm_l, mm_r);
+                mm_hi = _mm256_unpackhi_epi32(mm_l, mm_r);
+                break;
+            default:
+                mm_lo = _mm256_unpacklo_epi64(mm_l, mm_r);
+                mm_hi = _mm256_unpackhi_epi64(mm_l, mm_r);
+                break;
+        }
+        /* the unpacks work per 128 bit lane */
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i),
+                            _mm256_permute2x128_si256(mm_lo, mm_hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * i + 32),
+                            _mm256_permute2x128_si256(mm_lo, mm_hi, 0x31));
+    }
+    return i / size;
+}
+
+size_t
+pg_audio_deinterleave2_avx2(const Uint8 *src, Uint8 *left, Uint8 *right,
+                            int size, size_t frames)
+{
+    /* gather the left samples of each lane into its low 8 bytes and the
+     * right ones into its high 8 bytes */
+    const __m256i split8 = _mm256_setr_epi8(
+        0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8,
+        10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    const __m256i split16 = _mm256_setr_epi8(
+        0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15, 0, 1, 4, 5, 8,
+        9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    size_t nbytes = frames * size;
+    size_t i;
+    __m256i mm_a, mm_b, mm_l, mm_r;
+
+    for (i = 0; i + 32 <= nbytes; i += 32) {
+        mm_a = _mm256_loadu_si256((const __m256i *)(src + 2 * i));
+        mm_b = _mm256_loadu_si256((const __m256i *)(src + 2 * i + 32));
+        switch (size) {
+            case 1:
+            case 2:
+                mm_a = _mm256_shuffle_epi8(mm_a, size == 1 ? split8 : split16);
+                mm_b = _mm256_shuffle_epi8(mm_b, size == 1 ? split8 : split16);
+                /* L0 R0 | L1 R1 -> L0 L1 | R0 R1, in 64 bit blocks */
+                mm_a = _mm256_permute4x64_epi64(mm_a,
+                                                _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_b = _mm256_permute4x64_epi64(mm_b,
+                                                _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_l = _mm256_permute2x128_si256(mm_a, mm_b, 0x20);
+                mm_r = _mm256_permute2x128_si256(mm_a, mm_b, 0x31);
+                break;
+            case 4:
+                mm_l = _mm256_castps_si256(_mm256_shuffle_ps(
+                    _mm256_castsi256_ps(mm_a), _mm256_castsi256_ps(mm_b),
+                    _PG_SIMD_SHUFFLE(2, 0, 2, 0)));
+                mm_r = _mm256_castps_si256(_mm256_shuffle_ps(
+                    _mm256_castsi256_ps(mm_a), _mm256_castsi256_ps(mm_b),
+                    _PG_SIMD_SHUFFLE(3, 1, 3, 1)));
+                mm_l = _mm256_permute4x64_epi64(mm_l,
+                                                _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_r = _mm256_permute4x64_epi64(mm_r,
+                                                _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                break;
+            default:
+                mm_l = _mm256_permute4x64_epi64(
+                    _mm256_unpacklo_epi64(mm_a, mm_b),
+                    _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_r = _mm256_permute4x64_epi64(
+                    _mm256_unpackhi_epi64(mm_a, mm_b),
+                    _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                break;
+        }
+        _mm256_storeu_si256((__m256i *)(left + i), mm_l);
+        _mm256_storeu_si256((__m256i *)(right + i), mm_r);
+    }
+    return i / size;
+}
+
+size_t
+pg_audio_dot_f32_avx2(const float *a, const float *b, size_t n, float *sum)
+{
+    __m256 mm_sum = _mm256_setzero_ps();
+    float lanes[4];
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        mm_sum = _mm256_add_ps(mm_sum, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                                     _mm256_loadu_ps(b + i)));
+    }
+    _mm_storeu_ps(lanes, _mm_add_ps(_mm256_castps256_ps128(mm_sum),
+                                    _mm256_extractf128_ps(mm_sum, 1)));
+    *sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return i;
+}
+
+#else
+
+size_t
+pg_audio_s8_to_f32_avx2(const Uint8 *src, float *dst, size_t n,
+                        int is_unsigned)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_s16_to_f32_avx2(const Uint16 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_s32_to_f32_avx2(const Uint32 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_f32_to_s8_avx2(const float *src, Uint8 *dst, size_t n,
+                        int is_unsigned)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_f32_to_s16_avx2(const float *src, Uint16 *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_f32_to_s32_avx2(const float *src, Uint32 *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_interleave2_avx2(const Uint8 *left, const Uint8 *right, Uint8 *dst,
+                          int size, size_t frames)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_deinterleave2_avx2(const Uint8 *src, Uint8 *left, Uint8 *right,
+                            int size, size_t frames)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_dot_f32_avx2(const float *a, const float *b, size_t n, float *sum)
+{
+    BAD_AVX2_FUNCTION_CALL;
+    return 0;
+}
+
+#endif /* defined(__AVX2__) && defined(HAVE_IMMINTRIN_H) && \
+          !defined(SDL_DISABLE_IMMINTRIN_H) */
@@ -0,0 +1,373 @@
+#define NO_PYGAME_C_API
+#include "_pygame.h"
+#include "simd_audio.h"
+
+#if PG_ENABLE_ARM_NEON
+// sse2neon.h is from here: https://github.com/DLTcollab/sse2neon
+#include "include/sse2neon.h"
+#endif /* PG_ENABLE_ARM_NEON */
+
+#define BAD_SSE2_FUNCTION_CALL                                               \
+    printf(                                                                  \
+        "Fatal Error: Attempted calling an SSE2 function when both compile " \
+        "time and runtime support is missing. If you are seeing this "       \
+        "message, you have stumbled across a pygame bug, please report it "  \
+        "to the devs!");                                                     \
+    PG_EXIT(1)
+
+int
+pg_audio_has_sse_neon(void)
+{
+#if defined(__SSE2__)
+    return SDL_HasSSE2();
+#elif PG_ENABLE_ARM_NEON
+    return SDL_HasNEON();
+#else
+    return 0;
+#endif
+}
+
+#if defined(__SSE2__) || defined(PG_ENABLE_ARM_NEON)
+
+/* Convert to 32 bit integers, saturating, with NaN giving INT_MIN, as
+ * _pg_float_to_int() in mixer_convert.c does. Out of range, x86 converts to
+ * INT_MIN while NEON saturates, so the floats are clamped to the range that
+ * converts exactly first, and the lanes past either end are set after. */
+static __m128i
+_pg_cvt_saturate(__m128 v)
+{
+    const __m128 lo = _mm_set1_ps(-2147483648.0f);
+    /* the largest float below 2^31 */
+    const __m128 hi = _mm_set1_ps(2147483520.0f);
+    /* both false for NaN */
+    __m128i in = _mm_castps_si128(_mm_cmpge_ps(v, lo));
+    __m128i above =
+        _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(2147483648.0f)));
+    __m128i r = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, lo), hi));
+
+    r = _mm_or_si128(_mm_and_si128(in, r),
+                     _mm_andnot_si128(in, _mm_set1_epi32((int)0x80000000u)));
+    return _mm_or_si128(_mm_andnot_si128(above, r),
+                        _mm_and_si128(above, _mm_set1_epi32(0x7fffffff)));
+}
+
+size_t
+pg_audio_s8_to_f32_sse2(const Uint8 *src, float *dst, size_t n,
+                        int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi8(is_unsigned ? (char)0x80 : 0);
+    const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+    __m128i mm_src, mm_lo, mm_hi;
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        mm_src = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)),
+                               flip);
+        /* sign extend each byte to 16 bits, then each word to 32 */
+        mm_lo = _mm_srai_epi16(_mm_unpacklo_epi8(mm_src, mm_src), 8);
+        mm_hi = _mm_srai_epi16(_mm_unpackhi_epi8(mm_src, mm_src), 8);
+        _mm_storeu_ps(dst + i,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                                     _mm_unpacklo_epi16(mm_lo, mm_lo), 16)),
+                                 scale));
+        _mm_storeu_ps(dst + i + 4,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                                     _mm_unpackhi_epi16(mm_lo, mm_lo), 16)),
+                                 scale));
+        _mm_storeu_ps(dst + i + 8,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                                     _mm_unpacklo_epi16(mm_hi, mm_hi), 16)),
+                                 scale));
+        _mm_storeu_ps(dst + i + 12,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                                     _mm_unpackhi_epi16(mm_hi, mm_hi), 16)),
+                                 scale));
+    }
+    return i;
+}
+
+size_t
+pg_audio_s16_to_f32_sse2(const Uint16 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi16(is_unsigned ? (short)0x8000 : 0);
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    __m128i mm_src;
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        mm_src = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)),
+                               flip);
+        _mm_storeu_ps(dst + i,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                                     _mm_unpacklo_epi16(mm_src, mm_src), 16)),
+                                 scale));
+        _mm_storeu_ps(dst + i + 4,
+                      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(
+                                     _mm_unpackhi_epi16(mm_src, mm_src), 16)),
+                                 scale));
+    }
+    return i;
+}
+
+size_t
+pg_audio_s32_to_f32_sse2(const Uint32 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi32(is_unsigned ? (int)0x80000000u : 0);
+    const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    __m128i mm_src;
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        mm_src = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)),
+                               flip);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(mm_src), scale));
+    }
+    return i;
+}
+
+size_t
+pg_audio_f32_to_s8_sse2(const float *src, Uint8 *dst, size_t n,
+                        int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi8(is_unsigned ? (char)0x80 : 0);
+    const __m128 scale = _mm_set1_ps(128.0f);
+    __m128 mm_src;
+    __m128i mm_0, mm_1, mm_2, mm_3;
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        mm_src = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        mm_0 = _pg_cvt_saturate(mm_src);
+        mm_src = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        mm_1 = _pg_cvt_saturate(mm_src);
+        mm_src = _mm_mul_ps(_mm_loadu_ps(src + i + 8), scale);
+        mm_2 = _pg_cvt_saturate(mm_src);
+        mm_src = _mm_mul_ps(_mm_loadu_ps(src + i + 12), scale);
+        mm_3 = _pg_cvt_saturate(mm_src);
+        /* the signed packs saturate to the 8 bit range for us */
+        mm_0 = _mm_packs_epi16(_mm_packs_epi32(mm_0, mm_1),
+                               _mm_packs_epi32(mm_2, mm_3));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(mm_0, flip));
+    }
+    return i;
+}
+
+size_t
+pg_audio_f32_to_s16_sse2(const float *src, Uint16 *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi16(is_unsigned ? (short)0x8000 : 0);
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    __m128 mm_src;
+    __m128i mm_lo, mm_hi;
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        mm_src = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        mm_lo = _pg_cvt_saturate(mm_src);
+        mm_src = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        mm_hi = _pg_cvt_saturate(mm_src);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_xor_si128(_mm_packs_epi32(mm_lo, mm_hi), flip));
+    }
+    return i;
+}
+
+size_t
+pg_audio_f32_to_s32_sse2(const float *src, Uint32 *dst, size_t n,
+                         int is_unsigned)
+{
+    const __m128i flip = _mm_set1_epi32(is_unsigned ? (int)0x80000000u : 0);
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    __m128 mm_src;
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        mm_src = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_xor_si128(_pg_cvt_saturate(mm_src), flip));
+    }
+    return i;
+}
+
+size_t
+pg_audio_interleave2_sse2(const Uint8 *left, const Uint8 *right, Uint8 *dst,
+                          int size, size_t frames)
+{
+    /* bytes of each channel handled per iteration */
+    const size_t step = 16;
+    size_t nbytes = frames * size;
+    size_t i;
+    __m128i mm_l, mm_r, mm_lo, mm_hi;
+
+    for (i = 0; i + step <= nbytes; i += step) {
+        mm_l = _mm_loadu_si128((const __m128i *)(left + i));
+        mm_r = _mm_loadu_si128((const __m128i *)(right + i));
+        switch (size) {
+            case 1:
+                mm_lo = _mm_unpacklo_epi8(mm_l, mm_r);
+                mm_hi = _mm_unpackhi_epi8(mm_l, mm_r);
+                break;
+            case 2:
+                mm_lo = _mm_unpacklo_epi16(mm_l, mm_r);
+                mm_hi = _mm_unpackhi_epi16(mm_l, mm_r);
+                break;
+            case 4:
+                mm_lo = _mm_unpacklo_epi32(mm_l, mm_r);
+                mm_hi = _mm_unpackhi_epi32(mm_l, mm_r);
+                break;
+            default:
+                mm_lo = _mm_unpacklo_epi64(mm_l, mm_r);
+                mm_hi = _mm_unpackhi_epi64(mm_l, mm_r);
+                break;
+        }
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), mm_lo);
+        _mm_storeu_si128((__m128i *)(dst + 2 * i + 16), mm_hi);
+    }
+    return i / size;
+}
+
+size_t
+pg_audio_deinterleave2_sse2(const Uint8 *src, Uint8 *left, Uint8 *right,
+                            int size, size_t frames)
+{
+    const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+    size_t nbytes = frames * size;
+    size_t i;
+    __m128i mm_a, mm_b, mm_l, mm_r;
+
+    for (i = 0; i + 16 <= nbytes; i += 16) {
+        mm_a = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        mm_b = _mm_loadu_si128((const __m128i *)(src + 2 * i + 16));
+        switch (size) {
+            case 1:
+                mm_l = _mm_packus_epi16(_mm_and_si128(mm_a, low_bytes),
+                                        _mm_and_si128(mm_b, low_bytes));
+                mm_r = _mm_packus_epi16(_mm_srli_epi16(mm_a, 8),
+                                        _mm_srli_epi16(mm_b, 8));
+                break;
+            case 2:
+                /* L0 L1 R0 R1 | L2 L3 R2 R3 -> L0 L1 L2 L3 | R0 R1 R2 R3 */
+                mm_a = _mm_shufflelo_epi16(mm_a, _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_a = _mm_shufflehi_epi16(mm_a, _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_a = _mm_shuffle_epi32(mm_a, _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_b = _mm_shufflelo_epi16(mm_b, _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_b = _mm_shufflehi_epi16(mm_b, _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_b = _mm_shuffle_epi32(mm_b, _PG_SIMD_SHUFFLE(3, 1, 2, 0));
+                mm_l = _mm_unpacklo_epi64(mm_a, mm_b);
+                mm_r = _mm_unpackhi_epi64(mm_a, mm_b);
+                break;
+            case 4:
+                mm_l = _mm_castps_si128(_mm_shuffle_ps(
+                    _mm_castsi128_ps(mm_a), _mm_castsi128_ps(mm_b),
+                    _PG_SIMD_SHUFFLE(2, 0, 2, 0)));
+                mm_r = _mm_castps_si128(_mm_shuffle_ps(
+                    _mm_castsi128_ps(mm_a), _mm_castsi128_ps(mm_b),
+                    _PG_SIMD_SHUFFLE(3, 1, 3, 1)));
+                break;
+            default:
+                mm_l = _mm_unpacklo_epi64(mm_a, mm_b);
+                mm_r = _mm_unpackhi_epi64(mm_a, mm_b);
+                break;
+        }
+        _mm_storeu_si128((__m128i *)(left + i), mm_l);
+        _mm_storeu_si128((__m128i *)(right + i), mm_r);
+    }
+    return i / size;
+}
+
+size_t
+pg_audio_dot_f32_sse2(const float *a, const float *b, size_t n, float *sum)
+{
+    __m128 mm_sum0 = _mm_setzero_ps(), mm_sum1 = _mm_setzero_ps();
+    float lanes[4];
+    size_t i;
+
+    /* two accumulators hide the latency of the adds */
+    for (i = 0; i + 8 <= n; i += 8) {
+        mm_sum0 = _mm_add_ps(
+            mm_sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        mm_sum1 = _mm_add_ps(mm_sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4),
+                                                 _mm_loadu_ps(b + i + 4)));
+    }
+    _mm_storeu_ps(lanes, _mm_add_ps(mm_sum0, mm_sum1));
+    *sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return i;
+}
+
+#else
+
+size_t
+pg_audio_s8_to_f32_sse2(const Uint8 *src, float *dst, size_t n,
+                        int is_unsigned)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_s16_to_f32_sse2(const Uint16 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_s32_to_f32_sse2(const Uint32 *src, float *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_f32_to_s8_sse2(const float *src, Uint8 *dst, size_t n,
+                        int is_unsigned)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_f32_to_s16_sse2(const float *src, Uint16 *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_f32_to_s32_sse2(const float *src, Uint32 *dst, size_t n,
+                         int is_unsigned)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_interleave2_sse2(const Uint8 *left, const Uint8 *right, Uint8 *dst,
+                          int size, size_t frames)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_deinterleave2_sse2(const Uint8 *src, Uint8 *left, Uint8 *right,
+                            int size, size_t frames)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+size_t
+pg_audio_dot_f32_sse2(const float *a, const float *b, size_t n, float *sum)
+{
+    BAD_SSE2_FUNCTION_CALL;
+    return 0;
+}
+
+#endif /* defined(__SSE2__) || defined(PG_ENABLE_ARM_NEON) */
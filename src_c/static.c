@@ -415,6 +415,10 @@ PyInit_pygame_static()
 #include "font.c"
 
 #include "mixer.c"
+#include "mixer_convert.c"
+#include "mixer_dsp.c"
+#include "simd_audio_avx2.c"
+#include "simd_audio_sse2.c"
 
 #include "music.c"
 
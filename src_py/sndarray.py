@@ -29,9 +29,9 @@ is the amplitude of the wave at a particular moment in time. For
 example, in 22-kHz format, element number 5 of the array is the
 amplitude of the wave after 5/22000 seconds.
 
-Each sample is an 8-bit or 16-bit integer, depending on the data format.
-A stereo sound file has two values per sample, while a mono sound file
-only has one.
+Each sample is an 8-bit or 16-bit integer, or a 32-bit integer or float,
+depending on the data format. A mono sound has one value per sample, and
+other sounds one per channel.
 
 Sounds with 16-bit data will be treated as unsigned integers,
 if the sound sample type requests this.
@@ -76,20 +76,23 @@ def samples(sound):
     always be in the format returned from pygame.mixer.get_init().
     """
 
-    return numpy.array(sound, copy=False)
+    # the Sound exports its samples typed and shaped, so NumPy views them
+    # without a copy
+    return numpy.asarray(sound)
 
 
-def make_sound(array):
-    """pygame.sndarray.make_sound(array): return Sound
+def make_sound(array, copy=True):
+    """pygame.sndarray.make_sound(array, copy=True): return Sound
 
     Convert an array into a Sound object.
 
     Create a new playable Sound object from an array. The mixer module
     must be initialized and the array format must be similar to the mixer
-    audio format.
+    audio format. With copy=False, the Sound plays from the memory of the
+    array, which must then be in the exact mixer format.
     """
 
-    return mixer.Sound(array=array)
+    return mixer.Sound(array=array, copy=copy)
 
 
 def use_arraytype(arraytype):
@@ -0,0 +1,166 @@
+import os
+import time
+import unittest
+
+from pygame import mixer
+from pygame._sdl2 import audio
+from pygame._sdl2.sdl2 import error as sdl2_error
+
+
+class AudioDeviceCaptureTest(unittest.TestCase):
+    """Capture through the ring buffer, on the dummy audio driver, whose
+    recording device captures silence in real time."""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.driver = os.environ.get("SDL_AUDIODRIVER")
+        os.environ["SDL_AUDIODRIVER"] = "dummy"
+        mixer.quit()
+        mixer.init()
+
+    @classmethod
+    def tearDownClass(cls):
+        mixer.quit()
+        if cls.driver is None:
+            del os.environ["SDL_AUDIODRIVER"]
+        else:
+            os.environ["SDL_AUDIODRIVER"] = cls.driver
+
+    def setUp(self):
+        names = audio.get_audio_device_names(True)
+        if not names:
+            self.skipTest("no recording device")
+        self.name = names[0]
+        self.devices = []
+
+    def tearDown(self):
+        for device in self.devices:
+            device.close()
+
+    def open(self, **kwargs):
+        try:
+            device = audio.AudioDevice(
+                self.name, True, 22050, audio.AUDIO_S16, 1, 512, 0, **kwargs
+            )
+        except sdl2_error:
+            self.skipTest("the recording device can't be opened")
+        self.devices.append(device)
+        return device
+
+    def wait_for(self, condition):
+        deadline = time.time() + 2.0
+        while not condition() and time.time() < deadline:
+            time.sleep(0.01)
+        if not condition():
+            self.skipTest("the recording device captures nothing")
+
+    def test_ring__empty(self):
+        """Ensure a ring with nothing captured yet reads as empty."""
+        device = self.open(ring_frames=1024)
+
+        self.assertEqual(device.get_available(), 0)
+        self.assertEqual(device.get_dropped(), 0)
+        self.assertEqual(device.read(), b"")
+        self.assertEqual(device.read_into(bytearray(64)), 0)
+        self.assertEqual(device.get_levels(), ((0.0,), (0.0,)))
+
+    def test_ring__read(self):
+        """Ensure captured frames are taken out of the ring whole."""
+        device = self.open(ring_frames=22050)
+        device.pause(0)
+        self.wait_for(lambda: device.get_available() >= 16)
+
+        data = device.read(10)
+        self.assertIsInstance(data, bytes)
+        self.assertEqual(len(data), 10 * 2)
+
+        # a byte short of a frame is left in the ring
+        buffer = bytearray(7)
+        self.assertEqual(device.read_into(buffer), 3)
+        self.assertEqual(device.read_into(bytearray(1)), 0)
+
+        available = device.get_available()
+        data = device.read()
+        self.assertGreaterEqual(len(data), available * 2)
+        self.assertEqual(len(data) % 2, 0)
+
+    def test_ring__read_into_readonly(self):
+        """Ensure read_into needs a writable buffer."""
+        device = self.open(ring_frames=1024)
+
+        self.assertRaises(BufferError, device.read_into, b"\x00" * 8)
+        self.assertRaises(TypeError, device.read_into, 8)
+
+    def test_ring__levels(self):
+        """Ensure the levels are measured for each channel, and reset."""
+        device = self.open(ring_frames=22050)
+        device.pause(0)
+        self.wait_for(lambda: device.get_available() > 0)
+
+        rms, peak = device.get_levels()
+        self.assertEqual(len(rms), 1)
+        self.assertEqual(len(peak), 1)
+        self.assertTrue(0.0 <= rms[0] <= 1.0)
+        self.assertTrue(0.0 <= peak[0] <= 1.0)
+        self.assertLessEqual(rms[0], peak[0])
+
+        device.pause(1)
+        device.get_levels()
+        self.assertEqual(device.get_levels(), ((0.0,), (0.0,)))
+
+    def test_ring__dropped(self):
+        """Ensure frames that don't fit in a full ring are counted."""
+        device = self.open(ring_frames=256)
+        device.pause(0)
+        self.wait_for(lambda: device.get_dropped() > 0)
+
+        self.assertEqual(device.get_available(), 256)
+        device.pause(1)
+        dropped = device.get_dropped()
+        self.assertEqual(len(device.read()), 256 * 2)
+        self.assertEqual(device.get_dropped(), dropped)
+
+    def test_callback(self):
+        """Ensure a device opened with a callback calls it, and has no ring."""
+        calls = []
+
+        def callback(device, data):
+            calls.append((device, len(data)))
+
+        device = self.open(callback=callback)
+        self.assertIs(device.callback, callback)
+        self.assertRaises(sdl2_error, device.get_available)
+        self.assertRaises(sdl2_error, device.read)
+        self.assertRaises(sdl2_error, device.read_into, bytearray(4))
+        self.assertRaises(sdl2_error, device.get_levels)
+        self.assertRaises(sdl2_error, device.get_dropped)
+
+        device.pause(0)
+        self.wait_for(lambda: calls)
+        device.pause(1)
+        self.assertIs(calls[0][0], device)
+        self.assertGreater(calls[0][1], 0)
+
+    def test_arguments(self):
+        """Ensure invalid arguments are rejected."""
+        with self.assertRaises(ValueError):
+            audio.AudioDevice(self.name, False, 22050, audio.AUDIO_S16, 1, 512, 0)
+
+        with self.assertRaises(TypeError):
+            audio.AudioDevice(None, True, 22050, audio.AUDIO_S16, 1, 512, 0)
+
+        with self.assertRaises(ValueError):
+            audio.AudioDevice(
+                self.name,
+                True,
+                22050,
+                audio.AUDIO_S16,
+                2,
+                512,
+                0,
+                ring_frames=2**30,
+            )
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -3,6 +3,9 @@ import sys
 import platform
 import unittest
 import time
+import struct
+import tempfile
+import wave
 
 from pygame.tests.test_utils import example_path
 import pygame
@@ -467,6 +470,125 @@ class MixerMusicModuleTest(unittest.TestCase):
         pygame.mixer.music.pause()
         self.assertFalse(pygame.mixer.music.get_busy())
 
+    def test_play_playlist(self):
+        """Ensure playlist tracks follow each other on the exact sample."""
+        music = pygame.mixer.music
+        pygame.mixer.quit()
+        pygame.mixer.init(22050, -16, 2, offline=True)
+        frequency, size, channels = pygame.mixer.get_init()
+        frame = 2 * channels
+        first = struct.pack("=h", 1000) * channels * 20000
+        second = struct.pack("=h", -2000) * channels * 20000
+
+        with tempfile.TemporaryDirectory() as directory:
+            paths = []
+            for name, data in (("first.wav", first), ("second.wav", second)):
+                path = os.path.join(directory, name)
+                with wave.open(path, "wb") as wav:
+                    wav.setnchannels(channels)
+                    wav.setsampwidth(2)
+                    wav.setframerate(frequency)
+                    wav.writeframes(data)
+                paths.append(path)
+
+            music.set_volume(1.0)
+            music.play_playlist(paths)
+            self.assertEqual(music.get_playlist_index(), 0)
+            self.assertTrue(music.get_busy())
+            data = pygame.mixer.render_offline(41000 / frequency)
+            self.assertEqual(data, first + second + bytes(1000 * frame))
+            self.assertFalse(music.get_busy())
+            self.assertEqual(music.get_playlist_index(), -1)
+
+            # the second track starts the crossfade before the first ends
+            music.play_playlist(paths, crossfade=100)
+            data = pygame.mixer.render_offline(41000 / frequency)
+            start = (20000 - frequency // 10) * frame
+            end = start + len(second)
+            self.assertEqual(data[:start], first[:start])
+            self.assertEqual(data[len(first) : end], second[len(first) - start :])
+            self.assertEqual(data[end:], bytes(len(data) - end))
+
+            music.play_playlist(paths[:1], loops=1)
+            data = pygame.mixer.render_offline(41000 / frequency)
+            self.assertEqual(data, first * 2 + bytes(1000 * frame))
+
+            music.play_playlist(paths)
+            pygame.mixer.render_offline(0.1)
+            music.skip_track()
+            data = pygame.mixer.render_offline(0.5)
+            self.assertEqual(music.get_playlist_index(), 1)
+            self.assertEqual(data[-frame:], second[:frame])
+
+            music.extend_playlist(paths[:1])
+            music.stop()
+            self.assertEqual(music.get_playlist_index(), -1)
+            self.assertRaises(pygame.error, music.skip_track)
+            self.assertRaises(pygame.error, music.extend_playlist, paths)
+            self.assertRaises(ValueError, music.play_playlist, [])
+            self.assertRaises(TypeError, music.play_playlist, [1])
+            self.assertRaises(
+                pygame.error,
+                music.play_playlist,
+                [os.path.join(directory, "missing.wav")],
+            )
+            pygame.mixer.quit()
+
+    def test_get_position(self):
+        """Ensure get_position() follows the decoder, to the sample."""
+        music = pygame.mixer.music
+        pygame.mixer.quit()
+        pygame.mixer.init(22050, -16, 2, offline=True)
+        frequency = pygame.mixer.get_init()[0]
+        if pygame.mixer.get_sdl_mixer_version() < (2, 6, 0):
+            pygame.mixer.quit()
+            self.skipTest("needs SDL_mixer 2.6.0")
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "music.wav")
+            with wave.open(path, "wb") as wav:
+                wav.setnchannels(2)
+                wav.setsampwidth(2)
+                wav.setframerate(frequency)
+                wav.writeframes(bytes(4 * frequency * 2))
+
+            music.load(path)
+            music.play()
+            # the decoder is a whole buffer ahead of what was rendered
+            pygame.mixer.render_offline(1 / frequency)
+            buffer = pygame.mixer.get_stats()["buffer"]
+            self.assertAlmostEqual(music.get_position(), buffer / frequency)
+            pygame.mixer.render_offline((3 * buffer - 1) / frequency)
+            self.assertAlmostEqual(music.get_position(), 3 * buffer / frequency)
+            pos = music.get_pos()
+            self.assertGreaterEqual(pos, 3000 * buffer // frequency)
+            self.assertLessEqual(pos, 4000 * buffer // frequency + 1)
+
+            music.set_pos(1.5)
+            self.assertAlmostEqual(music.get_position(), 1.5)
+            # get_pos counts the time played, not the position
+            self.assertGreaterEqual(music.get_pos(), pos)
+
+            music.stop()
+            self.assertEqual(music.get_pos(), -1)
+            music.unload()
+            self.assertRaises(pygame.error, music.get_position)
+            pygame.mixer.quit()
+
+    def test_set_effects(self):
+        reverb = pygame.mixer.Reverb()
+        self.assertEqual(pygame.mixer.music.get_effects(), ())
+
+        pygame.mixer.music.set_effects([reverb])
+        self.assertEqual(pygame.mixer.music.get_effects(), (reverb,))
+        self.assertRaises(
+            ValueError, pygame.mixer.Channel(0).set_effects, [reverb]
+        )
+        self.assertRaises(TypeError, pygame.mixer.music.set_effects, [1])
+
+        pygame.mixer.music.set_effects(())
+        self.assertEqual(pygame.mixer.music.get_effects(), ())
+
     def todo_test_get_endevent(self):
         # __doc__ (as of 2008-08-02) for pygame.mixer_music.get_endevent:
 
@@ -3,7 +3,13 @@ import os
 import unittest
 import time
 import pathlib
+import struct
+import array
+import math
 import platform
+import tempfile
+import wave
+import weakref
 
 from pygame.tests.test_utils import example_path, prompt, question
 
@@ -182,6 +188,41 @@ class MixerModuleTest(unittest.TestCase):
         self.assertRaises(TypeError, mixer.set_soundfont, 0)
         self.assertRaises(TypeError, mixer.set_soundfont, ["one", "two"])
 
+    def test_load_sounds_async(self):
+        """Ensure sounds can be loaded in the background."""
+        mixer.init()
+        paths = [
+            example_path(os.path.join("data", "house_lo.wav")),
+            example_path(os.path.join("data", "house_lo.ogg")),
+            pathlib.Path(example_path(os.path.join("data", "boom.wav"))),
+        ]
+
+        loader = mixer.load_sounds_async(paths, workers=2)
+        self.assertIsInstance(loader, mixer.SoundLoader)
+        sounds = loader.result(timeout=30)
+
+        self.assertTrue(loader.done())
+        self.assertEqual(loader.get_progress(), (3, 3))
+        self.assertEqual(len(sounds), 3)
+        for sound in sounds:
+            self.assertIsInstance(sound, mixer.Sound)
+        self.assertEqual(sounds[0].get_raw(), mixer.Sound(paths[0]).get_raw())
+
+        self.assertEqual(mixer.load_sounds_async([]).result(), [])
+
+    def test_load_sounds_async__errors(self):
+        """Ensure failed background loads are reported."""
+        mixer.init()
+        loader = mixer.load_sounds_async(["/aWH8ryIyWt5BL7xf327e.wav"])
+        with self.assertRaises(pygame.error):
+            loader.result(timeout=30)
+
+        self.assertRaises(TypeError, mixer.load_sounds_async, [1])
+        self.assertRaises(ValueError, mixer.load_sounds_async, [], workers=-1)
+
+        mixer.quit()
+        self.assertRaises(pygame.error, mixer.load_sounds_async, [])
+
     def test_quit(self):
         """get_num_channels() Should throw pygame.error if uninitialized
         after mixer.quit()"""
@@ -392,6 +433,130 @@ class MixerModuleTest(unittest.TestCase):
     def _test_array_interface_fail(self, a):
         self.assertRaises(ValueError, mixer.Sound, array=a)
 
+    def test_array_keyword__conversions(self):
+        """Ensure arrays are converted to float mixers and from any layout."""
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("requires numpy")
+
+        mixer.init(22050, 32, 2, allowedchanges=0)
+        try:
+            if mixer.get_init()[1] != 32:
+                self.skipTest("float mixer not supported")
+            a = numpy.zeros([1000, 2], numpy.int16)
+            a[:, 0] = numpy.arange(-500, 500) * 64
+            a[:, 1] = -1 - a[:, 0]
+            expected = a.astype(numpy.float32) / 32768
+
+            snd = mixer.Sound(array=a)
+            self.assertTrue(numpy.array_equal(numpy.array(snd), expected))
+
+            # planar, as a Fortran ordered array is laid out
+            snd = mixer.Sound(array=numpy.asfortranarray(a))
+            self.assertTrue(numpy.array_equal(numpy.array(snd), expected))
+
+            snd = mixer.Sound(array=expected.astype(numpy.float64))
+            self.assertTrue(numpy.array_equal(numpy.array(snd), expected))
+        finally:
+            mixer.quit()
+
+        mixer.init(22050, -16, 2, allowedchanges=0)
+        try:
+            if mixer.get_init()[1] != -16:
+                self.skipTest("signed 16 bit mixer not supported")
+            f = numpy.array([[0.0, 1.0], [-1.0, 0.5], [2.0, -2.0]], numpy.float32)
+            snd = mixer.Sound(array=f)
+            self.assertEqual(
+                numpy.array(snd).tolist(),
+                [[0, 32767], [-32768, 16384], [32767, -32768]],
+            )
+        finally:
+            mixer.quit()
+
+    def test_array_keyword__float_to_int32(self):
+        """Ensure full scale floats saturate when converted for a 32 bit
+        integer mixer, the same in the vector kernels as in the scalar tail."""
+        mixer.init(22050, -32, 1, allowedchanges=0, offline=True)
+        try:
+            # 19 samples: 16 for the vector loops, 3 for the scalar tail
+            values = [1.0, -1.0, 0.5, 2.0, -2.0]
+            f = array.array("f", values * 3 + values[:4])
+            got = struct.unpack("=19i", mixer.Sound(array=f).get_raw())
+            expected = [2**31 - 1, -(2**31), 2**30, 2**31 - 1, -(2**31)]
+            self.assertEqual(list(got[:15]), expected * 3)
+            self.assertEqual(list(got[15:]), expected[:4])
+        finally:
+            mixer.quit()
+
+    def test_array_keyword__byte_order(self):
+        """Ensure arrays in the other byte order are swapped, and exported
+        typed for any number of channels."""
+        try:
+            import numpy
+        except ImportError:
+            self.skipTest("requires numpy")
+
+        mixer.init(22050, -16, 2, allowedchanges=0)
+        try:
+            if mixer.get_init()[1] != -16:
+                self.skipTest("signed 16 bit mixer not supported")
+            a = numpy.array([[1, -2], [300, -400], [32767, -32768]], numpy.int16)
+            swapped = a.astype(a.dtype.newbyteorder())
+            self.assertTrue(numpy.array_equal(numpy.array(mixer.Sound(array=a)), a))
+            self.assertTrue(
+                numpy.array_equal(numpy.array(mixer.Sound(array=swapped)), a)
+            )
+            # strided too
+            snd = mixer.Sound(array=numpy.asfortranarray(swapped))
+            self.assertTrue(numpy.array_equal(numpy.array(snd), a))
+        finally:
+            mixer.quit()
+
+        mixer.init(22050, 32, 4, allowedchanges=0)
+        try:
+            if mixer.get_init()[1:] != (32, 4):
+                self.skipTest("four channel float mixer not supported")
+            f = numpy.linspace(-1.0, 1.0, 40, dtype=numpy.float32).reshape(10, 4)
+            snd = mixer.Sound(array=f.astype(f.dtype.newbyteorder()))
+            view = numpy.asarray(snd)
+            self.assertEqual(view.dtype, numpy.float32)
+            self.assertEqual(view.shape, (10, 4))
+            self.assertTrue(numpy.array_equal(view, f))
+        finally:
+            mixer.quit()
+
+    def test_resample_buffer(self):
+        """Ensure resample_buffer converts samples between rates."""
+        mixer.init(22050, -16, 2, allowedchanges=0)
+        try:
+            frame = struct.pack("=hh", 1000, -1000)
+            samples = frame * 1000
+
+            for quality in (0, 1, 2):
+                out = mixer.resample_buffer(samples, 11025, quality=quality)
+                self.assertEqual(len(out), len(samples) * 2)
+                # a constant signal stays constant away from the ends
+                self.assertEqual(out[800:808], frame * 2)
+
+                out = mixer.resample_buffer(samples, 22050, 44100, quality)
+                self.assertEqual(len(out), len(samples) * 2)
+
+            self.assertEqual(mixer.resample_buffer(samples, 22050), samples)
+            self.assertEqual(mixer.resample_buffer(b"", 44100), b"")
+
+            self.assertRaises(ValueError, mixer.resample_buffer, samples, 0)
+            self.assertRaises(ValueError, mixer.resample_buffer, samples, -1)
+            self.assertRaises(
+                ValueError, mixer.resample_buffer, samples, 44100, quality=3
+            )
+            # not a whole number of stereo frames
+            self.assertRaises(ValueError, mixer.resample_buffer, b"abc", 44100)
+        finally:
+            mixer.quit()
+
+        self.assertRaises(pygame.error, mixer.resample_buffer, b"", 44100)
+
     def test_array_interface(self):
         mixer.init(22050, -16, 1, allowedchanges=0)
         snd = mixer.Sound(buffer=b"\x00\x7f" * 20)
@@ -579,6 +744,139 @@ class MixerModuleTest(unittest.TestCase):
             found_channel = mixer.find_channel()
             self.assertIsNotNone(found_channel)
 
+    def test_get_sample_clock(self):
+        """Ensure the sample clock starts with the mixer and only advances."""
+        self.assertRaises(pygame.error, mixer.get_sample_clock)
+        mixer.init()
+
+        first = mixer.get_sample_clock()
+        time.sleep(0.1)
+        second = mixer.get_sample_clock()
+
+        self.assertIsInstance(first, int)
+        self.assertGreaterEqual(first, 0)
+        self.assertGreaterEqual(second, first)
+
+    def test_get_stats(self):
+        """Ensure the statistics of the audio thread can be read and reset."""
+        self.assertRaises(pygame.error, mixer.get_stats)
+        mixer.init()
+        time.sleep(0.1)
+
+        stats = mixer.get_stats()
+        self.assertEqual(
+            set(stats),
+            {
+                "callbacks",
+                "mean_callback_ms",
+                "max_callback_ms",
+                "xruns",
+                "buffer",
+                "latency_ms",
+                "playing",
+                "virtual",
+                "events_lost",
+            },
+        )
+        self.assertGreaterEqual(
+            stats["max_callback_ms"], stats["mean_callback_ms"]
+        )
+        self.assertEqual(stats["playing"], 0)
+
+        mixer.get_stats(reset=True)
+        stats = mixer.get_stats()
+        self.assertLessEqual(stats["xruns"], stats["callbacks"])
+
+    def test_render_offline(self):
+        """Ensure the mixer renders scheduled sounds exactly, with no device."""
+        mixer.init()
+        self.assertRaises(pygame.error, mixer.render_offline, 0.1)
+        mixer.quit()
+
+        mixer.init(frequency=22050, size=-16, channels=2, buffer=1024, offline=True)
+        frequency, size, channels = mixer.get_init()
+        frame = abs(size) // 8 * channels
+        silence = bytes(frame)
+        sound = mixer.Sound(buffer=b"\x00\x40" * channels * 100)
+        channel = mixer.Channel(0)
+
+        self.assertEqual(mixer.get_sample_clock(), 0)
+        channel.play(sound, at_sample=1500)
+        data = mixer.render_offline(0.1)
+        rendered = round(frequency * 0.1)
+        self.assertEqual(len(data), rendered * frame)
+        self.assertGreaterEqual(mixer.get_sample_clock(), rendered)
+        self.assertEqual(data[: 1500 * frame], silence * 1500)
+        self.assertNotEqual(data[1500 * frame : 1600 * frame], silence * 100)
+        self.assertEqual(data[1600 * frame :], silence * (rendered - 1600))
+
+        # the next render carries on where the last one stopped
+        channel.play(sound, at_sample=4000)
+        data = mixer.render_offline(0.1)
+        start = (4000 - rendered) * frame
+        self.assertEqual(data[:start], silence * (4000 - rendered))
+        self.assertNotEqual(data[start : start + frame], silence)
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "render.wav")
+            self.assertIsNone(mixer.render_offline(0.5, path))
+            with wave.open(path) as wav:
+                self.assertEqual(wav.getframerate(), frequency)
+                self.assertEqual(wav.getnchannels(), channels)
+                self.assertEqual(wav.getsampwidth(), 2)
+                self.assertEqual(wav.getnframes(), round(frequency * 0.5))
+
+        self.assertEqual(mixer.render_offline(0), b"")
+        self.assertRaises(ValueError, mixer.render_offline, -1)
+
+    def test_render_offline__idle(self):
+        """Ensure an offline mixer uses no CPU between renders, and is not
+        slowed down by the disk driver settings of the environment."""
+        delay = os.environ.get("SDL_DISKAUDIODELAY")
+        os.environ["SDL_DISKAUDIODELAY"] = "1000"
+        try:
+            mixer.init(frequency=22050, size=-16, channels=2, offline=True)
+            start = time.time()
+            self.assertEqual(len(mixer.render_offline(1.0)), 22050 * 4)
+            self.assertLess(time.time() - start, 1.0)
+
+            start = time.process_time()
+            time.sleep(0.5)
+            self.assertLess(time.process_time() - start, 0.25)
+            self.assertEqual(len(mixer.render_offline(0.1)), 2205 * 4)
+        finally:
+            mixer.quit()
+            if delay is None:
+                del os.environ["SDL_DISKAUDIODELAY"]
+            else:
+                os.environ["SDL_DISKAUDIODELAY"] = delay
+
+    def test_set_volumes(self):
+        """Ensure set_volumes applies to all its channels at the next buffer."""
+        self.assertRaises(pygame.error, mixer.set_volumes, [0], [1.0])
+        mixer.init(frequency=22050, size=-16, channels=2, buffer=1024, offline=True)
+        sound = mixer.Sound(buffer=struct.pack("<hh", 8000, 8000) * 22050)
+        channels = [sound.play(loops=-1) for _ in range(3)]
+        self.assertRaises(ValueError, mixer.set_volumes, [0, 1], [1.0])
+        self.assertRaises(IndexError, mixer.set_volumes, [100], [1.0])
+        self.assertRaises(TypeError, mixer.set_volumes, ["0"], [1.0])
+        self.assertRaises(TypeError, mixer.set_volumes, [0], ["loud"])
+
+        ids = [channels[0].id, channels[1], channels[2].id]
+        mixer.set_volumes(ids, [0.5, (0.0, 1.0), 0.0])
+        data = mixer.render_offline(0.1)
+        self.assertEqual(channels[0].get_volume(), 0.5)
+        self.assertEqual(channels[1].get_volume(), 1.0)
+        self.assertEqual(channels[2].get_volume(), 0.0)
+        left, right = struct.unpack_from("<hh", data, len(data) - 4)
+        self.assertAlmostEqual(left, 4000, delta=10)
+        self.assertAlmostEqual(right, 12000, delta=10)
+
+        self.assertRaises(ValueError, mixer.set_source_locations, [0], [(0, 300)])
+        mixer.set_source_locations(channels, [(90, 0)] * 3)
+        mixer.render_offline(0.1)
+        self.assertEqual(channels[0].get_volume(), 0.5)
+
     def todo_test_get_busy(self):
         # __doc__ (as of 2008-08-02) for pygame.mixer.get_busy:
 
@@ -630,6 +928,21 @@ class MixerModuleTest(unittest.TestCase):
         # should still be default
         self.assertEqual(result, int(default_num_channels / 2))
 
+    def test_set_num_virtual(self):
+        """Ensure the number of virtual voices can be set and retrieved."""
+        mixer.init()
+        self.assertEqual(mixer.get_num_virtual(), 0)
+
+        try:
+            mixer.set_num_virtual(64)
+            self.assertEqual(mixer.get_num_virtual(), 64)
+
+            for count in (-1, 1025):
+                self.assertRaises(ValueError, mixer.set_num_virtual, count)
+            self.assertEqual(mixer.get_num_virtual(), 64)
+        finally:
+            mixer.set_num_virtual(0)
+
     def todo_test_stop(self):
         # __doc__ (as of 2008-08-02) for pygame.mixer.stop:
 
@@ -810,6 +1123,30 @@ class ChannelTypeTest(unittest.TestCase):
 
         self.fail()
 
+    def test_get_sound__and_queue(self):
+        """Ensure the playing and queued sounds follow play, queue and stop."""
+        channel = mixer.Channel(0)
+        sound = mixer.Sound(example_path(os.path.join("data", "house_lo.wav")))
+        queued = mixer.Sound(buffer=b"\x00" * 4096)
+
+        try:
+            channel.play(sound, loops=-1)
+            channel.queue(queued)
+            self.assertIs(channel.get_sound(), sound)
+            self.assertIs(channel.get_queue(), queued)
+
+            # playing drops the queue
+            channel.play(sound, loops=-1)
+            self.assertIs(channel.get_sound(), sound)
+            self.assertIsNone(channel.get_queue())
+
+            channel.stop()
+            self.assertFalse(channel.get_busy())
+            self.assertIsNone(channel.get_sound())
+            self.assertIsNone(channel.get_queue())
+        finally:
+            channel.stop()
+
     def todo_test_get_sound(self):
         # __doc__ (as of 2008-08-02) for pygame.mixer.Channel.get_sound:
 
@@ -831,6 +1168,110 @@ class ChannelTypeTest(unittest.TestCase):
 
         self.assertAlmostEqual(volume, expected_volume)
 
+    def test_set_rate(self):
+        """Ensure a channel's playback rate can be set and retrieved."""
+        channel = mixer.Channel(0)
+        self.assertEqual(channel.get_rate(), 1.0)
+
+        channel.set_rate(2.0)
+        self.assertEqual(channel.get_rate(), 2.0)
+        channel.set_rate(0.25)
+        self.assertEqual(channel.get_rate(), 0.25)
+
+        for rate in (0.0, -1.0, 8.5, float("nan")):
+            self.assertRaises(ValueError, channel.set_rate, rate)
+        self.assertRaises(TypeError, channel.set_rate, "2")
+        self.assertEqual(channel.get_rate(), 0.25)
+        channel.set_rate(1.0)
+
+    def test_play__at_sample(self):
+        """Ensure sounds can be scheduled on the sample clock."""
+        channel = mixer.Channel(0)
+        sound = mixer.Sound(buffer=b"\x00" * 4096)
+        frequency = mixer.get_init()[0]
+
+        try:
+            at = mixer.get_sample_clock() + frequency * 10
+            channel.play(sound, at_sample=at)
+            # busy and silent until the sound starts
+            self.assertTrue(channel.get_busy())
+            self.assertIs(channel.get_sound(), sound)
+            self.assertEqual(channel.get_rate(), 1.0)
+
+            # a frame already mixed starts the sound right away
+            channel.play(sound, loops=-1, at_sample=0)
+            self.assertTrue(channel.get_busy())
+            channel.stop(at_sample=mixer.get_sample_clock() + frequency)
+            self.assertTrue(channel.get_busy())
+            channel.stop(at_sample=0)
+            self.assertFalse(channel.get_busy())
+
+            self.assertRaises(ValueError, channel.play, sound, at_sample=-1)
+            self.assertRaises(TypeError, channel.play, sound, at_sample=1.5)
+            self.assertRaises(ValueError, channel.stop, at_sample=-1)
+        finally:
+            channel.stop()
+
+    def test_play__loop_region(self):
+        """Ensure a region of a sound loops between an intro and an outro."""
+        mixer.quit()
+        mixer.init(frequency=22050, size=-16, channels=1, offline=True)
+        try:
+            frequency = mixer.get_init()[0]
+            sound = mixer.Sound(buffer=struct.pack("=10h", *range(1, 11)))
+            channel = mixer.Channel(0)
+
+            channel.play(
+                sound, loops=2, loop_start=3 / frequency, loop_end=6 / frequency
+            )
+            data = mixer.render_offline(0.01)
+            played = struct.unpack(f"={len(data) // 2}h", data)
+            expected = [1, 2, 3, 4, 5, 6, 4, 5, 6, 4, 5, 6, 7, 8, 9, 10]
+            self.assertEqual(list(played[:16]), expected)
+            self.assertEqual(set(played[16:]), {0})
+
+            # the region goes on to the end of the sound by default
+            channel.play(sound, loops=-1, loop_start=8 / frequency)
+            data = mixer.render_offline(0.01)
+            played = struct.unpack(f"={len(data) // 2}h", data)
+            self.assertEqual(list(played[:14]), list(range(1, 11)) + [9, 10, 9, 10])
+            self.assertTrue(channel.get_busy())
+            channel.stop()
+
+            self.assertRaises(ValueError, channel.play, sound, loop_start=-1)
+            self.assertRaises(
+                ValueError, channel.play, sound, loop_start=0.5, loop_end=0.1
+            )
+            self.assertRaises(TypeError, channel.play, sound, loop_end="1")
+        finally:
+            mixer.quit()
+
+    def test_set_rate__while_playing(self):
+        """Ensure sounds play, queue and stop on a channel with a rate."""
+        channel = mixer.Channel(0)
+        sound = mixer.Sound(example_path(os.path.join("data", "house_lo.wav")))
+
+        try:
+            channel.set_rate(1.5)
+            channel.play(sound, loops=-1)
+            self.assertTrue(channel.get_busy())
+            self.assertIs(channel.get_sound(), sound)
+            self.assertEqual(sound.get_num_channels(), 1)
+
+            channel.set_volume(0.5, 1.0)
+            channel.set_rate(0.5)
+            channel.stop()
+            self.assertFalse(channel.get_busy())
+
+            # queueing on an idle channel plays at once
+            channel.queue(sound)
+            self.assertTrue(channel.get_busy())
+            self.assertIs(channel.get_sound(), sound)
+        finally:
+            channel.stop()
+            channel.set_volume(1.0)
+            channel.set_rate(1.0)
+
     def todo_test_get_volume__while_playing(self):
         """Ensure a channel's volume can be retrieved while playing."""
         self.fail()
@@ -970,6 +1411,45 @@ class ChannelTypeTest(unittest.TestCase):
         self.assertRaises(ValueError, lambda: ch.set_source_location(0, 256.0))
         self.assertRaises(TypeError, lambda: ch.set_source_location("", 6.25))
 
+    def test_set_bus(self):
+        """Ensure a channel can be sent to a Bus and back to the output."""
+        ch = mixer.Channel(0)
+        bus = mixer.Bus("sfx")
+        sound = mixer.Sound(buffer=b"\x00" * 4096)
+        self.assertIsNone(ch.get_bus())
+
+        ch.set_bus(bus)
+        self.assertIs(ch.get_bus(), bus)
+        ch.play(sound, loops=-1)
+        self.assertTrue(ch.get_busy())
+
+        ch.set_bus(None)
+        self.assertIsNone(ch.get_bus())
+        self.assertTrue(ch.get_busy())
+        ch.stop()
+
+        self.assertRaises(TypeError, ch.set_bus, "sfx")
+
+    def test_set_effects(self):
+        """Ensure a channel can have effects, not shared with a Bus."""
+        ch = mixer.Channel(0)
+        bus = mixer.Bus("sfx")
+        lowpass = mixer.Biquad("lowpass", frequency=500)
+        sound = mixer.Sound(buffer=b"\x00" * 4096)
+        self.assertEqual(ch.get_effects(), ())
+
+        ch.set_effects([lowpass])
+        self.assertEqual(ch.get_effects(), (lowpass,))
+        ch.play(sound, loops=-1)
+        self.assertTrue(ch.get_busy())
+        self.assertRaises(ValueError, bus.set_effects, [lowpass])
+        self.assertRaises(TypeError, ch.set_effects, [bus])
+
+        ch.set_effects([])
+        self.assertEqual(ch.get_effects(), ())
+        bus.set_effects([lowpass])
+        ch.stop()
+
     def test_id_getter(self):
         ch1 = mixer.Channel(1)
         ch2 = mixer.Channel(2)
@@ -1101,6 +1581,198 @@ class SoundTypeTest(unittest.TestCase):
         with self.assertRaisesRegex(pygame.error, "mixer not initialized"):
             mixer.Sound(file=filename)
 
+    def test_sound__stream(self):
+        """Ensure a streaming Sound can be created and played."""
+        filename = example_path(os.path.join("data", "house_lo.wav"))
+        sound = mixer.Sound(filename, stream=True)
+        loaded = mixer.Sound(file=filename)
+
+        self.assertIsInstance(sound, mixer.Sound)
+        self.assertAlmostEqual(
+            sound.get_length(), loaded.get_length(), places=2
+        )
+        self.assertRaises(TypeError, sound.get_raw)
+        self.assertRaises(BufferError, memoryview, sound)
+
+        channel = sound.play()
+        self.assertIsInstance(channel, mixer.Channel)
+        self.assertIs(channel.get_sound(), sound)
+        self.assertEqual(sound.get_num_channels(), 1)
+
+        # A stream only ever plays on one channel.
+        sound.play()
+        self.assertEqual(sound.get_num_channels(), 1)
+
+        sound.stop()
+        self.assertEqual(sound.get_num_channels(), 0)
+
+    def test_sound__stream_reinit(self):
+        """Ensure a streaming Sound plays on after the mixer is initialized
+        again with another format."""
+        filename = example_path(os.path.join("data", "house_lo.wav"))
+        sound = mixer.Sound(filename, stream=True)
+        mixer.quit()
+
+        mixer.init(22050, 8, 1, offline=True)
+        try:
+            channel = sound.play()
+            self.assertIsInstance(channel, mixer.Channel)
+            data = mixer.render_offline(0.1)
+            self.assertNotEqual(data, b"\x80" * len(data))
+        finally:
+            mixer.quit()
+
+    def test_sound__stream_file_object(self):
+        """Ensure a streaming Sound can be created from a file object."""
+        filename = example_path(os.path.join("data", "house_lo.wav"))
+
+        with open(filename, "rb") as file_obj:
+            sound = mixer.Sound(file=file_obj, stream=True)
+            channel = mixer.Channel(0)
+            channel.play(sound)
+
+            self.assertEqual(sound.get_num_channels(), 1)
+            channel.stop()
+            del sound
+
+    def test_sound__stream_invalid(self):
+        """Ensure stream=True is rejected for sources it can't stream."""
+        with self.assertRaises(TypeError):
+            mixer.Sound(buffer=b"\x00" * 16, stream=True)
+
+        with self.assertRaises(TypeError):
+            mixer.Sound(b"\x00" * 16, stream=True)
+
+        with self.assertRaises(TypeError):
+            mixer.Sound(array=bytearray(16), stream=True)
+
+        with self.assertRaises(ValueError):
+            mixer.Sound(
+                example_path(os.path.join("data", "house_lo.ogg")), stream=True
+            )
+
+    def test_sound__copy_false(self):
+        """Ensure Sound(buffer, copy=False) shares the buffer's memory."""
+        samples = bytearray(b"\x01\x02\x03\x04" * 16)
+        snd = mixer.Sound(buffer=samples, copy=False)
+
+        self.assertEqual(snd.get_raw(), bytes(samples))
+
+        samples[:4] = b"\x05\x06\x07\x08"
+        self.assertEqual(snd.get_raw()[:4], b"\x05\x06\x07\x08")
+        self.assertFalse(memoryview(snd).readonly)
+
+    def test_sound__copy_false_file(self):
+        """Ensure copy=False is rejected for sources with no memory to share."""
+        filename = example_path(os.path.join("data", "house_lo.wav"))
+
+        with self.assertRaises(TypeError):
+            mixer.Sound(filename, copy=False)
+
+        with self.assertRaises(TypeError):
+            mixer.Sound(file=filename, copy=False)
+
+        with open(filename, "rb") as file_obj:
+            with self.assertRaises(TypeError):
+                mixer.Sound(file_obj, copy=False)
+
+        # a buffer given positionally is still shared
+        samples = bytearray(b"\x01\x02" * 32)
+        snd = mixer.Sound(samples, copy=False)
+        samples[:2] = b"\x03\x04"
+        self.assertEqual(snd.get_raw()[:2], b"\x03\x04")
+
+    def test_sound__copy_false_readonly(self):
+        """Ensure a Sound sharing read-only memory exports it read-only."""
+        snd = mixer.Sound(buffer=b"\x00\x01" * 32, copy=False)
+        view = memoryview(snd)
+
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.tobytes(), b"\x00\x01" * 32)
+
+    def test_sound__copy_false_array(self):
+        """Ensure Sound(array, copy=False) needs samples in mixer format."""
+        frequency, format, channels = mixer.get_init()
+        if format != -16:
+            self.skipTest("needs a signed 16 bit mixer")
+        shape = [32] if channels == 1 else [32, channels]
+
+        samples = memoryview(bytearray(64 * channels)).cast("h", shape)
+        snd = mixer.Sound(array=samples, copy=False)
+        self.assertAlmostEqual(snd.get_length(), 32 / frequency)
+
+        samples = memoryview(bytearray(256 * channels)).cast("d", shape)
+        with self.assertRaises(ValueError):
+            mixer.Sound(array=samples, copy=False)
+
+    def test_sound__mmap(self):
+        """Ensure Sound(file, mmap=True) plays a WAV file from a memory map."""
+        frequency, format, channels = mixer.get_init()
+        if format != -16:
+            self.skipTest("needs a signed 16 bit mixer")
+        samples = struct.pack("<h", 1000) * channels * 64
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "mapped.wav")
+            with wave.open(path, "wb") as wav:
+                wav.setnchannels(channels)
+                wav.setsampwidth(2)
+                wav.setframerate(frequency)
+                wav.writeframes(samples)
+
+            snd = mixer.Sound(path, mmap=True)
+            self.assertEqual(snd.get_raw(), samples)
+            self.assertTrue(memoryview(snd).readonly)
+            self.assertAlmostEqual(snd.get_length(), 64 / frequency)
+
+            with open(path, "rb") as file_obj:
+                other = mixer.Sound(file=file_obj, mmap=True)
+            self.assertEqual(other.get_raw(), samples)
+
+            # raw samples in the mixer format have to be asked for
+            path = os.path.join(directory, "mapped.raw")
+            with open(path, "wb") as file_obj:
+                file_obj.write(samples)
+            raw = mixer.Sound(pathlib.Path(path), mmap="raw")
+            self.assertEqual(raw.get_raw(), samples)
+            with self.assertRaises(ValueError):
+                mixer.Sound(path, mmap=True)
+            with self.assertRaises(ValueError):
+                mixer.Sound(path, mmap="wav")
+
+            path = os.path.join(directory, "other.wav")
+            with wave.open(path, "wb") as wav:
+                wav.setnchannels(channels)
+                wav.setsampwidth(2)
+                wav.setframerate(frequency // 2)
+                wav.writeframes(samples)
+            with self.assertRaises(ValueError):
+                mixer.Sound(path, mmap=True)
+
+            # the maps must be gone before the files can be removed
+            del snd, other, raw
+
+        with self.assertRaises(TypeError):
+            mixer.Sound(buffer=samples, mmap=True)
+        with self.assertRaises(TypeError):
+            mixer.Sound(path, stream=True, mmap=True)
+
+    def test_sound__mmap_compressed(self):
+        """Ensure Sound(file, mmap=True) rejects compressed files rather than
+        play their bytes as samples."""
+        for name in ("house_lo.ogg", "house_lo.mp3", "house_lo.flac"):
+            path = example_path(os.path.join("data", name))
+            with self.assertRaises(ValueError):
+                mixer.Sound(path, mmap=True)
+
+        with tempfile.TemporaryDirectory() as directory:
+            # a RIFF file that is not a WAV file
+            path = os.path.join(directory, "movie.avi")
+            with open(path, "wb") as file_obj:
+                file_obj.write(b"RIFF" + struct.pack("<I", 4) + b"AVI " + bytes(64))
+            with self.assertRaises(ValueError):
+                mixer.Sound(path, mmap=True)
+
     @unittest.skipIf(IS_PYPY, "pypy skip")
     def test_samples_address(self):
         """Test the _samples_address getter."""
@@ -1298,6 +1970,167 @@ class SoundTypeTest(unittest.TestCase):
             with self.assertRaisesRegex(pygame.error, "mixer not initialized"):
                 snd.get_raw()
 
+    def test_resample(self):
+        """Ensure resample returns a new Sound at the mixer frequency."""
+        mixer.quit()
+        mixer.init(22050, -16, 1, allowedchanges=0)
+        try:
+            samples = struct.pack("=h", 1000) * 500
+            snd = mixer.Sound(buffer=samples)
+            snd.set_volume(0.5)
+
+            new = snd.resample(11025)
+            self.assertIsInstance(new, mixer.Sound)
+            self.assertIsNot(new, snd)
+            self.assertEqual(len(new.get_raw()), len(samples) * 2)
+            self.assertAlmostEqual(new.get_length(), snd.get_length() * 2)
+            self.assertEqual(new.get_volume(), snd.get_volume())
+            self.assertEqual(snd.get_raw(), samples)
+
+            new = snd.resample(44100, quality=2)
+            self.assertEqual(len(new.get_raw()), len(samples) // 2)
+
+            snd.set_priority(3)
+            self.assertEqual(snd.resample(44100).get_priority(), 3)
+            self.assertEqual(snd.resample(22050).get_raw(), samples)
+            self.assertRaises(ValueError, snd.resample, 0)
+            self.assertRaises(ValueError, snd.resample, 44100, -1)
+        finally:
+            mixer.quit()
+
+    def test_subsound(self):
+        """Ensure subsound returns a Sound sharing the samples of its parent."""
+        mixer.quit()
+        mixer.init(22050, -16, 1, allowedchanges=0)
+        try:
+            samples = struct.pack("=100h", *range(100))
+            snd = mixer.Sound(buffer=samples)
+            snd.set_volume(0.5)
+            snd.set_priority(2)
+
+            sub = snd.subsound(10 / 22050, 30 / 22050)
+            self.assertIsInstance(sub, mixer.Sound)
+            self.assertEqual(sub.get_raw(), samples[20:60])
+            self.assertEqual(sub.get_volume(), snd.get_volume())
+            self.assertEqual(sub.get_priority(), 2)
+            self.assertEqual(snd.subsound(90 / 22050).get_raw(), samples[180:])
+            self.assertEqual(snd.subsound(0, 1.0).get_raw(), samples)
+
+            # no copy is made, and the parent lives as long as the subsound
+            memoryview(sub).cast("B")[:2] = struct.pack("=h", -1)
+            self.assertEqual(snd.get_raw()[20:22], struct.pack("=h", -1))
+            parent = weakref.ref(snd)
+            del snd
+            self.assertIsNotNone(parent())
+            self.assertEqual(sub.subsound(0, 1 / 22050).get_raw(), b"\xff\xff")
+            del sub
+            self.assertIsNone(parent())
+
+            snd = mixer.Sound(buffer=samples)
+            self.assertRaises(ValueError, snd.subsound, -0.001)
+            self.assertRaises(ValueError, snd.subsound, 20 / 22050, 10 / 22050)
+            self.assertRaises(ValueError, snd.subsound, 1.0)
+            self.assertRaises(TypeError, snd.subsound, "0")
+        finally:
+            mixer.quit()
+
+    def test_set_priority(self):
+        """Ensure a sound's priority can be set and retrieved."""
+        snd = mixer.Sound(buffer=b"\x00" * 64)
+        self.assertEqual(snd.get_priority(), 0)
+
+        snd.set_priority(5)
+        self.assertEqual(snd.get_priority(), 5)
+        snd.set_priority(-2)
+        self.assertEqual(snd.get_priority(), -2)
+        self.assertRaises(TypeError, snd.set_priority, "5")
+
+    def test_play__priority(self):
+        """Ensure a sound only cuts off sounds that matter less."""
+        filename = example_path(os.path.join("data", "house_lo.wav"))
+        low = mixer.Sound(file=filename)
+        high = mixer.Sound(file=filename)
+        high.set_priority(1)
+        num_channels = mixer.get_num_channels()
+
+        try:
+            mixer.set_num_channels(1)
+            channel = low.play(loops=-1)
+            self.assertIsNotNone(channel)
+
+            # the same priority and volume cuts nothing off
+            self.assertIsNone(low.play())
+            self.assertIs(channel.get_sound(), low)
+
+            self.assertEqual(high.play(loops=-1).id, channel.id)
+            self.assertIs(channel.get_sound(), high)
+            self.assertIsNone(low.play())
+            self.assertIs(channel.get_sound(), high)
+
+            # a quieter sound of the same priority is cut off, once it can
+            # go on as a virtual voice
+            channel.set_volume(0.25)
+            self.assertIsNone(high.play())
+            mixer.set_num_virtual(4)
+            self.assertEqual(high.play().id, channel.id)
+        finally:
+            mixer.stop()
+            mixer.set_num_virtual(0)
+            mixer.set_num_channels(num_channels)
+
+    def test_play__priority_quieter(self):
+        """Ensure a quieter sound of the same priority keeps its channel
+        when it would be lost."""
+        filename = example_path(os.path.join("data", "house_lo.wav"))
+        quiet = mixer.Sound(file=filename)
+        loud = mixer.Sound(file=filename)
+        quiet.set_volume(0.25)
+        num_channels = mixer.get_num_channels()
+
+        try:
+            mixer.set_num_channels(1)
+            channel = quiet.play(loops=-1)
+            self.assertIsNotNone(channel)
+
+            self.assertIsNone(loud.play())
+            self.assertIs(channel.get_sound(), quiet)
+            self.assertTrue(channel.get_busy())
+
+            channel.set_volume(0.5, 0.0)
+            self.assertIsNone(loud.play())
+            self.assertIs(channel.get_sound(), quiet)
+        finally:
+            mixer.stop()
+            mixer.set_num_channels(num_channels)
+
+    def test_play__virtual(self):
+        """Ensure a sound cut off resumes once its channel is free again."""
+        filename = example_path(os.path.join("data", "house_lo.wav"))
+        low = mixer.Sound(file=filename)
+        short = mixer.Sound(buffer=b"\x00" * 4096)
+        short.set_priority(1)
+        num_channels = mixer.get_num_channels()
+
+        try:
+            mixer.set_num_channels(1)
+            mixer.set_num_virtual(4)
+            channel = low.play(loops=-1)
+            self.assertEqual(short.play().id, channel.id)
+
+            deadline = time.time() + 2.0
+            while channel.get_sound() is not low and time.time() < deadline:
+                time.sleep(0.01)
+            self.assertIs(channel.get_sound(), low)
+            self.assertTrue(channel.get_busy())
+
+            # stopping the sound drops it for good
+            low.stop()
+            self.assertIsNone(channel.get_sound())
+        finally:
+            mixer.stop()
+            mixer.set_num_virtual(0)
+            mixer.set_num_channels(num_channels)
+
     def test_correct_subclassing(self):
         class CorrectSublass(mixer.Sound):
             def __init__(self, file):
@@ -1332,6 +2165,568 @@ class SoundTypeTest(unittest.TestCase):
         self.assertRaises(RuntimeError, incorrect.get_volume)
 
 
+############################# SOUNDBANK CLASS TESTS ############################
+
+
+class SoundBankTypeTest(unittest.TestCase):
+    @classmethod
+    def tearDownClass(cls):
+        mixer.quit()
+
+    def setUp(self):
+        if mixer.get_init() is None:
+            mixer.init()
+        frequency, format, channels = mixer.get_init()
+        if format != -16:
+            self.skipTest("needs a signed 16 bit mixer")
+        self.channels = channels
+        wave_samples = [
+            int(8000 * math.sin(i * 2 * math.pi / 100)) for i in range(3000)
+        ]
+        self.beep = mixer.Sound(
+            buffer=b"".join(struct.pack("=h", x) * channels for x in wave_samples)
+        )
+        self.click = mixer.Sound(buffer=struct.pack("=h", 1000) * channels * 10)
+
+    def test_sound_bank(self):
+        """Ensure sounds written with write_sound_bank() load from a SoundBank."""
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "sounds.bank")
+            mixer.write_sound_bank(path, {"beep": self.beep, "click": self.click})
+
+            bank = mixer.SoundBank(path)
+            self.assertEqual(len(bank), 2)
+            self.assertEqual(bank.get_names(), ("beep", "click"))
+            self.assertIn("click", bank)
+            self.assertNotIn("boom", bank)
+
+            beep = bank.load("beep")
+            self.assertEqual(beep.get_raw(), self.beep.get_raw())
+            # clips in the mixer format play from the map, without a copy
+            self.assertTrue(memoryview(beep).readonly)
+            self.assertEqual(bank.load("click").get_raw(), self.click.get_raw())
+            self.assertIsInstance(bank.play("click"), mixer.Channel)
+            self.assertRaises(KeyError, bank.load, "boom")
+
+            # pairs work as well as a mapping, and keep their order
+            with open(path, "wb") as file_obj:
+                mixer.write_sound_bank(file_obj, [("b", self.click), ("a", self.beep)])
+            with open(path, "rb") as file_obj:
+                other = mixer.SoundBank(file_obj)
+            self.assertEqual(other.get_names(), ("b", "a"))
+
+            mixer.stop()
+            del bank, beep, other
+
+    def test_sound_bank__adpcm(self):
+        """Ensure ADPCM clips are a quarter of the size and decode on load."""
+        with tempfile.TemporaryDirectory() as directory:
+            pcm_path = os.path.join(directory, "pcm.bank")
+            adpcm_path = os.path.join(directory, "adpcm.bank")
+            mixer.write_sound_bank(pcm_path, {"beep": self.beep})
+            mixer.write_sound_bank(adpcm_path, {"beep": self.beep}, adpcm=True)
+            self.assertLess(
+                os.path.getsize(adpcm_path), os.path.getsize(pcm_path) // 3
+            )
+
+            bank = mixer.SoundBank(adpcm_path)
+            beep = bank.load("beep")
+            raw = beep.get_raw()
+            self.assertEqual(len(raw), len(self.beep.get_raw()))
+            expected = struct.unpack(f"={len(raw) // 2}h", self.beep.get_raw())
+            decoded = struct.unpack(f"={len(raw) // 2}h", raw)
+            error = max(abs(a - b) for a, b in zip(expected, decoded))
+            self.assertLess(error, 1000)
+            del bank, beep
+
+    def test_sound_bank__invalid(self):
+        """Ensure bad files and arguments raise errors."""
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "sounds.bank")
+            with open(path, "wb") as file_obj:
+                file_obj.write(b"RIFF" + bytes(60))
+            self.assertRaises(ValueError, mixer.SoundBank, path)
+
+            mixer.write_sound_bank(path, {"beep": self.beep})
+            with open(path, "r+b") as file_obj:
+                file_obj.truncate(100)
+            self.assertRaises(ValueError, mixer.SoundBank, path)
+
+            self.assertRaises(TypeError, mixer.write_sound_bank, path, [self.beep])
+            self.assertRaises(
+                TypeError, mixer.write_sound_bank, path, {"beep": "beep"}
+            )
+            self.assertRaises(
+                ValueError,
+                mixer.write_sound_bank,
+                path,
+                [("beep", self.beep), ("beep", self.click)],
+            )
+
+
+################################ BUS CLASS TESTS ###############################
+
+
+class MusicStreamTypeTest(unittest.TestCase):
+    @classmethod
+    def tearDownClass(cls):
+        mixer.quit()
+
+    def setUp(self):
+        mixer.quit()
+        mixer.init(22050, -16, 1, offline=True)
+        directory = tempfile.TemporaryDirectory()
+        self.addCleanup(directory.cleanup)
+        self.directory = directory.name
+
+    def make_wav(self, name, value, frames):
+        path = os.path.join(self.directory, name)
+        with wave.open(path, "wb") as wav:
+            wav.setnchannels(1)
+            wav.setsampwidth(2)
+            wav.setframerate(22050)
+            wav.writeframes(struct.pack("<h", value) * frames)
+        return path
+
+    def test_music_stream(self):
+        """Ensure a MusicStream plays, at its own volume."""
+        stream = mixer.MusicStream(self.make_wav("music.wav", 1000, 3000))
+        self.assertAlmostEqual(stream.get_length(), 3000 / 22050)
+        self.assertFalse(stream.get_busy())
+        self.assertIsNone(stream.get_channel())
+        self.assertEqual(stream.get_volume(), 1.0)
+
+        stream.set_volume(0.5)
+        self.assertEqual(stream.get_volume(), 0.5)
+        channel = stream.play(at_sample=mixer.get_sample_clock() + 10)
+        self.assertIsInstance(channel, mixer.Channel)
+        self.assertEqual(stream.get_channel(), channel)
+        self.assertTrue(stream.get_busy())
+        data = mixer.render_offline(3100 / 22050)
+        self.assertEqual(
+            data, bytes(20) + struct.pack("=h", 500) * 3000 + bytes(180)
+        )
+        mixer.render_offline(0.1)
+        self.assertFalse(stream.get_busy())
+
+        # the fade in starts on the first frame of the stream
+        stream.set_volume(1.0)
+        stream.play(fade_ms=50)
+        data = mixer.render_offline(3000 / 22050)
+        samples = struct.unpack(f"={len(data) // 2}h", data)
+        self.assertLess(samples[0], 50)
+        self.assertLess(samples[100], samples[500])
+        self.assertEqual(samples[2000:], (1000,) * 1000)
+
+        stream.stop()
+        self.assertFalse(stream.get_busy())
+
+    def test_play_streams(self):
+        """Ensure play_streams() starts streams on the same sample."""
+        drums = mixer.MusicStream(self.make_wav("drums.wav", 1000, 3000))
+        bass = mixer.MusicStream(self.make_wav("bass.wav", 300, 5000))
+
+        at = mixer.get_sample_clock() + 100
+        self.assertEqual(mixer.play_streams([drums, bass], at_sample=at), at)
+        self.assertTrue(drums.get_busy())
+        self.assertTrue(bass.get_busy())
+        data = mixer.render_offline(6000 / 22050)
+        self.assertEqual(
+            data,
+            bytes(200)
+            + struct.pack("=h", 1300) * 3000
+            + struct.pack("=h", 300) * 2000
+            + bytes(1800),
+        )
+
+        # a frame already mixed is made up for by skipping ahead
+        mixer.render_offline(0.1)
+        at = mixer.get_sample_clock() - 1000
+        self.assertEqual(mixer.play_streams([drums, bass], at_sample=at), at)
+        data = mixer.render_offline(4000 / 22050)
+        self.assertEqual(
+            data, struct.pack("=h", 1300) * 2000 + struct.pack("=h", 300) * 2000
+        )
+
+        clock = mixer.get_sample_clock()
+        self.assertGreater(mixer.play_streams([drums], loops=1), clock)
+        mixer.stop()
+
+        self.assertRaises(TypeError, mixer.play_streams, [drums, 1])
+        self.assertRaises(TypeError, mixer.play_streams, 1)
+        self.assertRaises(ValueError, mixer.play_streams, [drums], at_sample=-1)
+        self.assertRaises(ValueError, mixer.MusicStream, __file__)
+
+    def test_channel_play__stream_at_sample(self):
+        """Ensure a streamed Sound can be scheduled on the sample clock."""
+        sound = mixer.Sound(self.make_wav("sound.wav", 1000, 1000), stream=True)
+        channel = mixer.Channel(0)
+        channel.play(sound, at_sample=mixer.get_sample_clock() + 50)
+        data = mixer.render_offline(1100 / 22050)
+        self.assertEqual(
+            data, bytes(100) + struct.pack("=h", 1000) * 1000 + bytes(100)
+        )
+
+
+class BusTypeTest(unittest.TestCase):
+    def test_bus(self):
+        """Ensure Bus() creation works."""
+        bus = mixer.Bus("sfx")
+
+        self.assertEqual(bus.name, "sfx")
+        self.assertIsNone(bus.parent)
+        self.assertEqual(bus.get_gain(), 1.0)
+        self.assertFalse(bus.get_mute())
+        self.assertEqual(bus.get_effects(), ())
+        self.assertRaises(TypeError, mixer.Bus)
+        self.assertRaises(TypeError, mixer.Bus, 1)
+
+    def test_bus__parent(self):
+        """Ensure buses can be nested."""
+        master = mixer.Bus("master")
+        sfx = mixer.Bus("sfx", master)
+        steps = mixer.Bus("steps", parent=sfx)
+
+        self.assertIs(sfx.parent, master)
+        self.assertIs(steps.parent, sfx)
+        self.assertRaises(TypeError, mixer.Bus, "x", "master")
+
+    def test_set_gain(self):
+        bus = mixer.Bus("sfx")
+
+        bus.set_gain(0.5)
+        self.assertEqual(bus.get_gain(), 0.5)
+        bus.set_gain(2.0)
+        self.assertEqual(bus.get_gain(), 2.0)
+        self.assertRaises(ValueError, bus.set_gain, -0.5)
+        self.assertEqual(bus.get_gain(), 2.0)
+
+    def test_set_mute(self):
+        bus = mixer.Bus("sfx")
+
+        bus.set_mute(True)
+        self.assertTrue(bus.get_mute())
+        bus.set_mute(False)
+        self.assertFalse(bus.get_mute())
+
+    def test_set_effects(self):
+        """Ensure an effect can only be used once."""
+        dialogue = mixer.Bus("dialogue")
+        music = mixer.Bus("music")
+        sfx = mixer.Bus("sfx")
+        ducker = mixer.Ducker(dialogue)
+
+        music.set_effects([ducker])
+        self.assertEqual(music.get_effects(), (ducker,))
+        self.assertRaises(ValueError, sfx.set_effects, [ducker])
+        self.assertRaises(ValueError, music.set_effects, [ducker, ducker])
+        self.assertRaises(TypeError, sfx.set_effects, [1])
+        self.assertRaises(TypeError, sfx.set_effects, 1)
+        self.assertEqual(music.get_effects(), (ducker,))
+
+        music.set_effects(())
+        self.assertEqual(music.get_effects(), ())
+        sfx.set_effects([ducker])
+        self.assertEqual(sfx.get_effects(), (ducker,))
+
+    def test_effect(self):
+        """Ensure Effect is only a base class."""
+        self.assertRaises(TypeError, mixer.Effect)
+        self.assertTrue(issubclass(mixer.Ducker, mixer.Effect))
+
+    def test_ducker(self):
+        bus = mixer.Bus("dialogue")
+
+        mixer.Ducker(bus, depth=1.0, threshold=0.1, attack=0, release=100)
+        self.assertRaises(TypeError, mixer.Ducker, "dialogue")
+        self.assertRaises(ValueError, mixer.Ducker, bus, depth=1.5)
+        self.assertRaises(ValueError, mixer.Ducker, bus, threshold=0)
+        self.assertRaises(ValueError, mixer.Ducker, bus, attack=-1)
+        self.assertRaises(ValueError, mixer.Ducker, bus, release=-1)
+
+    def test_ducker__attributes(self):
+        dialogue = mixer.Bus("dialogue")
+        voice = mixer.Bus("voice")
+        ducker = mixer.Ducker(dialogue, depth=0.25)
+
+        self.assertIs(ducker.sidechain, dialogue)
+        self.assertEqual(ducker.depth, 0.25)
+        ducker.sidechain = voice
+        ducker.attack = 5
+        self.assertIs(ducker.sidechain, voice)
+        self.assertEqual(ducker.attack, 5.0)
+        with self.assertRaises(TypeError):
+            ducker.sidechain = None
+        with self.assertRaises(ValueError):
+            ducker.depth = -0.5
+
+    def test_biquad(self):
+        biquad = mixer.Biquad()
+
+        self.assertEqual(biquad.type, "lowpass")
+        self.assertEqual(biquad.frequency, 1000.0)
+        self.assertAlmostEqual(biquad.q, 0.7071, places=4)
+        self.assertEqual(biquad.gain, 0.0)
+        for filter_type in ("highpass", "bandpass", "notch", "peaking"):
+            biquad.type = filter_type
+            self.assertEqual(biquad.type, filter_type)
+        biquad = mixer.Biquad("highshelf", 8000, gain=-6)
+        self.assertEqual(biquad.type, "highshelf")
+        self.assertEqual(biquad.gain, -6.0)
+        self.assertRaises(ValueError, mixer.Biquad, "allpass")
+        self.assertRaises(TypeError, mixer.Biquad, 1)
+        self.assertRaises(ValueError, mixer.Biquad, frequency=0)
+        self.assertRaises(ValueError, mixer.Biquad, q=-1)
+
+    def test_compressor(self):
+        compressor = mixer.Compressor(threshold=-6, ratio=2)
+
+        self.assertEqual(compressor.threshold, -6.0)
+        self.assertEqual(compressor.ratio, 2.0)
+        self.assertEqual(compressor.attack, 5.0)
+        self.assertEqual(compressor.release, 100.0)
+        self.assertEqual(compressor.makeup, 0.0)
+        limiter = mixer.Compressor(-1, float("inf"), attack=0)
+        self.assertEqual(limiter.ratio, float("inf"))
+        self.assertRaises(ValueError, mixer.Compressor, threshold=3)
+        self.assertRaises(ValueError, mixer.Compressor, ratio=0.5)
+        self.assertRaises(ValueError, mixer.Compressor, ratio=float("nan"))
+        self.assertRaises(ValueError, mixer.Compressor, attack=-1)
+
+    def test_delay(self):
+        self.assertRaises(pygame.error, mixer.Delay)
+        mixer.init()
+        try:
+            delay = mixer.Delay(100, feedback=0.5)
+            self.assertEqual(delay.time, 100.0)
+            self.assertEqual(delay.feedback, 0.5)
+            self.assertAlmostEqual(delay.mix, 0.35)
+            delay.time = 2000
+            self.assertEqual(delay.time, 2000.0)
+            self.assertRaises(ValueError, mixer.Delay, 0)
+            self.assertRaises(ValueError, mixer.Delay, 20000)
+            self.assertRaises(ValueError, mixer.Delay, feedback=1)
+        finally:
+            mixer.quit()
+
+    def test_reverb(self):
+        self.assertRaises(pygame.error, mixer.Reverb)
+        mixer.init()
+        try:
+            reverb = mixer.Reverb(room_size=0.8)
+            self.assertAlmostEqual(reverb.room_size, 0.8)
+            self.assertEqual(reverb.damping, 0.5)
+            self.assertAlmostEqual(reverb.mix, 0.3)
+            bus = mixer.Bus("sfx")
+            bus.set_effects([reverb, mixer.Compressor(), mixer.Delay()])
+            self.assertRaises(ValueError, mixer.Reverb, damping=2)
+        finally:
+            mixer.quit()
+
+    @staticmethod
+    def sine(frequency, amplitude, frames):
+        """Mono 16 bit samples of a sine at 22050 Hz."""
+        return b"".join(
+            struct.pack("<h", int(amplitude * math.sin(2 * math.pi * frequency * t)))
+            for t in (i / 22050 for i in range(frames))
+        )
+
+    def render(self, effect, samples, seconds):
+        """Play samples once through effect on the output of a mono offline
+        mixer, and return what was rendered."""
+        mixer.init(22050, -16, 1, buffer=1024, offline=True)
+        try:
+            if callable(effect):
+                effect = effect()
+            mixer.set_output_effects([effect])
+            mixer.Sound(buffer=samples).play()
+            return array.array("h", mixer.render_offline(seconds))
+        finally:
+            mixer.quit()
+
+    def test_biquad__render(self):
+        """Ensure a lowpass Biquad passes a sine below its cutoff and cuts
+        one far above it."""
+        low = self.sine(100, 16000, 8820)
+        high = self.sine(8000, 16000, 8820)
+        low = self.render(mixer.Biquad("lowpass", 500), low, 0.4)
+        high = self.render(mixer.Biquad("lowpass", 500), high, 0.4)
+
+        # past the first 0.1 seconds, which the filter settles in
+        self.assertGreater(max(map(abs, low[2205:6615])), 15000)
+        self.assertLess(max(map(abs, high[2205:6615])), 16000 / 100)
+
+    def test_compressor__render(self):
+        """Ensure a limiter caps the peaks at its threshold."""
+        limiter = mixer.Compressor(-6, float("inf"), attack=0)
+        data = self.render(limiter, self.sine(440, 30000, 4410), 0.2)
+
+        threshold = 32768 * 10 ** (-6 / 20)
+        self.assertAlmostEqual(max(map(abs, data[:4410])), threshold, delta=2)
+
+    def test_delay__render(self):
+        """Ensure Delay repeats an impulse every time milliseconds, scaled by
+        mix and feedback."""
+        impulse = struct.pack("<h", 16000) + bytes(2)
+        data = self.render(
+            lambda: mixer.Delay(100, feedback=0.5, mix=0.25), impulse, 0.5
+        )
+
+        start = next(i for i, sample in enumerate(data) if sample)
+        delay = 2205  # 100 milliseconds at 22050 Hz
+        self.assertAlmostEqual(data[start], 16000 * 0.75, delta=2)
+        self.assertAlmostEqual(data[start + delay], 16000 * 0.25, delta=2)
+        self.assertAlmostEqual(data[start + 2 * delay], 16000 * 0.125, delta=2)
+        self.assertAlmostEqual(data[start + 3 * delay], 16000 * 0.0625, delta=2)
+        self.assertEqual(max(map(abs, data[start + 1 : start + delay])), 0)
+
+    def test_reverb__render(self):
+        """Ensure Reverb leaves a decaying tail once the dry sound ended."""
+        burst = self.sine(1000, 16000, 1102)
+        data = self.render(lambda: mixer.Reverb(room_size=0.8, mix=0.5), burst, 1.0)
+
+        def rms(start, end):
+            window = data[start:end]
+            return math.sqrt(sum(sample * sample for sample in window) / len(window))
+
+        early = rms(2205, 4410)
+        late = rms(15435, 17640)
+        self.assertGreater(early, 100)
+        self.assertGreater(late, 0)
+        self.assertLess(late, early / 2)
+
+    def test_analyzer(self):
+        analyzer = mixer.Analyzer(256, bands=8)
+        self.assertEqual(analyzer.fft_size, 256)
+        self.assertEqual(analyzer.bands, 8)
+        self.assertEqual(analyzer.threshold, 1.5)
+        self.assertFalse(analyzer.update())
+        self.assertEqual(analyzer.get_bands(), (0.0,) * 8)
+        self.assertRaises(ValueError, mixer.Analyzer, 1000)
+        self.assertRaises(ValueError, mixer.Analyzer, 32)
+        self.assertRaises(ValueError, mixer.Analyzer, bands=0)
+        self.assertRaises(ValueError, mixer.Analyzer, threshold=0.5)
+
+        view = analyzer.get_spectrum()
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.format, "f")
+        self.assertEqual(len(view), 129)
+        self.assertRaises(BufferError, analyzer.__init__, 512)
+        view.release()
+        analyzer.__init__(512)
+        self.assertEqual(len(analyzer.get_spectrum()), 257)
+
+    def test_set_output_effects(self):
+        """Ensure an Analyzer on the output finds the frequency of a sine."""
+        self.assertRaises(pygame.error, mixer.set_output_effects, [])
+        mixer.init(22050, -16, 1, offline=True)
+        try:
+            # right in the middle of bin 20 of a 256 sample FFT
+            frequency = 20 * 22050 / 256
+            sine = b"".join(
+                struct.pack("<h", int(16000 * math.sin(2 * math.pi * frequency * t)))
+                for t in (i / 22050 for i in range(22050))
+            )
+            analyzer = mixer.Analyzer(256, bands=8)
+            mixer.set_output_effects([analyzer])
+            self.assertEqual(mixer.get_output_effects(), (analyzer,))
+            self.assertRaises(ValueError, mixer.Bus("sfx").set_effects, [analyzer])
+
+            spectrum = analyzer.get_spectrum()
+            mixer.Sound(buffer=sine).play(loops=-1)
+            mixer.render_offline(0.1)
+            self.assertTrue(analyzer.update())
+            self.assertEqual(spectrum.tolist().index(max(spectrum)), 20)
+            self.assertAlmostEqual(spectrum[20], 16000 / 32768, places=2)
+            self.assertTrue(analyzer.get_onset())
+            bands = analyzer.get_bands()
+            self.assertGreater(max(bands), 0.4)
+
+            mixer.render_offline(0.1)
+            self.assertTrue(analyzer.update())
+            self.assertFalse(analyzer.get_onset())
+            self.assertFalse(analyzer.update())
+            spectrum.release()
+
+            mixer.set_output_effects([])
+            self.assertEqual(mixer.get_output_effects(), ())
+        finally:
+            mixer.quit()
+
+    def test_emitter(self):
+        self.assertRaises(pygame.error, mixer.Emitter)
+        mixer.init(22050, -16, 2, offline=True)
+        try:
+            emitter = mixer.Emitter((3, 0, 0), binaural=False)
+            self.assertEqual(emitter.position, pygame.Vector3(3, 0, 0))
+            self.assertEqual(emitter.velocity, pygame.Vector3(0, 0, 0))
+            self.assertEqual(emitter.model, "inverse")
+            self.assertEqual(emitter.min_distance, 1.0)
+            self.assertEqual(emitter.max_distance, 1000.0)
+            self.assertFalse(emitter.binaural)
+            self.assertAlmostEqual(emitter.get_distance(), 3.0)
+            self.assertRaises(ValueError, setattr, emitter, "model", "square")
+            self.assertRaises(TypeError, setattr, emitter, "position", (1, 2))
+            self.assertRaises(ValueError, mixer.Emitter, min_distance=0)
+            self.assertRaises(ValueError, mixer.Emitter, doppler=-1)
+
+            # on the right, at a third of the volume
+            sound = mixer.Sound(buffer=struct.pack("<hh", 9000, 9000) * 22050)
+            channel = sound.play(loops=-1)
+            channel.set_effects([emitter])
+            data = mixer.render_offline(0.2)
+            left, right = struct.unpack_from("<hh", data, len(data) - 4)
+            self.assertAlmostEqual(left, 0, delta=1)
+            self.assertAlmostEqual(right, 3000, delta=30)
+
+            # on the left, the right ear in the shadow of the head
+            emitter.position = (-3, 0, 0)
+            emitter.binaural = True
+            data = mixer.render_offline(0.2)
+            left, right = struct.unpack_from("<hh", data, len(data) - 4)
+            self.assertAlmostEqual(left, 3000, delta=30)
+            self.assertLess(right, left)
+
+            # moving along its velocity
+            start = mixer.get_sample_clock()
+            emitter.velocity = (-10, 0, 0)
+            mixer.render_offline(0.1)
+            moved = 10 * (mixer.get_sample_clock() - start) / 22050
+            self.assertAlmostEqual(emitter.get_distance(), 3 + moved, places=3)
+            self.assertEqual(emitter.position, pygame.Vector3(-3, 0, 0))
+        finally:
+            mixer.quit()
+
+    def test_set_listener(self):
+        listener = mixer.get_listener()
+        self.assertEqual(listener["position"], pygame.Vector3(0, 0, 0))
+        self.assertEqual(listener["forward"], pygame.Vector3(0, 0, -1))
+        self.assertEqual(listener["up"], pygame.Vector3(0, 1, 0))
+        self.assertEqual(listener["speed_of_sound"], 343.0)
+        self.assertRaises(ValueError, mixer.set_listener, forward=(0, 1, 0))
+        self.assertRaises(ValueError, mixer.set_listener, speed_of_sound=0)
+        self.assertRaises(TypeError, mixer.set_listener, position=(1, 2))
+
+        mixer.init(22050, -16, 2, offline=True)
+        try:
+            emitter = mixer.Emitter((0, 0, -5))
+            mixer.set_listener(position=(0, 0, -1), speed_of_sound=100)
+            listener = mixer.get_listener()
+            self.assertEqual(listener["position"], pygame.Vector3(0, 0, -1))
+            self.assertEqual(listener["velocity"], pygame.Vector3(0, 0, 0))
+            self.assertEqual(listener["speed_of_sound"], 100.0)
+            self.assertAlmostEqual(emitter.get_distance(), 4.0)
+        finally:
+            mixer.set_listener(
+                position=(0, 0, 0),
+                velocity=(0, 0, 0),
+                forward=(0, 0, -1),
+                up=(0, 1, 0),
+                speed_of_sound=343,
+            )
+            mixer.quit()
+
+
 ##################################### MAIN #####################################
 
 if __name__ == "__main__":
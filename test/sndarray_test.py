@@ -89,6 +89,34 @@ class SndarrayTest(unittest.TestCase):
         check_sound(-16, 2, [[0, -0x7FFF], [-0x7FFF, 0], [0x7FFF, 0], [0, 0x7FFF]])
         check_sound(32, 2, [[0.0, -1.0], [-1.0, 0], [1.0, 0], [0, 1.0]])
 
+    def test_make_sound__no_copy(self):
+        """Ensure a Sound made with copy=False shares the memory of the array."""
+        try:
+            pygame.mixer.init(22050, 32, 2, allowedchanges=0)
+        except pygame.error:
+            # Not all sizes are supported on all systems.
+            self.skipTest("unsupported mixer configuration")
+        try:
+            if pygame.mixer.get_init()[1:] != (32, 2):
+                self.skipTest("unsupported mixer configuration")
+            arr = array([[0.0, -1.0], [-1.0, 0], [1.0, 0], [0, 1.0]], float32)
+            snd = pygame.sndarray.make_sound(arr, copy=False)
+            samples = pygame.sndarray.samples(snd)
+            self.assertEqual(samples.dtype, float32)
+            self.assertEqual(samples.shape, (4, 2))
+
+            # effects work in place on the samples the Sound plays
+            arr[0, 0] = 0.5
+            self.assertEqual(samples[0, 0], 0.5)
+            samples *= 0.5
+            self.assertEqual(arr[1, 0], -0.5)
+
+            self.assertRaises(
+                ValueError, pygame.sndarray.make_sound, arr.astype(int16), copy=False
+            )
+        finally:
+            pygame.mixer.quit()
+
     def test_samples(self):
         null_byte = b"\x00"
 